@@ -7,11 +7,27 @@ if(PKG_CONFIG_FOUND)
 	
 	find_path(SCREEN_X11_INCLUDE_DIR NAMES X11/Xlib.h PATHS ${PCM_X11_INCLUDEDIR} PATH_SUFFIXES X11)	
 	find_library(SCREEN_X11_LIBRARY NAMES X11 PATHS ${PCM_X11_LIBDIR})
+
+	# optional extensions: MIT-SHM (Xext), XRender and XDamage (Xfixes)
+	find_path(SCREEN_XSHM_INCLUDE_DIR NAMES X11/extensions/XShm.h PATHS ${PCM_X11_INCLUDEDIR})
+	find_library(SCREEN_XEXT_LIBRARY NAMES Xext PATHS ${PCM_X11_LIBDIR})
+	find_path(SCREEN_XRENDER_INCLUDE_DIR NAMES X11/extensions/Xrender.h PATHS ${PCM_X11_INCLUDEDIR})
+	find_library(SCREEN_XRENDER_LIBRARY NAMES Xrender PATHS ${PCM_X11_LIBDIR})
+	find_path(SCREEN_XDAMAGE_INCLUDE_DIR NAMES X11/extensions/Xdamage.h PATHS ${PCM_X11_INCLUDEDIR})
+	find_library(SCREEN_XDAMAGE_LIBRARY NAMES Xdamage PATHS ${PCM_X11_LIBDIR})
+	find_library(SCREEN_XFIXES_LIBRARY NAMES Xfixes PATHS ${PCM_X11_LIBDIR})
 	
 else()
 	message( STATUS "PKG config not found. Fallback to default searching." )
 	find_path(SCREEN_X11_INCLUDE_DIR X11/Xlib.h)	
 	find_library(SCREEN_X11_LIBRARY X11)
+	find_path(SCREEN_XSHM_INCLUDE_DIR X11/extensions/XShm.h)
+	find_library(SCREEN_XEXT_LIBRARY Xext)
+	find_path(SCREEN_XRENDER_INCLUDE_DIR X11/extensions/Xrender.h)
+	find_library(SCREEN_XRENDER_LIBRARY Xrender)
+	find_path(SCREEN_XDAMAGE_INCLUDE_DIR X11/extensions/Xdamage.h)
+	find_library(SCREEN_XDAMAGE_LIBRARY Xdamage)
+	find_library(SCREEN_XFIXES_LIBRARY Xfixes)
 endif()
 
 
@@ -24,6 +40,24 @@ if(XLibs_FOUND)
 	set(XLibs_INCLUDE_DIRS ${SCREEN_X11_INCLUDE_DIR} )
 	set(XLibs_LIBRARIES ${SCREEN_X11_LIBRARY} )
 	set(XLibs_DEFINITIONS -DHAS_XLIBS=1)
+	set(XLibs_EXTENSION_DEFINITIONS "")
+
+	if (SCREEN_XSHM_INCLUDE_DIR AND SCREEN_XEXT_LIBRARY)
+		list(APPEND XLibs_LIBRARIES ${SCREEN_XEXT_LIBRARY})
+		list(APPEND XLibs_EXTENSION_DEFINITIONS SMARTX11_SHM)
+
+		if (SCREEN_XRENDER_INCLUDE_DIR AND SCREEN_XRENDER_LIBRARY)
+			list(APPEND XLibs_LIBRARIES ${SCREEN_XRENDER_LIBRARY})
+			list(APPEND XLibs_EXTENSION_DEFINITIONS SMARTX11_RENDER)
+		endif()
+
+		if (SCREEN_XDAMAGE_INCLUDE_DIR AND SCREEN_XDAMAGE_LIBRARY AND SCREEN_XFIXES_LIBRARY)
+			list(APPEND XLibs_LIBRARIES ${SCREEN_XDAMAGE_LIBRARY} ${SCREEN_XFIXES_LIBRARY})
+			list(APPEND XLibs_EXTENSION_DEFINITIONS SMARTX11_DAMAGE)
+		endif()
+	endif()
+
+	message( STATUS "X11 grabber extensions: ${XLibs_EXTENSION_DEFINITIONS}" )
 else()
 	message( FATAL_ERROR "Could not found libx11-dev ( ${SCREEN_X11_INCLUDE_DIR}, ${SCREEN_X11_LIBRARY} )" )
 endif()
@@ -291,6 +291,27 @@ private:
 
 	void handleBenchmarkCommand(const QJsonObject& message, const QString& command, int tan);
 
+	///
+	/// Handle an incoming JSON Metrics message, returns the performance counters
+	///
+	/// @param message the incoming message
+	///
+	void handleMetricsCommand(const QJsonObject& message, const QString& command, int tan);
+
+	///
+	/// Handle an incoming JSON Capture Recorder message, starts or stops a recording of the raw video frames and LED colors
+	///
+	/// @param message the incoming message
+	///
+	void handleCaptureRecorderCommand(const QJsonObject& message, const QString& command, int tan);
+
+	///
+	/// Handle an incoming JSON Threads message, returns the registered threads with their CPU time
+	///
+	/// @param message the incoming message
+	///
+	void handleThreadsCommand(const QJsonObject& message, const QString& command, int tan);
+
 	///
 	/// Handle an incoming JSON message of unknown type
 	///
@@ -120,6 +120,18 @@ public:
 	///
 	bool deleteTable(const QString& table) const;
 
+	///
+	/// @brief Group the following writes of the calling thread into one transaction
+	/// @return             True on success else false
+	///
+	bool startTransaction() const;
+
+	///
+	/// @brief Commit the transaction started with startTransaction(), rolls back on failure
+	/// @return             True on success else false
+	///
+	bool commitTransaction() const;
+
 	///
 	/// @brief Sets a table in read-only mode.
 	/// Updates will not written to the table
@@ -5,9 +5,12 @@
 // qt
 #include <QDateTime>
 #include <QJsonDocument>
+#include <QList>
 
 ///
 /// @brief settings table db interface
+///        Records are kept in a write-through cache shared by all instances (global settings are shared too),
+///        so reads after the first one do not touch SQLite and do not parse the json again.
 ///
 class SettingsTable : public DBManager
 {
@@ -56,6 +59,30 @@ public:
 
 	bool isSettingGlobal(const QString& type) const;
 
+	///
+	/// @brief Start a transaction, the cache gets the records written in it only when commitTransaction() succeeds
+	///
+	bool startTransaction() const;
+
+	bool commitTransaction() const;
+
+	///
+	/// @brief Version of the settings cache, increased on every change of any settings record.
+	///        A record read from the database is cached only if the version did not change meanwhile.
+	///
+	static quint64 getCacheVersion();
+
+	///
+	/// @brief Drop the whole settings cache, required when the settings table is modified directly (import of a backup)
+	///
+	static void invalidateCache();
+
 private:
+	QString getCacheKey(const QString& type) const;
+	void    updateCache(const QString& type, const QString& config) const;
+	void    fillCache(const QString& type, const QString& config, quint64 version) const;
+
 	const quint8 _hyperhdr_inst;
+	mutable bool _inTransaction;
+	mutable QList<QPair<QString, QString>> _pendingCache;
 };
@@ -17,8 +17,6 @@ public:
 		QImage& hyperImage,
 		int hyperLatchTime) override;
 
-	bool Play(QPainter* painter) override;
-
 	static EffectDefinition getDefinition();
 
 	bool hasOwnImage() override;
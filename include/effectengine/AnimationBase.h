@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <algorithm>
+#include <vector>
 
 #include <QDateTime>
 #include <QSize>
@@ -19,9 +20,21 @@ class AnimationBase : public QObject
 	Q_OBJECT
 
 public:
+	/// Gradient stop: position, red, green, blue, alpha
+	struct GradientStop
+	{
+		uint8_t items[5];
+	};
+
+	/// 256 step gradient lookup, premultiplied red, green, blue and alpha
+	struct GradientTable
+	{
+		uint8_t rgba[256][4];
+	};
+
 	AnimationBase(QString name);
 	QString GetName();
-	virtual bool Play(QPainter* painter)=0;
+	virtual bool Play(QPainter* painter);
 	virtual void Init(QImage& hyperImage, int hyperLatchTime)=0;	
 	virtual bool hasLedData(QVector<ColorRgb>& buffer);
 	bool		 isStop();
@@ -39,6 +52,27 @@ private:
 protected:
 	void setStopMe(bool stopMe);
 	int clamp(int v, int lo, int hi);
+
+	///
+	/// Raster helpers for animations that render directly into Image<ColorRgb> (see hasOwnImage/getImage).
+	/// Solid fills are covered by Image::fastBox.
+	///
+
+	/// @brief Maps every pixel through a palette: pixel = palette[(indexes[i] + offset) % paletteLength]
+	/// @param[in] indexes   One palette index per pixel, row by row (width * height entries)
+	/// @param[in] palette   paletteLength RGB triplets
+	static void paletteBlit(Image<ColorRgb>& image, const int* indexes, const uint8_t* palette, int paletteLength, int offset);
+
+	/// @brief Samples the stops into a lookup table, the same way QGradient interpolates (premultiplied, padded)
+	static void buildGradientTable(GradientTable& table, const QList<GradientStop>& stops);
+
+	/// @brief Precomputes the angle of every pixel around the center (1/65536 of a full turn, QConicalGradient orientation)
+	static void buildConicalMap(std::vector<uint16_t>& map, int width, int height, int centerX, int centerY);
+
+	/// @brief Draws a conical gradient rotated by angle (degrees) using a map from buildConicalMap
+	/// Stops with alpha are blended over black, or over the current content of the image when overImage is set
+	/// (the pooled image is not cleared, so only a second layer may use it).
+	static void conicalGradient(Image<ColorRgb>& image, const std::vector<uint16_t>& map, int angle, const GradientTable& table, bool overImage = false);
 };
 
 struct Point2d
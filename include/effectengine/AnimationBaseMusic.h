@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <algorithm>
+#include <memory>
 
 #include <QDateTime>
 #include <QSize>
@@ -36,21 +37,26 @@ struct MovingTarget
 	void CopyFrom(MovingTarget* source);
 };
 
+class SoundCaptureResult;
+
 class AnimationBaseMusic : public AnimationBase
 {
 	Q_OBJECT
 
 public:
 	AnimationBaseMusic(QString name);
+	~AnimationBaseMusic() override;
 	static QJsonObject GetArgs();
 
 	bool isSoundEffect() override;
 
-	void store(MovingTarget* source);
-	void restore(MovingTarget* target);
+	///
+	/// @brief The effect's own copy of the last spectrum frame it has read from SoundCapture
+	///
+	SoundCaptureResult* getSoundResult();
 
 private:
-	MovingTarget _myTarget;
+	std::unique_ptr<SoundCaptureResult> _soundResult;
 protected:
 	
 };
@@ -12,7 +12,6 @@ public:
 		QImage& hyperImage,
 		int hyperLatchTime) override;
 
-	bool Play(QPainter* painter) override;
 	bool hasLedData(QVector<ColorRgb>& buffer) override;
 private:
 	int    hyperledCount;
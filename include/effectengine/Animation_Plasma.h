@@ -20,7 +20,9 @@ public:
 		QImage& hyperImage,
 		int hyperLatchTime) override;
 
-	bool Play(QPainter* painter) override;	
+	bool hasOwnImage() override;
+
+	bool getImage(Image<ColorRgb>& newImage) override;
 
 	static EffectDefinition getDefinition();
 
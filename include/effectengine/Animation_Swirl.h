@@ -6,10 +6,7 @@ class Animation_Swirl : public AnimationBase
 	Q_OBJECT
 
 public:
-	struct SwirlGradient
-	{
-		uint8_t items[5];
-	};
+	typedef AnimationBase::GradientStop SwirlGradient;
 
 	struct SwirlColor
 	{
@@ -22,13 +19,14 @@ public:
 		QImage& hyperImage,
 		int hyperLatchTime) override;
 
-	bool Play(QPainter* painter) override;
+	bool hasOwnImage() override;
+
+	bool getImage(Image<ColorRgb>& newImage) override;
 private:
 	Point2d getPoint(const QImage& hyperImage, bool random, double x, double y);
 	int   getSTime(int hyperLatchTime, int _rt, double steps);
 		
 	void  buildGradient(QList<Animation_Swirl::SwirlGradient>& ba, bool withAlpha, QList<Animation_Swirl::SwirlColor> cc, bool closeCircle);
-	bool  imageConicalGradient(QPainter* painter, int centerX, int centerY, int angle, const QList<Animation_Swirl::SwirlGradient>& bytearray);
 
 	Point2d pointS1;
 	Point2d pointS2;	
@@ -41,6 +39,11 @@ private:
 	int increment2;
 	QList<Animation_Swirl::SwirlGradient> baS1, baS2;
 
+	int imageWidth;
+	int imageHeight;
+	GradientTable tableS1, tableS2;
+	std::vector<uint16_t> mapS1, mapS2;
+
 
 protected:
 
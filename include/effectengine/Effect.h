@@ -1,7 +1,7 @@
 #pragma once
 
 // Qt includes
-#include <QThread>
+#include <QObject>
 #include <QJsonObject>
 #include <QSize>
 #include <QImage>
@@ -11,12 +11,18 @@
 #include <utils/Image.h>
 
 #include <atomic>
+#include <vector>
 #include <effectengine/AnimationBase.h>
+#include <effectengine/EffectScheduler.h>
 
 class HyperHdrInstance;
 class Logger;
 
-class Effect : public QThread
+///
+/// A running effect. It has no own thread: start() hands it to the EffectScheduler
+/// which calls step() for every frame on one of the shared effect workers.
+///
+class Effect : public QObject, public EffectScheduler::Task
 {
 	Q_OBJECT
 
@@ -32,11 +38,20 @@ public:
 	);
 	~Effect() override;
 
-	void run() override;
+	void start();
+
+	int step() override;
+
+	void done() override;
 
 	int  getPriority() const;
 	void requestInterruption();
-	bool isInterruptionRequested();
+	bool isInterruptionRequested() const;
+
+	///
+	/// @brief Pushed by the effect engine, a paused effect is woken up when its priority becomes visible again
+	///
+	void setVisiblePriority(int priority);
 
 	QString getName()     const;
 	int getTimeout()      const;
@@ -45,10 +60,13 @@ public:
 signals:
 	void setInput(int priority, const std::vector<ColorRgb> &ledColors, int timeout_ms, bool clearEffect);
 	void setInputImage(int priority, const Image<ColorRgb> &image, int timeout_ms, bool clearEffect);
+	void finished();
 
 private:	
 	bool ImageShow();
 	bool LedShow();
+	int  stopPlaying();
+	void releaseSound();
 
 	HyperHdrInstance	*_hyperhdr;
 	const int	_priority;
@@ -58,15 +76,20 @@ private:
 	const QJsonObject	_args;
 	const QString		_imageData;
 	int64_t				_endTime;
-	QVector<ColorRgb>	_colors;
+	const int			_ledCount;
 
 	Logger*				_log;	
 	std::atomic<bool>	_interupt {};
+	std::atomic<int>	_visiblePriority;
 
 	QSize           _imageSize;
 	QImage          _image;
 	QPainter*		_painter;
 	AnimationBase*	_effect;
 	QVector<ColorRgb> _ledBuffer;
+	std::vector<ColorRgb> _ledColors;
 	uint32_t        _soundHandle;
+
+	qint64			_renderTime;
+	qint64			_renderFrames;
 };
@@ -71,6 +71,11 @@ public slots:
 private slots:
 	void effectFinished();
 
+	///
+	/// @brief Push the visible priority to the running effects
+	///
+	void visiblePriorityChanged(quint8 priority);
+
 	///
 	/// @brief is called whenever the EffectFileHandler emits updated effect list
 	///
@@ -0,0 +1,102 @@
+#pragma once
+
+// STL includes
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// util includes
+#include <utils/Logger.h>
+#include <utils/Metrics.h>
+
+///
+/// Runs all effects of all instances on a small pool of worker threads instead of one thread per effect.
+///
+/// An effect is a task: step() renders one frame and returns the delay to the next one.
+/// The due times are kept in a hashed timer wheel with TICK_MS resolution. Tasks that are due
+/// in the same tick are started by the same wakeup, and the workers sleep when no effect is running.
+///
+class EffectScheduler
+{
+public:
+	class Task
+	{
+	public:
+		virtual ~Task() = default;
+
+		///
+		/// @brief Render the next frame, called by one worker at a time
+		/// @return Delay to the next step in ms, < 0 when the task is done
+		///
+		virtual int step() = 0;
+
+		///
+		/// @brief Called by the worker after step() has reported the end of the task
+		///
+		virtual void done() = 0;
+	};
+
+	static EffectScheduler* getInstance();
+
+	///
+	/// @brief Schedule a new task, the first step runs after delay ms
+	///
+	void add(Task* task, int delay = 0);
+
+	///
+	/// @brief Run the next step of the task as soon as possible
+	///
+	void wake(Task* task);
+
+	///
+	/// @brief Remove the task, waits for its running step. Must not be called from the step itself.
+	///
+	void remove(Task* task);
+
+	///
+	/// @brief Stop the workers, the tasks left in the wheel are not called anymore
+	///
+	void stop();
+
+private:
+	EffectScheduler();
+	~EffectScheduler();
+
+	enum class State { WAITING, READY, RUNNING };
+
+	struct Entry
+	{
+		State					state;
+		uint64_t				rounds;
+		int						slot;
+		std::list<Task*>::iterator	position;
+		bool					wakeRequested;
+		bool					removed;
+	};
+
+	void schedule(Task* task, Entry& entry, int delay);
+	void unlink(Task* task, Entry& entry);
+	void advance(std::chrono::steady_clock::time_point now);
+	void run(int index);
+
+	Logger*						_log;
+	std::mutex					_mutex;
+	std::condition_variable		_wake;
+	std::condition_variable		_stepDone;
+	std::vector<std::thread>	_workers;
+	std::map<Task*, Entry>		_tasks;
+	std::vector<std::list<Task*>>	_wheel;
+	std::deque<Task*>			_ready;
+	uint64_t					_currentTick;
+	std::chrono::steady_clock::time_point	_nextTick;
+	bool						_running;
+	bool						_stopped;
+
+	Metrics::Gauge*				_metricTasks;
+	Metrics::Histogram*			_metricStep;
+};
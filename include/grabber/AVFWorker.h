@@ -40,7 +40,7 @@ class AVFWorker : public  QThread
 				unsigned	__cropLeft, unsigned  __cropTop, 
 				unsigned	__cropBottom, unsigned __cropRight,
 				quint64		__currentFrame, qint64 __frameBegin,
-				int			__hdrToneMappingEnabled, uint8_t* __lutBuffer, bool __qframe);
+				int			__hdrToneMappingEnabled, const uint8_t* __lutBuffer, bool __qframe);
 
 		void startOnThisThread();
 		void run() override;
@@ -77,7 +77,7 @@ static	volatile bool	    _isActive;
 		quint64		_currentFrame;
 		qint64		_frameBegin;
 		uint8_t	    _hdrToneMappingEnabled;
-		uint8_t*	_lutBuffer;
+		const uint8_t*	_lutBuffer;
 		bool		_qframe;
 };
 
@@ -0,0 +1,84 @@
+#pragma once
+
+// stl includes
+#include <vector>
+
+// Qt includes
+#include <QObject>
+#include <QTimer>
+#include <QByteArray>
+
+// util includes
+#include <utils/PixelFormat.h>
+#include <utils/CaptureFile.h>
+#include <hyperhdrbase/Grabber.h>
+#include <grabber/V4L2Worker.h>
+
+///
+/// Video source without hardware: generated test patterns or a capture file played in a loop.
+/// The frames go through the same V4L2 workers (decoding, cropping, LUT) as a real capture device,
+/// so the whole pipeline can be loaded and measured reproducibly.
+///
+/// source: 'bars', 'noise', 'letterbox', 'hdr' or the path of a capture file
+/// fps:    > 0 fixed rate, 0 as fast as the workers allow, < 0 rate of the recording (patterns: 60)
+///
+class ReplayGrabber : public Grabber
+{
+	Q_OBJECT
+
+public:
+	enum class Pattern { BARS = 0, NOISE, LETTERBOX, HDR_RAMP, RECORDING };
+
+	ReplayGrabber(const QString& source, PixelFormat format, int width, int height, int fps, const QString& configurationPath);
+
+	~ReplayGrabber();
+
+	void setHdrToneMappingEnabled(int mode) override;
+
+public slots:
+
+	bool start() override;
+
+	void stop() override;
+
+	void newWorkerFrame(unsigned int workerIndex, Image<ColorRgb> image, quint64 sourceCount, qint64 _frameBegin) override;
+
+	void newWorkerFrameError(unsigned int workerIndex, QString error, quint64 sourceCount) override;
+
+private slots:
+	void grabFrame();
+
+private:
+	bool init() override;
+
+	void uninit() override;
+
+	bool process_frame();
+
+	int findVideoRecord(int after) const;
+
+	bool nextRecordedFrame();
+
+	void renderPattern(QByteArray& buffer, quint64 frameIndex);
+
+	ColorRgb patternColor(int x, int y, quint64 frameIndex, uint32_t& random) const;
+
+private:
+	QString				_source;
+	Pattern				_pattern;
+	PixelFormat			_format;
+	int					_replayWidth;
+	int					_replayHeight;
+	int					_replayFps;
+	QString				_configurationPath;
+	QTimer				_timer;
+	V4L2WorkerManager	_workerManager;
+	v4l2_buffer			_workerBuffer;
+	std::vector<QByteArray>	_buffers;
+	std::vector<uint8_t>	_rgbBuffer;
+	tjhandle			_compress;
+
+	CaptureFileReader	_recording;
+	std::vector<int>	_videoRecords;
+	int					_recordIndex;
+};
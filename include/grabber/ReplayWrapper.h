@@ -0,0 +1,15 @@
+#pragma once
+
+#include <hyperhdrbase/GrabberWrapper.h>
+#include <grabber/ReplayGrabber.h>
+
+class ReplayWrapper : public GrabberWrapper
+{
+	Q_OBJECT
+
+public:
+	ReplayWrapper(const QString& source, PixelFormat format, int width, int height, int fps, const QString& configurationPath);
+
+private:
+	ReplayGrabber _grabber;
+};
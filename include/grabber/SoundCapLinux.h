@@ -6,15 +6,32 @@
 
 #include <alsa/asoundlib.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <QSemaphore>
 #include <QTimer>
 
 #include <hyperhdrbase/SoundCapture.h>
+#include <utils/Metrics.h>
 
 #define SOUNDCAPLINUX_BUF_LENP 10
+
+///
+/// ALSA capture: a dedicated thread waits with poll() for full periods and copies them from the mmap'ed
+/// device buffer (plain reads when the device has no mmap access) into a sample ring.
+/// The FFT runs on a second thread, so a slow analysis never delays the capture.
+///
+/// Devices without a hardware clock (e.g. the 'null' plugin or a 'file' plugin reading a recording)
+/// are paced to the sample rate, so the capture can be tested without a sound card.
+///
 class SoundCapLinux : public SoundCapture
 {
     friend class HyperHdrDaemon;
+    friend class SoundCapLinuxTest;
     public:
 
     private:
@@ -25,10 +42,35 @@ class SoundCapLinux : public SoundCapture
 			void    Stop() override;
 
 			snd_pcm_t*				_handle;
-			snd_async_handler_t*	_pcmCallback;	
 
 	private:
-			static void RecordCallback(snd_async_handler_t* audioHandler);
+			void captureLoop();
+			void analysisLoop();
+
+			bool readPeriod(snd_pcm_uframes_t frames);
+			bool recover(int error);
+
+			void pushSamples(const int16_t* samples, size_t count);
+			size_t queuedSamples() const;
+
+			bool					_mmapAccess;
+			snd_pcm_uframes_t		_framesPerPeriod;
+			int						_wakeFd;
+
+			std::thread				_captureThread;
+			std::thread				_analysisThread;
+			std::atomic<bool>		_captureRunning;
+
+			// single producer (capture) / single consumer (analysis) sample ring
+			std::vector<int16_t>	_ring;
+			std::atomic<size_t>		_ringHead;
+			std::atomic<size_t>		_ringTail;
+			std::vector<int16_t>	_readBuffer;
+
+			std::mutex				_analysisMutex;
+			std::condition_variable	_analysisWake;
 
-			static int16_t    _soundBuffer[(1<<SOUNDCAPLINUX_BUF_LENP)*2];			
+			Metrics::Counter*		_metricXruns;
+			Metrics::Counter*		_metricDropped;
+			Metrics::Histogram*		_metricAnalysis;
 };
@@ -56,12 +56,14 @@ private slots:
 	int read_frame();
 
 private:
-	QString GetSharedLut();
+	void enumerateV4L2devices(bool silent, bool refresh = false);
 
-	void enumerateV4L2devices(bool silent);
+	QString getDevicesSignature();
+
+	bool loadDevicesCache(const QString& signature);
+
+	void saveDevicesCache(const QString& signature);
 
-	void loadLutFile(PixelFormat color = PixelFormat::NO_CHANGE);
-	
 	void getV4L2devices();
 
 	bool init() override;
@@ -43,7 +43,7 @@ class V4L2Worker : public  QThread
 				unsigned	__cropLeft, unsigned  __cropTop, 
 				unsigned	__cropBottom, unsigned __cropRight,
 				quint64		__currentFrame, qint64 __frameBegin,
-				int			__hdrToneMappingEnabled, uint8_t* __lutBuffer, bool __qframe);
+				int			__hdrToneMappingEnabled, const uint8_t* __lutBuffer, bool __qframe);
 
 		void startOnThisThread();
 		void run() override;
@@ -84,7 +84,7 @@ static	volatile bool	    _isActive;
 		quint64		_currentFrame;
 		qint64		_frameBegin;
 		uint8_t	    _hdrToneMappingEnabled;
-		uint8_t*	_lutBuffer;
+		const uint8_t*	_lutBuffer;
 		bool		_qframe;
 };
 
@@ -75,4 +75,8 @@ private:
 	void*					_library;
 	int						_actualDisplay;
 	struct x11Handle*		_handle;
+	qint64					_lastFrameTime;
+
+	Metrics::Histogram*		_metricCaptureTime;
+	Metrics::Counter*		_metricUnchangedFrames;
 };
@@ -21,6 +21,16 @@ struct x11Handle
 	int width;
 	int height;
 	int size;
+
+	// in: crop and maximum width for the scaling on the X server (maxWidth 0 = no scaling)
+	int cropLeft, cropTop, cropRight, cropBottom;
+	int maxWidth;
+
+	// out: the frame is already cropped and scaled, the frame did not change since the previous one (XDamage)
+	int scaled;
+	int changed;
+
+	void* priv;
 };
 
 extern "C" struct x11Displays* enumerateX11Displays();
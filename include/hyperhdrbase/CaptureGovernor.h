@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <utils/ColorRgb.h>
+#include <utils/Image.h>
+#include <utils/Logger.h>
+#include <utils/Metrics.h>
+
+///
+/// Closed-loop governor of the video capture.
+/// The instances report how many frames they processed, how long it took and how many new
+/// frames actually reached the LED output (smoothing ticks or direct writes). Once per second
+/// the governor compares the capture rate with that demand and raises the software decimation
+/// and lowers the number of decoding workers so the grabber does not decode frames the LEDs
+/// will never show. A scene cut restores the full frame rate immediately.
+///
+/// The decimation of the governor never goes below the user setting and it is not applied
+/// while the automatic signal detection is calibrating.
+///
+class CaptureGovernor
+{
+public:
+	static constexpr int MAX_INSTANCES = 32;
+
+	CaptureGovernor(Logger* log);
+
+	void setEnabled(bool enabled);
+
+	bool isEnabled() const;
+
+	///
+	/// @brief Called by the grabber wrapper for every frame forwarded to the instances
+	/// @param image          The captured frame
+	/// @param decimation     Current decimation of the grabber (in: effective, out: governor)
+	/// @param workers        Worker limit (out, 0 = all workers)
+	/// @param decodeTimeMs   Average time to decode a frame
+	/// @return true when the limits have changed
+	///
+	bool frameCaptured(const Image<ColorRgb>& image, int& decimation, int& workers, double decodeTimeMs);
+
+	///
+	/// @brief Instance side reporting, lock-free and safe from any thread
+	///
+	static void reportProcessed(int instance, int64_t microseconds);
+	static void reportConsumed(int instance);
+
+private:
+	bool detectSceneCut(const Image<ColorRgb>& image);
+	void startWindow(int64_t now);
+
+	static constexpr int SIGNATURE_SIZE = 8;
+
+	Logger*		_log;
+	bool		_enabled;
+	int			_decimation;
+	int			_workers;
+	int64_t		_windowStart;
+	int64_t		_holdUntil;
+	int			_frames;
+	uint64_t	_lastProcessed[MAX_INSTANCES];
+	uint64_t	_lastProcessedTime[MAX_INSTANCES];
+	uint64_t	_lastConsumed[MAX_INSTANCES];
+	uint8_t		_signature[SIGNATURE_SIZE * SIGNATURE_SIZE];
+	bool		_signatureValid;
+
+	Metrics::Gauge*		_metricDecimation;
+	Metrics::Gauge*		_metricWorkers;
+	Metrics::Counter*	_metricSceneCuts;
+};
@@ -10,8 +10,10 @@
 #include <utils/ImageResampler.h>
 #include <utils/Logger.h>
 #include <utils/Components.h>
+#include <utils/Metrics.h>
 #include <hyperhdrbase/DetectionManual.h>
 #include <hyperhdrbase/DetectionAutomatic.h>
+#include <hyperhdrbase/LutMapping.h>
 
 #include <QMultiMap>
 #include <QSemaphore>
@@ -81,6 +83,28 @@ public:
 
 	int  getFpsSoftwareDecimation();
 
+	///
+	/// @brief Limits of the adaptive capture governor
+	/// @param decimation  Minimum software decimation (the user setting still applies)
+	/// @param workers     Maximum number of decoding workers, 0 = all
+	///
+	void setCaptureLimits(int decimation, int workers);
+
+	///
+	/// @return Software decimation used for the next frame
+	///
+	int  getCaptureDecimation();
+
+	///
+	/// @return Number of decoding workers that can be used out of the available ones
+	///
+	unsigned int getCaptureWorkers(unsigned int available) const;
+
+	///
+	/// @return Average time to decode a frame in the current statistics period (ms)
+	///
+	double getAverageFrameTime() const;
+
 	int  getActualFps();
 
 	void setEncoding(QString enc);
@@ -153,7 +177,18 @@ signals:
 protected:
 	void loadLutFile(PixelFormat color, const QList<QString>& files);
 
-	void processSystemFrameBGRA(uint8_t* source, int lineSize = 0);
+	///
+	/// @brief Load the LUT from the configuration folder, the shared 'lut' folder next to the binary
+	/// or the system folder, whichever is found first
+	///
+	void loadLutFile(PixelFormat color, const QString& configurationPath);
+
+	///
+	/// @brief The 'lut' folder shipped next to the binary
+	///
+	QString GetSharedLut();
+
+	void processSystemFrameBGRA(uint8_t* source, int lineSize = 0, bool useCropping = true);
 
 	struct DeviceControlCapability
 	{
@@ -210,6 +245,10 @@ protected:
 		unsigned int	badFrame, goodFrame, segment;
 	} frameStat;
 
+	Metrics::Counter*	_metricFrames;
+	Metrics::Counter*	_metricBadFrames;
+	Metrics::Histogram*	_metricFrameTime;
+
 	volatile uint64_t   _currentFrame;
 
 	QString		_deviceName;
@@ -221,12 +260,15 @@ protected:
 	bool		_restartNeeded;
 	bool		_initialized;
 	int			_fpsSoftwareDecimation;
+	int			_governorDecimation;
+	int			_governorWorkers;
 
 	PixelFormat _actualVideoFormat;
 	int			_actualWidth, _actualHeight, _actualFPS;
 	QString		_actualDeviceName;
 
-	uint8_t*	_lutBuffer;
+	std::shared_ptr<LutMapping> _lut;
+	const uint8_t*	_lutBuffer;
 	bool		_lutBufferInit;
 
 	int			_lineLength;
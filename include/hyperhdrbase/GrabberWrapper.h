@@ -14,6 +14,7 @@
 #include <utils/settings.h>
 #include <hyperhdrbase/Grabber.h>
 #include <hyperhdrbase/DetectionAutomatic.h>
+#include <hyperhdrbase/CaptureGovernor.h>
 
 class GlobalSignals;
 class QTimer;
@@ -128,4 +129,6 @@ protected:
 
 	int			_benchmarkStatus;
 	QString		_benchmarkMessage;
+
+	CaptureGovernor	_governor;
 };
@@ -164,6 +164,8 @@ private slots:
 
 private:
 	friend class HyperHdrDaemon;
+	/// hyperhdr-bench runs its own instance
+	friend class BenchEnvironment;
 	///
 	/// @brief Construct the Manager
 	/// @param The root path of all userdata
@@ -197,4 +199,10 @@ private:
 
 	/// All pending requests
 	QMap<quint8, PendingRequests> _pendingRequests;
+
+	/// start time of the queued instances (ms)
+	QMap<quint8, qint64> _startTimes;
+
+	/// time of the startAll() call (ms), 0 once all of its instances are running
+	qint64 _startAllTime;
 };
@@ -9,6 +9,7 @@
 #include <hyperhdrbase/LedString.h>
 #include <hyperhdrbase/ImageToLedsMap.h>
 #include <utils/Logger.h>
+#include <utils/Metrics.h>
 
 // settings
 #include <utils/settings.h>
@@ -73,6 +74,13 @@ public:
 	void setHardLedMappingType(int mapType);
 	void setSparseProcessing(bool sparseProcessing);
 
+	///
+	/// @brief Configure the static frame detection
+	/// @param threshold  Allowed mean difference per color channel in the area of a led, 0 = disabled
+	/// @param refresh    A static frame is processed anyway after this time (ms)
+	///
+	void setFrameSkip(int threshold, int refresh);
+
 public slots:
 	/// Enable or disable the black border detector based on component
 	void setBlackbarDetectDisable(bool enable);
@@ -154,10 +162,20 @@ private:
 
 	quint8 _instanceIndex;
 
+	// static frame detection
+	int		_frameSkipThreshold;
+	int		_frameSkipRefresh;
+	uint64_t	_lastProcessedTime;
+	std::vector<ColorRgb> _lastColors;
+
 	// statistics
 	struct {
 		uint64_t	 ledStatBegin;
 		int   		 averageFrame;
 		unsigned int total;
+		unsigned int skipped;
 	} ledFrameStat;
+
+	Metrics::Histogram* _metricProcessTime;
+	Metrics::Counter*   _metricSkippedFrames;
 };
@@ -68,6 +68,17 @@ namespace hyperhdr
 				
 		std::vector<ColorRgb> Process(const Image<ColorRgb>& image, uint16_t* advanced);
 
+		///
+		/// Cheap change detection: sum of absolute differences of a few probe pixels in the area
+		/// of every led, compared with the last image that reported a change.
+		///
+		/// @param[in] image      The image to check
+		/// @param[in] threshold  Allowed mean difference per color channel in the area of a led
+		///
+		/// @return true when the area of any led changed more than the threshold (the image becomes the new reference)
+		///
+		bool hasChanged(const Image<ColorRgb>& image, int threshold);
+
 	private:		
 		std::vector<ColorRgb> getMeanLedColor(const Image<ColorRgb>& image) const;		
 
@@ -94,6 +105,12 @@ namespace hyperhdr
 
 		int _groupMin;
 		int _groupMax;
+
+		/// Probe pixels for hasChanged(), the end of the probes of each led and their last values
+		std::vector<int32_t> _probeMap;
+		std::vector<size_t> _probeLeds;
+		std::vector<uint8_t> _probeReference;
+		bool _probeValid;
 		
 		ColorRgb calcMeanColor(const Image<ColorRgb>& image, const std::vector<int32_t>& colors) const;
 
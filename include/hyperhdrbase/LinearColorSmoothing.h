@@ -10,6 +10,7 @@
 // hyperhdr incluse
 #include <leddevice/LedDevice.h>
 #include <utils/Components.h>
+#include <utils/Metrics.h>
 
 // settings
 #include <utils/settings.h>
@@ -198,6 +199,10 @@ private:
 	SmoothingType _smoothingType;
 	bool		  _infoUpdate;
 	bool		  _infoInput;
+	bool		  _newTarget;
 	int           _timerWatchdog;
 	int			  debugCounter;
+
+	Metrics::Histogram* _metricUpdateTime;
+	Metrics::Counter*   _metricFrames;
 };
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QString>
+#include <QMutex>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+///
+/// Read-only LUT table shared by all grabbers of the process.
+/// The lut_lin_tables.3d file is mapped once (page cache, no private copy) and every grabber
+/// that opens the same file gets the same reference-counted instance. The file holds several
+/// tables of LUT_FILE_SIZE bytes (HDR RGB, HDR YUV, SDR YUV): selecting one is only a pointer
+/// into the mapping. The mapping is followed by a readable guard page because the decoders
+/// read the last entry of a table as uint32_t. On Windows every table is read once into memory instead.
+///
+/// A LUT file must be replaced (not rewritten in place) while HyperHDR is running: a new file
+/// gets a new mapping on the next load, the old one is released with its last user.
+///
+class LutMapping
+{
+public:
+	~LutMapping();
+
+	LutMapping(const LutMapping&) = delete;
+	LutMapping& operator=(const LutMapping&) = delete;
+
+	///
+	/// @brief Map the LUT file or return the mapping already used by another grabber
+	/// @param fileName LUT file
+	/// @return nullptr when the file cannot be opened or mapped
+	///
+	static std::shared_ptr<LutMapping> open(const QString& fileName);
+
+	///
+	/// @brief Internal YUV to RGB table used when no LUT file is available, generated once
+	///
+	static std::shared_ptr<LutMapping> internalYuvTable();
+
+	///
+	/// @brief Table at the given index (LUT_FILE_SIZE bytes) and prefetch it
+	/// @return nullptr when the index is out of range or the table cannot be read
+	///
+	const uint8_t* table(int index);
+
+	qint64 size() const;
+	int tableCount() const;
+
+private:
+	LutMapping();
+
+	bool map(const QString& fileName);
+
+	QString		_fileName;
+	qint64		_size;
+	uint8_t*	_mapped;
+	size_t		_mappedSize;
+	QMutex		_tablesMutex;
+	std::vector<std::unique_ptr<uint8_t[]>> _tables;
+};
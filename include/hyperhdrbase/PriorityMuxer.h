@@ -15,6 +15,7 @@
 #include <utils/ColorRgb.h>
 #include <utils/Image.h>
 #include <utils/Components.h>
+#include <utils/Metrics.h>
 
 // global defines
 #define SMOOTHING_MODE_DEFAULT 0
@@ -277,4 +278,7 @@ private:
 	QTimer* _blockTimer;
 	QTime   _startTime;
 	bool    _startWarning;
+
+	Metrics::Counter* _metricInputFrames;
+	Metrics::Counter* _metricPriorityChanges;
 };
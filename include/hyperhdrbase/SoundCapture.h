@@ -9,14 +9,21 @@
 #include <QColor>
 #include <effectengine/AnimationBaseMusic.h>
 
+#include <atomic>
+
 #define SOUNDCAP_N_WAVE      1024
 #define SOUNDCAP_LOG2_N_WAVE 10
+#define SOUNDCAP_HOP         (SOUNDCAP_N_WAVE / 2)
 
 #define SOUNDCAP_RESULT_RES 8
 
+// published spectrum frames kept for the readers, a slot is rewritten every SOUNDCAP_PUBLISHED hops (~90ms)
+#define SOUNDCAP_PUBLISHED  4
+
 class SoundCaptureResult
 {
 	friend class  SoundCapture;
+	friend class  SoundCaptureTest;
 
 	int32_t _maxAverage;	
 	bool     _validData;
@@ -76,6 +83,8 @@ private:
 class  SoundCapture : public QObject
 {
 	Q_OBJECT
+	friend class  SoundCaptureTest;
+
 protected:
 	static SoundCapture* _soundInstance;
 
@@ -87,9 +96,10 @@ protected:
 	QList<QString>   _availableDevices;
 	bool	         _isActive;
 	QString          _selectedDevice;
+	int              _periodSize;		// frames per capture period, used by the backends that can set it
+	int              _bufferPeriods;	// periods in the device buffer
 	static bool		 _isRunning;
 	QList<uint32_t>  _instances;
-	static uint32_t  _resultIndex;
 	static SoundCaptureResult   _resultFFT;
 
 public:	
@@ -98,7 +108,16 @@ public:
 	QList<QString>		getDevices() const;
 	bool				getActive() const;
 	QString				getSelectedDevice() const;	
-	SoundCaptureResult* hasResult(uint32_t& lastIndex);
+
+	///
+	/// @brief Copy the latest spectrum frame into the effect's own result if it is newer than lastIndex
+	///
+	/// The reader never blocks the audio thread: the frames are published through a seqlock,
+	/// every effect keeps its own read cursor (lastIndex) and the frames it missed are counted.
+	///
+	/// @return The effect's result or NULL if there is no new frame
+	///
+	SoundCaptureResult* hasResult(AnimationBaseMusic* effect, uint32_t& lastIndex);
 	SoundCaptureResult* hasResult(AnimationBaseMusic *effect, uint32_t& lastIndex, bool* newAverage, bool* newSlow, bool* newFast, int *isMulti);
 	void				ForcedClose();
 
@@ -119,11 +138,35 @@ private:
 
 	static QSemaphore   _semaphore;
 
-
-	// FFT
-	static int16_t  _imgBuffer[SOUNDCAP_N_WAVE * 2];	
-	static int16_t  _lutSin[SOUNDCAP_N_WAVE - SOUNDCAP_N_WAVE / 4];
-
-	static inline int16_t  FIX_MPY(int16_t  a, int16_t  b);	        
-	static int32_t fix_fft(int16_t fr[], int16_t fi[], int16_t m, bool inverse);
+	struct PublishedResult
+	{
+		std::atomic<uint32_t>	sequence;	// odd while the slot is written
+		std::atomic<uint32_t>	index;
+		SoundCaptureResult		result;
+	};
+
+	// index of the last published frame, 0 = none yet
+	static std::atomic<uint32_t> _resultIndex;
+	static PublishedResult       _published[SOUNDCAP_PUBLISHED];
+
+	static void PublishResult();
+	static bool ReadResult(uint32_t& lastIndex, SoundCaptureResult& target);
+
+
+	// FFT: real input, Hann window, 50% overlap
+	static int16_t  _history[SOUNDCAP_N_WAVE];
+	static int16_t  _hopBuffer[SOUNDCAP_HOP];
+	static int      _hopFill;
+
+	static float    _window[SOUNDCAP_N_WAVE];
+	static float    _twiddleRe[SOUNDCAP_N_WAVE / 2];
+	static float    _twiddleIm[SOUNDCAP_N_WAVE / 2];
+	static float    _fftRe[SOUNDCAP_N_WAVE / 2];
+	static float    _fftIm[SOUNDCAP_N_WAVE / 2];
+	static uint16_t _bitReverse[SOUNDCAP_N_WAVE / 2];
+	static uint8_t  _bandIndex[SOUNDCAP_N_WAVE / 2];
+
+	static void InitSpectrum();
+	static bool AnaliseHop();
+	static void RealFFT();
 };
@@ -15,6 +15,7 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <atomic>
 
 // Utility includes
 #include <utils/ColorRgb.h>
@@ -23,6 +24,8 @@
 #include <utils/Logger.h>
 #include <functional>
 #include <utils/Components.h>
+#include <utils/TripleBuffer.h>
+#include <utils/Metrics.h>
 
 class LedDevice;
 
@@ -346,6 +349,9 @@ protected:
 	/// Current device's type
 	QString _activeDeviceType;
 
+	/// Prometheus labels of the device metrics: owning instance and device type
+	QString _metricLabels;
+
 	/// Helper to pipe device configuration from constructor to start()
 	QJsonObject _devConfig;
 
@@ -427,6 +433,9 @@ private:
 	/// @brief Stop refresh cycle
 	void stopRefreshTimer();
 
+	/// @brief Apply the optional real-time scheduling and CPU affinity to the output thread
+	void setupOutputThread(const QJsonObject& deviceConfig);
+
 	/// Is last write refreshing enabled?
 	bool	_isRefreshEnabled;
 
@@ -434,14 +443,32 @@ private:
 	/// "RGB", "BGR", "RBG", "BRG", "GBR", "GRB"
 	QString	_colorOrder;
 
-	/// Last LED values written
+	/// Last LED values written, owned by the output thread
 	std::vector<ColorRgb> _lastLedValues;
 
-	QSemaphore _semaphore;
-	int32_t _frames;
+	/// Latest frame handed over from the producer to the output thread
+	TripleBuffer<std::vector<ColorRgb>> _ledMailbox;
+
+	/// Is a write already queued on the output thread?
+	std::atomic<bool> _writeRequested;
+
+	std::atomic<int32_t> _frames;
 	int32_t _incomingframes;
 
 	qint64  _framesBegin;
+
+	/// Output statistics since last report
+	std::atomic<int32_t> _droppedFrames;
+	std::atomic<int32_t> _lateWrites;
+	std::atomic<int64_t> _writeTimeTotal_us;
+	std::atomic<int64_t> _writeTimeMax_us;
+	qint64  _lastWriteBegin_us;
+
+	/// Always-on performance counters (see Metrics)
+	Metrics::Counter*   _metricFrames;
+	Metrics::Counter*   _metricDroppedFrames;
+	Metrics::Counter*   _metricLateWrites;
+	Metrics::Histogram* _metricWriteTime;
 };
 
 #endif // LEDEVICE_H
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <vector>
+
+///
+/// Binary capture container (little endian, memory mappable).
+/// The file header is followed by records: a fixed record header and its payload padded to 8 bytes.
+///
+///   VIDEO_FRAME  raw grabber buffer before decoding, params: pixel format, width, height, line length
+///   LED_COLORS   RGB triplets sent to the LED device, params: instance, LED count
+///
+/// Timestamps are in microseconds from the start of the recording.
+///
+namespace CaptureFile
+{
+	const char		MAGIC[8] = { 'H', 'D', 'R', 'C', 'A', 'P', '0', '1' };
+	const uint32_t	VERSION = 1;
+
+	enum class RecordType : uint32_t
+	{
+		VIDEO_FRAME = 1,
+		LED_COLORS = 2
+	};
+
+	struct FileHeader
+	{
+		char		magic[8];
+		uint32_t	version;
+		uint32_t	headerSize;
+		int64_t		startTime;		// ms since epoch
+		uint64_t	reserved;
+	};
+
+	struct RecordHeader
+	{
+		uint32_t	type;
+		uint32_t	size;			// payload size without padding
+		int64_t		timestamp;
+		uint32_t	params[4];
+	};
+
+	static_assert(sizeof(FileHeader) == 32, "Invalid capture file header size");
+	static_assert(sizeof(RecordHeader) == 32, "Invalid capture record header size");
+
+	inline uint32_t paddedSize(uint32_t size)
+	{
+		return (size + 7) & ~7u;
+	}
+}
+
+///
+/// Read-only view of a capture file. The file is mapped and indexed once, the payloads are
+/// returned as pointers into the mapping and stay valid until close().
+///
+class CaptureFileReader
+{
+public:
+	CaptureFileReader();
+	~CaptureFileReader();
+
+	bool open(const QString& fileName);
+	void close();
+
+	bool isOpen() const;
+	QString error() const;
+
+	int64_t startTime() const;
+	int count() const;
+
+	const CaptureFile::RecordHeader& header(int index) const;
+	const uint8_t* payload(int index) const;
+
+private:
+	QFile		_file;
+	uint8_t*	_data;
+	int64_t		_startTime;
+	QString		_error;
+	std::vector<qint64> _records;
+};
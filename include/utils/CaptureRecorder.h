@@ -0,0 +1,102 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Qt includes
+#include <QString>
+#include <QJsonObject>
+
+// util includes
+#include <utils/CaptureFile.h>
+#include <utils/ColorRgb.h>
+#include <utils/Logger.h>
+#include <utils/Metrics.h>
+#include <utils/PixelFormat.h>
+
+///
+/// Records raw grabber buffers and LED frames into a capture file (see CaptureFile.h).
+/// The producers only copy the data into a queue, the file is written by a background thread.
+/// The queue is bounded: when the disk cannot keep up the new records are dropped and counted.
+/// The file is limited to 1.5 GB so the replay grabber can map it on 32-bit systems,
+/// the recording stops on its own when the limit is reached.
+/// A recording can be played back with the replay grabber (--replay <file>).
+///
+class CaptureRecorder
+{
+public:
+	static CaptureRecorder* getInstance();
+
+	///
+	/// @brief Set the folder for the recordings started without a full path
+	///
+	void setDirectory(const QString& directory);
+
+	///
+	/// @brief Start a new recording, the current one is finished first. Safe to call from any thread.
+	///
+	bool start(const QString& fileName, bool video, bool leds, QString& error);
+
+	void stop();
+
+	bool isRecordingVideo() const
+	{
+		return _recordVideo.load(std::memory_order_relaxed);
+	}
+
+	bool isRecordingLeds() const
+	{
+		return _recordLeds.load(std::memory_order_relaxed);
+	}
+
+	void addVideoFrame(PixelFormat format, int width, int height, int lineLength, const uint8_t* data, int size);
+
+	void addLedColors(int instance, const std::vector<ColorRgb>& ledColors);
+
+	QJsonObject status();
+
+private:
+	CaptureRecorder();
+	~CaptureRecorder();
+
+	struct Record
+	{
+		CaptureFile::RecordHeader	header;
+		std::vector<uint8_t>		payload;
+	};
+
+	void push(CaptureFile::RecordType type, const uint8_t* data, size_t size, uint32_t param0, uint32_t param1, uint32_t param2, uint32_t param3);
+
+	void run();
+
+	void stopRecording();
+
+	Logger*							_log;
+	QString							_directory;
+	QString							_fileName;
+	FILE*							_file;
+	std::thread						_thread;
+	std::mutex						_controlMutex;
+	std::mutex						_mutex;
+	std::condition_variable			_wake;
+	std::deque<Record>				_queue;
+	size_t							_queuedBytes;
+	bool							_running;
+	std::atomic<bool>				_recordVideo;
+	std::atomic<bool>				_recordLeds;
+	std::chrono::steady_clock::time_point	_startTime;
+	uint64_t						_records;
+	uint64_t						_bytes;
+	uint64_t						_dropped;
+
+	Metrics::Counter*				_metricRecords;
+	Metrics::Counter*				_metricBytes;
+	Metrics::Counter*				_metricDropped;
+};
@@ -20,10 +20,15 @@ class ImageResampler
 			const uint8_t* data, int width, int height, int lineLength,
 			const PixelFormat pixelFormat, const uint8_t* lutBuffer, Image<ColorRgb>& outputImage);
 
+		///
+		/// @brief Downscale of the sourceSizeX x sourceSizeY area at startX, startY of a BGRA frame
+		/// to the target size (any ratio). Every target pixel is the average of its whole source box,
+		/// each source row is read once. The LUT is applied to the averaged colors.
+		///
 		static void processSystemImageBGRA(Image<ColorRgb>& image, int targetSizeX, int targetSizeY,
-			int startX, int startY,
+			int startX, int startY, int sourceSizeX, int sourceSizeY,
 			uint8_t* source, int _actualWidth, int _actualHeight,
-			int division, uint8_t* _lutBuffer, int lineSize = 0);
+			const uint8_t* _lutBuffer, int lineSize = 0);
 
 		static void applyLUT(uint8_t* _source, unsigned int width, unsigned int height, const uint8_t* lutBuffer, const int _hdrToneMappingEnabled);
 };
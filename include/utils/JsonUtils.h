@@ -56,7 +56,8 @@ namespace JsonUtils {
 	bool parse(const QString& path, const QString& data, QJsonDocument& doc, Logger* log);
 
 	///
-	/// @brief Validate json data against a schema
+	/// @brief Validate json data against a schema. Schemas from the resources (':' paths) are read
+	///        and compiled once on first use, the full checker runs only to report errors.
 	/// @param[in]   file     The path/name of json file just used for log messages
 	/// @param[in]   json     The json data
 	/// @param[in]   schemaP  The schema path
@@ -74,21 +74,45 @@ public:
 	static void     setLogLevel(LogLevel level, const QString & name = "");
 	static LogLevel getLogLevel(const QString & name = "");
 
+	///
+	/// @brief Write all pending messages of every thread now (normally done by the log thread)
+	///
+	static void     flush();
+
+	///
+	/// @brief Like flush() but gives up instead of waiting when the log thread or another flush is busy.
+	///        Used by the crash handler, the crashed thread may hold the logger locks.
+	/// @return False if nothing was written
+	///
+	static bool     tryFlush();
+
+	///
+	/// @brief Write the pending messages and join the log thread, called before the static objects
+	///        are destroyed. Messages logged afterwards are written directly by the calling thread.
+	///
+	static void     shutdown();
+
+	///
+	/// @brief Additionally write every message in a compact binary form (see Logger.cpp for the layout)
+	/// @param[in] path  The output file, an empty path closes the file
+	///
+	static bool     setBinaryLogFile(const QString & path);
+
+	///
+	/// @brief Formats the message and queues it for the log thread, never blocks.
+	///        When the queue of the calling thread is full the message is dropped (and counted).
+	///
 	void     Message(LogLevel level, const char* sourceFile, const char* func, unsigned int line, const char* fmt, ...);
 	void     setMinLevel(LogLevel level) { _minLevel = static_cast<int>(level); }
 	LogLevel getMinLevel() const { return static_cast<LogLevel>(int(_minLevel)); }
 	QString  getName() const { return _name; }
 	QString  getAppName() const { return _appname; }
 
-signals:
-	void newLogMessage(Logger::T_LOG_MESSAGE);
-
 protected:
 	Logger(const QString & name="", LogLevel minLevel = INFO);
 	~Logger() override;
 
 private:
-	void write(const Logger::T_LOG_MESSAGE & message);
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))	
 	static QRecursiveMutex       MapLock;
 #else
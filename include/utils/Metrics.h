@@ -0,0 +1,181 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+#include <chrono>
+
+// Qt includes
+#include <QString>
+#include <QByteArray>
+#include <QJsonObject>
+
+///
+/// Always-on performance counters.
+/// Metrics are registered once (usually in a constructor) and the returned pointer is kept:
+/// it stays valid for the lifetime of the process and updating it is a relaxed atomic add
+/// on a per-thread shard, so there is no lock and no cache line ping-pong on the hot path.
+/// Registering the same name, type and labels again returns the same metric.
+///
+/// The registry is exported as json (JSON-RPC 'metrics' command) and in the Prometheus
+/// text format (http://<host>:<port>/metrics).
+///
+class Metrics
+{
+public:
+	static constexpr int SHARDS = 8;
+	static constexpr int BUCKETS = 26;
+
+	class Metric
+	{
+	public:
+		virtual ~Metric() = default;
+
+	protected:
+		friend class Metrics;
+
+		static int shardIndex();
+
+		virtual void toJson(QJsonObject& json, const QString& key) const = 0;
+		virtual void toPrometheus(QByteArray& out, const QByteArray& name, const QByteArray& labels) const = 0;
+	};
+
+	///
+	/// Monotonic counter (events, frames, bytes)
+	///
+	class Counter : public Metric
+	{
+	public:
+		Counter();
+
+		void add(uint64_t value = 1)
+		{
+			_shards[shardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+		}
+
+		uint64_t value() const;
+
+	private:
+		struct alignas(64) Shard
+		{
+			std::atomic<uint64_t> value;
+		};
+
+		Shard _shards[SHARDS];
+
+		void toJson(QJsonObject& json, const QString& key) const override;
+		void toPrometheus(QByteArray& out, const QByteArray& name, const QByteArray& labels) const override;
+	};
+
+	///
+	/// Last known value (fps, queue length)
+	///
+	class Gauge : public Metric
+	{
+	public:
+		Gauge();
+
+		void set(double value)
+		{
+			_value.store(value, std::memory_order_relaxed);
+		}
+
+		double value() const
+		{
+			return _value.load(std::memory_order_relaxed);
+		}
+
+	private:
+		std::atomic<double> _value;
+
+		void toJson(QJsonObject& json, const QString& key) const override;
+		void toPrometheus(QByteArray& out, const QByteArray& name, const QByteArray& labels) const override;
+	};
+
+	///
+	/// Duration histogram with power-of-two microsecond buckets (1us ... 33s)
+	///
+	class Histogram : public Metric
+	{
+	public:
+		Histogram();
+
+		void observe(uint64_t microseconds)
+		{
+			int bucket = 0;
+			for (uint64_t v = (microseconds > 0) ? microseconds - 1 : 0; v != 0 && bucket < BUCKETS - 1; v >>= 1)
+				bucket++;
+
+			Shard& shard = _shards[shardIndex()];
+			shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+			shard.sum.fetch_add(microseconds, std::memory_order_relaxed);
+		}
+
+		void observe(std::chrono::steady_clock::time_point start)
+		{
+			observe((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+		}
+
+	private:
+		struct alignas(64) Shard
+		{
+			std::atomic<uint64_t> buckets[BUCKETS];
+			std::atomic<uint64_t> sum;
+		};
+
+		Shard _shards[SHARDS];
+
+		void collect(uint64_t* buckets, uint64_t& count, uint64_t& sum) const;
+		void toJson(QJsonObject& json, const QString& key) const override;
+		void toPrometheus(QByteArray& out, const QByteArray& name, const QByteArray& labels) const override;
+	};
+
+	///
+	/// Observes the lifetime of the scope in the histogram
+	///
+	class ScopedTimer
+	{
+	public:
+		explicit ScopedTimer(Histogram* histogram)
+			: _histogram(histogram)
+			, _start(std::chrono::steady_clock::now())
+		{
+		}
+
+		~ScopedTimer()
+		{
+			_histogram->observe(_start);
+		}
+
+	private:
+		Histogram* _histogram;
+		std::chrono::steady_clock::time_point _start;
+	};
+
+	///
+	/// @param name    Prometheus metric name, e.g. 'hyperhdr_led_frames_total'
+	/// @param help    Short description
+	/// @param labels  Optional Prometheus labels without braces, e.g. 'instance="0"'
+	///
+	static Counter*   counter(const QString& name, const QString& help, const QString& labels = QString());
+	static Gauge*     gauge(const QString& name, const QString& help, const QString& labels = QString());
+	static Histogram* histogram(const QString& name, const QString& help, const QString& labels = QString());
+
+	///
+	/// @brief Label string for a HyperHDR instance
+	///
+	static QString instanceLabel(int instance);
+
+	static QJsonObject toJson();
+	static QByteArray  toPrometheus();
+
+	enum class Type { COUNTER, GAUGE, HISTOGRAM };
+
+private:
+	static Metric* create(Type type);
+
+	///
+	/// A name already registered with another type is an error: it is logged and the caller
+	/// gets a working metric of the requested type that is not exported
+	///
+	static Metric* getOrCreate(Type type, const QString& name, const QString& help, const QString& labels);
+};
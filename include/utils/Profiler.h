@@ -1,13 +1,13 @@
 #include <stdio.h>
 #include <stdarg.h>
-#include <time.h>
+#include <chrono>
 #include <map>
 #include <utils/Logger.h>
 #include <HyperhdrConfig.h>
 
 /*
 The performance (real time) of any function can be tested with the help of profiler.
-The determined times are determined using clock cycles.
+The determined times are wall clock times (std::chrono::steady_clock), safe to use from any thread.
 
 To do this, compile with the cmake option: -DENABLE_PROFILER=ON
 This header file (utils/Profiler.h) must be included in the respective file that contains the function to be measured
@@ -17,6 +17,13 @@ PROFILER_TIMER_START("test_performance")
 The end point is set as follows:
 PROFILER_TIMER_GET("test_performance")
 
+Every measurement is also added to the statistics of the timer (or block): count, average, minimum and maximum.
+PROFILER_SAVE_STATISTICS("profiler.json")
+writes them as json, the HyperHDR daemon does it on exit to <userdata>/profiler.json.
+PROFILER_COMPARE_STATISTICS("baseline.json", 10)
+reports every timer whose average is more than 10 percent slower than in an earlier saved file,
+the daemon does it on exit when <userdata>/profiler-baseline.json exists.
+
 For more profiler function see the macros listed below
 */
 
@@ -29,6 +36,8 @@ For more profiler function see the macros listed below
 #define PROFILER_TIMER_START(stopWatchName)   Profiler::TimerStart(stopWatchName, __FILE__, __FUNCTION__, __LINE__);
 #define PROFILER_TIMER_GET(stopWatchName)    Profiler::TimerGetTime(stopWatchName, __FILE__, __FUNCTION__, __LINE__);
 #define PROFILER_TIMER_GET_IF(condition, stopWatchName) { if (condition) {Profiler::TimerGetTime(stopWatchName, __FILE__, __FUNCTION__, __LINE__);} }
+#define PROFILER_SAVE_STATISTICS(fileName) Profiler::SaveStatistics(fileName);
+#define PROFILER_COMPARE_STATISTICS(baselineFileName, tolerancePercent) Profiler::CompareStatistics(baselineFileName, tolerancePercent);
 
 class Profiler
 {
@@ -39,13 +48,17 @@ public:
 	static void TimerStart(const QString& stopWatchName, const char* sourceFile, const char* func, unsigned int line);
 	static void TimerGetTime(const QString& stopWatchName, const char* sourceFile, const char* func, unsigned int line);
 
+	static bool SaveStatistics(const QString& fileName);
+	static int  CompareStatistics(const QString& baselineFileName, double tolerancePercent);
+
 private:
 	static void initLogger();
+	static void addSample(const QString& name, double seconds);
 
 	static Logger*  _logger;
 	const char*     _file;
 	const char*     _func;
 	unsigned int    _line;
 	unsigned int    _blockId;
-	clock_t         _startTime;
+	std::chrono::steady_clock::time_point _startTime;
 };
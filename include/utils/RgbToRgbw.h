@@ -16,4 +16,44 @@ namespace RGBW {
 
 	WhiteAlgorithm stringToWhiteAlgorithm(const QString& str);
 	void Rgb_to_Rgbw(ColorRgb input, ColorRgbw * output, WhiteAlgorithm algorithm);
+
+	///
+	/// Integer, table-driven equivalent of Rgb_to_Rgbw for per-LED conversion in the device write path.
+	/// The floating point white factors are evaluated once for all 256 channel values.
+	///
+	class RgbwTable
+	{
+	public:
+		explicit RgbwTable(WhiteAlgorithm algorithm = WhiteAlgorithm::WHITE_OFF);
+
+		void setAlgorithm(WhiteAlgorithm algorithm);
+
+		void convert(const ColorRgb& input, ColorRgbw* output) const
+		{
+			if (_algorithm == WhiteAlgorithm::WHITE_OFF || _algorithm == WhiteAlgorithm::INVALID)
+			{
+				output->red = input.red;
+				output->green = input.green;
+				output->blue = input.blue;
+				output->white = 0;
+				return;
+			}
+
+			uint8_t white = _toWhite[0][input.red];
+			if (_toWhite[1][input.green] < white)
+				white = _toWhite[1][input.green];
+			if (_toWhite[2][input.blue] < white)
+				white = _toWhite[2][input.blue];
+
+			output->white = white;
+			output->red = input.red - _fromWhite[0][white];
+			output->green = input.green - _fromWhite[1][white];
+			output->blue = input.blue - _fromWhite[2][white];
+		}
+
+	private:
+		WhiteAlgorithm _algorithm;
+		uint8_t _toWhite[3][256];
+		uint8_t _fromWhite[3][256];
+	};
 }
@@ -0,0 +1,56 @@
+#pragma once
+
+// Qt includes
+#include <QString>
+#include <QJsonObject>
+#include <QJsonArray>
+
+///
+/// Names the threads of HyperHDR, places them on the configured CPUs with the configured priority class
+/// and keeps their CPU time.
+///
+/// A thread registers itself when it starts (registerCurrentThread) and is removed automatically when it ends.
+/// The placement of a role comes from the general settings, e.g.
+///
+///   "captureThreadsCpus" : "2,3",    "captureThreadsPriority" : "high"
+///   "instanceThreadsCpus" : "1",     "instanceThreadsPriority" : "normal"
+///   "effectThreadsCpus" : "0",       "effectThreadsPriority" : "low"
+///
+/// The LED output thread is configured per LED device (cpuAffinity, realtimePriority).
+/// An empty CPU list means all CPUs. CPU lists accept single CPUs and ranges: "0,2-3".
+/// Affinity and priority classes are applied on Linux, other systems only map the priority to QThread priorities.
+///
+class ThreadTopology
+{
+public:
+	enum class Role { INSTANCE = 0, LED_OUTPUT, CAPTURE_WORKER, EFFECT, OTHER, COUNT };
+
+	enum class Priority { LOW = 0, NORMAL, HIGH, REALTIME };
+
+	///
+	/// @brief Name the current thread and apply the placement configured for the role
+	///
+	static void registerCurrentThread(Role role, const QString& name);
+
+	///
+	/// @brief Pin the current thread to a single CPU and/or set its priority, overrides the role configuration
+	///
+	/// @param cpu       CPU index, -1 keeps the current affinity
+	/// @param priority  priority class
+	///
+	static void placeCurrentThread(int cpu, Priority priority);
+
+	///
+	/// @brief Read the placement of all roles from the general settings and apply it to the running threads
+	///
+	static void configure(const QJsonObject& generalConfig);
+
+	///
+	/// @brief CPU time of the running threads and of the finished threads grouped by name
+	///
+	static QJsonArray report();
+
+	static QString roleToString(Role role);
+	static QString priorityToString(Priority priority);
+	static Priority stringToPriority(const QString& priority);
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+
+///
+/// Lock-free single producer / single consumer mailbox (latest wins).
+/// The producer fills back() and calls publish(), the consumer calls update() and reads front().
+/// Neither side ever blocks, an unread frame is simply replaced by the newer one.
+///
+template <typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() :
+		_middle(1),
+		_back(0),
+		_front(2)
+	{
+	}
+
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	///
+	/// @brief Producer: buffer to be filled before publish()
+	///
+	T& back()
+	{
+		return _buffers[_back];
+	}
+
+	///
+	/// @brief Producer: make the back buffer available to the consumer
+	///
+	/// @return True, if the previous frame was never read by the consumer (dropped)
+	///
+	bool publish()
+	{
+		int old = _middle.exchange(_back | DIRTY, std::memory_order_acq_rel);
+		_back = old & INDEX;
+		return (old & DIRTY) != 0;
+	}
+
+	///
+	/// @brief Consumer: fetch the latest published frame if there is any
+	///
+	/// @return True, if front() was replaced by a new frame
+	///
+	bool update()
+	{
+		if ((_middle.load(std::memory_order_acquire) & DIRTY) == 0)
+			return false;
+
+		int old = _middle.exchange(_front, std::memory_order_acq_rel);
+		_front = old & INDEX;
+		return true;
+	}
+
+	///
+	/// @brief Consumer: the most recent frame received by update()
+	///
+	T& front()
+	{
+		return _buffers[_front];
+	}
+
+	const T& front() const
+	{
+		return _buffers[_front];
+	}
+
+private:
+	static constexpr int INDEX = 0x3;
+	static constexpr int DIRTY = 0x4;
+
+	T _buffers[3];
+	std::atomic<int> _middle;
+	int _back;
+	int _front;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QJsonArray>
+#include <QString>
+
+#include <memory>
+#include <vector>
+
+/// QJsonSchemaValidator is a precompiled form of a json schema for the hot validation paths.
+/// The schema is walked once in compile(): type names, enum sets, limits, required flags and
+/// child schemas are stored in a tree, so validate() does no string matching and no allocation.
+///
+/// It only answers valid/invalid with exactly the same result as QJsonSchemaChecker::validate().
+/// Error messages are still produced by QJsonSchemaChecker when validation fails.
+/// Schemas that use dependencies, options.dependencies or additionalProperties as a schema
+/// are reported as not compiled, the caller must fall back to QJsonSchemaChecker.
+
+class QJsonSchemaValidator
+{
+public:
+	QJsonSchemaValidator();
+	~QJsonSchemaValidator();
+
+	QJsonSchemaValidator(const QJsonSchemaValidator&) = delete;
+	QJsonSchemaValidator& operator=(const QJsonSchemaValidator&) = delete;
+
+	///
+	/// @param schema The resolved schema (no $ref)
+	/// @return true when the schema could be compiled
+	///
+	bool compile(const QJsonObject& schema);
+
+	///
+	/// @return true when compile() succeeded
+	///
+	bool isCompiled() const;
+
+	///
+	/// @brief Validate a JSON structure against the compiled schema. Thread-safe.
+	/// @param value The JSON value to check
+	/// @return true when the value is valid
+	///
+	bool validate(const QJsonObject& value) const;
+
+private:
+	enum class Type { NONE, STRING, NUMBER, INTEGER, BOOLEAN, OBJECT, ARRAY, NULLTYPE, ANY };
+
+	struct Node;
+
+	struct Property
+	{
+		QString key;
+		bool    required;
+		std::unique_ptr<Node> node;
+	};
+
+	struct Node
+	{
+		Type   type = Type::NONE;
+
+		bool   checkProperties = false;
+		bool   denyAdditional = false;
+		std::vector<Property> properties;
+
+		bool   checkEnum = false;
+		std::vector<QJsonValue> enumValues;
+
+		bool   checkMinimum = false;
+		bool   checkMaximum = false;
+		double minimum = 0;
+		double maximum = 0;
+
+		bool   checkMinLength = false;
+		bool   checkMaxLength = false;
+		int    minLength = 0;
+		int    maxLength = 0;
+
+		bool   checkMinItems = false;
+		bool   checkMaxItems = false;
+		int    minItems = 0;
+		int    maxItems = 0;
+
+		bool   checkArray = false;
+		bool   uniqueItems = false;
+		std::unique_ptr<Node> items;
+	};
+
+	static bool compileNode(Node& node, const QJsonObject& schema);
+	static bool validateNode(const Node& node, const QJsonValue& value);
+	static bool validateObject(const Node& node, const QJsonObject& value);
+
+	std::unique_ptr<Node> _root;
+};
@@ -31,6 +31,9 @@
 #include <utils/ColorSys.h>
 #include <utils/Process.h>
 #include <utils/JsonUtils.h>
+#include <utils/Metrics.h>
+#include <utils/CaptureRecorder.h>
+#include <utils/ThreadTopology.h>
 
 // bonjour wrapper
 #ifdef ENABLE_AVAHI
@@ -198,6 +201,12 @@ proceed:
 		handleVideoControlsCommand(message, command, tan);
 	else if (command == "benchmark")
 		handleBenchmarkCommand(message, command, tan);
+	else if (command == "metrics")
+		handleMetricsCommand(message, command, tan);
+	else if (command == "capture-recorder")
+		handleCaptureRecorderCommand(message, command, tan);
+	else if (command == "threads")
+		handleThreadsCommand(message, command, tan);
 	else if (command == "transform" || command == "correction" || command == "temperature")
 		sendErrorReply("The command " + command + "is deprecated, please use the HyperHDR Web Interface to configure", command, tan);
 	// END
@@ -933,6 +942,40 @@ void JsonAPI::handleBenchmarkCommand(const QJsonObject& message, const QString&
 	sendSuccessReply(command, tan);
 }
 
+void JsonAPI::handleMetricsCommand(const QJsonObject&, const QString& command, int tan)
+{
+	sendSuccessDataReply(QJsonDocument(Metrics::toJson()), command, tan);
+}
+
+void JsonAPI::handleCaptureRecorderCommand(const QJsonObject& message, const QString& command, int tan)
+{
+	const QString subcommand = message["subcommand"].toString();
+	const QString full_command = command + "-" + subcommand;
+	CaptureRecorder* recorder = CaptureRecorder::getInstance();
+
+	if (subcommand == "start")
+	{
+		QString error;
+
+		if (!recorder->start(message["file"].toString(), message["video"].toBool(true), message["leds"].toBool(true), error))
+		{
+			sendErrorReply(error, full_command, tan);
+			return;
+		}
+	}
+	else if (subcommand == "stop")
+	{
+		recorder->stop();
+	}
+
+	sendSuccessDataReply(QJsonDocument(recorder->status()), full_command, tan);
+}
+
+void JsonAPI::handleThreadsCommand(const QJsonObject&, const QString& command, int tan)
+{
+	sendSuccessDataReply(QJsonDocument(ThreadTopology::report()), command, tan);
+}
+
 void JsonAPI::handleVideoControlsCommand(const QJsonObject& message, const QString& command, int tan)
 {
 
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <iomanip>
 #include <cstdio>
+#include <cstring>
 #include <cmath>
 
 // stl includes
@@ -19,27 +20,127 @@
 #include <hyperhdrbase/ImageProcessor.h>
 #include <HyperhdrConfig.h>
 #include <hyperhdrbase/HyperHdrInstance.h>
-#include <utils/QStringUtils.h>
 
 
 // project includes
 #include "BoblightClientConnection.h"
 
+namespace
+{
+	/// Messages longer than that are dropped
+	const int MAX_BUFFER_SIZE = 100 * 1024;
+
+	/// 'set light <index> rgb <r> <g> <b>' is the longest message
+	const int MAX_TOKENS = 7;
+
+	struct Token
+	{
+		const char*	data;
+		int			size;
+	};
+
+	enum class Keyword
+	{
+		UNKNOWN = 0, HELLO, PING, GET, SET, SYNC, VERSION, LIGHTS, LIGHT, PRIORITY, RGB, SPEED, INTERPOLATION, USE, SINGLECHANGE
+	};
+
+	///
+	/// Perfect hash of the protocol keywords: length, first and last character select a single slot
+	/// of the table, one memcmp confirms the keyword.
+	///
+	class KeywordTable
+	{
+	public:
+		KeywordTable()
+		{
+			add("hello", Keyword::HELLO);
+			add("ping", Keyword::PING);
+			add("get", Keyword::GET);
+			add("set", Keyword::SET);
+			add("sync", Keyword::SYNC);
+			add("version", Keyword::VERSION);
+			add("lights", Keyword::LIGHTS);
+			add("light", Keyword::LIGHT);
+			add("priority", Keyword::PRIORITY);
+			add("rgb", Keyword::RGB);
+			add("speed", Keyword::SPEED);
+			add("interpolation", Keyword::INTERPOLATION);
+			add("use", Keyword::USE);
+			add("singlechange", Keyword::SINGLECHANGE);
+		}
+
+		Keyword find(const Token& token) const
+		{
+			if (token.size == 0)
+				return Keyword::UNKNOWN;
+
+			const Entry& entry = _entries[hash(token.data, token.size)];
+
+			if (entry.size == token.size && memcmp(entry.text, token.data, token.size) == 0)
+				return entry.keyword;
+
+			return Keyword::UNKNOWN;
+		}
+
+	private:
+		static const int SIZE = 32;
+
+		struct Entry
+		{
+			const char*	text;
+			int			size;
+			Keyword		keyword;
+		};
+
+		static int hash(const char* text, int size)
+		{
+			return (size + (uint8_t)text[0] + 4 * (uint8_t)text[size - 1]) & (SIZE - 1);
+		}
+
+		void add(const char* text, Keyword keyword)
+		{
+			const int size = (int)strlen(text);
+			Entry& entry = _entries[hash(text, size)];
+
+			assert(entry.keyword == Keyword::UNKNOWN);
+
+			entry.text = text;
+			entry.size = size;
+			entry.keyword = keyword;
+		}
+
+		Entry _entries[SIZE] = {};
+	};
+
+	Keyword keyword(const Token& token)
+	{
+		static const KeywordTable table;
+		return table.find(token);
+	}
+
+	bool isSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+	}
+}
+
 BoblightClientConnection::BoblightClientConnection(HyperHdrInstance* hyperhdr, QTcpSocket *socket, int priority)
 	: QObject()
-	, _locale(QLocale::C)
 	, _socket(socket)
 	, _imageProcessor(hyperhdr->getImageProcessor())
 	, _hyperhdr(hyperhdr)
-	, _receiveBuffer()
+	, _receiveBuffer(MAX_BUFFER_SIZE)
+	, _receiveSize(0)
+	, _pendingFrame(false)
+	, _pendingColors(hyperhdr->getLedCount(), ColorRgb::BLACK)
 	, _priority(priority)
 	, _ledColors(hyperhdr->getLedCount(), ColorRgb::BLACK)
 	, _log(Logger::getInstance("BOBLIGHT"))
 	, _clientAddress(QHostInfo::fromName(socket->peerAddress().toString()).hostName())
+	, _metricMessages(Metrics::counter("hyperhdr_boblight_messages_total", "Boblight messages received", Metrics::instanceLabel(hyperhdr->getInstanceIndex())))
+	, _metricFrames(Metrics::counter("hyperhdr_boblight_frames_total", "Boblight LED frames sent to the instance", Metrics::instanceLabel(hyperhdr->getInstanceIndex())))
+	, _metricReadTime(Metrics::histogram("hyperhdr_boblight_read_seconds", "Time spent parsing the received Boblight data", Metrics::instanceLabel(hyperhdr->getInstanceIndex())))
 {
-	// initalize the locale. Start with the default C-locale
-	_locale.setNumberOptions(QLocale::OmitGroupSeparator | QLocale::RejectGroupSeparator);
-
 	// connect internal signals and slots
 	connect(_socket, &QTcpSocket::disconnected, this, &BoblightClientConnection::socketClosed);
 	connect(_socket, &QTcpSocket::readyRead, this, &BoblightClientConnection::readData);
@@ -56,55 +157,60 @@ BoblightClientConnection::~BoblightClientConnection()
 
 void BoblightClientConnection::readData()
 {
-	_receiveBuffer.append(_socket->readAll());
+	Metrics::ScopedTimer timer(_metricReadTime);
 
-	int bytes = _receiveBuffer.indexOf('\n') + 1;
-	while(bytes > 0)
+	char* buffer = _receiveBuffer.data();
+
+	while (true)
 	{
-		// create message string (strip the newline)
-		const QString message = readMessage(_receiveBuffer.data(), bytes);
+		// drop messages if the buffer is full without a complete line
+		if (_receiveSize == MAX_BUFFER_SIZE)
+		{
+			Debug(_log, "server drops messages (buffer full)");
+			_receiveSize = 0;
+		}
+
+		const qint64 bytes = _socket->read(buffer + _receiveSize, MAX_BUFFER_SIZE - _receiveSize);
+		if (bytes <= 0)
+			break;
 
-		// handle trimmed message
-		handleMessage(message);
+		_receiveSize += (int)bytes;
 
-		// remove message data from buffer
-		_receiveBuffer.remove(0, bytes);
+		// handle all complete lines in place
+		const char* line = buffer;
+		const char* end = buffer + _receiveSize;
+		const char* newline;
 
-		// drop messages if the buffer is too full
-		if (_receiveBuffer.size() > 100*1024)
+		while ((newline = static_cast<const char*>(memchr(line, '\n', end - line))) != nullptr)
 		{
-			Debug(_log, "server drops messages (buffer full)");
-			_receiveBuffer.clear();
+			handleMessage(line, (int)(newline - line));
+			line = newline + 1;
 		}
 
-		// try too look up '\n' again
-		bytes = _receiveBuffer.indexOf('\n') + 1;
+		// keep the incomplete line for the next read
+		_receiveSize = (int)(end - line);
+		if (line != buffer && _receiveSize > 0)
+			memmove(buffer, line, _receiveSize);
 	}
-}
 
-QString BoblightClientConnection::readMessage(const char *data, const size_t size) const
-{
-	char *end = (char *)data + size - 1;
-
-	// Trim left
-	while (data < end && std::isspace(*data))
+	// all frames completed by this read are sent as one update: the newest complete frame wins
+	if (_pendingFrame)
 	{
-		++data;
-	}
+		_pendingFrame = false;
 
-	// Trim right
-	while (end > data && std::isspace(*end))
-	{
-		--end;
+		if (_priority >= 128 && _priority < 254)
+		{
+			_hyperhdr->setInput(_priority, _pendingColors);
+			_metricFrames->add();
+		}
 	}
+}
 
-	// create message string (strip the newline)
-	const int len = end - data + 1;
-	const QString message =  QString::fromLatin1(data, len);
-
-	//std::cout << bytes << ": \"" << message.toUtf8().constData() << "\"" << std::endl;
-
-	return message;
+void BoblightClientConnection::completeFrame()
+{
+	// same size: the copy does not allocate
+	_pendingColors = _ledColors;
+	_pendingFrame = true;
 }
 
 void BoblightClientConnection::socketClosed()
@@ -116,53 +222,90 @@ void BoblightClientConnection::socketClosed()
 	emit connectionClosed(this);
 }
 
-
-void BoblightClientConnection::handleMessage(const QString & message)
+void BoblightClientConnection::handleMessage(const char* data, int size)
 {
-	//std::cout << "boblight message: " << message.toStdString() << std::endl;
-	auto messageParts = QStringUtils::REFSPLITTER(message, ' ');
-	if (messageParts.size() > 0)
+	_metricMessages->add();
+
+	// split the message into words, there are no allocations
+	Token tokens[MAX_TOKENS];
+	int count = 0;
+	const char* end = data + size;
+
+	for (const char* position = data; position < end;)
 	{
-		if (messageParts[0] == QStringLiteral("hello"))
+		while (position < end && isSpace(*position))
+			++position;
+
+		const char* begin = position;
+
+		while (position < end && !isSpace(*position))
+			++position;
+
+		if (position > begin)
+		{
+			// more words than any valid message: it is reported as unknown
+			if (count == MAX_TOKENS)
+			{
+				count++;
+				break;
+			}
+
+			tokens[count].data = begin;
+			tokens[count].size = (int)(position - begin);
+			count++;
+		}
+	}
+
+	if (count > 0 && count <= MAX_TOKENS)
+	{
+		const Keyword command = keyword(tokens[0]);
+
+		if (command == Keyword::HELLO)
 		{
 			sendMessage("hello\n");
 			return;
 		}
-		else if (messageParts[0] == QStringLiteral("ping"))
+		else if (command == Keyword::PING)
 		{
 			sendMessage("ping 1\n");
 			return;
 		}
-		else if (messageParts[0] == QStringLiteral("get") && messageParts.size() > 1)
+		else if (command == Keyword::GET && count > 1)
 		{
-			if (messageParts[1] == QStringLiteral("version"))
+			const Keyword subject = keyword(tokens[1]);
+
+			if (subject == Keyword::VERSION)
 			{
 				sendMessage("version 5\n");
 				return;
 			}
-			else if (messageParts[1] == QStringLiteral("lights"))
+			else if (subject == Keyword::LIGHTS)
 			{
 				sendLightMessage();
 				return;
 			}
 		}
-		else if (messageParts[0] == QStringLiteral("set") && messageParts.size() > 2)
+		else if (command == Keyword::SET && count > 2)
 		{
-			if (messageParts.size() > 3 && messageParts[1] == QStringLiteral("light"))
+			const Keyword subject = keyword(tokens[1]);
+
+			if (count > 3 && subject == Keyword::LIGHT)
 			{
 				bool rc;
-				const unsigned ledIndex = parseUInt(messageParts[2], &rc);
+				const unsigned ledIndex = parseUInt(tokens[2].data, tokens[2].size, &rc);
 				if (rc && ledIndex < _ledColors.size())
 				{
-					if (messageParts[3] == QStringLiteral("rgb") && messageParts.size() == 7)
+					const Keyword property = keyword(tokens[3]);
+
+					if (property == Keyword::RGB && count == 7)
 					{
 						// custom parseByte accepts both ',' and '.' as decimal separator
 						// no need to replace decimal comma with decimal point
 
 						bool rc1, rc2, rc3;
-						const uint8_t red = parseByte(messageParts[4], &rc1);
-						const uint8_t green = parseByte(messageParts[5], &rc2);
-						const uint8_t blue = parseByte(messageParts[6], &rc3);
+						const uint8_t red = parseByte(tokens[4].data, tokens[4].size, &rc1);
+						const uint8_t green = parseByte(tokens[5].data, tokens[5].size, &rc2);
+						const uint8_t blue = parseByte(tokens[6].data, tokens[6].size, &rc3);
 
 						if (rc1 && rc2 && rc3)
 						{
@@ -174,31 +317,34 @@ void BoblightClientConnection::handleMessage(const QString & message)
 							if (_priority == 0 || _priority < 128 || _priority >= 254)
 								return;
 
-							// send current color values to HyperHDR if this is the last led assuming leds values are send in order of id
+							// the frame is complete if this is the last led assuming leds values are send in order of id
 							if (ledIndex == _ledColors.size() -1)
 							{
-								_hyperhdr->setInput(_priority, _ledColors);
+								completeFrame();
 							}
 
 							return;
 						}
 					}
-					else if(messageParts[3] == QStringLiteral("speed") ||
-						      messageParts[3] == QStringLiteral("interpolation") ||
-						      messageParts[3] == QStringLiteral("use") ||
-						      messageParts[3] == QStringLiteral("singlechange"))
+					else if (property == Keyword::SPEED ||
+						     property == Keyword::INTERPOLATION ||
+						     property == Keyword::USE ||
+						     property == Keyword::SINGLECHANGE)
 					{
 						// these message are ignored by HyperHDR
 						return;
 					}
 				}
 			}
-			else if (messageParts.size() == 3 && messageParts[1] == QStringLiteral("priority"))
+			else if (count == 3 && subject == Keyword::PRIORITY)
 			{
 				bool rc;
-				const int prio = static_cast<int>(parseUInt(messageParts[2], &rc));
+				const int prio = static_cast<int>(parseUInt(tokens[2].data, tokens[2].size, &rc));
 				if (rc && prio != _priority)
 				{
+					// a frame of the previous priority is not sent to the new one
+					_pendingFrame = false;
+
 					if (_priority != 0 && _hyperhdr->getPriorityInfo(_priority).componentId == hyperhdr::COMP_BOBLIGHTSERVER)
 						_hyperhdr->clear(_priority);
 
@@ -226,16 +372,16 @@ void BoblightClientConnection::handleMessage(const QString & message)
 				}
 			}
 		}
-		else if (messageParts[0] == QStringLiteral("sync"))
+		else if (command == Keyword::SYNC)
 		{
 			if ( _priority >= 128 && _priority < 254)
-				_hyperhdr->setInput(_priority, _ledColors); // send current color values to HyperHDR
+				completeFrame(); // send current color values to HyperHDR
 
 			return;
 		}
 	}
 
-	Debug(_log, "unknown boblight message: %s", QSTRING_CSTR(message));
+	Debug(_log, "unknown boblight message: %s", QSTRING_CSTR(QString::fromLatin1(data, size).trimmed()));
 }
 
 /// Float values 10 to the power of -p for p in 0 .. 8.
@@ -250,7 +396,7 @@ const float ipows[] = {
 	1.0f / 10000000.0f,
 	1.0f / 100000000.0f};
 
-float BoblightClientConnection::parseFloat(const QStringView& s, bool *ok) const
+float BoblightClientConnection::parseFloat(const char* data, int size, bool *ok) const
 {
 	// We parse radix 10
 	const char MIN_DIGIT = '0';
@@ -268,22 +414,18 @@ float BoblightClientConnection::parseFloat(const QStringView& s, bool *ok) const
 	/// The integer part of the number
 	int64_t n = 0;
 
-	auto it = s.begin();
-
-#define STEP ((it != s.end()) && (q++ < MAX_LEN))
-
 	// parse the integer-part
-	while (it->unicode() >= MIN_DIGIT && it->unicode() <= MAX_DIGIT && STEP)
+	while (q < size && data[q] >= MIN_DIGIT && data[q] <= MAX_DIGIT)
 	{
-		n = (n * 10) + (it->unicode() - MIN_DIGIT);
-		++it;
+		n = (n * 10) + (data[q] - MIN_DIGIT);
+		++q;
 	}
 
 	/// The resulting float value
 	float f = static_cast<float>(n);
 
 	// parse decimal part
-	if ((it->unicode() == SEP_POINT || it->unicode() == SEP_COMMA) && STEP)
+	if (q < size && (data[q] == SEP_POINT || data[q] == SEP_COMMA))
 	{
 		/// The decimal part of the number
 		int64_t d = 0;
@@ -291,12 +433,12 @@ float BoblightClientConnection::parseFloat(const QStringView& s, bool *ok) const
 		/// The exponent for the scale-factor 10 to the power -e
 		int e = 0;
 
-		++it;
-		while (it->unicode() >= MIN_DIGIT && it->unicode() <= MAX_DIGIT && STEP)
+		++q;
+		while (q < size && data[q] >= MIN_DIGIT && data[q] <= MAX_DIGIT)
 		{
-			d = (d * 10) + (it->unicode() - MIN_DIGIT);
+			d = (d * 10) + (data[q] - MIN_DIGIT);
 			++e;
-			++it;
+			++q;
 		}
 
 		const float h = static_cast<float>(d);
@@ -312,11 +454,10 @@ float BoblightClientConnection::parseFloat(const QStringView& s, bool *ok) const
 		}
 	}
 
-	if (q >= MAX_LEN || q < s.length())
+	if (size == 0 || size >= MAX_LEN || q < size)
 	{
 		if (ok)
 		{
-			//std::cout << "FAIL L " << q << ": " << s.toUtf8().constData() << std::endl;
 			*ok = false;
 		}
 		return 0;
@@ -324,14 +465,13 @@ float BoblightClientConnection::parseFloat(const QStringView& s, bool *ok) const
 
 	if (ok)
 	{
-		//std::cout << "OK " << d << ": " << s.toUtf8().constData() << std::endl;
 		*ok = true;
 	}
 
 	return f;
 }
 
-unsigned BoblightClientConnection::parseUInt(const QStringView& s, bool *ok) const
+unsigned BoblightClientConnection::parseUInt(const char* data, int size, bool *ok) const
 {
 	// We parse radix 10
 	const char MIN_DIGIT = '0';
@@ -344,35 +484,29 @@ unsigned BoblightClientConnection::parseUInt(const QStringView& s, bool *ok) con
 	int q = 0;
 
 	/// The integer part of the number
-	int n = 0;
-
-	auto it = s.begin();
+	unsigned n = 0;
 
 	// parse the integer-part
-	while (it->unicode() >= MIN_DIGIT && it->unicode() <= MAX_DIGIT && ((it != s.end()) && (q++ < MAX_LEN)))
+	while (q < size && q < MAX_LEN && data[q] >= MIN_DIGIT && data[q] <= MAX_DIGIT)
 	{
-		n = (n * 10) + (it->unicode() - MIN_DIGIT);
-		++it;
+		n = (n * 10) + (data[q] - MIN_DIGIT);
+		++q;
 	}
 
 	if (ok)
 	{
-		*ok = !(q >= MAX_LEN || q < s.length());
+		*ok = (size > 0 && size < MAX_LEN && q == size);
 	}
 
 	return n;
 }
 
-uint8_t BoblightClientConnection::parseByte(const QStringView& s, bool *ok) const
+uint8_t BoblightClientConnection::parseByte(const char* data, int size, bool *ok) const
 {
 	const int LO = 0;
 	const int HI = 255;
 
-#if defined(FAST_FLOAT_PARSE)
-	const float d = parseFloat(s, ok);
-#else
-	const float d = s.toFloat(ok);
-#endif
+	const float d = parseFloat(data, size, ok);
 
 	// Clamp to byte range 0 to 255
 	return static_cast<uint8_t>(qBound(LO, int(HI * d), HI)); // qBound args are in order min, value, max; see: https://doc.qt.io/qt-5/qtglobal.html#qBound
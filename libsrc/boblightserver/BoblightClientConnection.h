@@ -3,17 +3,15 @@
 // Qt includes
 #include <QByteArray>
 #include <QTcpSocket>
-#include <QLocale>
 #include <QString>
 
-#include <QStringView>
+// stl includes
+#include <vector>
 
 // utils includes
 #include <utils/Logger.h>
 #include <utils/ColorRgb.h>
-
-/// Whether to parse floats with an eye on performance
-#define FAST_FLOAT_PARSE
+#include <utils/Metrics.h>
 
 class ImageProcessor;
 class HyperHdrInstance;
@@ -57,12 +55,21 @@ private slots:
 	void socketClosed();
 
 private:
+	/// hyperhdr-bench measures the parser without the socket
+	friend class BoblightBench;
+
 	///
 	/// Handle an incoming boblight message
 	///
-	/// @param message the incoming message as string
+	/// @param data the message without the newline
+	/// @param size the length of the message
 	///
-	void handleMessage(const QString &message);
+	void handleMessage(const char* data, int size);
+
+	///
+	/// Keep the current LED colors as the frame sent at the end of the read
+	///
+	void completeFrame();
 
 	///
 	/// Send a message to the connected client
@@ -77,45 +84,37 @@ private:
 	void sendLightMessage();
 
 	///
-	/// Interpret the float value "0.0" to "1.0" of the QString byte values 0 .. 255
+	/// Interpret the float value "0.0" to "1.0" of the byte values 0 .. 255
 	///
-	/// @param s the string to parse
+	/// @param data the characters to parse
+	/// @param size the number of characters
 	/// @param ok whether the result is ok
 	/// @return the parsed byte value in range 0 to 255, or 0
 	///
-	uint8_t parseByte(const QStringView& s, bool *ok = nullptr) const;
+	uint8_t parseByte(const char* data, int size, bool *ok = nullptr) const;
 
 	///
-	/// Parse the given QString as unsigned int value.
+	/// Parse the given characters as unsigned int value.
 	///
-	/// @param s the string to parse
+	/// @param data the characters to parse
+	/// @param size the number of characters
 	/// @param ok whether the result is ok
 	/// @return the parsed unsigned int value
 	///
-	unsigned parseUInt(const QStringView& s, bool *ok = nullptr) const;
+	unsigned parseUInt(const char* data, int size, bool *ok = nullptr) const;
 
 	///
-	/// Parse the given QString as float value, e.g. the 16-bit (wide char) QString "1" shall represent 1, "0.5" is 0.5 and so on.
+	/// Parse the given characters as float value, e.g. "1" shall represent 1, "0.5" is 0.5 and so on.
+	/// Both '.' and ',' are accepted as decimal separator.
 	///
-	/// @param s the string to parse
+	/// @param data the characters to parse
+	/// @param size the number of characters
 	/// @param ok whether the result is ok
 	/// @return the parsed float value, or 0
 	///
-	float parseFloat(const QStringView& s, bool *ok = nullptr) const;
-
-	///
-	/// Read an incoming boblight message as QString
-	///
-	/// @param data the char data buffer of the incoming message
-	/// @param size the length of the buffer buffer
-	/// @returns the incoming boblight message as QString
-	///
-	QString readMessage(const char *data, const size_t size) const;
+	float parseFloat(const char* data, int size, bool *ok = nullptr) const;
 
 private:
-	/// Locale used for parsing floating point values
-	QLocale _locale;
-
 	/// The TCP-Socket that is connected tot the boblight-client
 	QTcpSocket * _socket;
 
@@ -125,8 +124,17 @@ private:
 	/// Link to HyperHDR for writing led-values to a priority channel
 	HyperHdrInstance * _hyperhdr;
 
-	/// The buffer used for reading data from the socket
-	QByteArray _receiveBuffer;
+	/// The buffer used for reading data from the socket, allocated once
+	std::vector<char> _receiveBuffer;
+
+	/// The number of received bytes in the buffer (an incomplete line)
+	int _receiveSize;
+
+	/// A complete LED frame waits to be sent at the end of the current read
+	bool _pendingFrame;
+
+	/// Copy of the LED colors at the end of the last complete frame, the next frame may already be started
+	std::vector<ColorRgb> _pendingColors;
 
 	/// The priority used by this connection
 	int _priority;
@@ -139,4 +147,8 @@ private:
 
 	/// address of client
 	QString _clientAddress;
+
+	Metrics::Counter* _metricMessages;
+	Metrics::Counter* _metricFrames;
+	Metrics::Histogram* _metricReadTime;
 };
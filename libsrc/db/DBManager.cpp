@@ -60,8 +60,15 @@ QSqlDatabase DBManager::getDB() const
 			throw std::runtime_error("Failed to open database connection!");
 		}
 		else
+		{
 			Info(_log, "Database opened: %s", QSTRING_CSTR(dbFile.absoluteFilePath()));
 
+			// readers of other threads are not blocked by writes, commits do not wait for a full fsync
+			QSqlQuery pragma(db);
+			if (!pragma.exec("PRAGMA journal_mode=WAL") || !pragma.exec("PRAGMA synchronous=NORMAL"))
+				Warning(_log, "Could not enable the WAL journal mode: %s", QSTRING_CSTR(pragma.lastError().text()));
+		}
+
 		return db;
 	}
 }
@@ -205,6 +212,32 @@ bool DBManager::updateRecord(const VectorPair& conditions, const QVariantMap& co
 	return true;
 }
 
+bool DBManager::startTransaction() const
+{
+	if (_readonlyMode)
+		return false;
+
+	QSqlDatabase idb = getDB();
+	if (!idb.transaction())
+	{
+		Error(_log, "Could not create a DB transaction. Error: %s", QSTRING_CSTR(idb.lastError().text()));
+		return false;
+	}
+	return true;
+}
+
+bool DBManager::commitTransaction() const
+{
+	QSqlDatabase idb = getDB();
+	if (!idb.commit())
+	{
+		Error(_log, "Could not commit the DB transaction. Error: %s", QSTRING_CSTR(idb.lastError().text()));
+		idb.rollback();
+		return false;
+	}
+	return true;
+}
+
 bool DBManager::getRecord(const VectorPair& conditions, QVariantMap& results, const QStringList& tColumns, const QStringList& tOrder) const
 {
 	QSqlDatabase idb = getDB();
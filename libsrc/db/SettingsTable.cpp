@@ -1,11 +1,29 @@
 #include <db/SettingsTable.h>
 #include <utils/settings.h>
 
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
 #define INSTANCE_COLUMN QString("hyperhdr_instance")
 
+namespace
+{
+	struct CachedRecord
+	{
+		QString       config;
+		QJsonDocument document;
+	};
+
+	QMutex                        cacheMutex;
+	QHash<QString, CachedRecord>  cache;
+	quint64                       cacheVersion = 0;
+}
+
 SettingsTable::SettingsTable(quint8 instance, QObject* parent)
 	: DBManager(parent)
 	, _hyperhdr_inst(instance)
+	, _inTransaction(false)
 {
 	setTable("settings");
 	// create table columns
@@ -30,7 +48,36 @@ bool SettingsTable::createSettingsRecord(const QString& type, const QString& con
 	// when a setting is not global we are searching also for the instance
 	if(!isSettingGlobal(type))
 		cond.append(CPair("AND "+ INSTANCE_COLUMN,_hyperhdr_inst));
-	return createRecord(cond, map);
+
+	if (!createRecord(cond, map))
+		return false;
+
+	// the cache holds committed data only
+	if (_inTransaction)
+		_pendingCache.append(qMakePair(type, config));
+	else
+		updateCache(type, config);
+	return true;
+}
+
+bool SettingsTable::startTransaction() const
+{
+	_inTransaction = DBManager::startTransaction();
+	_pendingCache.clear();
+	return _inTransaction;
+}
+
+bool SettingsTable::commitTransaction() const
+{
+	const bool committed = DBManager::commitTransaction();
+
+	if (committed)
+		for (const auto& record : _pendingCache)
+			updateCache(record.first, record.second);
+
+	_pendingCache.clear();
+	_inTransaction = false;
+	return committed;
 }
 
 ///
@@ -41,6 +88,12 @@ bool SettingsTable::createSettingsRecord(const QString& type, const QString& con
 ///
 bool SettingsTable::recordExist(const QString& type) const
 {
+	{
+		QMutexLocker locker(&cacheMutex);
+		if (cache.contains(getCacheKey(type)))
+			return true;
+	}
+
 	VectorPair cond;
 	cond.append(CPair("type",type));
 	// when a setting is not global we are searching also for the instance
@@ -56,6 +109,17 @@ bool SettingsTable::recordExist(const QString& type) const
 ///
 QJsonDocument SettingsTable::getSettingsRecord(const QString& type) const
 {
+	const QString key = getCacheKey(type);
+	{
+		QMutexLocker locker(&cacheMutex);
+		auto it = cache.constFind(key);
+		if (it != cache.constEnd())
+			return it->document;
+	}
+
+	// a save between the query and the insert must not be overwritten by the row read here
+	const quint64 version = getCacheVersion();
+
 	QVariantMap results;
 	VectorPair cond;
 	cond.append(CPair("type",type));
@@ -63,7 +127,12 @@ QJsonDocument SettingsTable::getSettingsRecord(const QString& type) const
 	if(!isSettingGlobal(type))
 		cond.append(CPair("AND " + INSTANCE_COLUMN,_hyperhdr_inst));
 	getRecord(cond, results, QStringList("config"));
-	return QJsonDocument::fromJson(results["config"].toByteArray());
+
+	// cache only existing records
+	QString config = results["config"].toString();
+	if (!results["config"].isNull())
+		fillCache(type, config, version);
+	return QJsonDocument::fromJson(config.toUtf8());
 }
 
 ///
@@ -73,6 +142,17 @@ QJsonDocument SettingsTable::getSettingsRecord(const QString& type) const
 ///
 QString SettingsTable::getSettingsRecordString(const QString& type) const
 {
+	const QString key = getCacheKey(type);
+	{
+		QMutexLocker locker(&cacheMutex);
+		auto it = cache.constFind(key);
+		if (it != cache.constEnd())
+			return it->config;
+	}
+
+	// a save between the query and the insert must not be overwritten by the row read here
+	const quint64 version = getCacheVersion();
+
 	QVariantMap results;
 	VectorPair cond;
 	cond.append(CPair("type",type));
@@ -80,7 +160,12 @@ QString SettingsTable::getSettingsRecordString(const QString& type) const
 	if(!isSettingGlobal(type))
 		cond.append(CPair("AND " + INSTANCE_COLUMN,_hyperhdr_inst));
 	getRecord(cond, results, QStringList("config"));
-	return results["config"].toString();
+
+	// cache only existing records
+	QString config = results["config"].toString();
+	if (!results["config"].isNull())
+		fillCache(type, config, version);
+	return config;
 }
 
 bool SettingsTable::deleteSettingsRecordString(const QString& type) const
@@ -91,7 +176,14 @@ bool SettingsTable::deleteSettingsRecordString(const QString& type) const
 	// when a setting is not global we are searching also for the instance
 	if (!isSettingGlobal(type))
 		cond.append(CPair("AND "+ INSTANCE_COLUMN, _hyperhdr_inst));
-	return deleteRecord(cond);		
+
+	bool result = deleteRecord(cond);
+
+	QMutexLocker locker(&cacheMutex);
+	cache.remove(getCacheKey(type));
+	cacheVersion++;
+
+	return result;
 }
 
 bool SettingsTable::purge(const QString& type) const
@@ -100,7 +192,12 @@ bool SettingsTable::purge(const QString& type) const
 	VectorPair cond;
 	cond.append(CPair("type", type));
 	// when a setting is not global we are searching also for the instance
-	return deleteRecord(cond);
+	bool result = deleteRecord(cond);
+
+	// the record is removed for all instances
+	invalidateCache();
+
+	return result;
 }
 ///
 /// @brief Delete all settings entries associated with this instance, called from InstanceTable of HyperHDRIManager
@@ -110,14 +207,16 @@ void SettingsTable::deleteInstance() const
 	VectorPair cond;
 	cond.append(CPair(INSTANCE_COLUMN,_hyperhdr_inst));
 	deleteRecord(cond);
+
+	invalidateCache();
 }
 
 bool SettingsTable::isSettingGlobal(const QString& type) const
 {
 	// list of global settings
-	QStringList list;
-	// server port services
-	list << settings::typeToString(settings::type::JSONSERVER) << settings::typeToString(settings::type::PROTOSERVER)
+	static const QStringList list = QStringList()
+		// server port services
+		<< settings::typeToString(settings::type::JSONSERVER) << settings::typeToString(settings::type::PROTOSERVER)
 		<< settings::typeToString(settings::type::FLATBUFSERVER) << settings::typeToString(settings::type::NETWORK)
 		<< settings::typeToString(settings::type::NETFORWARD) << settings::typeToString(settings::type::WEBSERVER)
 		<< settings::typeToString(settings::type::VIDEOGRABBER) << settings::typeToString(settings::type::SYSTEMGRABBER) 
@@ -128,3 +227,48 @@ bool SettingsTable::isSettingGlobal(const QString& type) const
 
 	return list.contains(type);
 }
+
+QString SettingsTable::getCacheKey(const QString& type) const
+{
+	if (isSettingGlobal(type))
+		return type;
+
+	return QString("%1@%2").arg(type).arg(_hyperhdr_inst);
+}
+
+void SettingsTable::fillCache(const QString& type, const QString& config, quint64 version) const
+{
+	// the rows read inside a transaction are not committed yet
+	if (_inTransaction)
+		return;
+
+	CachedRecord record{ config, QJsonDocument::fromJson(config.toUtf8()) };
+	const QString key = getCacheKey(type);
+
+	QMutexLocker locker(&cacheMutex);
+	if (cacheVersion == version)
+		cache.insert(key, record);
+}
+
+void SettingsTable::updateCache(const QString& type, const QString& config) const
+{
+	CachedRecord record{ config, QJsonDocument::fromJson(config.toUtf8()) };
+	const QString key = getCacheKey(type);
+
+	QMutexLocker locker(&cacheMutex);
+	cache.insert(key, record);
+	cacheVersion++;
+}
+
+quint64 SettingsTable::getCacheVersion()
+{
+	QMutexLocker locker(&cacheMutex);
+	return cacheVersion;
+}
+
+void SettingsTable::invalidateCache()
+{
+	QMutexLocker locker(&cacheMutex);
+	cache.clear();
+	cacheVersion++;
+}
@@ -25,11 +25,6 @@ void Animation4Music_PulseBlue::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_PulseBlue::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_PulseBlue::hasOwnImage()
 {
 	return true;
@@ -25,11 +25,6 @@ void Animation4Music_PulseGreen::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_PulseGreen::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_PulseGreen::hasOwnImage()
 {
 	return true;
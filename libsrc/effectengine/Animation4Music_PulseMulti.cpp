@@ -25,11 +25,6 @@ void Animation4Music_PulseMulti::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_PulseMulti::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_PulseMulti::hasOwnImage()
 {
 	return true;
@@ -25,11 +25,6 @@ void Animation4Music_PulseMultiFast::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_PulseMultiFast::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_PulseMultiFast::hasOwnImage()
 {
 	return true;
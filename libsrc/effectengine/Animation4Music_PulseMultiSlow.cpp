@@ -25,11 +25,6 @@ void Animation4Music_PulseMultiSlow::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_PulseMultiSlow::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_PulseMultiSlow::hasOwnImage()
 {
 	return true;
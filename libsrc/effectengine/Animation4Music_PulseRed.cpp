@@ -25,11 +25,6 @@ void Animation4Music_PulseRed::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_PulseRed::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_PulseRed::hasOwnImage()
 {
 	return true;
@@ -25,11 +25,6 @@ void Animation4Music_PulseWhite::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_PulseWhite::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_PulseWhite::hasOwnImage()
 {
 	return true;
@@ -25,11 +25,6 @@ void Animation4Music_PulseYellow::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_PulseYellow::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_PulseYellow::hasOwnImage()
 {
 	return true;
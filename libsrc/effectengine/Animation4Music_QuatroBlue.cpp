@@ -27,11 +27,6 @@ void Animation4Music_QuatroBlue::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_QuatroBlue::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_QuatroBlue::hasOwnImage()
 {
 	return true;
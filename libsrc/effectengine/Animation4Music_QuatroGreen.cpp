@@ -27,11 +27,6 @@ void Animation4Music_QuatroGreen::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_QuatroGreen::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_QuatroGreen::hasOwnImage()
 {
 	return true;
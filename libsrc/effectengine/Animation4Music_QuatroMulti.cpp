@@ -27,11 +27,6 @@ void Animation4Music_QuatroMulti::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_QuatroMulti::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_QuatroMulti::hasOwnImage()
 {
 	return true;
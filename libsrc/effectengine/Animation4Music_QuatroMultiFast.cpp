@@ -27,11 +27,6 @@ void Animation4Music_QuatroMultiFast::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_QuatroMultiFast::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_QuatroMultiFast::hasOwnImage()
 {
 	return true;
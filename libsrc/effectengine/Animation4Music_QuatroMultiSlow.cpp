@@ -27,11 +27,6 @@ void Animation4Music_QuatroMultiSlow::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_QuatroMultiSlow::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_QuatroMultiSlow::hasOwnImage()
 {
 	return true;
@@ -27,11 +27,6 @@ void Animation4Music_QuatroRed::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_QuatroRed::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_QuatroRed::hasOwnImage()
 {
 	return true;
@@ -27,11 +27,6 @@ void Animation4Music_QuatroWhite::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_QuatroWhite::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_QuatroWhite::hasOwnImage()
 {
 	return true;
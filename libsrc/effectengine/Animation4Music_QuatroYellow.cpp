@@ -27,11 +27,6 @@ void Animation4Music_QuatroYellow::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_QuatroYellow::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_QuatroYellow::hasOwnImage()
 {
 	return true;
@@ -27,11 +27,6 @@ void Animation4Music_StereoBlue::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_StereoBlue::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_StereoBlue::hasOwnImage()
 {
 	return true;
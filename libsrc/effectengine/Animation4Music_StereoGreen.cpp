@@ -27,11 +27,6 @@ void Animation4Music_StereoGreen::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_StereoGreen::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_StereoGreen::hasOwnImage()
 {
 	return true;
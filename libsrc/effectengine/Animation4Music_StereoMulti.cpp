@@ -27,11 +27,6 @@ void Animation4Music_StereoMulti::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_StereoMulti::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_StereoMulti::hasOwnImage()
 {
 	return true;
@@ -27,11 +27,6 @@ void Animation4Music_StereoMultiFast::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_StereoMultiFast::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_StereoMultiFast::hasOwnImage()
 {
 	return true;
@@ -27,11 +27,6 @@ void Animation4Music_StereoMultiSlow::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_StereoMultiSlow::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_StereoMultiSlow::hasOwnImage()
 {
 	return true;
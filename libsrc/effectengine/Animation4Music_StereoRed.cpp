@@ -27,11 +27,6 @@ void Animation4Music_StereoRed::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_StereoRed::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_StereoRed::hasOwnImage()
 {
 	return true;
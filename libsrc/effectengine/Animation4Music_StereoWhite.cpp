@@ -27,11 +27,6 @@ void Animation4Music_StereoWhite::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_StereoWhite::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_StereoWhite::hasOwnImage()
 {
 	return true;
@@ -27,11 +27,6 @@ void Animation4Music_StereoYellow::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_StereoYellow::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_StereoYellow::hasOwnImage()
 {
 	return true;
@@ -24,11 +24,6 @@ void Animation4Music_TestEq::Init(
 	SetSleepTime(5);
 }
 
-bool Animation4Music_TestEq::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_TestEq::hasOwnImage()
 {
 	return true;
@@ -37,7 +32,7 @@ bool Animation4Music_TestEq::hasOwnImage()
 bool Animation4Music_TestEq::getImage(Image<ColorRgb>& newImage)
 {
 	uint8_t  buffScaledResult[SOUNDCAP_RESULT_RES];
-	auto r = SoundCapture::getInstance()->hasResult(_internalIndex);	
+	auto r = SoundCapture::getInstance()->hasResult(this, _internalIndex);	
 
 	if (r==NULL)
 		return false;
@@ -30,11 +30,6 @@ void Animation4Music_WavesPulse::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_WavesPulse::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_WavesPulse::hasOwnImage()
 {
 	return true;
@@ -30,11 +30,6 @@ void Animation4Music_WavesPulseFast::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_WavesPulseFast::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_WavesPulseFast::hasOwnImage()
 {
 	return true;
@@ -30,11 +30,6 @@ void Animation4Music_WavesPulseSlow::Init(
 	SetSleepTime(15);
 }
 
-bool Animation4Music_WavesPulseSlow::Play(QPainter* painter)
-{
-	return false;
-}
-
 bool Animation4Music_WavesPulseSlow::hasOwnImage()
 {
 	return true;
@@ -1,5 +1,9 @@
 #include <effectengine/AnimationBase.h>
 
+#ifndef M_PI
+	#define M_PI           3.14159265358979323846
+#endif
+
 AnimationBase::AnimationBase(QString name) :
 	_name(name),
 	_sleepTime(100),
@@ -23,6 +27,11 @@ QString AnimationBase::GetName()
 	return _name;
 };
 
+bool AnimationBase::Play(QPainter* painter)
+{
+	return false;
+};
+
 bool AnimationBase::isSoundEffect()
 {
 	return false;
@@ -60,3 +69,109 @@ bool AnimationBase::hasLedData(QVector<ColorRgb>& buffer)
 	return false;
 }
 
+void AnimationBase::paletteBlit(Image<ColorRgb>& image, const int* indexes, const uint8_t* palette, int paletteLength, int offset)
+{
+	size_t    count = static_cast<size_t>(image.width()) * image.height();
+	uint8_t*  dest = reinterpret_cast<uint8_t*>(image.memptr());
+
+	offset %= paletteLength;
+	if (offset < 0)
+		offset += paletteLength;
+
+	for (size_t i = 0; i < count; i++, dest += 3)
+	{
+		int index = indexes[i] + offset;
+		while (index >= paletteLength)
+			index -= paletteLength;
+
+		const uint8_t* color = &palette[index * 3];
+		dest[0] = color[0];
+		dest[1] = color[1];
+		dest[2] = color[2];
+	}
+}
+
+void AnimationBase::buildGradientTable(GradientTable& table, const QList<GradientStop>& stops)
+{
+	if (stops.isEmpty())
+	{
+		memset(table.rgba, 0, sizeof(table.rgba));
+		return;
+	}
+
+	// same ordering as QGradient::setColorAt: a stop is placed before the existing ones at the same position
+	QList<GradientStop> sorted;
+	for (const GradientStop& stop : stops)
+	{
+		int index = 0;
+		while (index < sorted.length() && sorted[index].items[0] < stop.items[0])
+			index++;
+		sorted.insert(index, stop);
+	}
+
+	int next = 0;
+	for (int i = 0; i < 256; i++)
+	{
+		while (next < sorted.length() && sorted[next].items[0] <= i)
+			next++;
+
+		const GradientStop& from = sorted[std::max(next - 1, 0)];
+		const GradientStop& to = sorted[std::min(next, int(sorted.length()) - 1)];
+
+		int range = int(to.items[0]) - int(from.items[0]);
+		int weight = (range > 0) ? ((i - from.items[0]) * 256) / range : 0;
+		weight = std::min(std::max(weight, 0), 256);
+
+		uint8_t* out = table.rgba[i];
+		for (int c = 0; c < 3; c++)
+		{
+			int a = (int(from.items[c + 1]) * from.items[4]) / 255;
+			int b = (int(to.items[c + 1]) * to.items[4]) / 255;
+			out[c] = uint8_t((a * (256 - weight) + b * weight) >> 8);
+		}
+		out[3] = uint8_t((int(from.items[4]) * (256 - weight) + int(to.items[4]) * weight) >> 8);
+	}
+}
+
+void AnimationBase::buildConicalMap(std::vector<uint16_t>& map, int width, int height, int centerX, int centerY)
+{
+	const double turn = 2.0 * M_PI;
+
+	map.resize(static_cast<size_t>(width) * height);
+
+	for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
+		{
+			double t = 1.0 - atan2(y + 0.5 - centerY, x + 0.5 - centerX) / turn;
+			t -= floor(t);
+			map[static_cast<size_t>(y) * width + x] = static_cast<uint16_t>(int(t * 65536.0) & 0xFFFF);
+		}
+}
+
+void AnimationBase::conicalGradient(Image<ColorRgb>& image, const std::vector<uint16_t>& map, int angle, const GradientTable& table, bool overImage)
+{
+	size_t   count = std::min(map.size(), static_cast<size_t>(image.width()) * image.height());
+	uint8_t* dest = reinterpret_cast<uint8_t*>(image.memptr());
+	uint16_t rotation = static_cast<uint16_t>((std::min(std::max(angle, 0), 360) * 65536) / 360);
+
+	for (size_t i = 0; i < count; i++, dest += 3)
+	{
+		const uint8_t* color = table.rgba[uint16_t(map[i] - rotation) >> 8];
+		uint8_t alpha = color[3];
+
+		// the table is premultiplied, so over a black background the color is used as it is
+		if (alpha == 255 || !overImage)
+		{
+			dest[0] = color[0];
+			dest[1] = color[1];
+			dest[2] = color[2];
+		}
+		else
+		{
+			int inverse = 255 - alpha;
+			dest[0] = uint8_t(color[0] + (dest[0] * inverse) / 255);
+			dest[1] = uint8_t(color[1] + (dest[1] * inverse) / 255);
+			dest[2] = uint8_t(color[2] + (dest[2] * inverse) / 255);
+		}
+	}
+}
@@ -1,11 +1,14 @@
 #include <effectengine/AnimationBaseMusic.h>
+#include <hyperhdrbase/SoundCapture.h>
 
 AnimationBaseMusic::AnimationBaseMusic(QString name) :
-	AnimationBase(name)	
+	AnimationBase(name),
+	_soundResult(new SoundCaptureResult())
 {
-	_myTarget.Clear();
 };
 
+AnimationBaseMusic::~AnimationBaseMusic() = default;
+
 QJsonObject AnimationBaseMusic::GetArgs() {
 	QJsonObject doc;
 	doc["smoothing-custom-settings"] = true;
@@ -18,12 +21,8 @@ bool AnimationBaseMusic::isSoundEffect()
 	return true;
 };
 
-void AnimationBaseMusic::store(MovingTarget* source) {
-	_myTarget.CopyFrom(source);
-};
-
-void AnimationBaseMusic::restore(MovingTarget* target) {
-	target->CopyFrom(&_myTarget);
+SoundCaptureResult* AnimationBaseMusic::getSoundResult() {
+	return _soundResult.get();
 };
 
 void MovingTarget::Clear()
@@ -45,11 +45,6 @@ void Animation_MoodBlobs::Init(
 	
 }
 
-bool Animation_MoodBlobs::Play(QPainter* painter)
-{
-	return true;
-}
-
 bool Animation_MoodBlobs::hasLedData(QVector<ColorRgb>& buffer)
 {
 	if (buffer.length() != hyperledCount && buffer.length() > 1)
@@ -69,20 +69,19 @@ void Animation_Plasma::Init(
 
 
 
-bool Animation_Plasma::Play(QPainter* painter)
+bool Animation_Plasma::hasOwnImage()
 {
-	bool ret = true;
-	
-	qint64 mod = start++;
-	for (int y = 0; y < PLASMA_HEIGHT; y++)
-		for (int x = 0; x < PLASMA_WIDTH; x++) {
-			int delta = y * PLASMA_WIDTH;
-			int palIndex = int((plasma[delta + x] + mod) % PAL_LEN)*3;			
+	return true;
+};
 
-			painter->setPen(qRgb(pal[palIndex],pal[palIndex+1], pal[palIndex+2]));
-			painter->drawPoint(x, y);
-		}
-	return ret;
+bool Animation_Plasma::getImage(Image<ColorRgb>& newImage)
+{
+	newImage.resize(PLASMA_WIDTH, PLASMA_HEIGHT);
+
+	int mod = int(start++ % PAL_LEN);
+	paletteBlit(newImage, plasma, pal, PAL_LEN, mod);
+
+	return true;
 }
 
 QJsonObject Animation_Plasma::GetArgs() {
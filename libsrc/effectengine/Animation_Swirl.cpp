@@ -24,6 +24,8 @@ Animation_Swirl::Animation_Swirl(QString name) :
 	S2 = false;;
 	increment = 1;
 	increment2 = -1;
+	imageWidth = 80;
+	imageHeight = 45;
 
 	custom_colors.append({ 255, 0, 0, 0 });
 	custom_colors.append({ 0, 255, 0, 0 });
@@ -169,11 +171,27 @@ void Animation_Swirl::Init(
 		S2 = true;
 		buildGradient(baS2, true, _custColors2);
 	}
+
+	imageWidth = hyperImage.width();
+	imageHeight = hyperImage.height();
+
+	buildGradientTable(tableS1, baS1);
+	buildConicalMap(mapS1, imageWidth, imageHeight, pointS1.x, pointS1.y);
+
+	if (S2)
+	{
+		buildGradientTable(tableS2, baS2);
+		buildConicalMap(mapS2, imageWidth, imageHeight, pointS2.x, pointS2.y);
+	}
 }
 
-bool Animation_Swirl::Play(QPainter* painter)
+bool Animation_Swirl::hasOwnImage()
+{
+	return true;
+};
+
+bool Animation_Swirl::getImage(Image<ColorRgb>& newImage)
 {
-	bool ret;
 	angle += increment;
 	if (angle > 360)
 		angle = 0;
@@ -185,43 +203,12 @@ bool Animation_Swirl::Play(QPainter* painter)
 		angle2 = 0;
 	if (angle2 < 0)
 		angle2 = 360;
-	
-	ret = imageConicalGradient(painter, pointS1.x, pointS1.y, angle, baS1);
-	if (S2)
-		ret |= imageConicalGradient(painter, pointS2.x, pointS2.y, angle2, baS2);
-	return ret;
-}
 
+	newImage.resize(imageWidth, imageHeight);
 
-bool Animation_Swirl::imageConicalGradient(QPainter* painter, int centerX, int centerY, int angle, const QList<Animation_Swirl::SwirlGradient>& bytearray)										
-{
-	int startX = 0;
-	int startY = 0;
-	int width  = painter->device()->width();
-	int height = painter->device()->height();
-	
-	angle = qMax(qMin(angle,360),0);
-
-	
-	QRect myQRect(startX,startY,width,height);
-	QConicalGradient gradient(QPoint(centerX,centerY), angle );
-
-	foreach(Animation_Swirl::SwirlGradient item, bytearray)
-	{
-		gradient.setColorAt(
-			((uint8_t)item.items[0])/255.0,
-			QColor(
-				(uint8_t)(item.items[1]),
-				(uint8_t)(item.items[2]),
-				(uint8_t)(item.items[3]),
-				(uint8_t)(item.items[4])
-		));
-	}
-
-	painter->fillRect(myQRect, gradient);
+	conicalGradient(newImage, mapS1, angle, tableS1);
+	if (S2)
+		conicalGradient(newImage, mapS2, angle2, tableS2, true);
 
 	return true;
-
 }
-
-
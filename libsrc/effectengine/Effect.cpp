@@ -2,7 +2,10 @@
 #include <QDateTime>
 #include <QFile>
 #include <QResource>
-#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <algorithm>
 
 // effect engin eincludes
 #include <effectengine/Effect.h>
@@ -68,7 +71,7 @@
 #include <hyperhdrbase/SoundCapture.h>
 
 Effect::Effect(HyperHdrInstance *hyperhdr, int priority, int timeout, const QString &name, const QJsonObject &args, const QString &imageData)
-	: QThread()
+	: QObject()
 	, _hyperhdr(hyperhdr)
 	, _priority(priority)
 	, _timeout(timeout)	
@@ -76,16 +79,16 @@ Effect::Effect(HyperHdrInstance *hyperhdr, int priority, int timeout, const QStr
 	, _args(args)
 	, _imageData(imageData)
 	, _endTime(-1)
-	, _colors()	
+	, _ledCount(hyperhdr->getLedCount())
+	, _visiblePriority(hyperhdr->getCurrentPriority())
 	, _imageSize(hyperhdr->getLedGridSize())
 	, _image(_imageSize,QImage::Format_ARGB32_Premultiplied)
 	, _painter(NULL)
 	, _effect(NULL)
 	, _soundHandle(0)
+	, _renderTime(0)
+	, _renderFrames(0)
 {
-	_colors.resize(_hyperhdr->getLedCount());
-	_colors.fill(ColorRgb::BLACK);
-
 	_log = Logger::getInstance(QString("EFFECT%1(%2)").arg(hyperhdr->getInstanceIndex()).arg((name.length()>9)?name.left(6)+"...":name));
 
 	// init effect image for image based effects, size is based on led layout
@@ -316,7 +319,9 @@ Effect::~Effect()
 	Info(_log, "Deleting effect named: '%s'", QSTRING_CSTR(_name));
 	
 	requestInterruption();
-	wait();
+	EffectScheduler::getInstance()->remove(this);
+
+	releaseSound();
 
 	delete _effect;
 	_effect = NULL;
@@ -325,104 +330,131 @@ Effect::~Effect()
 	_painter = NULL;
 }
 
-void Effect::run()
+void Effect::start()
 {
-	if (_effect == NULL)
+	// fetched here on the owning thread: a blocking call in step() would stall a shared effect worker
+	if (_effect != NULL && _effect->isSoundEffect())
 	{
-		Error(_log, "Unable to find effect by this name. Please review configuration. Effect name: '%s'", QSTRING_CSTR(_name));
-		return;
+		SoundCapture* soundCapture = SoundCapture::getInstance();
+		Qt::ConnectionType type = (soundCapture->thread() == QThread::currentThread()) ? Qt::DirectConnection : Qt::BlockingQueuedConnection;
+
+		QMetaObject::invokeMethod(soundCapture, "getCaptureInstance", type, Q_RETURN_ARG(uint32_t, _soundHandle));
 	}
 
-	int latchTime = 10;
-	int ledCount = 0;
-	QMetaObject::invokeMethod(_hyperhdr, "getLedCount", Qt::BlockingQueuedConnection, Q_RETURN_ARG(int, ledCount));
+	EffectScheduler::getInstance()->add(this);
+}
 
-	_ledBuffer.resize(ledCount);
+int Effect::step()
+{
+	if (_painter == NULL)
+	{
+		if (_effect == NULL)
+		{
+			Error(_log, "Unable to find effect by this name. Please review configuration. Effect name: '%s'", QSTRING_CSTR(_name));
+			return -1;
+		}
 
-	_effect->Init(_image, latchTime);
+		int latchTime = 10;
 
-	_painter = new QPainter(&_image);
+		_ledBuffer.resize(_ledCount);
 
-	if (_timeout > 0)
-	{
-		_endTime = QDateTime::currentMSecsSinceEpoch() + _timeout;
-	}
+		_effect->Init(_image, latchTime);
 
-	if (_effect->isSoundEffect())
-	{
-		QMetaObject::invokeMethod(SoundCapture::getInstance(), "getCaptureInstance", Qt::BlockingQueuedConnection, Q_RETURN_ARG(uint32_t, _soundHandle));
-	}
-	
-	Info(_log, "Begin playing the effect with priority: %i", _priority);
-	while (!_interupt && (_timeout <= 0 || QDateTime::currentMSecsSinceEpoch() < _endTime))
-	{
-		if (_priority > 0)
+		_painter = new QPainter(&_image);
+
+		if (_timeout > 0)
 		{
-			int currentPriority = 0;
-			QMetaObject::invokeMethod(_hyperhdr, "getCurrentPriority", Qt::BlockingQueuedConnection, Q_RETURN_ARG(int, currentPriority));
-
-			if (currentPriority < _priority)
-			{
-				QCoreApplication::processEvents(QEventLoop::AllEvents, 15);
-				if (!_interupt && (_timeout <= 0 || QDateTime::currentMSecsSinceEpoch() < _endTime))
-					QThread::msleep(500);
-				continue;
-			}
+			_endTime = QDateTime::currentMSecsSinceEpoch() + _timeout;
 		}
 
-		bool   hasLedData = false;
+		Info(_log, "Begin playing the effect with priority: %i", _priority);
+	}
 
-		if (!_effect->hasOwnImage())
-		{
-			_effect->Play(_painter);			
+	qint64 now = QDateTime::currentMSecsSinceEpoch();
 
-			hasLedData = _effect->hasLedData(_ledBuffer);
-		}		
+	if (_interupt || (_timeout > 0 && now >= _endTime))
+		return stopPlaying();
 
-		int    micro   = _effect->GetSleepTime();
-		qint64 dieTime = QDateTime::currentMSecsSinceEpoch() + micro;
+	// hidden by a more important priority: setVisiblePriority wakes the effect up.
+	// The timeout was checked against the same 'now', so the delay is at least 1 ms and the next step stops the effect.
+	if (_priority > 0 && _visiblePriority < _priority)
+		return (_timeout > 0) ? static_cast<int>(std::min(static_cast<qint64>(_endTime) - now, static_cast<qint64>(500))) : 500;
 
-		if (_effect->hasOwnImage())
-		{
-			Image<ColorRgb> image(80, 45);
-			int timeout = _timeout;
-			if (timeout > 0)
-			{
-				timeout = _endTime - QDateTime::currentMSecsSinceEpoch();
-				if (timeout <= 0)
-					break;
-			}
-
-			if (_effect->getImage(image))
-				emit setInputImage(_priority, image, timeout, false);
-		}
-		else if (hasLedData)
-		{
-			if (!LedShow())
-				break;
-		}
-		else
+	QElapsedTimer renderTimer;
+	bool   hasLedData = false;
+
+	if (!_effect->hasOwnImage())
+	{
+		renderTimer.start();
+		_effect->Play(_painter);
+		_renderTime += renderTimer.nsecsElapsed();
+		_renderFrames++;
+
+		hasLedData = _effect->hasLedData(_ledBuffer);
+	}		
+
+	int    micro   = _effect->GetSleepTime();
+	qint64 dieTime = QDateTime::currentMSecsSinceEpoch() + micro;
+
+	if (_effect->hasOwnImage())
+	{
+		// the image comes from the shared image buffer cache
+		Image<ColorRgb> image(80, 45);
+		int timeout = _timeout;
+		if (timeout > 0)
 		{
-			ImageShow();
+			timeout = _endTime - QDateTime::currentMSecsSinceEpoch();
+			if (timeout <= 0)
+				return stopPlaying();
 		}
 
-		if (_effect->isStop())
-			break;
-				
-		while (!_interupt && QDateTime::currentMSecsSinceEpoch() < dieTime &&
-			   (_timeout <= 0 || QDateTime::currentMSecsSinceEpoch() < _endTime))
-		{
-			micro = dieTime - QDateTime::currentMSecsSinceEpoch();			
-			while (micro > 200)
-				micro /= 2;
+		renderTimer.start();
+		bool hasImage = _effect->getImage(image);
+		_renderTime += renderTimer.nsecsElapsed();
+		_renderFrames++;
 
-			if (micro > 0)
-				QThread::msleep(micro);			
-		}
+		if (hasImage)
+			emit setInputImage(_priority, image, timeout, false);
+	}
+	else if (hasLedData)
+	{
+		if (!LedShow())
+			return stopPlaying();
+	}
+	else
+	{
+		ImageShow();
 	}
 
-	Info(_log, "The effect quits with priority: %i", _priority);
+	if (_effect->isStop())
+		return stopPlaying();
+
+	if (_timeout > 0)
+		dieTime = std::min(dieTime, static_cast<qint64>(_endTime));
 
+	return std::max(static_cast<int>(dieTime - QDateTime::currentMSecsSinceEpoch()), 1);
+}
+
+void Effect::done()
+{
+	emit finished();
+}
+
+int Effect::stopPlaying()
+{
+	if (_painter != NULL)
+		Info(_log, "The effect quits with priority: %i", _priority);
+
+	if (_renderFrames > 0)
+		Debug(_log, "Average render time: %.3f ms per frame (%lld frames)", _renderTime / (_renderFrames * 1000000.0), static_cast<long long>(_renderFrames));
+
+	releaseSound();
+
+	return -1;
+}
+
+void Effect::releaseSound()
+{
 	if (_soundHandle != 0)
 	{
 		Info(_log, "Releasing sound handle %i for effect named: '%s'", _soundHandle, QSTRING_CSTR(_name));
@@ -444,14 +476,11 @@ bool Effect::LedShow()
 			return false;
 	}
 
-	int ledCount = 0;
-	QMetaObject::invokeMethod(_hyperhdr, "getLedCount", Qt::BlockingQueuedConnection, Q_RETURN_ARG(int, ledCount));
-
-	
-	if (ledCount == _ledBuffer.length())
+	// the LED count is fixed for the lifetime of the effect: a new layout restarts the running effects
+	if (_ledCount == _ledBuffer.length())
 	{
-		QVector<ColorRgb> _cQV = _ledBuffer;
-		emit setInput(_priority, std::vector<ColorRgb>( _cQV.begin(), _cQV.end() ), timeout, false);
+		_ledColors.assign(_ledBuffer.begin(), _ledBuffer.end());
+		emit setInput(_priority, _ledColors, timeout, false);
 	}
 	else
 	{
@@ -478,21 +507,21 @@ bool Effect::ImageShow()
 	int width = _image.width();
 	int height = _image.height();
 
+	// the frame is shared with the receiver, the buffer is recycled by the image buffer cache
 	Image<ColorRgb> image(width, height);
-	QByteArray binaryImage;
+	uint8_t* dest = reinterpret_cast<uint8_t*>(image.memptr());
 
 	for (int i = 0; i<height; ++i)
 	{
-		const QRgb * scanline = reinterpret_cast<const QRgb *>(_image.scanLine(i));
-		for (int j = 0; j< width; ++j)
+		const QRgb * scanline = reinterpret_cast<const QRgb *>(_image.constScanLine(i));
+		for (int j = 0; j< width; ++j, dest += 3)
 		{
-			binaryImage.append((char) qRed(scanline[j]));
-			binaryImage.append((char) qGreen(scanline[j]));
-			binaryImage.append((char) qBlue(scanline[j]));
+			dest[0] = (uint8_t) qRed(scanline[j]);
+			dest[1] = (uint8_t) qGreen(scanline[j]);
+			dest[2] = (uint8_t) qBlue(scanline[j]);
 		}
 	}
 
-	memcpy(image.memptr(), binaryImage.data(), binaryImage.size());
 	emit setInputImage(_priority, image, timeout, false);
 
 	return true;
@@ -505,12 +534,19 @@ int  Effect::getPriority() const {
 
 void Effect::requestInterruption() {
 	_interupt = true;
+	EffectScheduler::getInstance()->wake(this);
 }
 
-bool Effect::isInterruptionRequested() {
+bool Effect::isInterruptionRequested() const {
 	return _interupt;
 }
 
+void Effect::setVisiblePriority(int priority) {
+	_visiblePriority = priority;
+	if (priority >= _priority)
+		EffectScheduler::getInstance()->wake(this);
+}
+
 QString Effect::getName()     const {
 	return _name;
 }
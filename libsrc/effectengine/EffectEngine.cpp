@@ -24,6 +24,9 @@ EffectEngine::EffectEngine(HyperHdrInstance* hyperhdr)
 	connect(_hyperInstance, &HyperHdrInstance::channelCleared, this, &EffectEngine::channelCleared);
 	connect(_hyperInstance, &HyperHdrInstance::allChannelsCleared, this, &EffectEngine::allChannelsCleared);
 
+	// the effects pause while a more important priority is visible
+	connect(_hyperInstance->getMuxerInstance(), &PriorityMuxer::visiblePriorityChanged, this, &EffectEngine::visiblePriorityChanged);
+
 	// get notifications about refreshed effect list
 	connect(_effectDBHandler, &EffectDBHandler::effectListChanged, this, &EffectEngine::handleUpdatedEffectList);
 
@@ -144,7 +147,7 @@ int EffectEngine::runEffectScript(const QString &name, const QJsonObject &args,
 	Effect *effect = new Effect(_hyperInstance, priority, timeout, name, args, imageData);
 	connect(effect, &Effect::setInput, _hyperInstance, &HyperHdrInstance::setInput, Qt::QueuedConnection);
 	connect(effect, &Effect::setInputImage, _hyperInstance, &HyperHdrInstance::setInputImage, Qt::QueuedConnection);
-	connect(effect, &QThread::finished, this, &EffectEngine::effectFinished);
+	connect(effect, &Effect::finished, this, &EffectEngine::effectFinished);
 	connect(_hyperInstance, &HyperHdrInstance::finished, effect, &Effect::requestInterruption, Qt::DirectConnection);
 	_activeEffects.push_back(effect);
 
@@ -179,6 +182,14 @@ void EffectEngine::allChannelsCleared()
 	}
 }
 
+void EffectEngine::visiblePriorityChanged(quint8 priority)
+{
+	for (Effect * effect : _activeEffects)
+	{
+		effect->setVisiblePriority(priority);
+	}
+}
+
 void EffectEngine::effectFinished()
 {
 	Effect* effect = qobject_cast<Effect*>(sender());
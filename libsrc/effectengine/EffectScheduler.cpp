@@ -0,0 +1,273 @@
+#include <effectengine/EffectScheduler.h>
+#include <utils/ThreadTopology.h>
+
+#include <algorithm>
+
+namespace
+{
+	// wheel resolution, the due times of the effects are rounded up to the next tick
+	const int TICK_MS = 5;
+	// one turn of the wheel: 1.28s, longer delays wait for more rounds
+	const int SLOTS = 256;
+	const int WORKERS = 2;
+}
+
+EffectScheduler* EffectScheduler::getInstance()
+{
+	static EffectScheduler scheduler;
+	return &scheduler;
+}
+
+EffectScheduler::EffectScheduler()
+	: _log(Logger::getInstance("EFFECTSCHEDULER"))
+	, _wheel(SLOTS)
+	, _currentTick(0)
+	, _running(false)
+	, _stopped(false)
+	, _metricTasks(Metrics::gauge("hyperhdr_effect_scheduler_tasks", "Effects running on the effect scheduler"))
+	, _metricStep(Metrics::histogram("hyperhdr_effect_step_seconds", "Time to render one effect frame"))
+{
+}
+
+EffectScheduler::~EffectScheduler()
+{
+	stop();
+}
+
+void EffectScheduler::add(Task* task, int delay)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (_stopped || _tasks.find(task) != _tasks.end())
+			return;
+
+		if (!_running)
+		{
+			_running = true;
+			for (int i = 0; i < WORKERS; i++)
+				_workers.emplace_back(&EffectScheduler::run, this, i);
+
+			Info(_log, "Started %i effect workers", WORKERS);
+		}
+
+		// the wheel was idle: restart the clock instead of catching up the missed ticks
+		if (_tasks.empty())
+			_nextTick = std::chrono::steady_clock::now() + std::chrono::milliseconds(TICK_MS);
+
+		Entry& entry = _tasks[task];
+		entry.wakeRequested = false;
+		entry.removed = false;
+		schedule(task, entry, delay);
+
+		_metricTasks->set(_tasks.size());
+	}
+
+	_wake.notify_all();
+}
+
+void EffectScheduler::wake(Task* task)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		auto it = _tasks.find(task);
+		if (it == _tasks.end() || it->second.removed)
+			return;
+
+		Entry& entry = it->second;
+
+		if (entry.state == State::RUNNING)
+		{
+			entry.wakeRequested = true;
+			return;
+		}
+
+		if (entry.state == State::READY)
+			return;
+
+		unlink(task, entry);
+		entry.state = State::READY;
+		_ready.push_back(task);
+	}
+
+	_wake.notify_one();
+}
+
+void EffectScheduler::remove(Task* task)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	auto it = _tasks.find(task);
+	if (it == _tasks.end())
+		return;
+
+	if (it->second.state == State::RUNNING)
+	{
+		// the worker drops the task after its step
+		it->second.removed = true;
+		_stepDone.wait(lock, [this, task] { return _tasks.find(task) == _tasks.end(); });
+	}
+	else
+	{
+		unlink(task, it->second);
+		_tasks.erase(it);
+	}
+
+	_metricTasks->set(_tasks.size());
+}
+
+void EffectScheduler::stop()
+{
+	std::vector<std::thread> workers;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_stopped = true;
+		workers.swap(_workers);
+	}
+
+	_wake.notify_all();
+
+	for (auto& worker : workers)
+		worker.join();
+}
+
+void EffectScheduler::schedule(Task* task, Entry& entry, int delay)
+{
+	if (delay <= 0)
+	{
+		entry.state = State::READY;
+		_ready.push_back(task);
+		return;
+	}
+
+	// index of the first tick at or after the due time
+	const auto due = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay);
+	uint64_t target = _currentTick;
+
+	if (due > _nextTick)
+	{
+		const int64_t wait = std::chrono::duration_cast<std::chrono::microseconds>(due - _nextTick).count();
+		target += (wait + TICK_MS * 1000 - 1) / (TICK_MS * 1000);
+	}
+
+	entry.state = State::WAITING;
+	entry.rounds = (target - _currentTick) / SLOTS;
+	entry.slot = target % SLOTS;
+
+	std::list<Task*>& slot = _wheel[entry.slot];
+	entry.position = slot.insert(slot.end(), task);
+}
+
+void EffectScheduler::unlink(Task* task, Entry& entry)
+{
+	if (entry.state == State::WAITING)
+	{
+		_wheel[entry.slot].erase(entry.position);
+	}
+	else if (entry.state == State::READY)
+	{
+		auto it = std::find(_ready.begin(), _ready.end(), task);
+		if (it != _ready.end())
+			_ready.erase(it);
+	}
+}
+
+void EffectScheduler::advance(std::chrono::steady_clock::time_point now)
+{
+	while (_nextTick <= now)
+	{
+		std::list<Task*>& slot = _wheel[_currentTick % SLOTS];
+
+		for (auto it = slot.begin(); it != slot.end(); )
+		{
+			Entry& entry = _tasks[*it];
+
+			if (entry.rounds > 0)
+			{
+				entry.rounds--;
+				++it;
+			}
+			else
+			{
+				entry.state = State::READY;
+				_ready.push_back(*it);
+				it = slot.erase(it);
+			}
+		}
+
+		_currentTick++;
+		_nextTick += std::chrono::milliseconds(TICK_MS);
+	}
+}
+
+void EffectScheduler::run(int index)
+{
+	ThreadTopology::registerCurrentThread(ThreadTopology::Role::EFFECT, QString("EffectWorker%1").arg(index));
+
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while (!_stopped)
+	{
+		if (_ready.empty())
+		{
+			if (_tasks.empty())
+			{
+				_wake.wait(lock);
+			}
+			else
+			{
+				// the first idle worker moves the wheel, the others wait for the ready tasks
+				const auto now = std::chrono::steady_clock::now();
+
+				if (now < _nextTick)
+					_wake.wait_until(lock, _nextTick);
+				else
+				{
+					advance(now);
+					if (_ready.size() > 1)
+						_wake.notify_all();
+				}
+			}
+			continue;
+		}
+
+		Task* task = _ready.front();
+		_ready.pop_front();
+
+		_tasks[task].state = State::RUNNING;
+		_tasks[task].wakeRequested = false;
+
+		lock.unlock();
+
+		int delay;
+		{
+			Metrics::ScopedTimer timer(_metricStep);
+			delay = task->step();
+		}
+
+		lock.lock();
+
+		Entry& entry = _tasks[task];
+
+		if (!entry.removed && delay < 0)
+		{
+			// still marked as running: remove() waits until the owner has been notified
+			lock.unlock();
+			task->done();
+			lock.lock();
+		}
+
+		if (_tasks[task].removed || delay < 0)
+		{
+			_tasks.erase(task);
+			_metricTasks->set(_tasks.size());
+			_stepDone.notify_all();
+			continue;
+		}
+
+		schedule(task, entry, (entry.wakeRequested) ? 0 : delay);
+	}
+}
@@ -21,6 +21,7 @@
 
 #include <grabber/AVFGrabber.h>
 #include <utils/ColorSys.h>
+#include <utils/CaptureRecorder.h>
 
 // Apple frameworks
 #include <Accelerate/Accelerate.h>
@@ -718,9 +719,14 @@ bool AVFGrabber::process_image(const void* frameImageBuffer, int size)
 {
 	bool		frameSend = false;
 	uint64_t	processFrameIndex = _currentFrame++;
+	int			decimation = getCaptureDecimation();
+
+	// raw frame as delivered by the device, before decimation and decoding
+	if (CaptureRecorder::getInstance()->isRecordingVideo())
+		CaptureRecorder::getInstance()->addVideoFrame(_actualVideoFormat, _actualWidth, _actualHeight, _lineLength, (const uint8_t*)frameImageBuffer, size);
 
 	// frame skipping
-	if ((processFrameIndex % _fpsSoftwareDecimation != 0) && (_fpsSoftwareDecimation > 1))
+	if ((processFrameIndex % decimation != 0) && (decimation > 1))
 		return frameSend;
 
 	// We do want a new frame...
@@ -766,7 +772,7 @@ bool AVFGrabber::process_image(const void* frameImageBuffer, int size)
 				}
 			}
 
-			for (unsigned int i = 0; _AVFWorkerManager.isActive() && i < _AVFWorkerManager.workersCount && _AVFWorkerManager.workers != nullptr; i++)
+			for (unsigned int i = 0; _AVFWorkerManager.isActive() && i < getCaptureWorkers(_AVFWorkerManager.workersCount) && _AVFWorkerManager.workers != nullptr; i++)
 			{
 				if (_AVFWorkerManager.workers[i]->isFinished() || !_AVFWorkerManager.workers[i]->isRunning())
 				{
@@ -808,6 +814,7 @@ void AVFGrabber::newWorkerFrameError(unsigned int workerIndex, QString error, qu
 {
 
 	frameStat.badFrame++;
+	_metricBadFrames->add();
 	//Debug(_log, "Error occured while decoding mjpeg frame %d = %s", sourceCount, QSTRING_CSTR(error));	
 
 	// get next frame	
@@ -824,6 +831,8 @@ void AVFGrabber::newWorkerFrame(unsigned int workerIndex, Image<ColorRgb> image,
 {
 	frameStat.goodFrame++;
 	frameStat.averageFrame += QDateTime::currentMSecsSinceEpoch() - _frameBegin;
+	_metricFrames->add();
+	_metricFrameTime->observe((uint64_t)(QDateTime::currentMSecsSinceEpoch() - _frameBegin) * 1000);
 	
 	if (_signalAutoDetectionEnabled  || isCalibrating())
 	{
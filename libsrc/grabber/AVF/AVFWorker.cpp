@@ -22,6 +22,7 @@
 #include <QFileInfo>
 
 #include "grabber/AVFWorker.h"
+#include <utils/ThreadTopology.h>
 
 
 
@@ -133,7 +134,7 @@ void AVFWorker::setup(unsigned int __workerIndex, PixelFormat __pixelFormat,
 	uint8_t* __sharedData, int __size, int __width, int __height, int __lineLength,
 	uint __cropLeft, uint  __cropTop, uint __cropBottom, uint __cropRight,
 	quint64 __currentFrame, qint64 __frameBegin,
-	int __hdrToneMappingEnabled, uint8_t* __lutBuffer, bool __qframe)
+	int __hdrToneMappingEnabled, const uint8_t* __lutBuffer, bool __qframe)
 {
 	_workerIndex = __workerIndex;
 	_lineLength = __lineLength;
@@ -170,6 +171,8 @@ void AVFWorker::setup(unsigned int __workerIndex, PixelFormat __pixelFormat,
 
 void AVFWorker::run()
 {
+	ThreadTopology::registerCurrentThread(ThreadTopology::Role::CAPTURE_WORKER, QString("AVFWorker%1").arg(_workerIndex));
+
 	runMe();	
 }
 
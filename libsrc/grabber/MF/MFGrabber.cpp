@@ -28,6 +28,7 @@
 
 #include <grabber/MFGrabber.h>
 #include <utils/ColorSys.h>
+#include <utils/CaptureRecorder.h>
 #include <grabber/MFCallback.h>
 
 
@@ -901,9 +902,14 @@ bool MFGrabber::process_image(const void* frameImageBuffer, int size)
 {
 	bool		frameSend = false;
 	uint64_t	processFrameIndex = _currentFrame++;
+	int			decimation = getCaptureDecimation();
+
+	// raw frame as delivered by the device, before decimation and decoding
+	if (CaptureRecorder::getInstance()->isRecordingVideo())
+		CaptureRecorder::getInstance()->addVideoFrame(_actualVideoFormat, _actualWidth, _actualHeight, _lineLength, (const uint8_t*)frameImageBuffer, size);
 
 	// frame skipping
-	if ((processFrameIndex % _fpsSoftwareDecimation != 0) && (_fpsSoftwareDecimation > 1))
+	if ((processFrameIndex % decimation != 0) && (decimation > 1))
 		return frameSend;
 
 	// We do want a new frame...
@@ -949,7 +955,7 @@ bool MFGrabber::process_image(const void* frameImageBuffer, int size)
 				}
 			}
 
-			for (unsigned int i = 0; _MFWorkerManager.isActive() && i < _MFWorkerManager.workersCount && _MFWorkerManager.workers != nullptr; i++)
+			for (unsigned int i = 0; _MFWorkerManager.isActive() && i < getCaptureWorkers(_MFWorkerManager.workersCount) && _MFWorkerManager.workers != nullptr; i++)
 			{
 				if (_MFWorkerManager.workers[i]->isFinished() || !_MFWorkerManager.workers[i]->isRunning())
 				{
@@ -991,6 +997,7 @@ void MFGrabber::newWorkerFrameError(unsigned int workerIndex, QString error, qui
 {
 
 	frameStat.badFrame++;
+	_metricBadFrames->add();
 	//Debug(_log, "Error occured while decoding mjpeg frame %d = %s", sourceCount, QSTRING_CSTR(error));	
 
 	// get next frame	
@@ -1007,6 +1014,8 @@ void MFGrabber::newWorkerFrame(unsigned int workerIndex, Image<ColorRgb> image,
 {
 	frameStat.goodFrame++;
 	frameStat.averageFrame += QDateTime::currentMSecsSinceEpoch() - _frameBegin;
+	_metricFrames->add();
+	_metricFrameTime->observe((uint64_t)(QDateTime::currentMSecsSinceEpoch() - _frameBegin) * 1000);
 
 	if (_signalAutoDetectionEnabled || isCalibrating())
 	{
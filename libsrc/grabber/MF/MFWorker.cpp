@@ -22,6 +22,7 @@
 #include <QFileInfo>
 
 #include <grabber/MFWorker.h>
+#include <utils/ThreadTopology.h>
 
 
 
@@ -137,7 +138,7 @@ void MFWorker::setup(unsigned int __workerIndex, PixelFormat __pixelFormat,
 			uint8_t * __sharedData, int __size,int __width, int __height, int __lineLength,
 			uint __cropLeft,  uint  __cropTop, uint __cropBottom, uint __cropRight,
 			quint64 __currentFrame, qint64 __frameBegin,
-			int __hdrToneMappingEnabled, uint8_t* __lutBuffer, bool __qframe)
+			int __hdrToneMappingEnabled, const uint8_t* __lutBuffer, bool __qframe)
 {
 	_workerIndex = __workerIndex;  
 	_lineLength   = __lineLength;
@@ -173,6 +174,8 @@ void MFWorker::setup(unsigned int __workerIndex, PixelFormat __pixelFormat,
 
 void MFWorker::run()
 {
+	ThreadTopology::registerCurrentThread(ThreadTopology::Role::CAPTURE_WORKER, QString("MFWorker%1").arg(_workerIndex));
+
 	runMe();	
 }
 
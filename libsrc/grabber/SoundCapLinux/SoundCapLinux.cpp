@@ -1,16 +1,36 @@
 #include <grabber/SoundCapLinux.h>
+#include <utils/ThreadTopology.h>
 #include <cmath>
 #include <QString>
 #include <stdexcept>
 #include <iostream>
 #include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
 
-int16_t    SoundCapLinux::_soundBuffer[(1<<SOUNDCAPLINUX_BUF_LENP)*2];
+namespace
+{
+	const unsigned int SAMPLE_RATE = 22050;
+	const snd_pcm_sframes_t ANALYSIS_CHUNK = (1 << SOUNDCAPLINUX_BUF_LENP);
+	const int64_t PACING_TOLERANCE_MS = 200;
+}
 
 SoundCapLinux::SoundCapLinux(const QJsonDocument& effectConfig, QObject* parent)
                                         : SoundCapture(effectConfig, parent),
                                         _handle(NULL),
-										_pcmCallback(NULL)
+										_mmapAccess(false),
+										_framesPerPeriod(0),
+										_wakeFd(-1),
+										_captureRunning(false),
+										_ringHead(0),
+										_ringTail(0),
+										_metricXruns(Metrics::counter("hyperhdr_sound_xruns_total", "Sound capture overruns")),
+										_metricDropped(Metrics::counter("hyperhdr_sound_dropped_samples_total", "Captured samples dropped because the analysis could not keep up")),
+										_metricAnalysis(Metrics::histogram("hyperhdr_sound_analysis_seconds", "Spectrum analysis time per 1024 samples"))
 {		
         ListDevices();
 }
@@ -52,75 +72,58 @@ SoundCapLinux::~SoundCapLinux()
         Stop();
 }
 
-void SoundCapLinux::RecordCallback(snd_async_handler_t *audioHandler)
-{
-	try
-	{		
-		if (_isRunning && audioHandler != NULL)
-		{
-			snd_pcm_sframes_t periodSize = (1 << SOUNDCAPLINUX_BUF_LENP);
-			snd_pcm_t* shandle = snd_async_handler_get_pcm(audioHandler);
-			if (shandle != NULL)
-			{
-				snd_pcm_sframes_t incoming = snd_pcm_avail_update(shandle);
-
-				if (incoming >= periodSize) {
-					int total = snd_pcm_readi(shandle, _soundBuffer, periodSize);
-					if (total == periodSize) {
-						if (AnaliseSpectrum(_soundBuffer, SOUNDCAPLINUX_BUF_LENP))
-							_resultIndex++;
-					}
-				}
-			}
-		}
-	}
-	catch(...)
-	{
-	}
-}
-
 void SoundCapLinux::Start()
 {
 	if (_isActive && !_isRunning)
 	{
-		int				status;		
-		bool    		error = false;		
-		unsigned int 	exactRate = 22050;		
-				
-		snd_pcm_uframes_t periodSize = (1 << SOUNDCAPLINUX_BUF_LENP) * 2;
-		snd_pcm_uframes_t bufferSize = periodSize * 2;
+		int				status;
+		bool    		error = false;
+		unsigned int 	exactRate = SAMPLE_RATE;
+
+		snd_pcm_uframes_t periodSize = std::min(std::max(_periodSize, 256), 4096);
+		snd_pcm_uframes_t bufferSize = periodSize * std::min(std::max(_bufferPeriods, 2), 16);
 		snd_pcm_hw_params_t *hw_params;
+		snd_pcm_sw_params_t *sw_params;
 
 		QStringList deviceList = _selectedDevice.split('|');
-		
+
 		if (deviceList.size() == 0)
 		{
 			Error(Logger::getInstance("HYPERHDR"), "Invalid device name: %s", QSTRING_CSTR(_selectedDevice));
 		}
-		
+
 		QString device = deviceList.at(0).trimmed();
 		Info(Logger::getInstance("HYPERHDR"), "Opening device: %s", QSTRING_CSTR(device));
-		
-		
-		if ((status = snd_pcm_open (&_handle, QSTRING_CSTR(device), SND_PCM_STREAM_CAPTURE, 0)) < 0) {
+
+
+		if ((status = snd_pcm_open (&_handle, QSTRING_CSTR(device), SND_PCM_STREAM_CAPTURE, SND_PCM_NONBLOCK)) < 0) {
 			Error(Logger::getInstance("HYPERHDR"), "Cannot open input sound device '%s'. Error: '%s'",  QSTRING_CSTR(device), snd_strerror (status));
 			return;
 		}
-		
+
 		if ((status = snd_pcm_hw_params_malloc (&hw_params)) < 0) {
 				Error(Logger::getInstance("HYPERHDR"), "Cannot allocate hardware parameter buffer: '%s'", snd_strerror (status));
 				snd_pcm_close(_handle);
 				return;
 		}
-		
+
+		if ((status = snd_pcm_sw_params_malloc (&sw_params)) < 0) {
+				Error(Logger::getInstance("HYPERHDR"), "Cannot allocate software parameter buffer: '%s'", snd_strerror (status));
+				snd_pcm_hw_params_free (hw_params);
+				snd_pcm_close(_handle);
+				return;
+		}
+
 		try
-		{			
+		{
 			if ((status = snd_pcm_hw_params_any (_handle, hw_params)) < 0) {
 				Error(Logger::getInstance("HYPERHDR"), "Cannot set snd_pcm_hw_params_any: '%s'", snd_strerror (status));
 				throw 1;
 			}
 
-			if ((status = snd_pcm_hw_params_set_access (_handle, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0) {
+			_mmapAccess = (snd_pcm_hw_params_set_access (_handle, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED) >= 0);
+
+			if (!_mmapAccess && (status = snd_pcm_hw_params_set_access (_handle, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0) {
 				Error(Logger::getInstance("HYPERHDR"), "Cannot set snd_pcm_hw_params_set_access: '%s'", snd_strerror (status));
 				throw 2;
 			}
@@ -134,12 +137,12 @@ void SoundCapLinux::Start()
 				Error(Logger::getInstance("HYPERHDR"), "Cannot set snd_pcm_hw_params_set_rate_near: '%s'", snd_strerror (status));
 				throw 4;
 			}
-			else if (exactRate != 22050)
+			else if (exactRate != SAMPLE_RATE)
 			{
 				Error(Logger::getInstance("HYPERHDR"), "Cannot set rate to 22050");
 				throw 5;
 			}
-			
+
 			if ((status = snd_pcm_hw_params_set_channels (_handle, hw_params, 1)) < 0) {
 				Error(Logger::getInstance("HYPERHDR"), "Cannot set snd_pcm_hw_params_set_channels: '%s'",snd_strerror (status));
 				throw 6;
@@ -150,62 +153,89 @@ void SoundCapLinux::Start()
 				Error(Logger::getInstance("HYPERHDR"), "Cannot set snd_pcm_hw_params_set_period_size_near: '%s'", snd_strerror(status) );
 				throw 7;
 			}
-			else 			
+			else
         		Info(Logger::getInstance("HYPERHDR"), "Sound period size = %lu", (unsigned long)periodSize);
-			
+
 			if( (status = snd_pcm_hw_params_set_buffer_size_near(_handle, hw_params, &bufferSize)) < 0 )
 			{
 				Error(Logger::getInstance("HYPERHDR"), "Cannot set snd_pcm_hw_params_set_buffer_size_near: '%s'", snd_strerror(status) );
 				throw 8;
 			}
-			else 			
-        		Info(Logger::getInstance("HYPERHDR"), "Sound buffer size = %lu", (unsigned long)bufferSize);
-			
+			else
+        		Info(Logger::getInstance("HYPERHDR"), "Sound buffer size = %lu, access: %s", (unsigned long)bufferSize, (_mmapAccess) ? "mmap" : "read");
+
 
 			if ((status = snd_pcm_hw_params (_handle, hw_params)) < 0) {
 				Error(Logger::getInstance("HYPERHDR"),  "Cannot set snd_pcm_hw_params: '%s'", snd_strerror (status));
 				throw 9;
 			}
-			
+
+			// wake up the capture thread once per period
+			if ((status = snd_pcm_sw_params_current (_handle, sw_params)) < 0 ||
+				(status = snd_pcm_sw_params_set_avail_min (_handle, sw_params, periodSize)) < 0 ||
+				(status = snd_pcm_sw_params (_handle, sw_params)) < 0) {
+				Error(Logger::getInstance("HYPERHDR"),  "Cannot set snd_pcm_sw_params: '%s'", snd_strerror (status));
+				throw 10;
+			}
+
 			if ((status = snd_pcm_prepare (_handle)) < 0) {
 				Error(Logger::getInstance("HYPERHDR"),  "Cannot prepare device for use: '%s'", snd_strerror (status));
-				throw 10;			
-			}			
-
-			if ((status = snd_async_add_pcm_handler(&_pcmCallback, _handle, RecordCallback, NULL)) < 0) {			
-				Error(Logger::getInstance("HYPERHDR"),  "Registering record callback error, probably you chose wrong or virtual audio capture device: '%s'", snd_strerror(status));
 				throw 11;
 			}
 
+			if ((_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+				Error(Logger::getInstance("HYPERHDR"),  "Cannot create the wake up descriptor: '%s'", strerror(errno));
+				throw 12;
+			}
+
 			if (snd_pcm_state(_handle) == SND_PCM_STATE_PREPARED) {
         		if ((status = snd_pcm_start(_handle)) < 0) {
 	        		Error(Logger::getInstance("HYPERHDR"),  "Start failed: '%s'", snd_strerror(status));
-					snd_async_del_handler(_pcmCallback);
-					_pcmCallback = NULL;
-					throw 12;
+					throw 13;
         		}
 			}
 			else{
 				Error(Logger::getInstance("HYPERHDR"),  "Preparing device failed: '%s'", snd_strerror(status));
-				snd_async_del_handler(_pcmCallback);
-				_pcmCallback = NULL;
-				throw 13;
+				throw 14;
 			}
- 
+
 		}
 		catch(...)
 		{
 			error = true;
 		}
 
-		snd_pcm_hw_params_free (hw_params);		
-		
+		snd_pcm_hw_params_free (hw_params);
+		snd_pcm_sw_params_free (sw_params);
+
 		if (!error)
 		{
+			_framesPerPeriod = periodSize;
+
+			// room for the whole device buffer twice, rounded to a power of two
+			size_t ringSize = 1;
+			while (ringSize < std::max<size_t>(bufferSize * 2, SOUNDCAP_N_WAVE * 4))
+				ringSize <<= 1;
+
+			_ring.assign(ringSize, 0);
+			_ringHead = 0;
+			_ringTail = 0;
+			_readBuffer.resize(periodSize);
+
 			_isRunning = true;
+			_captureRunning = true;
+
+			_analysisThread = std::thread(&SoundCapLinux::analysisLoop, this);
+			_captureThread = std::thread(&SoundCapLinux::captureLoop, this);
 		}
 		else
 		{
+			if (_wakeFd >= 0)
+			{
+				close(_wakeFd);
+				_wakeFd = -1;
+			}
+
 			snd_pcm_close(_handle);
 			_handle = NULL;
 		}
@@ -219,20 +249,273 @@ void SoundCapLinux::Stop()
 
 	Info(Logger::getInstance("HYPERHDR"),  "Disconnecting from sound driver: '%s'", QSTRING_CSTR(_selectedDevice));
 
-		
+
 	_isRunning = false;
+	_captureRunning = false;
 
-	snd_pcm_drop(_handle);
+	uint64_t wake = 1;
+	if (write(_wakeFd, &wake, sizeof(wake)) < 0)
+		Warning(Logger::getInstance("HYPERHDR"), "Cannot wake up the sound capture thread: '%s'", strerror(errno));
+
+	if (_captureThread.joinable())
+		_captureThread.join();
 
-	if (_pcmCallback != NULL)
 	{
-		snd_async_del_handler(_pcmCallback);
-		_pcmCallback = NULL;
+		std::lock_guard<std::mutex> lock(_analysisMutex);
 	}
+	_analysisWake.notify_all();
+
+	if (_analysisThread.joinable())
+		_analysisThread.join();
+
+	close(_wakeFd);
+	_wakeFd = -1;
+
+	snd_pcm_drop(_handle);
 
 	if (_handle != NULL)
 	{
 		snd_pcm_close(_handle);
 		_handle = NULL;
-	}	
+	}
+}
+
+void SoundCapLinux::captureLoop()
+{
+	ThreadTopology::registerCurrentThread(ThreadTopology::Role::CAPTURE_WORKER, "SoundCapture");
+
+	const int count = std::max(snd_pcm_poll_descriptors_count(_handle), 0);
+	std::vector<struct pollfd> fds(count + 1);
+
+	snd_pcm_poll_descriptors(_handle, fds.data(), count);
+	fds[count].fd = _wakeFd;
+	fds[count].events = POLLIN;
+	fds[count].revents = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+	uint64_t captured = 0;
+	bool failed = false;
+
+	while (_captureRunning)
+	{
+		int ready = poll(fds.data(), fds.size(), 1000);
+
+		if (ready < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			Error(Logger::getInstance("HYPERHDR"), "Sound capture poll failed: '%s'", strerror(errno));
+			failed = true;
+			break;
+		}
+
+		// woken up by Stop()
+		if (fds[count].revents & POLLIN)
+			break;
+
+		if (ready == 0)
+			continue;
+
+		unsigned short revents = 0;
+		snd_pcm_poll_descriptors_revents(_handle, fds.data(), count, &revents);
+
+		if (revents & POLLERR)
+		{
+			if (!recover(-EPIPE))
+			{
+				failed = true;
+				break;
+			}
+			continue;
+		}
+
+		if (!(revents & POLLIN))
+			continue;
+
+		snd_pcm_sframes_t avail = snd_pcm_avail_update(_handle);
+
+		if (avail < 0)
+		{
+			if (!recover(avail))
+			{
+				failed = true;
+				break;
+			}
+			continue;
+		}
+
+		bool received = false;
+		while (_captureRunning && avail >= (snd_pcm_sframes_t)_framesPerPeriod)
+		{
+			if (!readPeriod(_framesPerPeriod))
+				break;
+
+			avail -= _framesPerPeriod;
+			captured += _framesPerPeriod;
+			received = true;
+		}
+
+		if (received)
+		{
+			{
+				std::lock_guard<std::mutex> lock(_analysisMutex);
+			}
+			_analysisWake.notify_one();
+		}
+
+		// devices without a clock ('null', 'file') deliver the samples as fast as they are read:
+		// only the excess over the tolerance is slept, so the drift of a real sound card is harmless
+		const auto due = start + std::chrono::microseconds(captured * 1000000 / SAMPLE_RATE);
+		const auto ahead = std::chrono::duration_cast<std::chrono::milliseconds>(due - std::chrono::steady_clock::now()).count();
+
+		if (ahead > PACING_TOLERANCE_MS)
+			poll(&fds[count], 1, (int)(ahead - PACING_TOLERANCE_MS));
+	}
+
+	if (failed)
+	{
+		// release the analysis thread now, the rest of the teardown belongs to the owner thread
+		_captureRunning = false;
+		{
+			std::lock_guard<std::mutex> lock(_analysisMutex);
+		}
+		_analysisWake.notify_all();
+
+		Error(Logger::getInstance("HYPERHDR"), "Sound capture stopped after a device error: '%s'", QSTRING_CSTR(_selectedDevice));
+
+		// Stop() clears _isRunning, so a later Start() can open the device again.
+		// A session started in the meantime has _captureRunning set and is left alone.
+		QMetaObject::invokeMethod(this, [this]() {
+			if (_isRunning && !_captureRunning)
+				Stop();
+		}, Qt::QueuedConnection);
+	}
+}
+
+bool SoundCapLinux::readPeriod(snd_pcm_uframes_t frames)
+{
+	if (!_mmapAccess)
+	{
+		snd_pcm_sframes_t total = snd_pcm_readi(_handle, _readBuffer.data(), frames);
+
+		if (total < 0)
+		{
+			recover(total);
+			return false;
+		}
+
+		pushSamples(_readBuffer.data(), total);
+		return true;
+	}
+
+	while (frames > 0)
+	{
+		const snd_pcm_channel_area_t* areas;
+		snd_pcm_uframes_t offset;
+		snd_pcm_uframes_t chunk = frames;
+
+		int status = snd_pcm_mmap_begin(_handle, &areas, &offset, &chunk);
+		if (status < 0)
+		{
+			recover(status);
+			return false;
+		}
+
+		// mono S16: the samples of the chunk are contiguous in the device buffer
+		const int16_t* samples = reinterpret_cast<const int16_t*>(static_cast<const uint8_t*>(areas[0].addr) + (areas[0].first + offset * areas[0].step) / 8);
+		pushSamples(samples, chunk);
+
+		snd_pcm_sframes_t committed = snd_pcm_mmap_commit(_handle, offset, chunk);
+		if (committed < 0 || (snd_pcm_uframes_t)committed != chunk)
+		{
+			recover((committed < 0) ? (int)committed : -EPIPE);
+			return false;
+		}
+
+		frames -= chunk;
+	}
+
+	return true;
+}
+
+bool SoundCapLinux::recover(int error)
+{
+	if (error == -EPIPE || error == -ESTRPIPE)
+		_metricXruns->add();
+
+	int status = snd_pcm_recover(_handle, error, 1);
+
+	if (status >= 0 && snd_pcm_state(_handle) == SND_PCM_STATE_PREPARED)
+		status = snd_pcm_start(_handle);
+
+	if (status < 0)
+	{
+		Error(Logger::getInstance("HYPERHDR"), "Sound capture failed: '%s'", snd_strerror(status));
+		return false;
+	}
+
+	return true;
+}
+
+void SoundCapLinux::pushSamples(const int16_t* samples, size_t count)
+{
+	const size_t size = _ring.size();
+	const size_t head = _ringHead.load(std::memory_order_relaxed);
+	const size_t space = size - (head - _ringTail.load(std::memory_order_acquire));
+
+	if (count > space)
+	{
+		_metricDropped->add(count - space);
+		count = space;
+	}
+
+	const size_t position = head & (size - 1);
+	const size_t first = std::min(count, size - position);
+
+	memcpy(&_ring[position], samples, first * sizeof(int16_t));
+	memcpy(&_ring[0], samples + first, (count - first) * sizeof(int16_t));
+
+	_ringHead.store(head + count, std::memory_order_release);
+}
+
+size_t SoundCapLinux::queuedSamples() const
+{
+	return _ringHead.load(std::memory_order_acquire) - _ringTail.load(std::memory_order_relaxed);
+}
+
+void SoundCapLinux::analysisLoop()
+{
+	ThreadTopology::registerCurrentThread(ThreadTopology::Role::OTHER, "SoundAnalysis");
+
+	std::vector<int16_t> samples(ANALYSIS_CHUNK);
+	std::unique_lock<std::mutex> lock(_analysisMutex);
+
+	while (true)
+	{
+		_analysisWake.wait(lock, [this] { return !_captureRunning || queuedSamples() >= (size_t)ANALYSIS_CHUNK; });
+
+		if (!_captureRunning)
+			break;
+
+		lock.unlock();
+
+		while (queuedSamples() >= (size_t)ANALYSIS_CHUNK)
+		{
+			const size_t size = _ring.size();
+			const size_t tail = _ringTail.load(std::memory_order_relaxed);
+			const size_t position = tail & (size - 1);
+			const size_t first = std::min((size_t)ANALYSIS_CHUNK, size - position);
+
+			memcpy(samples.data(), &_ring[position], first * sizeof(int16_t));
+			memcpy(samples.data() + first, &_ring[0], (ANALYSIS_CHUNK - first) * sizeof(int16_t));
+
+			_ringTail.store(tail + ANALYSIS_CHUNK, std::memory_order_release);
+
+			Metrics::ScopedTimer timer(_metricAnalysis);
+			AnaliseSpectrum(samples.data(), SOUNDCAPLINUX_BUF_LENP);
+		}
+
+		lock.lock();
+	}
 }
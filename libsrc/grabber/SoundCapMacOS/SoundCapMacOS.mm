@@ -119,7 +119,6 @@ void SoundCapMacOS::RecordCallback(uint32_t frameBytes, uint8_t* rawAudioData)
 			
 			if (_soundBufferIndex == destSize && AnaliseSpectrum(_soundBuffer, SOUNDCAPMACOS_BUF_LENP))
 			{
-				_resultIndex++;
 				_soundBufferIndex = 0;
 				destStart = (uint8_t*)(&_soundBuffer);
 			}
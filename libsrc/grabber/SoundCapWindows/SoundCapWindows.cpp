@@ -36,8 +36,7 @@ SoundCapWindows::~SoundCapWindows()
 
 void CALLBACK SoundCapWindows::soundInProc(HWAVEIN hwi, UINT uMsg, DWORD dwInstance, DWORD dwParam1, DWORD dwParam2)
 {
-	if (AnaliseSpectrum(_soundBuffer, SOUNDCAPWINDOWS_BUF_LENP))
-		_resultIndex++;
+	AnaliseSpectrum(_soundBuffer, SOUNDCAPWINDOWS_BUF_LENP);
 
 	if (_isRunning)
 		waveInAddBuffer (_hWaveIn, & _header, sizeof (WAVEHDR));
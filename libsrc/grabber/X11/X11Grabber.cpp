@@ -17,6 +17,7 @@
 #include <QDirIterator>
 #include <QFileInfo>
 #include <QCoreApplication>
+#include <QDateTime>
 
 #include <grabber/X11Grabber.h>
 #include <grabber/smartX11.h>
@@ -30,6 +31,12 @@ void (*_uninitX11Display)(x11Handle* retVal) = nullptr;
 unsigned char* (*_getFrame)(x11Handle * retVal) = nullptr;
 void (*_releaseFrame)(x11Handle* retVal) = nullptr;
 
+namespace
+{
+	// an unchanged screen is still forwarded at this interval, otherwise the instances consider the system capture inactive
+	const qint64 STATIC_FRAME_INTERVAL_MS = 250;
+}
+
 X11Grabber::X11Grabber(const QString& device, const QString& configurationPath)
 	: Grabber("X11_SYSTEM:" + device.left(14))
 	, _configurationPath(configurationPath)
@@ -37,6 +44,9 @@ X11Grabber::X11Grabber(const QString& device, const QString& configurationPath)
 	, _library(nullptr)
 	, _actualDisplay(0)
 	, _handle(nullptr)
+	, _lastFrameTime(0)
+	, _metricCaptureTime(Metrics::histogram("hyperhdr_grabber_x11_capture_seconds", "Time spent by the X11 server and client to capture a frame", QString("grabber=\"X11_SYSTEM:%1\"").arg(device.left(14))))
+	, _metricUnchangedFrames(Metrics::counter("hyperhdr_grabber_x11_unchanged_frames_total", "X11 captures skipped because the screen did not change (XDamage)", QString("grabber=\"X11_SYSTEM:%1\"").arg(device.left(14))))
 {
 	_timer.setTimerType(Qt::PreciseTimer);
 	connect(&_timer, &QTimer::timeout, this, &X11Grabber::grabFrame);
@@ -257,7 +267,19 @@ void X11Grabber::grabFrame()
 	{
 		if (_initialized && _handle != nullptr)
 		{
-			unsigned char* data = _getFrame(_handle);
+			unsigned char* data = nullptr;
+
+			// the X server crops and scales the frame when XRender is available
+			_handle->cropLeft = _cropLeft;
+			_handle->cropTop = _cropTop;
+			_handle->cropRight = _cropRight;
+			_handle->cropBottom = _cropBottom;
+			_handle->maxWidth = _width;
+
+			{
+				Metrics::ScopedTimer metricTimer(_metricCaptureTime);
+				data = _getFrame(_handle);
+			}
 
 			if (data == nullptr)
 			{
@@ -266,10 +288,18 @@ void X11Grabber::grabFrame()
 			}
 			else
 			{
-				_actualWidth = _handle->width;
-				_actualHeight = _handle->height;
-
-				processSystemFrameBGRA(data);
+				qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+				if (_handle->changed || now - _lastFrameTime >= STATIC_FRAME_INTERVAL_MS)
+				{
+					_lastFrameTime = now;
+					_actualWidth = _handle->width;
+					_actualHeight = _handle->height;
+
+					processSystemFrameBGRA(data, 0, _handle->scaled == 0);
+				}
+				else
+					_metricUnchangedFrames->add();
 
 				_releaseFrame(_handle);
 			}
@@ -4,6 +4,51 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#ifdef SMARTX11_SHM
+	#include <sys/ipc.h>
+	#include <sys/shm.h>
+	#include <X11/extensions/XShm.h>
+#endif
+
+#ifdef SMARTX11_RENDER
+	#include <X11/extensions/Xrender.h>
+#endif
+
+#ifdef SMARTX11_DAMAGE
+	#include <X11/extensions/Xdamage.h>
+#endif
+
+// state of the optional extensions: every one of them falls back to the plain XGetImage path
+struct x11Private
+{
+	bool hasShm;
+	bool hasRender;
+	bool hasDamage;
+	bool damaged;
+
+	// geometry the capture targets were created for
+	int rootWidth, rootHeight;
+	int sourceX, sourceY, sourceWidth, sourceHeight;
+	int targetWidth, targetHeight;
+
+#ifdef SMARTX11_SHM
+	XShmSegmentInfo shmInfo;
+	XImage* shmImage;
+	bool shmAttached;
+#endif
+
+#ifdef SMARTX11_RENDER
+	Pixmap pixmap;
+	Picture sourcePicture;
+	Picture targetPicture;
+#endif
+
+#ifdef SMARTX11_DAMAGE
+	Damage damage;
+	int damageEventBase;
+#endif
+};
+
 struct x11Displays* enumerateX11Displays()
 {
 	Display* myDisplay = XOpenDisplay(nullptr);
@@ -51,8 +96,12 @@ void releaseX11Displays(struct x11Displays* buffer)
 	free(buffer);
 }
 
+// errors are reported asynchronously: the code of the last one tells whether a request failed
+static int lastX11Error = 0;
+
 static int x11errorHandler(Display* d, XErrorEvent* e)
 {
+	lastX11Error = e->error_code;
 	return 0;
 }
 
@@ -73,12 +122,271 @@ x11Handle* initX11Display(int display)
 	retVal->width = 0;
 	retVal->height = 0;
 	retVal->size = 0;
+	retVal->cropLeft = retVal->cropTop = retVal->cropRight = retVal->cropBottom = 0;
+	retVal->maxWidth = 0;
+	retVal->scaled = 0;
+	retVal->changed = 1;
 
 	oldHandler = XSetErrorHandler(x11errorHandler);
 
+	struct x11Private* priv = (struct x11Private*)calloc(1, sizeof(struct x11Private));
+	retVal->priv = (void*)priv;
+
+	if (priv != nullptr)
+	{
+		priv->damaged = true;
+
+#if defined(SMARTX11_RENDER) || defined(SMARTX11_DAMAGE)
+		int eventBase = 0, errorBase = 0;
+#endif
+
+#ifdef SMARTX11_SHM
+		priv->hasShm = XShmQueryExtension(maindisplay);
+		priv->shmInfo.shmid = -1;
+#endif
+
+#ifdef SMARTX11_RENDER
+		priv->hasRender = priv->hasShm && XRenderQueryExtension(maindisplay, &eventBase, &errorBase);
+#endif
+
+#ifdef SMARTX11_DAMAGE
+		// without a persistent shared image there is no previous frame to return for an unchanged screen
+		if (priv->hasShm && XDamageQueryExtension(maindisplay, &eventBase, &errorBase))
+		{
+			priv->damage = XDamageCreate(maindisplay, RootWindow(maindisplay, display), XDamageReportNonEmpty);
+			priv->damageEventBase = eventBase;
+			priv->hasDamage = (priv->damage != None);
+		}
+#endif
+	}
+
 	return retVal;
 }
 
+static void releaseTargets(x11Handle* retVal)
+{
+	struct x11Private* priv = (struct x11Private*)retVal->priv;
+
+	if (priv == nullptr)
+		return;
+
+#ifdef SMARTX11_SHM
+	// XRender is only used together with MIT-SHM
+	Display* display = (Display*)retVal->handle;
+#endif
+
+#ifdef SMARTX11_RENDER
+	if (priv->targetPicture != None)
+		XRenderFreePicture(display, priv->targetPicture);
+	if (priv->sourcePicture != None)
+		XRenderFreePicture(display, priv->sourcePicture);
+	if (priv->pixmap != None)
+		XFreePixmap(display, priv->pixmap);
+
+	priv->targetPicture = priv->sourcePicture = None;
+	priv->pixmap = None;
+#endif
+
+#ifdef SMARTX11_SHM
+	// the server knows the segment only after a successful XShmAttach
+	if (priv->shmAttached)
+	{
+		XShmDetach(display, &priv->shmInfo);
+		XSync(display, False);
+		priv->shmAttached = false;
+	}
+
+	if (priv->shmImage != nullptr)
+	{
+		priv->shmImage->data = nullptr;
+		XDestroyImage(priv->shmImage);
+		priv->shmImage = nullptr;
+	}
+
+	if (priv->shmInfo.shmaddr != nullptr)
+		shmdt(priv->shmInfo.shmaddr);
+
+	priv->shmInfo.shmaddr = nullptr;
+	priv->shmInfo.shmid = -1;
+#endif
+
+	priv->targetWidth = priv->targetHeight = 0;
+}
+
+#ifdef SMARTX11_SHM
+static bool createTargets(x11Handle* retVal, bool scale)
+{
+	Display* display = (Display*)retVal->handle;
+	struct x11Private* priv = (struct x11Private*)retVal->priv;
+	Visual* visual = DefaultVisual(display, retVal->index);
+	int depth = DefaultDepth(display, retVal->index);
+
+	priv->shmImage = XShmCreateImage(display, visual, depth, ZPixmap, nullptr, &priv->shmInfo, priv->targetWidth, priv->targetHeight);
+	if (priv->shmImage == nullptr)
+		return false;
+
+	priv->shmInfo.shmid = shmget(IPC_PRIVATE, priv->shmImage->bytes_per_line * priv->shmImage->height, IPC_CREAT | 0600);
+	if (priv->shmInfo.shmid < 0)
+		return false;
+
+	priv->shmInfo.shmaddr = priv->shmImage->data = (char*)shmat(priv->shmInfo.shmid, nullptr, 0);
+	priv->shmInfo.readOnly = False;
+
+	if (priv->shmInfo.shmaddr == (char*)-1)
+	{
+		priv->shmInfo.shmaddr = nullptr;
+		shmctl(priv->shmInfo.shmid, IPC_RMID, nullptr);
+		return false;
+	}
+
+	lastX11Error = 0;
+	bool attached = XShmAttach(display, &priv->shmInfo);
+	XSync(display, False);
+	attached = attached && lastX11Error == 0;
+
+	// the segment is released by the system when both sides have detached
+	shmctl(priv->shmInfo.shmid, IPC_RMID, nullptr);
+
+	if (!attached)
+		return false;
+
+	priv->shmAttached = true;
+
+#ifdef SMARTX11_RENDER
+	if (scale)
+	{
+		Window root = RootWindow(display, retVal->index);
+		XRenderPictFormat* format = XRenderFindVisualFormat(display, visual);
+		XRenderPictureAttributes attributes = {};
+
+		if (format == nullptr)
+			return false;
+
+		attributes.subwindow_mode = IncludeInferiors;
+		priv->sourcePicture = XRenderCreatePicture(display, root, format, CPSubwindowMode, &attributes);
+		priv->pixmap = XCreatePixmap(display, root, priv->targetWidth, priv->targetHeight, depth);
+		priv->targetPicture = XRenderCreatePicture(display, priv->pixmap, format, 0, nullptr);
+
+		// maps a target pixel to the cropped source area: the server does the crop and the bilinear scaling
+		XTransform transform = { {
+			{ XDoubleToFixed((double)priv->sourceWidth / priv->targetWidth), XDoubleToFixed(0), XDoubleToFixed(priv->sourceX) },
+			{ XDoubleToFixed(0), XDoubleToFixed((double)priv->sourceHeight / priv->targetHeight), XDoubleToFixed(priv->sourceY) },
+			{ XDoubleToFixed(0), XDoubleToFixed(0), XDoubleToFixed(1) }
+		} };
+
+		XRenderSetPictureTransform(display, priv->sourcePicture, &transform);
+		XRenderSetPictureFilter(display, priv->sourcePicture, FilterBilinear, nullptr, 0);
+	}
+#endif
+
+	return true;
+}
+
+static unsigned char* getSharedFrame(x11Handle* retVal, int rootWidth, int rootHeight)
+{
+	Display* display = (Display*)retVal->handle;
+	struct x11Private* priv = (struct x11Private*)retVal->priv;
+
+	int sourceX = retVal->cropLeft;
+	int sourceY = retVal->cropTop;
+	int sourceWidth = rootWidth - retVal->cropLeft - retVal->cropRight;
+	int sourceHeight = rootHeight - retVal->cropTop - retVal->cropBottom;
+
+	if (sourceWidth <= 16 || sourceHeight <= 16)
+	{
+		sourceX = sourceY = 0;
+		sourceWidth = rootWidth;
+		sourceHeight = rootHeight;
+	}
+
+	bool scale = priv->hasRender && retVal->maxWidth > 0 && sourceWidth > retVal->maxWidth;
+	int targetWidth = (scale) ? retVal->maxWidth : rootWidth;
+	int targetHeight = (scale) ? ((sourceHeight * targetWidth) / sourceWidth) : rootHeight;
+
+	if (targetHeight < 1)
+		targetHeight = 1;
+
+	if (!scale)
+		sourceX = sourceY = 0;
+
+	if (priv->shmImage == nullptr || priv->rootWidth != rootWidth || priv->rootHeight != rootHeight ||
+		priv->sourceX != sourceX || priv->sourceY != sourceY || priv->sourceWidth != sourceWidth || priv->sourceHeight != sourceHeight ||
+		priv->targetWidth != targetWidth || priv->targetHeight != targetHeight)
+	{
+		releaseTargets(retVal);
+
+		priv->rootWidth = rootWidth;
+		priv->rootHeight = rootHeight;
+		priv->sourceX = sourceX;
+		priv->sourceY = sourceY;
+		priv->sourceWidth = sourceWidth;
+		priv->sourceHeight = sourceHeight;
+		priv->targetWidth = targetWidth;
+		priv->targetHeight = targetHeight;
+		priv->damaged = true;
+
+		if (!createTargets(retVal, scale))
+		{
+			releaseTargets(retVal);
+			return nullptr;
+		}
+	}
+
+#ifdef SMARTX11_DAMAGE
+	if (priv->hasDamage)
+	{
+		bool damaged = priv->damaged;
+
+		while (XPending(display))
+		{
+			XEvent event;
+			XNextEvent(display, &event);
+
+			if (event.type == priv->damageEventBase + XDamageNotify)
+				damaged = true;
+		}
+
+		priv->damaged = false;
+
+		if (!damaged)
+		{
+			// the shared image still holds the previous frame
+			retVal->changed = 0;
+			return (unsigned char*)priv->shmImage->data;
+		}
+
+		XDamageSubtract(display, priv->damage, None, None);
+	}
+#endif
+
+	bool captured;
+
+#ifdef SMARTX11_RENDER
+	if (scale)
+	{
+		XRenderComposite(display, PictOpSrc, priv->sourcePicture, None, priv->targetPicture, 0, 0, 0, 0, 0, 0, targetWidth, targetHeight);
+		captured = XShmGetImage(display, priv->pixmap, priv->shmImage, 0, 0, AllPlanes);
+	}
+	else
+#endif
+		captured = XShmGetImage(display, RootWindow(display, retVal->index), priv->shmImage, 0, 0, AllPlanes);
+
+	if (!captured)
+	{
+		releaseTargets(retVal);
+		return nullptr;
+	}
+
+	retVal->changed = 1;
+	retVal->scaled = (scale) ? 1 : 0;
+	retVal->width = priv->shmImage->width;
+	retVal->height = priv->shmImage->height;
+	retVal->size = priv->shmImage->bytes_per_line * priv->shmImage->height;
+
+	return (unsigned char*)priv->shmImage->data;
+}
+#endif
+
 void releaseFrame(x11Handle* retVal)
 {
 	if (retVal == nullptr)
@@ -90,25 +398,50 @@ void releaseFrame(x11Handle* retVal)
 	retVal->image = nullptr;
 }
 
-void uninitX11Display(x11Handle* retVal)
+static void restoreErrorHandler()
 {
 	if (oldHandler != nullptr)
 	{
 		XSetErrorHandler(oldHandler);
 		oldHandler = nullptr;
 	}
+}
 
+void uninitX11Display(x11Handle* retVal)
+{
 	if (retVal == nullptr)
+	{
+		restoreErrorHandler();
 		return;
+	}
 
 	releaseFrame(retVal);
 
+	if (retVal->priv != nullptr)
+	{
+		releaseTargets(retVal);
+
+#ifdef SMARTX11_DAMAGE
+		struct x11Private* priv = (struct x11Private*)retVal->priv;
+
+		if (priv->hasDamage)
+			XDamageDestroy((Display*)retVal->handle, priv->damage);
+#endif
+
+		free(retVal->priv);
+		retVal->priv = nullptr;
+	}
+
 	if (retVal->handle != nullptr)
 		XCloseDisplay((Display*)retVal->handle);
 
 	retVal->handle = nullptr;
 
-	free(retVal);	
+	free(retVal);
+
+	// only now: XShmDetach, XDamageDestroy and the close still report their errors through our handler,
+	// the default one terminates the process
+	restoreErrorHandler();
 }
 
 unsigned char* getFrame(x11Handle* retVal)
@@ -123,6 +456,28 @@ unsigned char* getFrame(x11Handle* retVal)
 
 	XGetWindowAttributes((Display*)retVal->handle, window, &attr);
 
+#ifdef SMARTX11_SHM
+	struct x11Private* priv = (struct x11Private*)retVal->priv;
+
+	if (priv != nullptr && priv->hasShm)
+	{
+		unsigned char* data = getSharedFrame(retVal, attr.width, attr.height);
+
+		if (data != nullptr)
+			return data;
+
+		// e.g. a remote display that cannot attach to the local segment
+#ifdef SMARTX11_DAMAGE
+		if (priv->hasDamage)
+			XDamageDestroy((Display*)retVal->handle, priv->damage);
+#endif
+		priv->hasShm = priv->hasRender = priv->hasDamage = false;
+	}
+#endif
+
+	retVal->changed = 1;
+	retVal->scaled = 0;
+
 	XImage *img = XGetImage((Display*)retVal->handle, window, 0, 0, attr.width, attr.height, AllPlanes, ZPixmap);
 	retVal->image = (void*)img;
 
@@ -0,0 +1,643 @@
+#include <algorithm>
+#include <cstring>
+
+#include <QDateTime>
+#include <QFileInfo>
+
+#include <grabber/ReplayGrabber.h>
+#include <utils/ColorSys.h>
+
+namespace
+{
+	const int	PATTERN_FPS = 60;
+	const int	JPEG_QUALITY = 85;
+
+	// the 75% color bars
+	const ColorRgb BARS[] = {
+		{ 191, 191, 191 }, { 191, 191, 0 }, { 0, 191, 191 }, { 0, 191, 0 },
+		{ 191, 0, 191 }, { 191, 0, 0 }, { 0, 0, 191 }, { 16, 16, 16 }
+	};
+
+	const uint32_t	MAX_RECORDED_SIZE = 16384;
+
+	///
+	/// The decoders trust the frame geometry: a corrupt or truncated record would make them read past the mapped file
+	///
+	bool checkVideoRecord(const CaptureFile::RecordHeader& header, QString& reason)
+	{
+		const uint32_t width = header.params[1], height = header.params[2];
+		const uint64_t lineLength = header.params[3];
+		uint64_t bytesPerPixel = 0;
+
+		switch ((PixelFormat)header.params[0])
+		{
+			case PixelFormat::YUYV: bytesPerPixel = 2; break;
+			case PixelFormat::RGB24: bytesPerPixel = 3; break;
+			case PixelFormat::XRGB: bytesPerPixel = 4; break;
+			case PixelFormat::NV12:
+			case PixelFormat::I420: bytesPerPixel = 1; break;
+			case PixelFormat::MJPEG: break;
+			default:
+				reason = QString("unsupported pixel format %1").arg(header.params[0]);
+				return false;
+		}
+
+		if (width == 0 || height == 0 || width > MAX_RECORDED_SIZE || height > MAX_RECORDED_SIZE)
+		{
+			reason = QString("invalid size %1x%2").arg(width).arg(height);
+			return false;
+		}
+
+		if ((PixelFormat)header.params[0] == PixelFormat::MJPEG)
+		{
+			if (header.size == 0)
+			{
+				reason = "empty payload";
+				return false;
+			}
+			return true;
+		}
+
+		if (lineLength < width * bytesPerPixel)
+		{
+			reason = QString("line length %1 is too short for the width %2").arg(lineLength).arg(width);
+			return false;
+		}
+
+		// NV12 and I420: the chroma planes follow the luma plane, together half of its size
+		uint64_t required = lineLength * height;
+		if (header.params[0] == (uint32_t)PixelFormat::NV12 || header.params[0] == (uint32_t)PixelFormat::I420)
+			required += lineLength * ((height + 1) / 2);
+
+		if (header.size < required)
+		{
+			reason = QString("payload of %1 bytes, %2 expected").arg(header.size).arg(required);
+			return false;
+		}
+
+		return true;
+	}
+}
+
+ReplayGrabber::ReplayGrabber(const QString& source, PixelFormat format, int width, int height, int fps, const QString& configurationPath)
+	: Grabber("REPLAY:" + QFileInfo(source).fileName().left(14))
+	, _source(source)
+	, _pattern(Pattern::BARS)
+	, _format(format)
+	, _replayWidth(std::max(width, 2) & ~1)
+	, _replayHeight(std::max(height, 2) & ~1)
+	, _replayFps(fps)
+	, _configurationPath(configurationPath)
+	, _workerBuffer{}
+	, _compress(nullptr)
+	, _recordIndex(-1)
+{
+	const QString name = source.toLower();
+
+	if (name == "bars")
+		_pattern = Pattern::BARS;
+	else if (name == "noise")
+		_pattern = Pattern::NOISE;
+	else if (name == "letterbox")
+		_pattern = Pattern::LETTERBOX;
+	else if (name == "hdr")
+		_pattern = Pattern::HDR_RAMP;
+	else
+		_pattern = Pattern::RECORDING;
+
+	if (_format != PixelFormat::YUYV && _format != PixelFormat::NV12 && _format != PixelFormat::I420 &&
+		_format != PixelFormat::MJPEG && _format != PixelFormat::XRGB && _format != PixelFormat::RGB24)
+	{
+		Warning(_log, "Unsupported replay format '%s', using YUYV", QSTRING_CSTR(pixelFormatToString(_format)));
+		_format = PixelFormat::YUYV;
+	}
+
+	_timer.setTimerType(Qt::PreciseTimer);
+	connect(&_timer, &QTimer::timeout, this, &ReplayGrabber::grabFrame);
+
+	DeviceProperties properties;
+	DevicePropertiesItem dpi;
+	dpi.x = _replayWidth;
+	dpi.y = _replayHeight;
+	dpi.fps = (_replayFps > 0) ? _replayFps : PATTERN_FPS;
+	dpi.pf = _format;
+	properties.name = "Replay: " + source;
+	properties.valid.append(dpi);
+	_deviceProperties.insert(properties.name, properties);
+}
+
+ReplayGrabber::~ReplayGrabber()
+{
+	uninit();
+
+	if (_compress != nullptr)
+		tjDestroy(_compress);
+}
+
+void ReplayGrabber::setHdrToneMappingEnabled(int mode)
+{
+	if (_hdrToneMappingEnabled != mode || _lutBuffer == nullptr)
+	{
+		_hdrToneMappingEnabled = mode;
+		Debug(_log, "setHdrToneMappingMode to: %s", (mode == 0) ? "Disabled" : ((mode == 1) ? "Fullscreen" : "Border mode"));
+
+		if (_workerManager.isActive())
+		{
+			_workerManager.Stop();
+			if (_actualVideoFormat == PixelFormat::YUYV || _actualVideoFormat == PixelFormat::I420 || _actualVideoFormat == PixelFormat::NV12)
+				loadLutFile(PixelFormat::YUYV, _configurationPath);
+			else
+				loadLutFile(PixelFormat::RGB24, _configurationPath);
+			_workerManager.Start();
+		}
+	}
+}
+
+bool ReplayGrabber::init()
+{
+	if (!_initialized)
+	{
+		if (_pattern == Pattern::RECORDING)
+		{
+			if (!_recording.open(_source))
+			{
+				Error(_log, "Could not open the capture file '%s': %s", QSTRING_CSTR(_source), QSTRING_CSTR(_recording.error()));
+				return false;
+			}
+
+			_recordIndex = -1;
+			_videoRecords.clear();
+
+			for (int i = 0; i < _recording.count(); i++)
+			{
+				const CaptureFile::RecordHeader& header = _recording.header(i);
+				QString reason;
+
+				if (header.type != (uint32_t)CaptureFile::RecordType::VIDEO_FRAME)
+					continue;
+
+				if (checkVideoRecord(header, reason))
+					_videoRecords.push_back(i);
+				else
+					Warning(_log, "Skipping the corrupted video record %d: %s", i, QSTRING_CSTR(reason));
+			}
+
+			if (!nextRecordedFrame())
+			{
+				Error(_log, "The capture file '%s' does not contain any video frame", QSTRING_CSTR(_source));
+				_recording.close();
+				return false;
+			}
+		}
+		else
+		{
+			_actualVideoFormat = _format;
+			_actualWidth = _replayWidth;
+			_actualHeight = _replayHeight;
+		}
+
+		_actualFPS = (_replayFps > 0) ? _replayFps : PATTERN_FPS;
+		_actualDeviceName = _deviceProperties.firstKey();
+
+		if (_actualVideoFormat == PixelFormat::YUYV || _actualVideoFormat == PixelFormat::I420 || _actualVideoFormat == PixelFormat::NV12)
+			loadLutFile(PixelFormat::YUYV, _configurationPath);
+		else
+			loadLutFile(PixelFormat::RGB24, _configurationPath);
+
+		Info(_log, "*************************************************************************************************");
+		Info(_log, "Starting replay grabber. Source: '%s', %s %dx%d, %s", QSTRING_CSTR(_source),
+			QSTRING_CSTR(pixelFormatToString(_actualVideoFormat).toUpper()), _actualWidth, _actualHeight,
+			(_replayFps > 0) ? QSTRING_CSTR(QString("%1 fps").arg(_replayFps)) : ((_replayFps == 0) ? "as fast as possible" : "source rate"));
+		Info(_log, "*************************************************************************************************");
+
+		_initialized = true;
+	}
+
+	return _initialized;
+}
+
+void ReplayGrabber::uninit()
+{
+	if (_initialized)
+	{
+		Debug(_log, "Uninit grabber: %s", QSTRING_CSTR(_source));
+		stop();
+	}
+}
+
+bool ReplayGrabber::start()
+{
+	try
+	{
+		if (init())
+		{
+			_workerManager.Start();
+			resetCounter(QDateTime::currentMSecsSinceEpoch());
+
+			if (_replayFps < 0 && _pattern == Pattern::RECORDING)
+			{
+				_timer.setSingleShot(true);
+				_timer.start(0);
+			}
+			else
+			{
+				_timer.setSingleShot(false);
+				_timer.start((_replayFps > 0) ? 1000 / _replayFps : ((_replayFps == 0) ? 0 : 1000 / PATTERN_FPS));
+			}
+
+			Info(_log, "Started");
+			return true;
+		}
+	}
+	catch (std::exception& e)
+	{
+		Error(_log, "start failed (%s)", e.what());
+	}
+
+	return false;
+}
+
+void ReplayGrabber::stop()
+{
+	if (_initialized)
+	{
+		_timer.stop();
+		_workerManager.Stop();
+		_recording.close();
+		_initialized = false;
+		Info(_log, "Stopped");
+	}
+}
+
+void ReplayGrabber::grabFrame()
+{
+	if (!_initialized)
+		return;
+
+	bool sent = process_frame();
+
+	// as fast as possible: feed every idle worker. At most one frame per worker and timer tick,
+	// a single worker decodes on this thread and is idle again at once.
+	for (unsigned int i = 1; sent && _replayFps == 0 && _initialized && i < _workerManager.workersCount; i++)
+		sent = process_frame();
+
+	if (_initialized && _replayFps < 0 && _pattern == Pattern::RECORDING)
+	{
+		// keep the recorded pacing, retry soon when all the workers are busy. A new loop starts without waiting.
+		int next = findVideoRecord(_recordIndex);
+		int64_t delay = (next > _recordIndex) ? (_recording.header(next).timestamp - _recording.header(_recordIndex).timestamp) / 1000 : 0;
+
+		_timer.start((sent) ? (int)std::max(delay, (int64_t)0) : 1);
+	}
+}
+
+int ReplayGrabber::findVideoRecord(int after) const
+{
+	if (_videoRecords.empty())
+		return -1;
+
+	auto next = std::upper_bound(_videoRecords.begin(), _videoRecords.end(), after);
+
+	return (next != _videoRecords.end()) ? *next : _videoRecords.front();
+}
+
+bool ReplayGrabber::nextRecordedFrame()
+{
+	int index = findVideoRecord(_recordIndex);
+
+	if (index < 0)
+		return false;
+
+	const CaptureFile::RecordHeader& header = _recording.header(index);
+
+	_recordIndex = index;
+	_actualVideoFormat = (PixelFormat)header.params[0];
+	_actualWidth = (int)header.params[1];
+	_actualHeight = (int)header.params[2];
+	_lineLength = (int)header.params[3];
+
+	return true;
+}
+
+bool ReplayGrabber::process_frame()
+{
+	if (!_workerManager.isActive())
+		return false;
+
+	if (_workerManager.workers == nullptr)
+	{
+		_workerManager.InitWorkers();
+		Debug(_log, "Worker's thread count  = %d", _workerManager.workersCount);
+
+		_buffers.resize(_workerManager.workersCount);
+
+		for (unsigned int i = 0; i < _workerManager.workersCount && _workerManager.workers != nullptr; i++)
+		{
+			V4L2Worker* _workerThread = _workerManager.workers[i];
+			connect(_workerThread, SIGNAL(newFrameError(unsigned int, QString, quint64)), this, SLOT(newWorkerFrameError(unsigned int, QString, quint64)));
+			connect(_workerThread, SIGNAL(newFrame(unsigned int, Image<ColorRgb>, quint64, qint64)), this, SLOT(newWorkerFrame(unsigned int, Image<ColorRgb>, quint64, qint64)));
+		}
+	}
+
+	unsigned int workerIndex = 0;
+
+	for (; workerIndex < getCaptureWorkers(_workerManager.workersCount); workerIndex++)
+	{
+		V4L2Worker* worker = _workerManager.workers[workerIndex];
+
+		if ((worker->isFinished() || !worker->isRunning()) && !worker->isBusy())
+			break;
+	}
+
+	if (workerIndex >= getCaptureWorkers(_workerManager.workersCount))
+		return false;
+
+	uint64_t	processFrameIndex = _currentFrame++;
+	int			decimation = getCaptureDecimation();
+	V4L2Worker*	worker = _workerManager.workers[workerIndex];
+
+	if (_pattern == Pattern::RECORDING && processFrameIndex > 0)
+		nextRecordedFrame();
+
+	// frame skipping
+	if ((processFrameIndex % decimation != 0) && (decimation > 1))
+	{
+		worker->noBusy();
+		return true;
+	}
+
+	const uint8_t* data;
+	int size;
+
+	if (_pattern == Pattern::RECORDING)
+	{
+		data = _recording.payload(_recordIndex);
+		size = (int)_recording.header(_recordIndex).size;
+	}
+	else
+	{
+		renderPattern(_buffers[workerIndex], processFrameIndex);
+		data = (const uint8_t*)_buffers[workerIndex].constData();
+		size = _buffers[workerIndex].size();
+	}
+
+	if (size <= 0)
+	{
+		worker->noBusy();
+		newWorkerFrameError(workerIndex, "Empty frame", processFrameIndex);
+		return true;
+	}
+
+	// the decoding time is measured from here, the pattern generation stands for the capture device
+	int64_t currentTime = QDateTime::currentMSecsSinceEpoch();
+
+	if (currentTime - frameStat.frameBegin >= 1000 * 60)
+	{
+		int total = (frameStat.badFrame + frameStat.goodFrame);
+		int av = (frameStat.goodFrame > 0) ? frameStat.averageFrame / frameStat.goodFrame : 0;
+
+		Info(_log, "Replay FPS: %.2f, av. delay: %dms, good: %d, bad: %d, %s",
+			total / ((currentTime - frameStat.frameBegin) / 1000.0),
+			av,
+			frameStat.goodFrame,
+			frameStat.badFrame,
+			QSTRING_CSTR(Image<ColorRgb>::getCacheInfo()));
+
+		resetCounter(currentTime);
+	}
+
+	if ((_actualVideoFormat == PixelFormat::YUYV || _actualVideoFormat == PixelFormat::I420 ||
+		_actualVideoFormat == PixelFormat::NV12) && !_lutBufferInit)
+	{
+		loadLutFile(PixelFormat::NO_CHANGE, _configurationPath);
+	}
+
+	_workerBuffer.index = workerIndex;
+
+	worker->setup(
+		workerIndex,
+		&_workerBuffer,
+		_actualVideoFormat,
+		const_cast<uint8_t*>(data), size, _actualWidth, _actualHeight, _lineLength,
+		_cropLeft, _cropTop, _cropBottom, _cropRight,
+		processFrameIndex, currentTime, _hdrToneMappingEnabled,
+		(_lutBufferInit) ? _lutBuffer : NULL, _qframe);
+
+	if (_workerManager.workersCount > 1)
+		worker->start();
+	else
+		worker->startOnThisThread();
+
+	return true;
+}
+
+ColorRgb ReplayGrabber::patternColor(int x, int y, quint64 frameIndex, uint32_t& random) const
+{
+	switch (_pattern)
+	{
+		case Pattern::NOISE:
+		{
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+			return ColorRgb{ (uint8_t)random, (uint8_t)(random >> 8), (uint8_t)(random >> 16) };
+		}
+
+		case Pattern::LETTERBOX:
+		{
+			// 2.40:1 movie in a 16:9 frame, the picture itself is a slowly moving diagonal gradient
+			const int border = _replayHeight / 8;
+
+			if (y < border || y >= _replayHeight - border)
+				return ColorRgb{ 0, 0, 0 };
+
+			const uint8_t value = (uint8_t)((x + y + frameIndex * 2) % 256);
+			return ColorRgb{ value, (uint8_t)(255 - value), (uint8_t)((y * 255) / _replayHeight) };
+		}
+
+		case Pattern::HDR_RAMP:
+		{
+			// four horizontal ramps (white, red, green, blue), shifted a little every frame
+			const uint8_t value = (uint8_t)((((x * 256) / _replayWidth) + frameIndex) % 256);
+
+			switch ((y * 4) / _replayHeight)
+			{
+				case 0: return ColorRgb{ value, value, value };
+				case 1: return ColorRgb{ value, 0, 0 };
+				case 2: return ColorRgb{ 0, value, 0 };
+				default: return ColorRgb{ 0, 0, value };
+			}
+		}
+
+		default:
+		{
+			const int bars = sizeof(BARS) / sizeof(BARS[0]);
+			const int position = (int)((x + frameIndex * 4) % _replayWidth);
+			return BARS[(position * bars) / _replayWidth];
+		}
+	}
+}
+
+void ReplayGrabber::renderPattern(QByteArray& buffer, quint64 frameIndex)
+{
+	const int width = _replayWidth, height = _replayHeight;
+	uint32_t random = (uint32_t)(frameIndex * 2654435761u) | 1;
+
+	switch (_format)
+	{
+		case PixelFormat::YUYV:
+		{
+			_lineLength = width * 2;
+			buffer.resize(_lineLength * height);
+
+			for (int y = 0; y < height; y++)
+			{
+				uint8_t* line = (uint8_t*)buffer.data() + (size_t)y * _lineLength;
+
+				for (int x = 0; x < width; x += 2, line += 4)
+				{
+					ColorRgb a = patternColor(x, y, frameIndex, random), b = patternColor(x + 1, y, frameIndex, random);
+					uint8_t u1, v1, u2, v2;
+
+					ColorSys::rgb2yuv(a.red, a.green, a.blue, line[0], u1, v1);
+					ColorSys::rgb2yuv(b.red, b.green, b.blue, line[2], u2, v2);
+					line[1] = (uint8_t)((u1 + u2) / 2);
+					line[3] = (uint8_t)((v1 + v2) / 2);
+				}
+			}
+			break;
+		}
+
+		case PixelFormat::NV12:
+		case PixelFormat::I420:
+		{
+			_lineLength = width;
+			buffer.resize(width * height * 3 / 2);
+
+			uint8_t* luma = (uint8_t*)buffer.data();
+			uint8_t* chroma = luma + (size_t)width * height;
+			uint8_t u, v;
+
+			for (int y = 0; y < height; y++)
+				for (int x = 0; x < width; x++)
+				{
+					ColorRgb color = patternColor(x, y, frameIndex, random);
+					ColorSys::rgb2yuv(color.red, color.green, color.blue, luma[(size_t)y * width + x], u, v);
+
+					if ((x & 1) == 0 && (y & 1) == 0)
+					{
+						const size_t index = (size_t)(y / 2) * (width / 2) + (x / 2);
+
+						if (_format == PixelFormat::NV12)
+						{
+							chroma[index * 2] = u;
+							chroma[index * 2 + 1] = v;
+						}
+						else
+						{
+							chroma[index] = u;
+							chroma[(size_t)(width / 2) * (height / 2) + index] = v;
+						}
+					}
+				}
+			break;
+		}
+
+		case PixelFormat::XRGB:
+		{
+			// bottom-up BGRX lines like the Windows capture devices
+			_lineLength = width * 4;
+			buffer.resize(_lineLength * height);
+
+			for (int y = 0; y < height; y++)
+			{
+				uint8_t* line = (uint8_t*)buffer.data() + (size_t)(height - 1 - y) * _lineLength;
+
+				for (int x = 0; x < width; x++, line += 4)
+				{
+					ColorRgb color = patternColor(x, y, frameIndex, random);
+					line[0] = color.blue;
+					line[1] = color.green;
+					line[2] = color.red;
+					line[3] = 0xFF;
+				}
+			}
+			break;
+		}
+
+		default:
+		{
+			// RGB24 and the source for MJPEG
+			_rgbBuffer.resize((size_t)width * height * 3);
+
+			uint8_t* pixel = _rgbBuffer.data();
+
+			for (int y = 0; y < height; y++)
+				for (int x = 0; x < width; x++, pixel += 3)
+				{
+					ColorRgb color = patternColor(x, y, frameIndex, random);
+					pixel[0] = color.red;
+					pixel[1] = color.green;
+					pixel[2] = color.blue;
+				}
+
+			if (_format == PixelFormat::RGB24)
+			{
+				_lineLength = width * 3;
+				buffer = QByteArray((const char*)_rgbBuffer.data(), (int)_rgbBuffer.size());
+				break;
+			}
+
+			unsigned char* jpeg = nullptr;
+			unsigned long jpegSize = 0;
+
+			if (_compress == nullptr)
+				_compress = tjInitCompress();
+
+			_lineLength = 0;
+
+			if (_compress != nullptr &&
+				tjCompress2(_compress, _rgbBuffer.data(), width, 0, height, TJPF_RGB, &jpeg, &jpegSize, TJSAMP_422, JPEG_QUALITY, TJFLAG_FASTDCT) == 0)
+				buffer = QByteArray((const char*)jpeg, (int)jpegSize);
+			else
+				buffer.clear();
+
+			if (jpeg != nullptr)
+				tjFree(jpeg);
+			break;
+		}
+	}
+}
+
+void ReplayGrabber::newWorkerFrameError(unsigned int workerIndex, QString error, quint64 sourceCount)
+{
+	frameStat.badFrame++;
+	_metricBadFrames->add();
+
+	if (_workerManager.workers != nullptr && workerIndex < _workerManager.workersCount)
+		_workerManager.workers[workerIndex]->noBusy();
+}
+
+void ReplayGrabber::newWorkerFrame(unsigned int workerIndex, Image<ColorRgb> image, quint64 sourceCount, qint64 _frameBegin)
+{
+	frameStat.goodFrame++;
+	frameStat.averageFrame += QDateTime::currentMSecsSinceEpoch() - _frameBegin;
+	_metricFrames->add();
+	_metricFrameTime->observe((uint64_t)(QDateTime::currentMSecsSinceEpoch() - _frameBegin) * 1000);
+
+	if (_signalAutoDetectionEnabled || isCalibrating())
+	{
+		if (checkSignalDetectionAutomatic(image))
+			emit newFrame(image);
+	}
+	else if (_signalDetectionEnabled)
+	{
+		if (checkSignalDetectionManual(image))
+			emit newFrame(image);
+	}
+	else
+		emit newFrame(image);
+
+	if (_workerManager.workers != nullptr && workerIndex < _workerManager.workersCount)
+		_workerManager.workers[workerIndex]->noBusy();
+}
@@ -0,0 +1,13 @@
+#include <QMetaType>
+#include <QFileInfo>
+#include <grabber/ReplayWrapper.h>
+
+ReplayWrapper::ReplayWrapper(const QString& source, PixelFormat format, int width, int height, int fps,
+	const QString& configurationPath)
+	: GrabberWrapper("REPLAY:" + QFileInfo(source).fileName().left(14), &_grabber)
+	, _grabber(source, format, width, height, fps, configurationPath)
+{
+	qRegisterMetaType<Image<ColorRgb>>("Image<ColorRgb>");
+	connect(&_grabber, &ReplayGrabber::newFrame, this, &GrabberWrapper::newFrame, Qt::DirectConnection);
+	connect(&_grabber, &ReplayGrabber::readError, this, &GrabberWrapper::readError, Qt::DirectConnection);
+}
@@ -5,6 +5,7 @@
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
 #include <sstream>
 #include <fcntl.h>
 #include <unistd.h>
@@ -21,9 +22,14 @@
 
 #include <QDirIterator>
 #include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSysInfo>
 
 #include <grabber/V4L2Grabber.h>
 #include <utils/ColorSys.h>
+#include <utils/CaptureRecorder.h>
 
 #define CLEAR(x) memset(&(x), 0, sizeof(x))
 
@@ -34,6 +40,12 @@
 // some stuff for HDR tone mapping
 #define LUT_FILE_SIZE 50331648
 
+namespace
+{
+	const char DEVICES_CACHE_FILE[] = "v4l2_devices.json";
+	const int  DEVICES_CACHE_VERSION = 1;
+}
+
 const V4L2Grabber::HyperHdrFormat supportedFormats[] =
 {
 	{ V4L2_PIX_FMT_YUYV,   PixelFormat::YUYV },
@@ -57,38 +69,6 @@ V4L2Grabber::V4L2Grabber(const QString & device, const QString & configurationPa
 	getV4L2devices();
 }
 
-QString V4L2Grabber::GetSharedLut()
-{
-	char result[ PATH_MAX ];
-
-	ssize_t count = readlink( "/proc/self/exe", result, PATH_MAX );
-	if (count < 0)
-	{
-		Debug(_log, "Readlink failed");
-		return "";
-	}
-
-	std::string appPath = std::string( result, (count > 0) ? count : 0 );
-	std::size_t found = appPath.find_last_of("/\\");
-
-	QString   ret = QString("%1%2").arg(QString::fromStdString(appPath.substr(0,found))).arg("/../lut");
-	QFileInfo info(ret);
-
-	ret = info.absoluteFilePath();
-	Debug(_log,"LUT folder location: '%s'", QSTRING_CSTR(ret));
-	return ret;
-}
-
-void V4L2Grabber::loadLutFile(PixelFormat color)
-{	
-	// load lut table
-	QString fileName1 = QString("%1%2").arg(_configurationPath).arg("/lut_lin_tables.3d");
-	QString fileName2 = QString("%1%2").arg(GetSharedLut()).arg("/lut_lin_tables.3d");
-	QString fileName3 = QString("/usr/share/hyperhdr/lut/lut_lin_tables.3d");
-
-	Grabber::loadLutFile(color, QList<QString>{fileName1, fileName2, fileName3});
-}
-
 void V4L2Grabber::setHdrToneMappingEnabled(int mode)
 {
 	if (_hdrToneMappingEnabled != mode || _lutBuffer == NULL)
@@ -104,9 +84,9 @@ void V4L2Grabber::setHdrToneMappingEnabled(int mode)
 			Debug(_log,"setHdrToneMappingMode replacing LUT and restarting");
 			_V4L2WorkerManager.Stop();
 			if ((_actualVideoFormat == PixelFormat::YUYV) || (_actualVideoFormat == PixelFormat::I420) || (_actualVideoFormat == PixelFormat::NV12))
-				loadLutFile(PixelFormat::YUYV);
+				loadLutFile(PixelFormat::YUYV, _configurationPath);
 			else
-				loadLutFile(PixelFormat::RGB24);
+				loadLutFile(PixelFormat::RGB24, _configurationPath);
 			_V4L2WorkerManager.Start();
 		}
 	}
@@ -316,10 +296,21 @@ void V4L2Grabber::getV4L2devices()
 	enumerateV4L2devices(false);
 }
 
-void V4L2Grabber::enumerateV4L2devices(bool silent)
+void V4L2Grabber::enumerateV4L2devices(bool silent, bool refresh)
 {
+	// querying every format, size and interval takes long, reuse the last result while the devices stay the same
+	QString signature = getDevicesSignature();
+
+	if (!refresh && loadDevicesCache(signature))
+	{
+		if (!silent)
+			for (auto it = _deviceProperties.begin(); it != _deviceProperties.end(); ++it)
+				Info(_log, "Found capture device: %s (cached, %i modes)", QSTRING_CSTR(it.key()), it.value().valid.count());
+		return;
+	}
 
 	QDirIterator it("/sys/class/video4linux/", QDirIterator::NoIteratorFlags);
+	bool complete = true;
 	_deviceProperties.clear();
 	while(it.hasNext())
 	{
@@ -333,6 +324,7 @@ void V4L2Grabber::enumerateV4L2devices(bool silent)
 			if (fd < 0)
 			{
 				throw_errno_exception("Cannot open '" + devName + "'");
+				complete = false;
 				continue;
 			}
 
@@ -525,6 +517,159 @@ void V4L2Grabber::enumerateV4L2devices(bool silent)
 			}
 		}
     }
+
+	// a device that could not be opened (busy, permissions) must be probed again next time
+	if (complete)
+		saveDevicesCache(signature);
+}
+
+QString V4L2Grabber::getDevicesSignature()
+{
+	// device nodes are recreated on every boot, so the sysfs path of the hardware and its name identify a device
+	QStringList signature;
+	QDirIterator it("/sys/class/video4linux/", QDirIterator::NoIteratorFlags);
+
+	signature << QSysInfo::kernelVersion();
+	while (it.hasNext())
+	{
+		QString dev = it.next();
+		if (it.fileName().startsWith("video"))
+		{
+			QFile devNameFile(dev + "/name");
+			QString name;
+
+			if (devNameFile.open(QFile::ReadOnly))
+			{
+				name = QString(devNameFile.readLine().trimmed());
+				devNameFile.close();
+			}
+
+			signature << QString("%1=%2:%3").arg(it.fileName()).arg(QFileInfo(dev).canonicalFilePath()).arg(name);
+		}
+	}
+
+	std::sort(signature.begin() + 1, signature.end());
+	return signature.join(";");
+}
+
+bool V4L2Grabber::loadDevicesCache(const QString& signature)
+{
+	QFile file(_configurationPath + "/" + DEVICES_CACHE_FILE);
+
+	if (!file.open(QFile::ReadOnly))
+		return false;
+
+	QJsonObject cache = QJsonDocument::fromJson(file.readAll()).object();
+	file.close();
+
+	if (cache["version"].toInt() != DEVICES_CACHE_VERSION || cache["signature"].toString() != signature)
+		return false;
+
+	const QJsonObject devices = cache["devices"].toObject();
+	_deviceProperties.clear();
+
+	for (auto it = devices.begin(); it != devices.end(); ++it)
+	{
+		const QJsonObject device = it.value().toObject();
+		DeviceProperties properties;
+
+		properties.name = device["name"].toString();
+
+		for (const QJsonValue& input : device["inputs"].toArray())
+			properties.inputs.insert(input.toObject()["name"].toString(), input.toObject()["index"].toInt());
+
+		for (const QJsonValue& res : device["resolutions"].toArray())
+			properties.resolutions << res.toString();
+
+		for (const QJsonValue& res : device["displayResolutions"].toArray())
+			properties.displayResolutions << res.toString();
+
+		for (const QJsonValue& fr : device["framerates"].toArray())
+			properties.framerates << fr.toString();
+
+		const QJsonObject controls = device["controls"].toObject();
+		DeviceControlCapability* capabilities[] = { &properties.brightness, &properties.contrast, &properties.saturation, &properties.hue };
+		const char* names[] = { "brightness", "contrast", "saturation", "hue" };
+
+		for (int i = 0; i < 4; i++)
+			if (controls.contains(names[i]))
+			{
+				const QJsonArray control = controls[names[i]].toArray();
+				capabilities[i]->enabled = true;
+				capabilities[i]->minVal = (long)control[0].toDouble();
+				capabilities[i]->maxVal = (long)control[1].toDouble();
+				capabilities[i]->defVal = (long)control[2].toDouble();
+			}
+
+		for (const QJsonValue& mode : device["modes"].toArray())
+		{
+			const QJsonArray m = mode.toArray();
+			DevicePropertiesItem di;
+
+			di.x = m[0].toInt();
+			di.y = m[1].toInt();
+			di.fps = m[2].toInt();
+			di.input = m[3].toInt();
+			di.pf = static_cast<PixelFormat>(m[4].toInt());
+			di.v4l2PixelFormat = (__u32)m[5].toDouble();
+			properties.valid.append(di);
+		}
+
+		_deviceProperties.insert(it.key(), properties);
+	}
+
+	return true;
+}
+
+void V4L2Grabber::saveDevicesCache(const QString& signature)
+{
+	QJsonObject devices;
+
+	for (auto it = _deviceProperties.begin(); it != _deviceProperties.end(); ++it)
+	{
+		const DeviceProperties& properties = it.value();
+		QJsonObject device;
+		QJsonArray inputs, modes;
+		QJsonObject controls;
+
+		device["name"] = properties.name;
+
+		for (auto input = properties.inputs.begin(); input != properties.inputs.end(); ++input)
+			inputs.append(QJsonObject{ {"name", input.key()}, {"index", input.value()} });
+		device["inputs"] = inputs;
+
+		device["resolutions"] = QJsonArray::fromStringList(properties.resolutions);
+		device["displayResolutions"] = QJsonArray::fromStringList(properties.displayResolutions);
+		device["framerates"] = QJsonArray::fromStringList(properties.framerates);
+
+		const DeviceControlCapability* capabilities[] = { &properties.brightness, &properties.contrast, &properties.saturation, &properties.hue };
+		const char* names[] = { "brightness", "contrast", "saturation", "hue" };
+
+		for (int i = 0; i < 4; i++)
+			if (capabilities[i]->enabled)
+				controls[names[i]] = QJsonArray{ (double)capabilities[i]->minVal, (double)capabilities[i]->maxVal, (double)capabilities[i]->defVal };
+		device["controls"] = controls;
+
+		for (const DevicePropertiesItem& di : properties.valid)
+			modes.append(QJsonArray{ di.x, di.y, di.fps, di.input, (int)di.pf, (double)di.v4l2PixelFormat });
+		device["modes"] = modes;
+
+		devices[it.key()] = device;
+	}
+
+	QJsonObject cache;
+	cache["version"] = DEVICES_CACHE_VERSION;
+	cache["signature"] = signature;
+	cache["devices"] = devices;
+
+	QFile file(_configurationPath + "/" + DEVICES_CACHE_FILE);
+	if (file.open(QFile::WriteOnly | QFile::Truncate))
+	{
+		file.write(QJsonDocument(cache).toJson(QJsonDocument::Compact));
+		file.close();
+	}
+	else
+		Warning(_log, "Could not write the capture devices cache: %s", QSTRING_CSTR(file.fileName()));
 }
 
 bool V4L2Grabber::start()
@@ -903,7 +1048,7 @@ bool V4L2Grabber::init_device(QString selectedDeviceName, DevicePropertiesItem p
 	{
 		case V4L2_PIX_FMT_YUYV:
 		{
-			loadLutFile(PixelFormat::YUYV);		
+			loadLutFile(PixelFormat::YUYV, _configurationPath);		
 			_actualVideoFormat = PixelFormat::YUYV;
 			_frameByteSize = props.x * props.y * 2;
 			Info(_log, "Video pixel format is set to: YUYV");
@@ -912,7 +1057,7 @@ bool V4L2Grabber::init_device(QString selectedDeviceName, DevicePropertiesItem p
 
 		case V4L2_PIX_FMT_XRGB32:
 		{
-			loadLutFile(PixelFormat::RGB24);
+			loadLutFile(PixelFormat::RGB24, _configurationPath);
 			_actualVideoFormat = PixelFormat::XRGB;
 			_frameByteSize = props.x * props.y * 4;
 			Info(_log, "Video pixel format is set to: XRGB");
@@ -921,7 +1066,7 @@ bool V4L2Grabber::init_device(QString selectedDeviceName, DevicePropertiesItem p
 
 		case V4L2_PIX_FMT_RGB24:
 		{
-			loadLutFile(PixelFormat::RGB24);
+			loadLutFile(PixelFormat::RGB24, _configurationPath);
 			_actualVideoFormat = PixelFormat::RGB24;
 			_frameByteSize = props.x * props.y * 3;
 			Info(_log, "Video pixel format is set to: RGB24");
@@ -930,7 +1075,7 @@ bool V4L2Grabber::init_device(QString selectedDeviceName, DevicePropertiesItem p
 
 		case V4L2_PIX_FMT_YUV420:
 		{
-			loadLutFile(PixelFormat::YUYV);
+			loadLutFile(PixelFormat::YUYV, _configurationPath);
 			_actualVideoFormat = PixelFormat::I420;
 			_frameByteSize = (props.x * props.y * 6) / 4;
 			Info(_log, "Video pixel format is set to: I420");
@@ -939,7 +1084,7 @@ bool V4L2Grabber::init_device(QString selectedDeviceName, DevicePropertiesItem p
 
 		case V4L2_PIX_FMT_NV12:
 		{
-			loadLutFile(PixelFormat::YUYV);
+			loadLutFile(PixelFormat::YUYV, _configurationPath);
 			_actualVideoFormat = PixelFormat::NV12;
 			_frameByteSize = (props.x * props.y * 6) / 4;
 			Info(_log, "Video pixel format is set to: NV12");
@@ -948,7 +1093,7 @@ bool V4L2Grabber::init_device(QString selectedDeviceName, DevicePropertiesItem p
 
 		case V4L2_PIX_FMT_MJPEG:
 		{
-			loadLutFile(PixelFormat::RGB24);
+			loadLutFile(PixelFormat::RGB24, _configurationPath);
 			_actualVideoFormat = PixelFormat::MJPEG;
 			Info(_log, "Video pixel format is set to: MJPEG");
 		}
@@ -1042,7 +1187,7 @@ int V4L2Grabber::read_frame()
 				{
 					throw_errno_exception("VIDIOC_DQBUF error. Video stream is probably broken. Refreshing list of the devices.");
 					stop();
-					getV4L2devices();
+					enumerateV4L2devices(false, true);
 				}
 				return 0;
 			}
@@ -1071,9 +1216,14 @@ bool V4L2Grabber::process_image(v4l2_buffer* buf, const void* frameImageBuffer,
 {	
 	bool		frameSend = false;
 	uint64_t	processFrameIndex = _currentFrame++;
+	int			decimation = getCaptureDecimation();
+
+	// raw frame as delivered by the device, before decimation and decoding
+	if (CaptureRecorder::getInstance()->isRecordingVideo())
+		CaptureRecorder::getInstance()->addVideoFrame(_actualVideoFormat, _actualWidth, _actualHeight, _lineLength, (const uint8_t*)frameImageBuffer, size);
 	
 	// frame skipping
-	if ( (processFrameIndex % _fpsSoftwareDecimation != 0) && (_fpsSoftwareDecimation > 1))
+	if ((processFrameIndex % decimation != 0) && (decimation > 1))
 		return frameSend;		
 
 	// We do want a new frame...
@@ -1121,7 +1271,7 @@ bool V4L2Grabber::process_image(v4l2_buffer* buf, const void* frameImageBuffer,
 		    	
 		    frameStat.segment|=(1<<buf->index);
 		    	
-			for (unsigned int i=0;_V4L2WorkerManager.isActive() && i < _V4L2WorkerManager.workersCount &&  _V4L2WorkerManager.workers != nullptr; i++)
+			for (unsigned int i=0;_V4L2WorkerManager.isActive() && i < getCaptureWorkers(_V4L2WorkerManager.workersCount) &&  _V4L2WorkerManager.workers != nullptr; i++)
 			{													
 				if (_V4L2WorkerManager.workers[i]->isFinished() || !_V4L2WorkerManager.workers[i]->isRunning())
 				{
@@ -1132,7 +1282,7 @@ bool V4L2Grabber::process_image(v4l2_buffer* buf, const void* frameImageBuffer,
 						if ((_actualVideoFormat == PixelFormat::YUYV || _actualVideoFormat == PixelFormat::I420 ||
 							_actualVideoFormat == PixelFormat::NV12) && !_lutBufferInit)
 						{
-							loadLutFile();
+							loadLutFile(PixelFormat::NO_CHANGE, _configurationPath);
 						}
 
 						_workerThread->setup(
@@ -1163,6 +1313,7 @@ bool V4L2Grabber::process_image(v4l2_buffer* buf, const void* frameImageBuffer,
 void V4L2Grabber::newWorkerFrameError(unsigned int workerIndex, QString error, quint64 sourceCount)
 {
 	frameStat.badFrame++;
+	_metricBadFrames->add();
 	//Debug(_log, "Error occured while decoding mjpeg frame %d = %s", sourceCount, QSTRING_CSTR(error));	
 	
 	// get next frame
@@ -1186,6 +1337,8 @@ void V4L2Grabber::newWorkerFrame(unsigned int workerIndex, Image<ColorRgb> image
 {
 	frameStat.goodFrame++;
 	frameStat.averageFrame += QDateTime::currentMSecsSinceEpoch() - _frameBegin;
+	_metricFrames->add();
+	_metricFrameTime->observe((uint64_t)(QDateTime::currentMSecsSinceEpoch() - _frameBegin) * 1000);
 	
 	if (_signalAutoDetectionEnabled || isCalibrating())
 	{
@@ -27,6 +27,7 @@
 #include <QFileInfo>
 
 #include <grabber/V4L2Worker.h>
+#include <utils/ThreadTopology.h>
 
 
 
@@ -125,7 +126,7 @@ void V4L2Worker::setup(unsigned int __workerIndex, v4l2_buffer* __v4l2Buf, Pixel
 			uint8_t * __sharedData, int __size,int __width, int __height, int __lineLength,
 			uint __cropLeft,  uint  __cropTop, uint __cropBottom, uint __cropRight,
 			quint64 __currentFrame, qint64 __frameBegin,
-			int __hdrToneMappingEnabled, uint8_t* __lutBuffer, bool __qframe)
+			int __hdrToneMappingEnabled, const uint8_t* __lutBuffer, bool __qframe)
 {
 	_workerIndex = __workerIndex;  
 	memcpy(&_v4l2Buf, __v4l2Buf, sizeof (v4l2_buffer));
@@ -153,6 +154,8 @@ v4l2_buffer* V4L2Worker::GetV4L2Buffer()
 
 void V4L2Worker::run()
 {
+	ThreadTopology::registerCurrentThread(ThreadTopology::Role::CAPTURE_WORKER, QString("V4L2Worker%1").arg(_workerIndex));
+
 	runMe();	
 }
 
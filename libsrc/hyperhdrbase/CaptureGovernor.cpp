@@ -0,0 +1,212 @@
+#include <hyperhdrbase/CaptureGovernor.h>
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+	const int64_t	WINDOW_MS = 1000;
+	const int64_t	SCENE_CUT_HOLD_MS = 2000;
+	const int		SCENE_CUT_THRESHOLD = 40;
+	const int		MAX_DECIMATION = 8;
+	const double	HEADROOM = 1.2;
+	const double	BUSY_LIMIT = 0.7;
+
+	struct alignas(64) InstanceStats
+	{
+		std::atomic<uint64_t> processed;
+		std::atomic<uint64_t> processedTime;
+		std::atomic<uint64_t> consumed;
+	};
+
+	InstanceStats& instanceStats(int instance)
+	{
+		static InstanceStats stats[CaptureGovernor::MAX_INSTANCES];
+		return stats[instance % CaptureGovernor::MAX_INSTANCES];
+	}
+}
+
+CaptureGovernor::CaptureGovernor(Logger* log)
+	: _log(log)
+	, _enabled(false)
+	, _decimation(1)
+	, _workers(0)
+	, _windowStart(0)
+	, _holdUntil(0)
+	, _frames(0)
+	, _signatureValid(false)
+	, _metricDecimation(Metrics::gauge("hyperhdr_capture_governor_decimation", "Software decimation applied by the capture governor"))
+	, _metricWorkers(Metrics::gauge("hyperhdr_capture_governor_workers", "Decoding workers allowed by the capture governor (0 = all)"))
+	, _metricSceneCuts(Metrics::counter("hyperhdr_capture_governor_scene_cuts_total", "Scene cuts that restored the full capture rate"))
+{
+	startWindow(0);
+}
+
+void CaptureGovernor::setEnabled(bool enabled)
+{
+	if (_enabled != enabled)
+	{
+		_enabled = enabled;
+		_decimation = 1;
+		_workers = 0;
+		_holdUntil = 0;
+		_signatureValid = false;
+		startWindow(QDateTime::currentMSecsSinceEpoch());
+
+		_metricDecimation->set(_decimation);
+		_metricWorkers->set(_workers);
+
+		Debug(_log, "Adaptive capture governor is: %s", (_enabled) ? "enabled" : "disabled");
+	}
+}
+
+bool CaptureGovernor::isEnabled() const
+{
+	return _enabled;
+}
+
+void CaptureGovernor::reportProcessed(int instance, int64_t microseconds)
+{
+	if (instance < 0)
+		return;
+
+	InstanceStats& stats = instanceStats(instance);
+	stats.processed.fetch_add(1, std::memory_order_relaxed);
+	stats.processedTime.fetch_add((uint64_t)std::max(microseconds, (int64_t)0), std::memory_order_relaxed);
+}
+
+void CaptureGovernor::reportConsumed(int instance)
+{
+	if (instance < 0)
+		return;
+
+	instanceStats(instance).consumed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CaptureGovernor::startWindow(int64_t now)
+{
+	_windowStart = now;
+	_frames = 0;
+
+	for (int i = 0; i < MAX_INSTANCES; i++)
+	{
+		InstanceStats& stats = instanceStats(i);
+		_lastProcessed[i] = stats.processed.load(std::memory_order_relaxed);
+		_lastProcessedTime[i] = stats.processedTime.load(std::memory_order_relaxed);
+		_lastConsumed[i] = stats.consumed.load(std::memory_order_relaxed);
+	}
+}
+
+bool CaptureGovernor::detectSceneCut(const Image<ColorRgb>& image)
+{
+	const int width = image.width(), height = image.height();
+
+	if (width < SIGNATURE_SIZE || height < SIGNATURE_SIZE)
+		return false;
+
+	// luminance of a sparse grid is enough to catch a cut, noise stays far below the threshold
+	int difference = 0;
+	uint8_t* signature = _signature;
+
+	for (int y = 0; y < SIGNATURE_SIZE; y++)
+		for (int x = 0; x < SIGNATURE_SIZE; x++, signature++)
+		{
+			const ColorRgb& pixel = image((2 * x + 1) * width / (2 * SIGNATURE_SIZE), (2 * y + 1) * height / (2 * SIGNATURE_SIZE));
+			uint8_t luminance = (uint8_t)((pixel.red * 2 + pixel.green * 5 + pixel.blue) >> 3);
+
+			difference += std::abs(luminance - *signature);
+			*signature = luminance;
+		}
+
+	bool sceneCut = _signatureValid && (difference / (SIGNATURE_SIZE * SIGNATURE_SIZE) > SCENE_CUT_THRESHOLD);
+	_signatureValid = true;
+
+	return sceneCut;
+}
+
+bool CaptureGovernor::frameCaptured(const Image<ColorRgb>& image, int& decimation, int& workers, double decodeTimeMs)
+{
+	const int64_t now = QDateTime::currentMSecsSinceEpoch();
+	const int current = std::max(decimation, 1);
+
+	_frames++;
+
+	if (detectSceneCut(image))
+	{
+		_metricSceneCuts->add();
+		_holdUntil = now + SCENE_CUT_HOLD_MS;
+		startWindow(now);
+
+		if (_decimation > 1 || _workers > 0)
+		{
+			_decimation = 1;
+			_workers = 0;
+			_metricDecimation->set(_decimation);
+			_metricWorkers->set(_workers);
+
+			decimation = _decimation;
+			workers = _workers;
+			return true;
+		}
+
+		return false;
+	}
+
+	const int64_t elapsed = now - _windowStart;
+
+	if (now < _holdUntil || elapsed < WINDOW_MS)
+		return false;
+
+	const double seconds = elapsed / 1000.0;
+	const double captureRate = _frames / seconds;
+	double demand = 0, busy = 0;
+
+	for (int i = 0; i < MAX_INSTANCES; i++)
+	{
+		InstanceStats& stats = instanceStats(i);
+
+		if (stats.processed.load(std::memory_order_relaxed) != _lastProcessed[i])
+		{
+			demand = std::max(demand, (stats.consumed.load(std::memory_order_relaxed) - _lastConsumed[i]) / seconds);
+			busy = std::max(busy, (stats.processedTime.load(std::memory_order_relaxed) - _lastProcessedTime[i]) / (seconds * 1000000.0));
+		}
+	}
+
+	startWindow(now);
+
+	// no instance shows the captured frames at the moment: nothing to measure
+	if (demand <= 0 || captureRate <= 0)
+		return false;
+
+	// capture a bit more than the LEDs show and keep the instance threads below the busy limit
+	double limit = demand * HEADROOM;
+
+	if (busy > BUSY_LIMIT)
+		limit = std::min(limit, captureRate * BUSY_LIMIT / busy);
+
+	const double sourceRate = captureRate * current;
+	const int newDecimation = std::max(1, std::min(MAX_DECIMATION, (int)(sourceRate / std::max(limit, 1.0))));
+	int newWorkers = _workers;
+
+	// keep every decoding worker below 50% load
+	if (decodeTimeMs > 0)
+		newWorkers = std::max(1, (int)std::ceil(sourceRate / newDecimation * decodeTimeMs / 1000.0 * 2));
+
+	if (newDecimation == _decimation && newWorkers == _workers)
+		return false;
+
+	Debug(_log, "Capture governor: decimation %d, workers %d (capture: %.1f fps, shown: %.1f fps, instance load: %.0f%%)",
+		newDecimation, newWorkers, captureRate, demand, busy * 100.0);
+
+	_decimation = newDecimation;
+	_workers = newWorkers;
+	_metricDecimation->set(_decimation);
+	_metricWorkers->set(_workers);
+
+	decimation = _decimation;
+	workers = _workers;
+	return true;
+}
@@ -1,6 +1,9 @@
 #include <hyperhdrbase/Grabber.h>
 #include <utils/ColorSys.h>
+#include <QCoreApplication>
 #include <QFile>
+#include <QFileInfo>
+#include <algorithm>
 
 const QString Grabber::AUTO_SETTING = QString("auto");
 const int	  Grabber::AUTO_INPUT = -1;
@@ -19,6 +22,9 @@ Grabber::Grabber(const QString& grabberName, int width, int height, int cropLeft
 	, _enabled(true)
 	, _hdrToneMappingEnabled(0)	
 	, _log(Logger::getInstance(grabberName.toUpper()))
+	, _metricFrames(Metrics::counter("hyperhdr_grabber_frames_total", "Frames captured and decoded by the grabber", QString("grabber=\"%1\"").arg(grabberName)))
+	, _metricBadFrames(Metrics::counter("hyperhdr_grabber_bad_frames_total", "Frames the grabber failed to decode", QString("grabber=\"%1\"").arg(grabberName)))
+	, _metricFrameTime(Metrics::histogram("hyperhdr_grabber_frame_seconds", "Time from the capture of a frame to the decoded image", QString("grabber=\"%1\"").arg(grabberName)))
 	, _currentFrame(0)
 	, _deviceName()
 	, _enc(PixelFormat::NO_CHANGE)
@@ -31,11 +37,14 @@ Grabber::Grabber(const QString& grabberName, int width, int height, int cropLeft
 	, _restartNeeded(false)
 	, _initialized(false)
 	, _fpsSoftwareDecimation(1)
+	, _governorDecimation(1)
+	, _governorWorkers(0)
 	, _actualVideoFormat(PixelFormat::NO_CHANGE)
 	, _actualWidth(0)
 	, _actualHeight(0)
 	, _actualFPS(0)
 	, _actualDeviceName("")
+	, _lut()
 	, _lutBuffer(NULL)
 	, _lutBufferInit(false)
 	, _lineLength(-1)
@@ -49,8 +58,6 @@ Grabber::Grabber(const QString& grabberName, int width, int height, int cropLeft
 
 Grabber::~Grabber()
 {
-	if (_lutBuffer != NULL)
-		free(_lutBuffer);
 	_lutBuffer = NULL;
 }
 
@@ -145,6 +152,34 @@ int Grabber::getFpsSoftwareDecimation()
 	return _fpsSoftwareDecimation;
 }
 
+void Grabber::setCaptureLimits(int decimation, int workers)
+{
+	_governorDecimation = std::max(decimation, 1);
+	_governorWorkers = std::max(workers, 0);
+}
+
+int Grabber::getCaptureDecimation()
+{
+	// the calibration of the signal detection needs every frame
+	if (isCalibrating())
+		return _fpsSoftwareDecimation;
+
+	return std::max(_fpsSoftwareDecimation, _governorDecimation);
+}
+
+unsigned int Grabber::getCaptureWorkers(unsigned int available) const
+{
+	if (_governorWorkers <= 0)
+		return available;
+
+	return std::min(available, (unsigned int)_governorWorkers);
+}
+
+double Grabber::getAverageFrameTime() const
+{
+	return (frameStat.goodFrame > 0) ? frameStat.averageFrame / (double)frameStat.goodFrame : 0.0;
+}
+
 int Grabber::getActualFps()
 {
 	return _actualFPS;
@@ -366,6 +401,22 @@ int Grabber::getHdrToneMappingEnabled()
 	return _hdrToneMappingEnabled;
 }
 
+QString Grabber::GetSharedLut()
+{
+	QString ret = QFileInfo(QString("%1%2").arg(QCoreApplication::applicationDirPath()).arg("/../lut")).absoluteFilePath();
+	Debug(_log, "LUT folder location: '%s'", QSTRING_CSTR(ret));
+	return ret;
+}
+
+void Grabber::loadLutFile(PixelFormat color, const QString& configurationPath)
+{
+	QString fileName1 = QString("%1%2").arg(configurationPath).arg("/lut_lin_tables.3d");
+	QString fileName2 = QString("%1%2").arg(GetSharedLut()).arg("/lut_lin_tables.3d");
+	QString fileName3 = QString("/usr/share/hyperhdr/lut/lut_lin_tables.3d");
+
+	loadLutFile(color, QList<QString>{fileName1, fileName2, fileName3});
+}
+
 void Grabber::loadLutFile(PixelFormat color, const QList<QString>& files)
 {
 	bool is_yuv = (color == PixelFormat::YUYV);
@@ -380,23 +431,11 @@ void Grabber::loadLutFile(PixelFormat color, const QList<QString>& files)
 
 	if (color == PixelFormat::NO_CHANGE)
 	{
-		if (_lutBuffer == NULL)
-			_lutBuffer = (uint8_t*)malloc(LUT_FILE_SIZE + 4);
+		std::shared_ptr<LutMapping> lut = LutMapping::internalYuvTable();
 
-		if (_lutBuffer != NULL)
-		{
-			for (int y = 0; y < 256; y++)
-				for (int u = 0; u < 256; u++)
-					for (int v = 0; v < 256; v++)
-					{
-						uint32_t ind_lutd = LUT_INDEX(y, u, v);
-						ColorSys::yuv2rgb(y, u, v,
-							_lutBuffer[ind_lutd],
-							_lutBuffer[ind_lutd + 1],
-							_lutBuffer[ind_lutd + 2]);
-					}
-			_lutBufferInit = true;
-		}
+		_lutBuffer = (lut != nullptr) ? lut->table(0) : nullptr;
+		_lut = lut;
+		_lutBufferInit = (_lutBuffer != nullptr);
 
 		Error(_log, "You have forgotten to put lut_lin_tables.3d file in the HyperHDR configuration folder. Internal LUT table for YUV conversion has been created instead.");
 		return;
@@ -406,40 +445,39 @@ void Grabber::loadLutFile(PixelFormat color, const QList<QString>& files)
 	{
 		for(QString fileName3d : files)
 		{
-			QFile file(fileName3d);
-			
-			if (file.open(QIODevice::ReadOnly))
+			// the mapping is shared with other grabbers using the same file
+			std::shared_ptr<LutMapping> lut = LutMapping::open(fileName3d);
+
+			if (lut != nullptr)
 			{
-				size_t length;
+				qint64 length = lut->size();
 				Debug(_log, "LUT file found: %s", QSTRING_CSTR(fileName3d));
-				
-				length = file.size();
 
 				if (length == LUT_FILE_SIZE * 3)
 				{
-					qint64 index = 0;
+					int index = 0;
 
 					if (is_yuv && _hdrToneMappingEnabled)
 					{
 						Debug(_log, "Index 1 for HDR YUV");
-						index = LUT_FILE_SIZE;
+						index = 1;
 					}
 					else if (is_yuv)
 					{
 						Debug(_log, "Index 2 for YUV");
-						index = LUT_FILE_SIZE * 2;
+						index = 2;
 					}
 					else
 						Debug(_log, "Index 0 for HDR RGB");
 
-					file.seek(index);
+					// switching between the tables only moves the pointer
+					_lutBuffer = lut->table(index);
+					_lut = lut;
 
-					if (_lutBuffer == NULL)
-						_lutBuffer = (unsigned char*)malloc(length + 4);
-
-					if (file.read((char*)_lutBuffer, LUT_FILE_SIZE) != LUT_FILE_SIZE)
+					if (_lutBuffer == nullptr)
 					{
 						Error(_log, "Error reading LUT file %s", QSTRING_CSTR(fileName3d));
+						_lut.reset();
 					}
 					else
 					{
@@ -448,9 +486,7 @@ void Grabber::loadLutFile(PixelFormat color, const QList<QString>& files)
 					}
 				}
 				else
-					Error(_log, "LUT file has invalid length: %i %s. Please generate new one LUT table using the generator page.", length, QSTRING_CSTR(fileName3d));
-				
-				file.close();
+					Error(_log, "LUT file has invalid length: %i %s. Please generate new one LUT table using the generator page.", (int)length, QSTRING_CSTR(fileName3d));
 
 				return;
 			}
@@ -545,34 +581,38 @@ QMap<Grabber::currentVideoModeInfo, QString> Grabber::getVideoCurrentMode() cons
 }
 
 
-void Grabber::processSystemFrameBGRA(uint8_t* source, int lineSize)
+void Grabber::processSystemFrameBGRA(uint8_t* source, int lineSize, bool useCropping)
 {	
-	int startX = _cropLeft;
-	int startY = _cropTop;
-	int realSizeX = _actualWidth - startX - _cropRight;
-	int realSizeY = _actualHeight - startY - _cropBottom;
+	int startX = (useCropping) ? _cropLeft : 0;
+	int startY = (useCropping) ? _cropTop : 0;
+	int realSizeX = _actualWidth - startX - ((useCropping) ? _cropRight : 0);
+	int realSizeY = _actualHeight - startY - ((useCropping) ? _cropBottom : 0);
 
 	if (realSizeX <= 16 || realSizeY <= 16)
 	{
+		startX = 0;
+		startY = 0;
 		realSizeX = _actualWidth;
 		realSizeY = _actualHeight;
 	}
 
-	int checkWidth = realSizeX;
-	int division = 1;
+	// any ratio: the area-averaging resampler is not limited to integer divisions
+	int targetSizeX = realSizeX;
+	int targetSizeY = realSizeY;
 
-	while (checkWidth > _width)
-	{		
-		division++;
-		checkWidth = realSizeX / division;
+	if (_width > 0 && realSizeX > _width)
+	{
+		targetSizeX = _width;
+		targetSizeY = std::max((int)(((int64_t)realSizeY * _width) / realSizeX), 1);
 	}
 
-	int targetSizeX = realSizeX / division;
-	int targetSizeY = realSizeY / division;
-
 	Image<ColorRgb> image(targetSizeX, targetSizeY);
 
-	ImageResampler::processSystemImageBGRA(image, targetSizeX, targetSizeY, startX, startY, source, _actualWidth, _actualHeight, division, (_hdrToneMappingEnabled == 0 || !_lutBufferInit) ? nullptr : _lutBuffer, lineSize);
+	{
+		Metrics::ScopedTimer metricTimer(_metricFrameTime);
+		ImageResampler::processSystemImageBGRA(image, targetSizeX, targetSizeY, startX, startY, realSizeX, realSizeY, source, _actualWidth, _actualHeight, (_hdrToneMappingEnabled == 0 || !_lutBufferInit) ? nullptr : _lutBuffer, lineSize);
+	}
+	_metricFrames->add();
 	
 	if (_signalDetectionEnabled)
 	{
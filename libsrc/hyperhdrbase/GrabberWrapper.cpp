@@ -24,6 +24,7 @@ GrabberWrapper::GrabberWrapper(const QString& grabberName, Grabber* ggrabber)
 	, _autoResume(false)
 	, _benchmarkStatus(-1)
 	, _benchmarkMessage("")
+	, _governor(_log)
 {
 	GrabberWrapper::instance = this;
 
@@ -112,6 +113,14 @@ void GrabberWrapper::newFrame(const Image<ColorRgb>& image)
 		Warning(_log, "Detected the video frame size changed (%ix%i). Cache buffer was cleared.", image.width(), image.height());
 	}
 
+	if (_governor.isEnabled() && _grabber != nullptr)
+	{
+		int decimation = _grabber->getCaptureDecimation(), workers = 0;
+
+		if (_governor.frameCaptured(image, decimation, workers, _grabber->getAverageFrameTime()))
+			_grabber->setCaptureLimits(decimation, workers);
+	}
+
 	emit systemImage(_grabberName, image);
 }
 
@@ -490,6 +499,11 @@ void GrabberWrapper::handleSettingsUpdate(settings::type type, const QJsonDocume
 			// software frame skipping
 			_grabber->setFpsSoftwareDecimation(obj["fpsSoftwareDecimation"].toInt(1));
 
+			// adaptive capture governor
+			_governor.setEnabled(obj["adaptiveCapture"].toBool(false));
+			if (!_governor.isEnabled())
+				_grabber->setCaptureLimits(1, 0);
+
 			// old dump signal detection
 			_grabber->setSignalDetectionEnable(obj["signalDetection"].toBool(false));
 
@@ -3,9 +3,11 @@
 #include <hyperhdrbase/HyperHdrInstance.h>
 #include <db/InstanceTable.h>
 #include <hyperhdrbase/GrabberWrapper.h>
+#include <utils/Metrics.h>
 
 // qt
 #include <QThread>
+#include <QDateTime>
 
 HyperHdrIManager* HyperHdrIManager::HIMinstance;
 
@@ -15,6 +17,7 @@ HyperHdrIManager::HyperHdrIManager(const QString& rootPath, QObject* parent, boo
 	, _instanceTable( new InstanceTable(rootPath, this, readonlyMode) )
 	, _rootPath( rootPath )
 	, _readonlyMode(readonlyMode)
+	, _startAllTime(0)
 {
 	HIMinstance = this;
 	qRegisterMetaType<InstanceState>("InstanceState");
@@ -42,11 +45,17 @@ QVector<QVariantMap> HyperHdrIManager::getInstanceData() const
 
 void HyperHdrIManager::startAll()
 {
+	_startAllTime = QDateTime::currentMSecsSinceEpoch();
+
 	for(const auto & entry : _instanceTable->getAllInstances(true))
 	{
 		startInstance(entry["instance"].toInt());
 	}
 
+	// nothing to wait for: no enabled instance
+	if (_startQueue.isEmpty())
+		_startAllTime = 0;
+
 	emit setNewComponentStateToAllInstances(hyperhdr::Components::COMP_HDR, (GrabberWrapper::getInstance()->getHdrToneMappingEnabled() != 0));
 }
 
@@ -117,6 +126,7 @@ bool HyperHdrIManager::startInstance(quint8 inst, bool block, QObject* caller, i
 
 			// add to queue and start
 			_startQueue << inst;
+			_startTimes[inst] = QDateTime::currentMSecsSinceEpoch();
 			hyperhdrThread->start();
 
 			// update db
@@ -235,10 +245,21 @@ void HyperHdrIManager::handleStarted()
 	HyperHdrInstance* hyperhdr = qobject_cast<HyperHdrInstance*>(sender());
 	quint8 instance = hyperhdr->getInstanceIndex();
 
-	Info(_log,"HyperHDR instance '%s' has been started", QSTRING_CSTR(_instanceTable->getNamebyIndex(instance)));
+	qint64 startTime = QDateTime::currentMSecsSinceEpoch() - _startTimes.take(instance);
+
+	Info(_log,"HyperHDR instance '%s' has been started in %lld ms", QSTRING_CSTR(_instanceTable->getNamebyIndex(instance)), static_cast<long long>(startTime));
+	Metrics::gauge("hyperhdr_instance_startup_seconds", "Time from the instance start request to a running instance", Metrics::instanceLabel(instance))->set(startTime / 1000.0);
 
 	_startQueue.removeAll(instance);
 	_runningInstances.insert(instance, hyperhdr);
+
+	// the instances start in their own threads: the startup phase ends with the last one
+	if (_startAllTime != 0 && _startQueue.isEmpty())
+	{
+		Metrics::gauge("hyperhdr_startup_seconds", "Duration of the startup phases", "phase=\"instances\"")->set((QDateTime::currentMSecsSinceEpoch() - _startAllTime) / 1000.0);
+		_startAllTime = 0;
+	}
+
 	emit instanceStateChanged(InstanceState::H_STARTED, instance);
 	emit change();
 
@@ -262,7 +283,14 @@ const QJsonObject HyperHdrIManager::getBackup()
 QString HyperHdrIManager::restoreBackup(const QJsonObject& message)
 {
 	if (_instanceTable != nullptr)
-		return _instanceTable->restoreBackup(message);
+	{
+		QString error = _instanceTable->restoreBackup(message);
+
+		// the settings table was replaced directly
+		SettingsTable::invalidateCache();
+
+		return error;
+	}
 	else
 		return QString("Empty instance table manager");
 }
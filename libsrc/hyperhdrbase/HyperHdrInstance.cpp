@@ -18,6 +18,8 @@
 #include <utils/hyperhdr.h>
 #include <utils/GlobalSignals.h>
 #include <utils/Logger.h>
+#include <utils/CaptureRecorder.h>
+#include <utils/ThreadTopology.h>
 
 // LedDevice includes
 #include <leddevice/LedDeviceWrapper.h>
@@ -41,6 +43,7 @@
 #include <hyperhdrbase/SystemControl.h>
 
 #include <hyperhdrbase/GrabberWrapper.h>
+#include <hyperhdrbase/CaptureGovernor.h>
 
 // Boblight
 #if defined(ENABLE_BOBLIGHT)	
@@ -110,6 +113,8 @@ HyperHdrInstance::~HyperHdrInstance()
 
 void HyperHdrInstance::start()
 {
+	ThreadTopology::registerCurrentThread(ThreadTopology::Role::INSTANCE, QString("Instance%1").arg(_instIndex));
+
 	connect(_settingsManager, &SettingsManager::settingsChanged, this, &HyperHdrInstance::settingsChanged);
 
 	if (!_raw2ledAdjustment->verifyAdjustments())
@@ -145,10 +150,15 @@ void HyperHdrInstance::start()
 	// initialize LED-devices
 	QJsonObject ledDevice = getSetting(settings::type::DEVICE).object();
 	ledDevice["currentLedCount"] = _hwLedCount; // Inject led count info
+	ledDevice["instance"] = _instIndex; // Inject instance index for the metrics
 
 	_ledDeviceWrapper = new LedDeviceWrapper(this);
 	connect(this, &HyperHdrInstance::compStateChangeRequest, _ledDeviceWrapper, &LedDeviceWrapper::handleComponentState);
 	connect(this, &HyperHdrInstance::ledDeviceData, _ledDeviceWrapper, &LedDeviceWrapper::updateLeds);
+	connect(this, &HyperHdrInstance::ledDeviceData, this, [this](const std::vector<ColorRgb>& ledValues) {
+		if (CaptureRecorder::getInstance()->isRecordingLeds())
+			CaptureRecorder::getInstance()->addLedColors(_instIndex, ledValues);
+	}, Qt::DirectConnection);
 	_ledDeviceWrapper->createLedDevice(ledDevice);
 
 	// smoothing
@@ -289,6 +299,7 @@ void HyperHdrInstance::handleSettingsUpdate(settings::type type, const QJsonDocu
 
 		// do always reinit until the led devices can handle dynamic changes
 		dev["currentLedCount"] = _hwLedCount; // Inject led count info
+		dev["instance"] = _instIndex; // Inject instance index for the metrics
 		_ledDeviceWrapper->createLedDevice(dev);
 
 		// TODO: Check, if framegrabber frequency is lower than latchtime..., if yes, stop
@@ -609,8 +620,10 @@ void HyperHdrInstance::update()
 
 	// copy image & process OR copy ledColors from muxer
 	Image<ColorRgb> image = priorityInfo.image;
+	bool imageFrame = (image.width() > 1 || image.height() > 1);
+	auto frameStart = std::chrono::steady_clock::now();
 
-	if (image.width() > 1 || image.height() > 1)
+	if (imageFrame)
 	{
 		emit currentImage(image);
 		_ledBuffer = _imageProcessor->process(image);
@@ -671,6 +684,9 @@ void HyperHdrInstance::update()
 		if  (! _deviceSmooth->enabled())
 		{
 			emit ledDeviceData(_ledBuffer);
+
+			if (imageFrame)
+				CaptureGovernor::reportConsumed(_instIndex);
 		}
 		else
 		{			
@@ -684,6 +700,10 @@ void HyperHdrInstance::update()
 			}
 		}
 	}
+
+	// load of the instance for the adaptive capture governor
+	if (imageFrame)
+		CaptureGovernor::reportProcessed(_instIndex, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - frameStart).count());
 	#if 0
 	else
 	{
@@ -51,6 +51,12 @@ ImageProcessor::ImageProcessor(const LedString& ledString, HyperHdrInstance* hyp
 	, _sparseProcessing(false)
 	, _hyperhdr(hyperhdr)
 	, _instanceIndex(hyperhdr->getInstanceIndex())
+	, _frameSkipThreshold(0)
+	, _frameSkipRefresh(1000)
+	, _lastProcessedTime(0)
+	, _lastColors()
+	, _metricProcessTime(Metrics::histogram("hyperhdr_image_processing_seconds", "Image to LED colors processing time", Metrics::instanceLabel(_instanceIndex)))
+	, _metricSkippedFrames(Metrics::counter("hyperhdr_image_static_frames_total", "Static frames that reused the previous LED colors", Metrics::instanceLabel(_instanceIndex)))
 {
 	// init
 	handleSettingsUpdate(settings::type::COLOR, _hyperhdr->getSetting(settings::type::COLOR));
@@ -61,6 +67,7 @@ ImageProcessor::ImageProcessor(const LedString& ledString, HyperHdrInstance* hyp
 		advanced[i] = i * i;
 
 	ledFrameStat.ledStatBegin = 0;
+	ledFrameStat.skipped = 0;
 }
 
 ImageProcessor::~ImageProcessor()
@@ -81,6 +88,8 @@ void ImageProcessor::handleSettingsUpdate(settings::type type, const QJsonDocume
 
 		bool newSparse = obj["sparse_processing"].toBool(false);
 		setSparseProcessing(newSparse);
+
+		setFrameSkip(obj["frameSkipThreshold"].toInt(0), obj["frameSkipRefresh"].toInt(1000));
 	}
 }
 
@@ -143,6 +152,18 @@ void ImageProcessor::setSparseProcessing(bool sparseProcessing)
 	}
 }
 
+void ImageProcessor::setFrameSkip(int threshold, int refresh)
+{
+	if (_frameSkipThreshold != threshold || _frameSkipRefresh != refresh)
+	{
+		_frameSkipThreshold = threshold;
+		_frameSkipRefresh = refresh;
+		_lastColors.clear();
+
+		Debug(_log, "Static frame detection: %s (threshold: %d, refresh: %dms)", (_frameSkipThreshold > 0) ? "enabled" : "disabled", _frameSkipThreshold, _frameSkipRefresh);
+	}
+}
+
 void ImageProcessor::setLedMappingType(int mapType)
 {
 	int _orgmappingType = _mappingType;
@@ -206,12 +227,14 @@ std::vector<ColorRgb> ImageProcessor::process(const Image<ColorRgb>& image)
 {
 	std::vector<ColorRgb> colors;
 	uint64_t currentTime = QDateTime::currentMSecsSinceEpoch();
+	Metrics::ScopedTimer metricTimer(_metricProcessTime);
 
 	if (ledFrameStat.ledStatBegin == 0 || ledFrameStat.ledStatBegin > currentTime)
 	{
 		ledFrameStat.ledStatBegin = currentTime;
 		ledFrameStat.averageFrame = 0;
 		ledFrameStat.total = 0;
+		ledFrameStat.skipped = 0;
 	}
 
 	long	 diff = currentTime - ledFrameStat.ledStatBegin;
@@ -221,11 +244,26 @@ std::vector<ColorRgb> ImageProcessor::process(const Image<ColorRgb>& image)
 		// Ensure that the buffer-image is the proper size
 		setSize(image);
 
+		// Static frame: none of the led areas changed, reuse the previous colors
+		if (_frameSkipThreshold > 0 && !_imageToLeds->hasChanged(image, _frameSkipThreshold) &&
+			!_lastColors.empty() && currentTime - _lastProcessedTime < (uint64_t)_frameSkipRefresh)
+		{
+			ledFrameStat.skipped++;
+			_metricSkippedFrames->add();
+			return _lastColors;
+		}
+
 		// Check black border detection
 		verifyBorder(image);
 
 		// Create a result vector and call the 'in place' function
-		colors = _imageToLeds->Process(image, advanced);			
+		colors = _imageToLeds->Process(image, advanced);
+
+		if (_frameSkipThreshold > 0)
+		{
+			_lastColors = colors;
+			_lastProcessedTime = currentTime;
+		}
 	}
 	else
 	{
@@ -250,11 +288,20 @@ std::vector<ColorRgb> ImageProcessor::process(const Image<ColorRgb>& image)
 					ledFrameStat.averageFrame / 1000.0,
 					ledFrameStat.total);
 			}
+
+			if (ledFrameStat.skipped > 0)
+			{
+				Debug(_log, "Static frames of instance %i: %d reused, %d processed",
+					_instanceIndex,
+					ledFrameStat.skipped,
+					ledFrameStat.total);
+			}
 		}
 
 		ledFrameStat.ledStatBegin = currentTime;
 		ledFrameStat.averageFrame = 0;
 		ledFrameStat.total = 0;
+		ledFrameStat.skipped = 0;
 	}	
 	// return the computed colors
 	return colors;
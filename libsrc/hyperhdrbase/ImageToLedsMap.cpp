@@ -1,7 +1,10 @@
 #include <hyperhdrbase/ImageToLedsMap.h>
 #include <hyperhdrbase/ImageProcessor.h>
+#include <cstring>
+#include <cstdlib>
 
 #define push_back_index(list, index) list.push_back((index) * 3)
+#define PROBES_PER_LED 16
 
 using namespace hyperhdr;
 
@@ -24,6 +27,7 @@ ImageToLedsMap::ImageToLedsMap(
 	, _colorsGroups()
 	, _groupMin(-1)
 	, _groupMax(-1)
+	, _probeValid(false)
 {
 	// Sanity check of the size of the borders (and width and height)
 	Q_ASSERT(_width  > 2*_verticalBorder);
@@ -49,6 +53,7 @@ ImageToLedsMap::ImageToLedsMap(
 		if ((led.maxX_frac-led.minX_frac) < 1e-6 || (led.maxY_frac-led.minY_frac) < 1e-6)
 		{
 			_colorsMap.emplace_back();
+			_probeLeds.push_back(_probeMap.size());
 			continue;
 		}
 
@@ -154,6 +159,12 @@ ImageToLedsMap::ImageToLedsMap(
 			}
 		}
 
+		// Spread a few probes over the area for the change detection
+		const size_t probeStep = std::max(ledColor.size() / PROBES_PER_LED, (size_t)1);
+		for (size_t i = 0; i < ledColor.size(); i += probeStep)
+			_probeMap.push_back(std::abs(ledColor[i]));
+		_probeLeds.push_back(_probeMap.size());
+
 		// Add the constructed vector to the map
 		_colorsMap.push_back(ledColor);
 
@@ -165,6 +176,8 @@ ImageToLedsMap::ImageToLedsMap(
 
 		totalCount += ledColor.size();
 	}
+	_probeReference.resize(_probeMap.size() * 3);
+
 	Info(_log, "Total index number is: %d. Sparse processing: %s, image size: %d x %d, area number: %d",
 				totalCount, (_sparseProcessing)?"enabled":"disabled", width, height, leds.size()); 
 }
@@ -236,6 +249,49 @@ std::vector<ColorRgb> ImageToLedsMap::Process(const Image<ColorRgb>& image,uint1
 	return colors;
 }
 
+bool ImageToLedsMap::hasChanged(const Image<ColorRgb>& image, int threshold)
+{
+	const uint8_t* imgData = (const uint8_t*)image.memptr();
+
+	if (_probeValid && image.width() == _width && image.height() == _height)
+	{
+		const uint8_t* reference = _probeReference.data();
+		bool changed = false;
+		size_t begin = 0;
+
+		for (size_t end : _probeLeds)
+		{
+			int difference = 0;
+
+			for (size_t i = begin; i < end; i++)
+			{
+				const uint8_t* pixel = imgData + _probeMap[i];
+				const uint8_t* last = reference + i * 3;
+
+				difference += std::abs(pixel[0] - last[0]) + std::abs(pixel[1] - last[1]) + std::abs(pixel[2] - last[2]);
+			}
+
+			if (difference > threshold * 3 * (int)(end - begin))
+			{
+				changed = true;
+				break;
+			}
+
+			begin = end;
+		}
+
+		if (!changed)
+			return false;
+	}
+
+	uint8_t* reference = _probeReference.data();
+	for (size_t i = 0; i < _probeMap.size(); i++, reference += 3)
+		memcpy(reference, imgData + _probeMap[i], 3);
+
+	_probeValid = true;
+	return true;
+}
+
 std::vector<ColorRgb> ImageToLedsMap::getMeanLedColor(const Image<ColorRgb> & image) const
 {
 	std::vector<ColorRgb> ledColors(_colorsMap.size(), ColorRgb{ 0,0,0 });
@@ -5,6 +5,7 @@
 
 #include <hyperhdrbase/LinearColorSmoothing.h>
 #include <hyperhdrbase/HyperHdrInstance.h>
+#include <hyperhdrbase/CaptureGovernor.h>
 
 #include <cmath>
 #include <stdint.h>
@@ -42,8 +43,11 @@ LinearColorSmoothing::LinearColorSmoothing(const QJsonDocument& config, HyperHdr
 	, _smoothingType(SmoothingType::Linear)
 	, _infoUpdate(true)
 	, _infoInput(true)
+	, _newTarget(false)
 	, _timerWatchdog(DEFAULT_WATCHDOG)
 	, debugCounter(0)
+	, _metricUpdateTime(Metrics::histogram("hyperhdr_smoothing_update_seconds", "Smoothing step processing time", Metrics::instanceLabel(hyperhdr->getInstanceIndex())))
+	, _metricFrames(Metrics::counter("hyperhdr_smoothing_frames_total", "Frames sent by the smoothing to the LED device", Metrics::instanceLabel(hyperhdr->getInstanceIndex())))
 {
 	// init cfg 0 (default)
 	addConfig(DEFAUL_SETTLINGTIME, DEFAUL_UPDATEFREQUENCY);
@@ -118,6 +122,7 @@ int LinearColorSmoothing::write(const std::vector<ColorRgb> &ledValues)
 			return 0;
 
 		emit _hyperhdr->ledDeviceData(ledValues);
+		CaptureGovernor::reportConsumed(_hyperhdr->getInstanceIndex());
 			return 0;
 	}
 
@@ -222,6 +227,7 @@ void LinearColorSmoothing::LinearSetup(const std::vector<ColorRgb>& ledValues)
 {
 	_targetTime = QDateTime::currentMSecsSinceEpoch() + _settlingTime;
 	_targetValues = ledValues;
+	_newTarget = true;
 	
 	/////////////////////////////////////////////////////////////////!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!	
 
@@ -344,6 +350,8 @@ void LinearColorSmoothing::LinearSmoothing(bool correction)
 
 void LinearColorSmoothing::updateLeds()
 {	
+	Metrics::ScopedTimer metricTimer(_metricUpdateTime);
+
 	try
 	{
 		_semaphore.acquire();
@@ -365,6 +373,13 @@ void LinearColorSmoothing::updateLeds()
 			LinearSmoothing(false);
 		}
 
+		// a new frame reached the LEDs: demand for the adaptive capture governor
+		if (_newTarget && !_pause)
+		{
+			_newTarget = false;
+			CaptureGovernor::reportConsumed(_hyperhdr->getInstanceIndex());
+		}
+
 		_semaphore.release();
 	}
 	catch (...)
@@ -378,6 +393,7 @@ void LinearColorSmoothing::queueColors(const std::vector<ColorRgb> & ledColors)
 {
 	if (!_pause)
 	{		
+		_metricFrames->add();
 		emit _hyperhdr->ledDeviceData(ledColors);
 	}	
 }
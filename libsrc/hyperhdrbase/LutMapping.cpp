@@ -0,0 +1,193 @@
+#include <hyperhdrbase/LutMapping.h>
+#include <hyperhdrbase/Grabber.h>
+#include <utils/ColorSys.h>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMap>
+#include <QMutexLocker>
+
+#include <new>
+
+#ifndef _WIN32
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+namespace
+{
+	const QString INTERNAL_YUV_KEY = QStringLiteral(":internal-yuv");
+
+	QMutex& mappingsMutex()
+	{
+		static QMutex mutex;
+		return mutex;
+	}
+
+	QMap<QString, std::weak_ptr<LutMapping>>& mappings()
+	{
+		static QMap<QString, std::weak_ptr<LutMapping>> shared;
+		return shared;
+	}
+}
+
+LutMapping::LutMapping()
+	: _size(0)
+	, _mapped(nullptr)
+	, _mappedSize(0)
+{
+}
+
+LutMapping::~LutMapping()
+{
+#ifndef _WIN32
+	if (_mapped != nullptr)
+		munmap(_mapped, _mappedSize);
+#endif
+}
+
+std::shared_ptr<LutMapping> LutMapping::open(const QString& fileName)
+{
+	QFileInfo info(fileName);
+
+	if (!info.isFile())
+		return nullptr;
+
+	// a replaced file has a new timestamp and gets its own mapping
+	const QString key = QString("%1:%2:%3").arg(info.canonicalFilePath()).arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+
+	QMutexLocker locker(&mappingsMutex());
+
+	std::shared_ptr<LutMapping> lut = mappings().value(key).lock();
+	if (lut != nullptr)
+		return lut;
+
+	for (auto it = mappings().begin(); it != mappings().end();)
+	{
+		if (it.value().expired())
+			it = mappings().erase(it);
+		else
+			++it;
+	}
+
+	lut.reset(new LutMapping());
+	if (!lut->map(info.canonicalFilePath()))
+		return nullptr;
+
+	mappings()[key] = lut;
+	return lut;
+}
+
+std::shared_ptr<LutMapping> LutMapping::internalYuvTable()
+{
+	QMutexLocker locker(&mappingsMutex());
+
+	std::shared_ptr<LutMapping> lut = mappings().value(INTERNAL_YUV_KEY).lock();
+	if (lut != nullptr)
+		return lut;
+
+	std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[LUT_FILE_SIZE + 4]);
+	if (buffer == nullptr)
+		return nullptr;
+
+	for (int y = 0; y < 256; y++)
+		for (int u = 0; u < 256; u++)
+			for (int v = 0; v < 256; v++)
+			{
+				uint32_t ind_lutd = LUT_INDEX(y, u, v);
+				ColorSys::yuv2rgb(y, u, v,
+					buffer[ind_lutd],
+					buffer[ind_lutd + 1],
+					buffer[ind_lutd + 2]);
+			}
+
+	lut.reset(new LutMapping());
+	lut->_fileName = INTERNAL_YUV_KEY;
+	lut->_size = LUT_FILE_SIZE;
+	lut->_tables.push_back(std::move(buffer));
+
+	mappings()[INTERNAL_YUV_KEY] = lut;
+	return lut;
+}
+
+bool LutMapping::map(const QString& fileName)
+{
+	QFile file(fileName);
+
+	if (!file.open(QIODevice::ReadOnly) || file.size() <= 0)
+		return false;
+
+	_fileName = fileName;
+	_size = file.size();
+	_tables.resize(tableCount());
+
+#ifndef _WIN32
+	// reserve the file size and one guard page, then map the file over the start of it
+	const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+	const size_t reserved = (size_t)_size + pageSize;
+
+	void* region = mmap(nullptr, reserved, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (region == MAP_FAILED)
+		return false;
+
+	if (mmap(region, (size_t)_size, PROT_READ, MAP_SHARED | MAP_FIXED, file.handle(), 0) == MAP_FAILED)
+	{
+		munmap(region, reserved);
+		return false;
+	}
+
+	_mapped = (uint8_t*)region;
+	_mappedSize = reserved;
+
+	#ifdef MADV_HUGEPAGE
+		madvise(_mapped, (size_t)_size, MADV_HUGEPAGE);
+	#endif
+#endif
+
+	return true;
+}
+
+const uint8_t* LutMapping::table(int index)
+{
+	if (index < 0 || index >= tableCount())
+		return nullptr;
+
+	if (_mapped != nullptr)
+	{
+		uint8_t* data = _mapped + (size_t)index * LUT_FILE_SIZE;
+
+#ifndef _WIN32
+		madvise(data, LUT_FILE_SIZE, MADV_WILLNEED);
+#endif
+
+		return data;
+	}
+
+	// no mmap: every table is read once on first use and shared from the heap
+	QMutexLocker locker(&_tablesMutex);
+
+	if (_tables[index] == nullptr)
+	{
+		QFile file(_fileName);
+		std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[LUT_FILE_SIZE + 4]);
+
+		if (buffer == nullptr || !file.open(QIODevice::ReadOnly) || !file.seek((qint64)index * LUT_FILE_SIZE) ||
+			file.read((char*)buffer.get(), LUT_FILE_SIZE) != LUT_FILE_SIZE)
+			return nullptr;
+
+		_tables[index] = std::move(buffer);
+	}
+
+	return _tables[index].get();
+}
+
+qint64 LutMapping::size() const
+{
+	return _size;
+}
+
+int LutMapping::tableCount() const
+{
+	return (int)(_size / LUT_FILE_SIZE);
+}
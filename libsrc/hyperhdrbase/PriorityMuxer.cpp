@@ -31,6 +31,8 @@ PriorityMuxer::PriorityMuxer(int instanceIndex, int ledCount, QObject * parent)
 	, _blockTimer(new QTimer(this))
 	, _startTime(QTime::currentTime().addSecs(3))
 	, _startWarning(false)
+	, _metricInputFrames(Metrics::counter("hyperhdr_muxer_input_frames_total", "Colors and images received by the priority muxer", Metrics::instanceLabel(instanceIndex)))
+	, _metricPriorityChanges(Metrics::counter("hyperhdr_muxer_priority_changes_total", "Changes of the visible priority", Metrics::instanceLabel(instanceIndex)))
 {	
 	// init lowest priority info
 	_lowestPriorityInfo.priority       = PriorityMuxer::LOWEST_PRIORITY;
@@ -183,6 +185,8 @@ bool PriorityMuxer::setInput(int priority, const std::vector<ColorRgb>& ledColor
 		return false;
 	}
 
+	_metricInputFrames->add();
+
 	// calc final timeout
 	if(timeout_ms > 0)
 		timeout_ms = QDateTime::currentMSecsSinceEpoch() + timeout_ms;
@@ -227,6 +231,8 @@ bool PriorityMuxer::setInputImage(int priority, const Image<ColorRgb>& image, in
 		return false;
 	}
 
+	_metricInputFrames->add();
+
 	// calculate final timeout
 	if(timeout_ms > 0)
 		timeout_ms = QDateTime::currentMSecsSinceEpoch() + timeout_ms;
@@ -383,6 +389,7 @@ void PriorityMuxer::setCurrentTime()
 		_previousPriority = _currentPriority;
 		_currentPriority = newPriority;
 		Info(_log, "Set visible priority to %d", newPriority);
+		_metricPriorityChanges->add();
 		emit visiblePriorityChanged(newPriority);
 		// check for visible comp change
 		if (comp != _prevVisComp)
@@ -185,6 +185,11 @@ bool SettingsManager::saveSettings(QJsonObject config, bool correct)
 	}
 
 	int rc = true;
+	QStringList changedKeys;
+
+	// all records are written in one transaction
+	bool transaction = _sTable->startTransaction();
+
 	// compare database data with new data to emit/save changes accordingly
 	for(const auto & key : keyList)
 	{
@@ -199,10 +204,19 @@ bool SettingsManager::saveSettings(QJsonObject config, bool correct)
 			}
 			else
 			{
-				emit settingsChanged(settings::stringToType(key), QJsonDocument::fromJson(data.toUtf8()));
+				changedKeys << key;
 			}
 		}
-	}	
+	}
+
+	// the cache is updated only when the commit succeeds
+	if (transaction && !_sTable->commitTransaction())
+		return false;
+
+	// the documents come already parsed from the settings cache
+	for (const auto & key : changedKeys)
+		emit settingsChanged(settings::stringToType(key), _sTable->getSettingsRecord(key));
+
 	return rc;
 }
 
@@ -214,6 +228,6 @@ void SettingsManager::saveSetting(settings::type key, QString saveData)
 	}
 	else
 	{
-		emit settingsChanged(key, QJsonDocument::fromJson(saveData.toUtf8()));
+		emit settingsChanged(key, _sTable->getSettingsRecord(settings::typeToString(key)));
 	}
 }
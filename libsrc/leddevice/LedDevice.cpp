@@ -8,13 +8,24 @@
 #include <QEventLoop>
 #include <QTimer>
 #include <QDateTime>
+#include <QThread>
 
 #include <hyperhdrbase/HyperHdrInstance.h>
 #include <utils/JsonUtils.h>
+#include <utils/ThreadTopology.h>
 
 //std includes
 #include <sstream>
 #include <iomanip>
+#include <chrono>
+
+namespace
+{
+	int64_t nowMicroseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
 
 LedDevice::LedDevice(const QJsonObject& deviceConfig, QObject* parent)
 	: QObject(parent)
@@ -34,13 +45,29 @@ LedDevice::LedDevice(const QJsonObject& deviceConfig, QObject* parent)
 	  , _isBlackScreen (false)
 	  , _lastWriteTime(QDateTime::currentDateTime())
 	  , _isRefreshEnabled (false)
-	  , _semaphore(1)
+	  , _writeRequested(false)
 	  , _frames(0)
 	  , _incomingframes(0)
 	  , _framesBegin(QDateTime::currentMSecsSinceEpoch())
+	  , _droppedFrames(0)
+	  , _lateWrites(0)
+	  , _writeTimeTotal_us(0)
+	  , _writeTimeMax_us(0)
+	  , _lastWriteBegin_us(0)
+	  , _metricFrames(nullptr)
+	  , _metricDroppedFrames(nullptr)
+	  , _metricLateWrites(nullptr)
+	  , _metricWriteTime(nullptr)
 {
 	_activeDeviceType = deviceConfig["type"].toString("UNSPECIFIED").toLower();
 
+	// the instance index is injected by HyperHdrInstance, two instances may drive devices of the same type
+	_metricLabels = QString("%1,device=\"%2\"").arg(Metrics::instanceLabel(deviceConfig["instance"].toInt(0))).arg(_activeDeviceType);
+	_metricFrames = Metrics::counter("hyperhdr_led_frames_total", "Frames written to the LED device", _metricLabels);
+	_metricDroppedFrames = Metrics::counter("hyperhdr_led_dropped_frames_total", "Frames replaced by a newer one before they were written", _metricLabels);
+	_metricLateWrites = Metrics::counter("hyperhdr_led_late_writes_total", "Paced writes that missed their slot", _metricLabels);
+	_metricWriteTime = Metrics::histogram("hyperhdr_led_write_seconds", "Time spent writing a frame to the LED device", _metricLabels);
+
 	connect(this, &LedDevice::manualUpdate, this, &LedDevice::rewriteLEDs);
 }
 
@@ -62,6 +89,8 @@ void LedDevice::start()
 		connect(_refreshTimer, &QTimer::timeout, this, &LedDevice::rewriteLEDs );
 	}
 
+	setupOutputThread(_devConfig);
+
 	close();
 
 	_isDeviceInitialised = false;
@@ -183,10 +212,24 @@ void LedDevice::startRefreshTimer()
 	if ( _isDeviceReady && _isEnabled && _refreshTimerInterval_ms > 0)
 	{
 		Debug(_log, "Starting timer with interval = %ims", _refreshTimer->interval());
+		// the first paced write after a restart has no previous slot to be late for
+		_lastWriteBegin_us = 0;
 		_refreshTimer->start();
 	}
 }
 
+void LedDevice::setupOutputThread(const QJsonObject& deviceConfig)
+{
+	ThreadTopology::registerCurrentThread(ThreadTopology::Role::LED_OUTPUT, QString("LedOut:%1").arg(_activeDeviceType));
+
+	bool realtime = deviceConfig["realtimePriority"].toBool(false);
+	int cpu = deviceConfig["cpuAffinity"].toInt(-1);
+
+	// the output thread is placed by the device configuration
+	if (realtime || cpu >= 0)
+		ThreadTopology::placeCurrentThread(cpu, (realtime) ? ThreadTopology::Priority::REALTIME : ThreadTopology::Priority::NORMAL);
+}
+
 void LedDevice::stopRefreshTimer()
 {
 	if ( _refreshTimer != nullptr )
@@ -202,12 +245,17 @@ int LedDevice::updateLeds(const std::vector<ColorRgb>& ledValues)
 
 	if (currentTime - _framesBegin >= 1000 * 60)
 	{
+		int32_t frames = _frames.exchange(0);
+		int64_t writeTimeTotal = _writeTimeTotal_us.exchange(0);
 
 		Info(_log, "LED refresh rate %.2f Hz (total written frames: %i, incoming: %i, interval: %.2fs). %s",
-			_frames / 60.0, _frames, _incomingframes, int(currentTime - _framesBegin) / 1000.0,
+			frames / 60.0, frames, _incomingframes, int(currentTime - _framesBegin) / 1000.0,
 			(_refreshTimer->isActive())?"Buffer timer is active, because the refresh timer is set by the user or by default.":"Buffer timer is disabled (refresh time = 0). Direct writes.");
 
-		_frames = 0;
+		Info(_log, "LED write time avg: %.2fms, max: %.2fms. Late writes: %i, dropped intermediate frames: %i",
+			(frames > 0) ? writeTimeTotal / (frames * 1000.0) : 0.0, _writeTimeMax_us.exchange(0) / 1000.0,
+			_lateWrites.exchange(0), _droppedFrames.exchange(0));
+
 		_incomingframes = 0;
 		_framesBegin = currentTime;
 	}
@@ -220,12 +268,17 @@ int LedDevice::updateLeds(const std::vector<ColorRgb>& ledValues)
 	}
 	else
 	{
-		_semaphore.acquire();		
-		_lastLedValues = ledValues;
-		_semaphore.release();
+		// single producer: the frame is handed over to the output thread without locking, latest wins
+		_ledMailbox.back() = ledValues;
+		if (_ledMailbox.publish())
+		{
+			_droppedFrames++;
+			_metricDroppedFrames->add();
+		}
 
-		if (!_refreshTimer->isActive())		
-			emit manualUpdate();		
+		// only one pending write is queued on the output thread, it always picks up the newest frame
+		if (!_refreshTimer->isActive() && !_writeRequested.exchange(true))
+			emit manualUpdate();
 	}
 	
 	return 0;
@@ -235,18 +288,37 @@ int LedDevice::rewriteLEDs()
 {
 	int retval = -1;
 
+	_writeRequested = false;
+
 	if ( _isDeviceReady && _isEnabled)
-	{				
-		_semaphore.acquire();
-		std::vector<ColorRgb> copy = _lastLedValues;
-		_semaphore.release();
+	{
+		if (_ledMailbox.update())
+			_lastLedValues = _ledMailbox.front();
 
-		if (copy.size()>0 && !(!_isEnabled || (!_isOn && !_isBlackScreen) || !_isDeviceReady || _isDeviceInError))
-			retval = write(copy);
+		int64_t writeBegin = nowMicroseconds();
+
+		// a paced write is late if it misses its slot by more than half of the refresh interval
+		if (_refreshTimer->isActive() && _lastWriteBegin_us > 0 &&
+			writeBegin - _lastWriteBegin_us > _refreshTimerInterval_ms * 1500LL)
+		{
+			_lateWrites++;
+			_metricLateWrites->add();
+		}
+		_lastWriteBegin_us = writeBegin;
+
+		if (_lastLedValues.size()>0 && !(!_isEnabled || (!_isOn && !_isBlackScreen) || !_isDeviceReady || _isDeviceInError))
+			retval = write(_lastLedValues);
+
+		int64_t writeTime = nowMicroseconds() - writeBegin;
+		_writeTimeTotal_us += writeTime;
+		int64_t writeTimeMax = _writeTimeMax_us;
+		while (writeTime > writeTimeMax && !_writeTimeMax_us.compare_exchange_weak(writeTimeMax, writeTime));
+		_metricWriteTime->observe((uint64_t)writeTime);
 
 		_lastWriteTime = QDateTime::currentDateTime();
 
-		_frames++;					
+		_frames++;
+		_metricFrames->add();
 	}
 	else
 	{
@@ -261,13 +333,10 @@ int LedDevice::writeBlack(int numberOfBlack)
 	int rc = -1;
 
 	for (int i = 0; i < numberOfBlack; i++)
-	{		
-		_semaphore.acquire();
-		std::vector<ColorRgb> copy = std::vector<ColorRgb>(static_cast<unsigned long>(_ledCount), ColorRgb::BLACK );
-		_lastLedValues = copy;
-		_semaphore.release();
+	{
+		_lastLedValues = std::vector<ColorRgb>(static_cast<unsigned long>(_ledCount), ColorRgb::BLACK );
 
-		rc = write(copy);
+		rc = write(_lastLedValues);
 	}
 	return rc;
 }
@@ -0,0 +1,125 @@
+#ifdef _WIN32
+#include <winsock.h>
+#else
+#include <arpa/inet.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// hyperhdr local includes
+#include "E131Encoder.h"
+
+namespace
+{
+	const uint8_t ACN_ID[12] = { 0x41, 0x53, 0x43, 0x2d, 0x45, 0x31, 0x2e, 0x31, 0x37, 0x00, 0x00, 0x00 };
+}
+
+/* defined parameters from http://tsp.esta.org/tsp/documents/docs/BSR_E1-31-20xx_CP-2014-1009r2.pdf */
+const uint32_t VECTOR_ROOT_E131_DATA = 0x00000004;
+//#define VECTOR_ROOT_E131_EXTENDED               0x00000008
+const uint8_t VECTOR_DMP_SET_PROPERTY = 0x02;
+const uint32_t VECTOR_E131_DATA_PACKET = 0x00000002;
+//#define VECTOR_E131_EXTENDED_SYNCHRONIZATION    0x00000001
+//#define VECTOR_E131_EXTENDED_DISCOVERY          0x00000002
+//#define VECTOR_UNIVERSE_DISCOVERY_UNIVERSE_LIST 0x00000001
+//#define E131_E131_UNIVERSE_DISCOVERY_INTERVAL   10         // seconds
+//#define E131_NETWORK_DATA_LOSS_TIMEOUT          2500       // milli econds
+//#define E131_DISCOVERY_UNIVERSE                 64214
+const int DMX_MAX = 512; // 512 usable slots
+
+E131Encoder::E131Encoder()
+	: _dmxChannelCount(0)
+	, _sequence(0)
+	, _universe(1)
+{
+}
+
+void E131Encoder::setup(const QUuid& cid, const QString& sourceName, uint8_t universe)
+{
+	_cid = cid.toRfc4122();
+	_sourceName = sourceName.toUtf8();
+	_universe = universe;
+
+	// the headers are generated again by the next frame
+	_dmxChannelCount = 0;
+	_packets.clear();
+	_channelCounts.clear();
+}
+
+int E131Encoder::encode(const std::vector<ColorRgb>& ledValues)
+{
+	const unsigned dmxChannelCount = static_cast<unsigned>(ledValues.size() * sizeof(ColorRgb));
+	const uint8_t* rawdata = reinterpret_cast<const uint8_t*>(ledValues.data());
+
+	if (dmxChannelCount != _dmxChannelCount)
+	{
+		_dmxChannelCount = dmxChannelCount;
+
+		const size_t packets = (dmxChannelCount + DMX_MAX - 1) / DMX_MAX;
+		_packets.resize(packets);
+		_channelCounts.resize(packets);
+
+		for (size_t i = 0; i < packets; i++)
+		{
+			_channelCounts[i] = std::min<unsigned>(dmxChannelCount - static_cast<unsigned>(i) * DMX_MAX, DMX_MAX);
+			prepare(_packets[i], _universe + static_cast<unsigned>(i), _channelCounts[i]);
+		}
+	}
+
+	_sequence++;
+
+	for (size_t i = 0; i < _packets.size(); i++)
+	{
+		_packets[i].sequence_number = _sequence;
+		memcpy(&_packets[i].property_values[1], rawdata + i * DMX_MAX, _channelCounts[i]);
+	}
+
+	return static_cast<int>(_packets.size());
+}
+
+const uint8_t* E131Encoder::packet(int index) const
+{
+	return _packets[index].raw;
+}
+
+unsigned E131Encoder::packetSize(int index) const
+{
+	return E131_DMP_DATA + 1 + _channelCounts[index];
+}
+
+// populates the headers
+void E131Encoder::prepare(e131_packet_t& packet, unsigned this_universe, unsigned this_dmxChannelCount) const
+{
+	memset(packet.raw, 0, sizeof(packet.raw));
+
+	/* Root Layer */
+	packet.preamble_size = htons(16);
+	packet.postamble_size = 0;
+	memcpy (packet.acn_id, ACN_ID, 12);
+	packet.root_flength = htons(0x7000 | (110+this_dmxChannelCount) );
+	packet.root_vector = htonl(VECTOR_ROOT_E131_DATA);
+	memcpy (packet.cid, _cid.constData(), std::min<size_t>(sizeof(packet.cid), _cid.size()) );
+
+	/* Frame Layer */
+	packet.frame_flength = htons(0x7000 | (88+this_dmxChannelCount));
+	packet.frame_vector = htonl(VECTOR_E131_DATA_PACKET);
+	snprintf (packet.source_name, sizeof(packet.source_name), "%s", _sourceName.constData() );
+	packet.priority = 100;
+	packet.reserved = htons(0);
+	packet.options = 0;	// Bit 7 =  Preview_Data
+					// Bit 6 =  Stream_Terminated
+					// Bit 5 = Force_Synchronization
+	packet.universe = htons(this_universe);
+
+	/* DMX Layer */
+	packet.dmp_flength = htons(0x7000 | (11+this_dmxChannelCount));
+	packet.dmp_vector = VECTOR_DMP_SET_PROPERTY;
+	packet.type = 0xa1;
+	packet.first_address = htons(0);
+	packet.address_increment = htons(1);
+	packet.property_value_count = htons(1+this_dmxChannelCount);
+
+	packet.property_values[0] = 0;	// start code
+}
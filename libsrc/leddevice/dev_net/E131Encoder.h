@@ -0,0 +1,127 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+#include <vector>
+
+// Qt includes
+#include <QByteArray>
+#include <QString>
+#include <QUuid>
+
+// HyperHDR includes
+#include <utils/ColorRgb.h>
+
+/**
+ *
+ * https://raw.githubusercontent.com/forkineye/ESPixelStick/master/_E131.h
+ * Project: E131 - E.131 (sACN) library for Arduino
+ * Copyright (c) 2015 Shelby Merrick
+ * http://www.forkineye.com
+ *
+ *  This program is provided free for you to use in any way that you wish,
+ *  subject to the laws and regulations where you are using it.  Due diligence
+ *  is strongly suggested before using this code.  Please give credit where due.
+ *
+ **/
+
+/* E1.31 Packet Offsets */
+//#define E131_ROOT_PREAMBLE_SIZE 0
+//#define E131_ROOT_POSTAMBLE_SIZE 2
+//#define E131_ROOT_ID 4
+//#define E131_ROOT_FLENGTH 16
+//#define E131_ROOT_VECTOR 18
+//#define E131_ROOT_CID 22
+
+//#define E131_FRAME_FLENGTH 38
+//#define E131_FRAME_VECTOR 40
+//#define E131_FRAME_SOURCE 44
+//#define E131_FRAME_PRIORITY 108
+//#define E131_FRAME_RESERVED 109
+//#define E131_FRAME_SEQ 111
+//#define E131_FRAME_OPT 112
+//#define E131_FRAME_UNIVERSE 113
+
+//#define E131_DMP_FLENGTH 115
+//#define E131_DMP_VECTOR 117
+//#define E131_DMP_TYPE 118
+//#define E131_DMP_ADDR_FIRST 119
+//#define E131_DMP_ADDR_INC 121
+//#define E131_DMP_COUNT 123
+const unsigned int E131_DMP_DATA=125;
+
+/* E1.31 Packet Structure */
+typedef union
+{
+#pragma pack(push, 1)
+	struct
+	{
+		/* Root Layer */
+		uint16_t preamble_size;
+		uint16_t postamble_size;
+		uint8_t  acn_id[12];
+		uint16_t root_flength;
+		uint32_t root_vector;
+		char     cid[16];
+
+		/* Frame Layer */
+		uint16_t frame_flength;
+		uint32_t frame_vector;
+		char     source_name[64];
+		uint8_t  priority;
+		uint16_t reserved;
+		uint8_t  sequence_number;
+		uint8_t  options;
+		uint16_t universe;
+
+		/* DMP Layer */
+		uint16_t dmp_flength;
+		uint8_t  dmp_vector;
+		uint8_t  type;
+		uint16_t first_address;
+		uint16_t address_increment;
+		uint16_t property_value_count;
+		uint8_t  property_values[513];
+	};
+#pragma pack(pop)
+
+	uint8_t raw[638];
+} e131_packet_t;
+
+///
+/// Builds the E1.31 packets of a frame, one per universe of 512 channels.
+/// The headers are generated only when the configuration or the number of channels changes,
+/// a frame only updates the sequence number and copies the channel data.
+///
+class E131Encoder
+{
+public:
+	E131Encoder();
+
+	///
+	/// @brief Set the identity of the sender and the first universe
+	///
+	void setup(const QUuid& cid, const QString& sourceName, uint8_t universe);
+
+	///
+	/// @brief Encode the colors of a frame
+	///
+	/// @param[in] ledValues The RGB-color per LED
+	/// @return The number of packets of the frame
+	///
+	int encode(const std::vector<ColorRgb>& ledValues);
+
+	const uint8_t* packet(int index) const;
+	unsigned packetSize(int index) const;
+
+private:
+	void prepare(e131_packet_t& packet, unsigned universe, unsigned dmxChannelCount) const;
+
+	std::vector<e131_packet_t>	_packets;
+	std::vector<unsigned>		_channelCounts;
+	unsigned					_dmxChannelCount;
+	uint8_t						_sequence;
+	uint8_t						_universe;
+	QByteArray					_cid;
+	QByteArray					_sourceName;
+};
@@ -4,6 +4,14 @@
 
 #include <chrono>
 
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <linux/sockios.h>
+#endif
+
 // https://docs.microsoft.com/en-us/windows/win32/winprog/windows-data-types#ssize-t
 #if defined(_MSC_VER)
 #include <BaseTsd.h>
@@ -13,11 +21,14 @@ typedef SSIZE_T ssize_t;
 // Constants
 namespace {
 constexpr std::chrono::milliseconds CONNECT_TIMEOUT{1000};
+constexpr std::chrono::milliseconds WRITE_TIMEOUT{1000};
 
 const int MAX_NUM_LEDS = 10000; // OPC can handle 21845 LEDs - in theory, fadecandy device should handle 10000 LEDs
 const int OPC_SET_PIXELS = 0; // OPC command codes
 const int OPC_SYS_EX = 255; // OPC command codes
 const int OPC_HEADER_SIZE = 4; // OPC header size
+const int SEND_BUFFER_FRAMES = 4; // system send buffer size in frames, bounds the latency on a slow link
+const int MIN_SEND_BUFFER_SIZE = 16384;
 } //End of constants
 
 // TCP elements
@@ -28,7 +39,17 @@ LedDeviceFadeCandy::LedDeviceFadeCandy(const QJsonObject& deviceConfig)
 	  , _client(nullptr)
 	  , _host()
 	  , _port(STREAM_DEFAULT_PORT)
+	  , _framePending(false)
+	  , _transferActive(false)
+	  , _metricQueuedBytes(nullptr)
+	  , _metricRtt(nullptr)
+	  , _metricStaleFrames(nullptr)
+	  , _metricTransferTime(nullptr)
 {
+	_metricQueuedBytes = Metrics::gauge("hyperhdr_led_opc_queued_bytes", "Bytes queued in the socket or in flight to the OPC server", _metricLabels);
+	_metricRtt = Metrics::gauge("hyperhdr_led_opc_rtt_seconds", "Smoothed TCP round trip time to the OPC server", _metricLabels);
+	_metricStaleFrames = Metrics::counter("hyperhdr_led_opc_stale_frames_total", "Frames replaced by a newer one while the socket was backed up", _metricLabels);
+	_metricTransferTime = Metrics::histogram("hyperhdr_led_opc_transfer_seconds", "Time until a frame has left the socket queue", _metricLabels);
 }
 
 LedDeviceFadeCandy::~LedDeviceFadeCandy()
@@ -107,6 +128,7 @@ bool LedDeviceFadeCandy::initNetwork()
 	if (_client == nullptr)
 	{
 		_client = new QTcpSocket(this);
+		connect(_client, &QTcpSocket::bytesWritten, this, &LedDeviceFadeCandy::handleBytesWritten);
 		isInitOK = true;
 	}
 	return isInitOK;
@@ -137,10 +159,17 @@ int LedDeviceFadeCandy::close()
 {
 	int retval = 0;
 	_isDeviceReady = false;
+	_framePending = false;
+	_transferActive = false;
 
 	// LedDevice specific closing activities
 	if (_client != nullptr)
 	{
+		// the last frame (black on switch off) is still queued, deliver it before the socket is closed
+		if (isConnected() && _client->bytesToWrite() > 0)
+		{
+			_client->waitForBytesWritten(WRITE_TIMEOUT.count());
+		}
 		_client->close();
 		// Everything is OK -> device is closed
 	}
@@ -166,6 +195,7 @@ bool LedDeviceFadeCandy::tryConnect()
 			if (_client->waitForConnected(CONNECT_TIMEOUT.count()))
 			{
 				Info(_log, "fadecandy/opc: connected to %s:%d on channel %d", QSTRING_CSTR(_host), _port, _channel);
+				setupSocket();
 				if (_setFcConfig)
 				{
 					sendFadeCandyConfiguration();
@@ -187,15 +217,98 @@ int LedDeviceFadeCandy::write(const std::vector<ColorRgb>& ledValues)
 		idx += 3;
 	}
 
+	if (!isConnected() && !tryConnect())
+	{
+		return -1;
+	}
+
+	// the previous frame is still queued: keep only the newest one, it is sent when the queue drains.
+	// The switch off frame is always queued, the device may be closed before the queue drains.
+	if (_client->bytesToWrite() > 0 && !_isInSwitchOff)
+	{
+		if (_framePending)
+		{
+			_metricStaleFrames->add();
+		}
+		_framePending = true;
+		updateQueueMetrics();
+		return 0;
+	}
+
 	int retval = transferData() < 0 ? -1 : 0;
 	return retval;
 }
 
+void LedDeviceFadeCandy::handleBytesWritten(qint64 /*bytes*/)
+{
+	if (_client == nullptr || _client->bytesToWrite() > 0)
+	{
+		return;
+	}
+
+	if (_transferActive)
+	{
+		_transferActive = false;
+		_metricTransferTime->observe(_transferBegin);
+	}
+
+	if (_framePending && isConnected())
+	{
+		transferData();
+	}
+	else
+	{
+		updateQueueMetrics();
+	}
+}
+
+void LedDeviceFadeCandy::setupSocket()
+{
+	_framePending = false;
+	_transferActive = false;
+
+	_client->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+	_client->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, qMax(_opc_data.size() * SEND_BUFFER_FRAMES, MIN_SEND_BUFFER_SIZE));
+}
+
+void LedDeviceFadeCandy::updateQueueMetrics()
+{
+	qint64 queued = _client->bytesToWrite();
+
+#if defined(__linux__)
+	const int fd = static_cast<int>(_client->socketDescriptor());
+	if (fd >= 0)
+	{
+		// sent but not acknowledged yet, or still waiting in the system send buffer
+		int inFlight = 0;
+		if (ioctl(fd, SIOCOUTQ, &inFlight) == 0)
+		{
+			queued += inFlight;
+		}
+
+		struct tcp_info info;
+		socklen_t length = sizeof(info);
+		if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &length) == 0)
+		{
+			_metricRtt->set(info.tcpi_rtt / 1000000.0);
+		}
+	}
+#endif
+
+	_metricQueuedBytes->set(static_cast<double>(queued));
+}
+
 qint64 LedDeviceFadeCandy::transferData()
 {
 	if (isConnected() || tryConnect())
 	{
-		return _client->write(_opc_data);
+		_framePending = false;
+		_transferActive = true;
+		_transferBegin = std::chrono::steady_clock::now();
+
+		qint64 written = _client->write(_opc_data);
+		updateQueueMetrics();
+		return written;
 	}
 	return -2;
 }
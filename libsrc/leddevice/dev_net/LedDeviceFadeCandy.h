@@ -5,6 +5,8 @@
 #include <QTcpSocket>
 #include <QString>
 
+#include <chrono>
+
 // LedDevice includes
 #include <leddevice/LedDevice.h>
 
@@ -86,6 +88,14 @@ protected:
 	///
 	int write(const std::vector<ColorRgb>& ledValues) override;
 
+private slots:
+	///
+	/// @brief The socket has handed data over to the system: sends the newest pending frame once the queue is empty
+	///
+	/// @param[in] bytes amount of bytes written
+	///
+	void handleBytesWritten(qint64 bytes);
+
 private:
 
 	///
@@ -108,6 +118,16 @@ private:
 	///
 	bool isConnected() const;
 
+	///
+	/// @brief Enable TCP_NODELAY and limit the system send buffer to a few frames
+	///
+	void setupSocket();
+
+	///
+	/// @brief Update the queue depth and round trip time metrics
+	///
+	void updateQueueMetrics();
+
 	///
 	/// @brief Transfer current opc_data buffer to opc server
 	///
@@ -145,6 +165,16 @@ private:
 	bool        _noInterp;
 	bool        _manualLED;
 	bool        _ledOnOff;
+
+	// backpressure: a frame is written only when the previous one has left the socket queue
+	bool        _framePending;
+	bool        _transferActive;
+	std::chrono::steady_clock::time_point _transferBegin;
+
+	Metrics::Gauge*     _metricQueuedBytes;
+	Metrics::Gauge*     _metricRtt;
+	Metrics::Counter*   _metricStaleFrames;
+	Metrics::Histogram* _metricTransferTime;
 };
 
 #endif // LEDEVICEFADECANDY_H
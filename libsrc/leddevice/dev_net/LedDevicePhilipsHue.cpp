@@ -327,6 +327,13 @@ bool LedDevicePhilipsHueBridge::initRestAPI(const QString &hostname, int port, c
 		//Base-path is api-path + authentication token (here username)
 		_restApi->setBasePath( QString(API_BASE_PATH).arg(token) );
 
+		connect(_restApi, &ProviderRestApi::asyncFinished, this, [this](const QString& key, const httpResponse& response) {
+			if (response.error())
+				Warning(_log, "Asynchronous request for '%s' failed: %s", QSTRING_CSTR(key), QSTRING_CSTR(response.getErrorReason()));
+			else
+				checkApiError(response.getBody());
+		});
+
 		isInitOK = true;
 	}
 
@@ -612,6 +619,12 @@ void LedDevicePhilipsHueBridge::setLightState(unsigned int lightId, const QStrin
 	post( QString("%1/%2/%3").arg( API_LIGHTS ).arg( lightId ).arg( API_STATE ), state, wait);
 }
 
+void LedDevicePhilipsHueBridge::setLightStateAsync(unsigned int lightId, const QString &state)
+{
+	DebugIf( verbose, _log, "SetLightStateAsync [%u]: %s", lightId, QSTRING_CSTR(state) );
+	_restApi->putAsync( QString("%1/%2/%3").arg( API_LIGHTS ).arg( lightId ).arg( API_STATE ), state );
+}
+
 QJsonDocument LedDevicePhilipsHueBridge::getGroupState(unsigned int groupId)
 {
 	DebugIf( verbose, _log, "GetGroupState [%u]", groupId );
@@ -883,8 +896,6 @@ LedDevicePhilipsHue::LedDevicePhilipsHue(const QJsonObject& deviceConfig)
 	  , _handshake_timeout_max(1000)
 	  , _stopConnection(false)
 	  , _semaphore(1)
-      , _lastConfirm(0)
-	  , _lastId(-1)
 	  , _groupStreamState(false)
 {
 }
@@ -1593,36 +1604,16 @@ void LedDevicePhilipsHue::setState(PhilipsHueLight& light, bool on, const CiColo
 
 	if ( !stateCmd.isEmpty() || !powerCmd.isEmpty())
 	{
-		bool wait = false;
-
 		if (!stateCmd.isEmpty())
 		{
 			stateCmd = QString("\"%1\":%2").arg(API_STATE_ON, "true") + "," + stateCmd;
 			stateCmd = stateCmd.left(stateCmd.length() - 1);
+			setLightStateAsync( light.getId(), "{" + stateCmd + "}");
 		}
 
-		_semaphore.acquire();
-
-		uint64_t _currentTime = QDateTime::currentMSecsSinceEpoch();
-
-		if ((_currentTime - _lastConfirm > 1500 && ((int) light.getId()) != _lastId) ||
-			(_currentTime - _lastConfirm > 3000))
-		{
-			_lastId = light.getId();
-			_lastConfirm = _currentTime;
-			wait = true;
-		}
-
-		_semaphore.release();
-
-		if (!stateCmd.isEmpty())
-			setLightState( light.getId(), "{" + stateCmd + "}", wait);
-
+		// supersedes the color update if it is still pending
 		if (!powerCmd.isEmpty() && !on)
-		{
-			QThread::msleep(50);
-			setLightState(light.getId(), "{" + powerCmd + "}");
-		}
+			setLightStateAsync( light.getId(), "{" + powerCmd + "}");
 	}
 }
 
@@ -1652,7 +1643,11 @@ bool LedDevicePhilipsHue::powerOn(bool wait)
 bool LedDevicePhilipsHue::powerOff()
 {
 	if ( _isDeviceReady)
-	{		
+	{
+		// pending color updates must not switch the lights on again
+		if (_restApi != nullptr)
+			_restApi->clearAsyncQueue();
+
 		//Switch off Philips Hue devices physically
 		for ( PhilipsHueLight& light : _lights )
 		{
@@ -258,6 +258,14 @@ public:
 	QJsonDocument getLightState(unsigned int lightId);
 	void setLightState(unsigned int lightId = 0, const QString &state = "", bool wait = true);
 
+	///
+	/// @brief Queue a light state update without blocking. A pending update of the same light is replaced (latest wins).
+	///
+	/// @param lightId the light to update.
+	/// @param state the content of the PUT request.
+	///
+	void setLightStateAsync(unsigned int lightId, const QString &state);
+
 	QMap<quint16,QJsonObject> getLightMap() const;
 
 	QMap<quint16,QJsonObject> getGroupMap() const;
@@ -587,7 +595,5 @@ private:
 	QString		_streamOwner;
 	
 	QSemaphore	_semaphore;
-	uint64_t	_lastConfirm;
-	int			_lastId;
 	bool		_groupStreamState;
 };
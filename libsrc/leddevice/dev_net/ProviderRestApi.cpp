@@ -14,6 +14,10 @@ namespace {
 
 const QChar ONE_SLASH = '/';
 
+const int DEFAULT_ASYNC_MAX_IN_FLIGHT = 2;
+const int DEFAULT_ASYNC_REQUESTS_PER_SECOND = 10;
+const int DEFAULT_TIMEOUT_MS = 5000;
+
 } //End of constants
 
 ProviderRestApi::ProviderRestApi(const QString &host, int port, const QString &basePath)
@@ -21,8 +25,18 @@ ProviderRestApi::ProviderRestApi(const QString &host, int port, const QString &b
 	  ,_scheme("http")
 	  ,_hostname(host)
 	  ,_port(port)
+	  ,_timeout(DEFAULT_TIMEOUT_MS)
+	  ,_asyncTimer(new QTimer(this))
+	  ,_asyncInFlight(0)
+	  ,_asyncMaxInFlight(DEFAULT_ASYNC_MAX_IN_FLIGHT)
+	  ,_asyncRate(DEFAULT_ASYNC_REQUESTS_PER_SECOND)
+	  ,_asyncTokens(DEFAULT_ASYNC_REQUESTS_PER_SECOND)
+	  ,_asyncLastRefill(0)
 {
 	_networkManager = new QNetworkAccessManager(this);
+	_asyncTimer->setSingleShot(true);
+	connect(_asyncTimer, &QTimer::timeout, this, &ProviderRestApi::processAsyncQueue);
+	_asyncClock.start();
 	_apiUrl.setScheme(_scheme);
 	_apiUrl.setHost(host);
 	_apiUrl.setPort(port);
@@ -96,12 +110,38 @@ void ProviderRestApi::setQuery(const QUrlQuery &query)
 	_query = query;
 }
 
+void ProviderRestApi::setTimeout(int milliseconds)
+{
+	_timeout = qMax(0, milliseconds);
+}
+
+void ProviderRestApi::watchReply(QNetworkReply* reply) const
+{
+	if (_timeout <= 0)
+		return;
+
+	// QNetworkRequest::setTransferTimeout needs Qt 5.15: abort the reply instead, finished() is emitted as usual
+	QTimer* timer = new QTimer(reply);
+	timer->setSingleShot(true);
+	connect(timer, &QTimer::timeout, reply, [reply]() {
+		reply->setProperty("timedOut", true);
+		reply->abort();
+	});
+	connect(reply, &QNetworkReply::finished, timer, &QTimer::stop);
+	timer->start(_timeout);
+}
+
 QUrl ProviderRestApi::getUrl() const
+{
+	return getUrl(_path);
+}
+
+QUrl ProviderRestApi::getUrl(const QString &path) const
 {
 	QUrl url = _apiUrl;
 
 	QString fullPath = _basePath;
-	appendPath (fullPath, _path );
+	appendPath (fullPath, path );
 
 	url.setPath(fullPath);
 	url.setFragment( _fragment );
@@ -124,6 +164,7 @@ httpResponse ProviderRestApi::get(const QUrl &url)
 	// Connect requestFinished signal to quit slot of the loop.
 	QEventLoop loop;
 	QNetworkReply* reply = _networkManager->get(request);
+	watchReply(reply);
 
 	loop.connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
 
@@ -156,13 +197,16 @@ httpResponse ProviderRestApi::put(const QUrl &url, const QString &body, bool wai
 	if (!wait)
 	{
 		httpResponse response;
-		_networkManager->put(request, body.toUtf8());
+		QNetworkReply* reply = _networkManager->put(request, body.toUtf8());
+		watchReply(reply);
+		connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
 		return response;
 	}
 	
 	// Connect requestFinished signal to quit slot of the loop.
 	QEventLoop loop;
 	QNetworkReply* reply = _networkManager->put(request, body.toUtf8());
+	watchReply(reply);
 
 	loop.connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
 
@@ -181,6 +225,97 @@ httpResponse ProviderRestApi::put(const QUrl &url, const QString &body, bool wai
 	return response;
 }
 
+void ProviderRestApi::putAsync(const QString &path, const QString &body, const QString &key)
+{
+	AsyncRequest request;
+	request.key = (key.isEmpty()) ? path : key;
+	request.url = getUrl(path);
+	request.body = body.toUtf8();
+
+	bool coalesced = false;
+	for (AsyncRequest& pending : _asyncQueue)
+		if (pending.key == request.key)
+		{
+			pending.url = request.url;
+			pending.body = request.body;
+			coalesced = true;
+			break;
+		}
+
+	if (!coalesced)
+		_asyncQueue.append(request);
+
+	processAsyncQueue();
+}
+
+void ProviderRestApi::setAsyncLimits(int maxInFlight, int requestsPerSecond)
+{
+	_asyncMaxInFlight = qMax(1, maxInFlight);
+	_asyncRate = qMax(0, requestsPerSecond);
+	_asyncTokens = qMin(_asyncTokens, (double)qMax(1, _asyncRate));
+}
+
+void ProviderRestApi::clearAsyncQueue()
+{
+	_asyncQueue.clear();
+	_asyncTimer->stop();
+}
+
+int ProviderRestApi::getAsyncPendingCount() const
+{
+	return _asyncQueue.size() + _asyncInFlight;
+}
+
+void ProviderRestApi::processAsyncQueue()
+{
+	if (_asyncRate > 0)
+	{
+		qint64 now = _asyncClock.elapsed();
+		_asyncTokens = qMin((double)_asyncRate, _asyncTokens + (now - _asyncLastRefill) * _asyncRate / 1000.0);
+		_asyncLastRefill = now;
+	}
+
+	while (!_asyncQueue.isEmpty() && _asyncInFlight < _asyncMaxInFlight && (_asyncRate == 0 || _asyncTokens >= 1.0))
+	{
+		AsyncRequest request = _asyncQueue.takeFirst();
+
+		QNetworkReply* reply = _networkManager->put(QNetworkRequest(request.url), request.body);
+		reply->setProperty("asyncKey", request.key);
+		watchReply(reply);
+		connect(reply, &QNetworkReply::finished, this, &ProviderRestApi::handleAsyncReply);
+
+		_asyncInFlight++;
+		if (_asyncRate > 0)
+			_asyncTokens -= 1.0;
+	}
+
+	// the queue is blocked by the rate budget only: wake up when the next token is available
+	if (!_asyncQueue.isEmpty() && _asyncInFlight < _asyncMaxInFlight && !_asyncTimer->isActive())
+	{
+		int delay = qMax(1, (int)((1.0 - _asyncTokens) * 1000.0 / _asyncRate));
+		_asyncTimer->start(delay);
+	}
+}
+
+void ProviderRestApi::handleAsyncReply()
+{
+	QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+
+	if (reply == nullptr)
+		return;
+
+	_asyncInFlight = qMax(0, _asyncInFlight - 1);
+
+	httpResponse response = getResponse(reply);
+	QString key = reply->property("asyncKey").toString();
+
+	reply->deleteLater();
+
+	emit asyncFinished(key, response);
+
+	processAsyncQueue();
+}
+
 httpResponse ProviderRestApi::getResponse(QNetworkReply* const &reply)
 {
 	httpResponse response;
@@ -242,6 +377,9 @@ httpResponse ProviderRestApi::getResponse(QNetworkReply* const &reply)
 			}
 			errorReason = QString ("[%3 %4] - %5").arg(QString::number(httpStatusCode) , httpReason, advise);
 		}
+		else if (reply->property("timedOut").toBool()) {
+			errorReason = QString("No response within %1 ms").arg(_timeout);
+		}
 		else {
 			errorReason = reply->errorString();
 		}
@@ -9,6 +9,9 @@
 #include <QNetworkReply>
 #include <QUrlQuery>
 #include <QJsonDocument>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QList>
 
 ///
 /// Response object for REST-API calls and JSON-responses
@@ -62,6 +65,11 @@ private:
 ///
 ///@endcode
 ///
+/// Frequent state updates should use putAsync instead. The requests are queued without blocking the caller,
+/// pending requests for the same resource are coalesced (latest wins) and the number of requests in flight
+/// and the request rate are bounded. Replies are reported by the asyncFinished signal.
+///
+///
 class ProviderRestApi : public QObject
 {
 	Q_OBJECT
@@ -134,6 +142,13 @@ public:
 	///
 	void setQuery(const QUrlQuery &query);
 
+	///
+	/// @brief Set the time a request may take before it is aborted with an error
+	///
+	/// @param[in] milliseconds Timeout, 0 = wait forever (default: 5000)
+	///
+	void setTimeout(int milliseconds);
+
 	///
 	/// @brief Execute GET request
 	///
@@ -157,6 +172,34 @@ public:
 	///
 	httpResponse put(const QString &body = "", bool wait = true);
 
+	///
+	/// @brief Queue an asynchronous PUT request. The call never blocks.
+	/// A request that is still pending for the same key is replaced by the new body (latest wins).
+	///
+	/// @param[in] path Resource path below the API's base path, e.g. "lights/1/state"
+	/// @param[in] body The body of the request in JSON
+	/// @param[in] key  Coalescing key, the path is used if empty
+	///
+	void putAsync(const QString &path, const QString &body, const QString &key = "");
+
+	///
+	/// @brief Set limits for the asynchronous request queue
+	///
+	/// @param[in] maxInFlight Maximum number of requests sent but not answered yet
+	/// @param[in] requestsPerSecond Maximum request rate, 0 = unlimited
+	///
+	void setAsyncLimits(int maxInFlight, int requestsPerSecond);
+
+	///
+	/// @brief Drop all queued asynchronous requests which were not sent yet
+	///
+	void clearAsyncQueue();
+
+	///
+	/// @brief Number of asynchronous requests queued or in flight
+	///
+	int getAsyncPendingCount() const;
+
 	///
 	/// @brief Handle responses for REST requests
 	///
@@ -165,8 +208,28 @@ public:
 	///
 	httpResponse getResponse(QNetworkReply* const &reply);
 
+signals:
+	///
+	/// @brief Emits when an asynchronous request has finished
+	///
+	/// @param[in] key Coalescing key of the request
+	/// @param[in] response The response of the request
+	///
+	void asyncFinished(const QString& key, const httpResponse& response);
+
+private slots:
+	void processAsyncQueue();
+	void handleAsyncReply();
+
 private:
 
+	struct AsyncRequest
+	{
+		QString		key;
+		QUrl		url;
+		QByteArray	body;
+	};
+
 	///
 	/// @brief Execute PUT request
 	///
@@ -184,6 +247,16 @@ private:
 	///
 	void appendPath (QString &path, const QString &appendPath) const;
 
+	///
+	/// @brief Get the URL for the given resource path below the API's base path
+	///
+	QUrl getUrl(const QString &path) const;
+
+	///
+	/// @brief Abort the reply when it does not finish within the timeout
+	///
+	void watchReply(QNetworkReply* reply) const;
+
 	Logger* _log;
 
 	QNetworkAccessManager* _networkManager;
@@ -193,6 +266,7 @@ private:
 	QString   _scheme;
 	QString   _hostname;
 	int       _port;
+	int       _timeout;
 
 	QString   _basePath;
 	QString   _path;
@@ -200,6 +274,14 @@ private:
 	QString   _fragment;
 	QUrlQuery _query;
 
+	QList<AsyncRequest> _asyncQueue;
+	QTimer*   _asyncTimer;
+	QElapsedTimer _asyncClock;
+	int       _asyncInFlight;
+	int       _asyncMaxInFlight;
+	int       _asyncRate;
+	double    _asyncTokens;
+	qint64    _asyncLastRefill;
 };
 
 #endif // PROVIDERRESTKAPI_H
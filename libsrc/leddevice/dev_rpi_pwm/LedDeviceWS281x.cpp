@@ -33,6 +33,8 @@ bool LedDeviceWS281x::init(const QJsonObject &deviceConfig)
 		}
 		else
 		{
+			_rgbwTable.setAlgorithm(_whiteAlgorithm);
+
 			_channel = deviceConfig["pwmchannel"].toInt(0);
 			if (_channel != 0 && _channel != 1)
 			{
@@ -117,14 +119,16 @@ int LedDeviceWS281x::write(const std::vector<ColorRgb> &ledValues)
 			break;
 		}
 
-		_temp_rgbw.red = color.red;
-		_temp_rgbw.green = color.green;
-		_temp_rgbw.blue = color.blue;
-		_temp_rgbw.white = 0;
-
 		if (_led_string.channel[_channel].strip_type == SK6812_STRIP_GRBW)
 		{
-			Rgb_to_Rgbw(color, &_temp_rgbw, _whiteAlgorithm);
+			_rgbwTable.convert(color, &_temp_rgbw);
+		}
+		else
+		{
+			_temp_rgbw.red = color.red;
+			_temp_rgbw.green = color.green;
+			_temp_rgbw.blue = color.blue;
+			_temp_rgbw.white = 0;
 		}
 
 		_led_string.channel[_channel].leds[idx++] =
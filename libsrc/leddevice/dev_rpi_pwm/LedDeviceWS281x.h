@@ -66,6 +66,7 @@ private:
 	ws2811_t    _led_string;
 	int         _channel;
 	RGBW::WhiteAlgorithm _whiteAlgorithm;
+	RGBW::RgbwTable _rgbwTable;
 	ColorRgbw   _temp_rgbw;
 };
 
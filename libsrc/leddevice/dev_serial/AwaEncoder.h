@@ -0,0 +1,41 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// HyperHDR includes
+#include <utils/ColorRgb.h>
+
+///
+/// Data part of an Adalight AWA frame: the RGB values followed by a Fletcher checksum of them,
+/// so the receiver can drop frames damaged by a high serial speed.
+///
+namespace AwaEncoder
+{
+	const int CHECKSUM_SIZE = 2;
+
+	///
+	/// @brief Copy the colors to the frame and append the checksum
+	///
+	/// @param[in] ledValues The RGB-color per LED
+	/// @param[out] output Start of the LED data in the frame, must hold ledValues.size() * 3 + CHECKSUM_SIZE bytes
+	///
+	inline void encode(const std::vector<ColorRgb>& ledValues, uint8_t* output)
+	{
+		const size_t size = ledValues.size() * sizeof(ColorRgb);
+		const uint8_t* input = reinterpret_cast<const uint8_t*>(ledValues.data());
+
+		memcpy(output, input, size);
+
+		uint16_t fletcher1 = 0, fletcher2 = 0;
+		for (size_t i = 0; i < size; i++)
+		{
+			fletcher1 = (fletcher1 + input[i]) % 255;
+			fletcher2 = (fletcher2 + fletcher1) % 255;
+		}
+		output[size] = static_cast<uint8_t>(fletcher1);
+		output[size + 1] = static_cast<uint8_t>(fletcher2);
+	}
+}
@@ -1,4 +1,5 @@
 #include "LedDeviceAdalight.h"
+#include "AwaEncoder.h"
 
 #include <QtEndian>
 
@@ -58,7 +59,7 @@ void LedDeviceAdalight::CreateHeader()
 	{
 		_ligthBerryAPA102Mode = false;
 		totalLedCount -= 1;
-		_ledBuffer.resize((uint64_t)_headerSize + _ledRGBCount + ((_awa_mode) ? 2 : 0), 0x00);
+		_ledBuffer.resize((uint64_t)_headerSize + _ledRGBCount + ((_awa_mode) ? AwaEncoder::CHECKSUM_SIZE : 0), 0x00);
 
 		if (_awa_mode)
 			Debug(_log, "Adalight driver with activated high speeed & data integration check AWA protocol");
@@ -96,26 +97,16 @@ int LedDeviceAdalight::write(const std::vector<ColorRgb> & ledValues)
 	}
 	else
 	{
-		if ((_headerSize + ledValues.size() * sizeof(ColorRgb) + ((_awa_mode) ? 2 : 0)) > _ledBuffer.size())
+		if ((_headerSize + ledValues.size() * sizeof(ColorRgb) + ((_awa_mode) ? AwaEncoder::CHECKSUM_SIZE : 0)) > _ledBuffer.size())
 		{
 			Warning(_log, "Adalight buffer's size has changed. Skipping refresh.");
 			return 0;
 		}
 		
-		memcpy(_headerSize + _ledBuffer.data(), ledValues.data(), ledValues.size() * sizeof(ColorRgb));
-
 		if (_awa_mode)
-		{			
-			uint16_t fletcher1 = 0, fletcher2 = 0;
-			uint8_t* input = (uint8_t*)ledValues.data();
-			for (uint16_t iLed = 0; iLed < ledValues.size() * sizeof(ColorRgb); iLed++, input++)
-			{
-				fletcher1 = (fletcher1 + *input) % 255;
-				fletcher2 = (fletcher2 + fletcher1) % 255;
-			}
-			_ledBuffer[_headerSize + ledValues.size() * sizeof(ColorRgb)  ] = fletcher1;
-			_ledBuffer[_headerSize + ledValues.size() * sizeof(ColorRgb)+1] = fletcher2;
-		}
+			AwaEncoder::encode(ledValues, _headerSize + _ledBuffer.data());
+		else
+			memcpy(_headerSize + _ledBuffer.data(), ledValues.data(), ledValues.size() * sizeof(ColorRgb));
 	}
 
 	int rc = writeBytes(_ledBuffer.size(), _ledBuffer.data());
@@ -0,0 +1,16 @@
+#include "ClocklessSpiEncoder.h"
+
+ClocklessSpiEncoder::ClocklessSpiEncoder(const uint8_t (&bitpairToByte)[4])
+{
+	for (int value = 0; value < 256; value++)
+	{
+		// most significant bit pair is transmitted first
+		uint8_t bytes[SPI_BYTES_PER_COLOUR] = {
+			bitpairToByte[(value >> 6) & 0x3],
+			bitpairToByte[(value >> 4) & 0x3],
+			bitpairToByte[(value >> 2) & 0x3],
+			bitpairToByte[value & 0x3]
+		};
+		memcpy(&_expansion[value], bytes, SPI_BYTES_PER_COLOUR);
+	}
+}
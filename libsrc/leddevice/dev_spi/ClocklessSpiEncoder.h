@@ -0,0 +1,72 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// HyperHDR includes
+#include <utils/ColorRgb.h>
+#include <utils/ColorRgbw.h>
+
+///
+/// Encoder of color bytes into SPI bit patterns for clockless LED strips (WS2812, SK6812, SK6822, APA104).
+/// Every LED data bit is sent as a nibble of SPI bits, so a color byte expands to 4 SPI bytes.
+/// The expansion of all 256 byte values is precomputed once, encoding a color byte is a single 32-bit copy.
+///
+class ClocklessSpiEncoder
+{
+public:
+	static constexpr int SPI_BYTES_PER_COLOUR = 4;
+
+	///
+	/// @brief Constructs the encoder
+	///
+	/// @param[in] bitpairToByte SPI byte for each pair of data bits 00, 01, 10 and 11
+	///
+	explicit ClocklessSpiEncoder(const uint8_t (&bitpairToByte)[4]);
+
+	///
+	/// @brief Encode RGB colors
+	///
+	/// @param[in] ledValues The RGB-color per LED
+	/// @param[out] output Target buffer, must hold ledValues.size() * (3 * SPI_BYTES_PER_COLOUR + gapBytes) bytes
+	/// @param[in] gapBytes Number of bytes skipped after every LED (wait time of some chips)
+	/// @return Pointer behind the last written byte
+	///
+	uint8_t* encode(const std::vector<ColorRgb>& ledValues, uint8_t* output, int gapBytes = 0) const
+	{
+		for (const ColorRgb& color : ledValues)
+		{
+			output = encode(color.red, output);
+			output = encode(color.green, output);
+			output = encode(color.blue, output);
+			output += gapBytes;
+		}
+		return output;
+	}
+
+	///
+	/// @brief Encode a single RGBW color
+	///
+	uint8_t* encode(const ColorRgbw& color, uint8_t* output) const
+	{
+		output = encode(color.red, output);
+		output = encode(color.green, output);
+		output = encode(color.blue, output);
+		return encode(color.white, output);
+	}
+
+	///
+	/// @brief Encode a single color byte
+	///
+	uint8_t* encode(uint8_t value, uint8_t* output) const
+	{
+		memcpy(output, &_expansion[value], SPI_BYTES_PER_COLOUR);
+		return output + SPI_BYTES_PER_COLOUR;
+	}
+
+private:
+	/// SPI bytes for every color byte value, stored in transmission order
+	uint32_t _expansion[256];
+};
@@ -1,5 +1,15 @@
 #include "LedDeviceAPA104.h"
 
+namespace
+{
+	const uint8_t BITPAIR_TO_BYTE[4] = {
+		0b10001000,
+		0b10001110,
+		0b11101000,
+		0b11101110,
+	};
+}
+
 /*
 From the data sheet:
 
@@ -38,12 +48,7 @@ LedDeviceAPA104::LedDeviceAPA104(const QJsonObject &deviceConfig)
 	: ProviderSpi(deviceConfig)
 	, SPI_BYTES_PER_COLOUR(4)
 	, SPI_FRAME_END_LATCH_BYTES(8)
-	, bitpair_to_byte {
-		0b10001000,
-		0b10001110,
-		0b11101000,
-		0b11101110,
-	}
+	, _encoder(BITPAIR_TO_BYTE)
 {
 }
 
@@ -74,30 +79,17 @@ bool LedDeviceAPA104::init(const QJsonObject &deviceConfig)
 int LedDeviceAPA104::write(const std::vector<ColorRgb> &ledValues)
 {
 	unsigned spi_ptr = 0;
-	const int SPI_BYTES_PER_LED = sizeof(ColorRgb) * SPI_BYTES_PER_COLOUR;
 	
 	if (_ledCount != ledValues.size())
 	{
 		Warning(_log, "APA104 led's number has changed (old: %d, new: %d). Rebuilding buffer.", _ledCount,  ledValues.size());
-		_ledCount = ledValues.size();
+		setLedCount(static_cast<int>(ledValues.size()));
 		
 		_ledBuffer.resize(0, 0x00);
 		_ledBuffer.resize(_ledRGBCount * SPI_BYTES_PER_COLOUR + SPI_FRAME_END_LATCH_BYTES, 0x00);
 	}
 
-	for (const ColorRgb& color : ledValues)
-	{
-		uint32_t colorBits = ((unsigned int)color.red << 16)
-			| ((unsigned int)color.green << 8)
-			| color.blue;
-
-		for (int j=SPI_BYTES_PER_LED - 1; j>=0; j--)
-		{
-			_ledBuffer[spi_ptr+j] = bitpair_to_byte[ colorBits & 0x3 ];
-			colorBits >>= 2;
-		}
-		spi_ptr += SPI_BYTES_PER_LED;
-	}
+	spi_ptr = _encoder.encode(ledValues, _ledBuffer.data()) - _ledBuffer.data();
 
 	for (int j=0; j < SPI_FRAME_END_LATCH_BYTES; j++)
 	{
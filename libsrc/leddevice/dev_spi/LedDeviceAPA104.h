@@ -3,6 +3,7 @@
 
 // HyperHDR includes
 #include "ProviderSpi.h"
+#include "ClocklessSpiEncoder.h"
 
 ///
 /// Implementation of the LedDevice interface for writing to APA104 led device via spi.
@@ -46,7 +47,7 @@ private:
 	const int SPI_BYTES_PER_COLOUR;
 	const int SPI_FRAME_END_LATCH_BYTES;
 
-	uint8_t bitpair_to_byte[4];
+	ClocklessSpiEncoder _encoder;
 };
 
 #endif // LEDEVICEAPA104_H
@@ -1,15 +1,20 @@
 #include "LedDeviceSk6812SPI.h"
 
+namespace
+{
+	const uint8_t BITPAIR_TO_BYTE[4] = {
+		0b10001000,
+		0b10001100,
+		0b11001000,
+		0b11001100,
+	};
+}
+
 LedDeviceSk6812SPI::LedDeviceSk6812SPI(const QJsonObject &deviceConfig)
 	: ProviderSpi(deviceConfig)
 	  , _whiteAlgorithm(RGBW::WhiteAlgorithm::INVALID)
 	  , SPI_BYTES_PER_COLOUR(4)
-	  , bitpair_to_byte {
-		  0b10001000,
-		  0b10001100,
-		  0b11001000,
-		  0b11001100,
-		  }
+	  , _encoder(BITPAIR_TO_BYTE)
 {
 }
 
@@ -40,6 +45,8 @@ bool LedDeviceSk6812SPI::init(const QJsonObject &deviceConfig)
 		{
 			Debug( _log, "whiteAlgorithm : %s", QSTRING_CSTR(whiteAlgorithm));
 
+			_rgbwTable.setAlgorithm(_whiteAlgorithm);
+
 			WarningIf(( _baudRate_Hz < 2050000 || _baudRate_Hz > 4000000 ), _log, "SPI rate %d outside recommended range (2050000 -> 4000000)", _baudRate_Hz);
 
 			const int SPI_FRAME_END_LATCH_BYTES = 3;
@@ -54,34 +61,24 @@ bool LedDeviceSk6812SPI::init(const QJsonObject &deviceConfig)
 int LedDeviceSk6812SPI::write(const std::vector<ColorRgb> &ledValues)
 {
 	unsigned spi_ptr = 0;
-	const int SPI_BYTES_PER_LED = sizeof(ColorRgbw) * SPI_BYTES_PER_COLOUR;
 
 	if (_ledCount != ledValues.size())
 	{
 		Warning(_log, "Sk6812SPI led's number has changed (old: %d, new: %d). Rebuilding buffer.", _ledCount,  ledValues.size());
-		_ledCount = ledValues.size();
+		setLedCount(static_cast<int>(ledValues.size()));
 	
 		const int SPI_FRAME_END_LATCH_BYTES = 3;
 		_ledBuffer.resize(0, 0x00);
 		_ledBuffer.resize(_ledRGBWCount * SPI_BYTES_PER_COLOUR + SPI_FRAME_END_LATCH_BYTES, 0x00);
 	}
 
+	uint8_t* output = _ledBuffer.data();
 	for (const ColorRgb& color : ledValues)
 	{
-		RGBW::Rgb_to_Rgbw(color, &_temp_rgbw, _whiteAlgorithm);
-		uint32_t colorBits = 
-			((uint32_t)_temp_rgbw.red << 24) +
-			((uint32_t)_temp_rgbw.green << 16) +
-			((uint32_t)_temp_rgbw.blue << 8) +
-			_temp_rgbw.white;
-
-		for (int j=SPI_BYTES_PER_LED - 1; j>=0; j--)
-		{
-			_ledBuffer[spi_ptr+j] = bitpair_to_byte[ colorBits & 0x3 ];
-			colorBits >>= 2;
-		}
-		spi_ptr += SPI_BYTES_PER_LED;
+		_rgbwTable.convert(color, &_temp_rgbw);
+		output = _encoder.encode(_temp_rgbw, output);
 	}
+	spi_ptr = output - _ledBuffer.data();
 
 	_ledBuffer[spi_ptr++] = 0;
 	_ledBuffer[spi_ptr++] = 0;
@@ -3,6 +3,7 @@
 
 // HyperHDR includes
 #include "ProviderSpi.h"
+#include "ClocklessSpiEncoder.h"
 
 ///
 /// Implementation of the LedDevice interface for writing to Sk6801 LED-device via SPI.
@@ -44,9 +45,10 @@ private:
 	int write(const std::vector<ColorRgb> & ledValues) override;
 
 	RGBW::WhiteAlgorithm _whiteAlgorithm;
+	RGBW::RgbwTable _rgbwTable;
 
 	const int SPI_BYTES_PER_COLOUR;
-	uint8_t bitpair_to_byte[4];
+	ClocklessSpiEncoder _encoder;
 
 	ColorRgbw _temp_rgbw;
 };
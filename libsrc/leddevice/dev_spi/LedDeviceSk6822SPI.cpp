@@ -1,4 +1,15 @@
 #include "LedDeviceSk6822SPI.h"
+
+namespace
+{
+	const uint8_t BITPAIR_TO_BYTE[4] = {
+		0b10001000,
+		0b10001110,
+		0b11101000,
+		0b11101110,
+	};
+}
+
 /*
 From the data sheet:
 
@@ -41,12 +52,7 @@ LedDeviceSk6822SPI::LedDeviceSk6822SPI(const QJsonObject &deviceConfig)
 	  , SPI_BYTES_PER_COLOUR(4)
 	  , SPI_BYTES_WAIT_TIME(3)
 	  , SPI_FRAME_END_LATCH_BYTES(13)
-	  , bitpair_to_byte {
-		  0b10001000,
-		  0b10001110,
-		  0b11101000,
-		  0b11101110,
-		  }
+	  , _encoder(BITPAIR_TO_BYTE)
 {
 }
 
@@ -77,32 +83,17 @@ bool LedDeviceSk6822SPI::init(const QJsonObject &deviceConfig)
 
 int LedDeviceSk6822SPI::write(const std::vector<ColorRgb> &ledValues)
 {
-	unsigned spi_ptr = 0;
-	const int SPI_BYTES_PER_LED = sizeof(ColorRgb) * SPI_BYTES_PER_COLOUR;
-
 	if (_ledCount != ledValues.size())
 	{
 		Warning(_log, "Sk6822SPI led's number has changed (old: %d, new: %d). Rebuilding buffer.", _ledCount,  ledValues.size());
-		_ledCount = ledValues.size();
+		setLedCount(static_cast<int>(ledValues.size()));
 		
 		_ledBuffer.resize(0, 0x00);
 		_ledBuffer.resize( (_ledRGBCount *  SPI_BYTES_PER_COLOUR) + (_ledCount * SPI_BYTES_WAIT_TIME ) + SPI_FRAME_END_LATCH_BYTES, 0x00);
 	}
 	
-	for (const ColorRgb& color : ledValues)
-	{
-		uint32_t colorBits = ((unsigned int)color.red << 16)
-							 | ((unsigned int)color.green << 8)
-							 | color.blue;
-
-		for (int j=SPI_BYTES_PER_LED - 1; j>=0; j--)
-		{
-			_ledBuffer[spi_ptr+j] = bitpair_to_byte[ colorBits & 0x3 ];
-			colorBits >>= 2;
-		}
-		spi_ptr += SPI_BYTES_PER_LED;
-		spi_ptr += SPI_BYTES_WAIT_TIME;	// the wait between led time is all zeros
-	}
+	// the wait between led time is all zeros
+	_encoder.encode(ledValues, _ledBuffer.data(), SPI_BYTES_WAIT_TIME);
 
 /*
 	// debug the whole SPI packet
@@ -3,6 +3,7 @@
 
 // HyperHDR includes
 #include "ProviderSpi.h"
+#include "ClocklessSpiEncoder.h"
 
 ///
 /// Implementation of the LedDevice interface for writing to Sk6822 LED-device via SPI.
@@ -47,7 +48,7 @@ private:
 	const int SPI_BYTES_WAIT_TIME;
 	const int SPI_FRAME_END_LATCH_BYTES;
 
-	uint8_t bitpair_to_byte[4];
+	ClocklessSpiEncoder _encoder;
 };
 
 #endif // LEDEVICESK6822SPI_H
@@ -1,5 +1,15 @@
 #include "LedDeviceWs2812SPI.h"
 
+namespace
+{
+	const uint8_t BITPAIR_TO_BYTE[4] = {
+		0b10001000,
+		0b10001100,
+		0b11001000,
+		0b11001100,
+	};
+}
+
 	/*
 From the data sheet:
 
@@ -38,12 +48,7 @@ LedDeviceWs2812SPI::LedDeviceWs2812SPI(const QJsonObject &deviceConfig)
 	: ProviderSpi(deviceConfig)
 	  , SPI_BYTES_PER_COLOUR(4)
 	  , SPI_FRAME_END_LATCH_BYTES(116)
-	  , bitpair_to_byte {
-		  0b10001000,
-		  0b10001100,
-		  0b11001000,
-		  0b11001100,
-		  }
+	  , _encoder(BITPAIR_TO_BYTE)
 {
 }
 
@@ -74,30 +79,17 @@ bool LedDeviceWs2812SPI::init(const QJsonObject &deviceConfig)
 int LedDeviceWs2812SPI::write(const std::vector<ColorRgb> &ledValues)
 {
 	unsigned spi_ptr = 0;
-	const int SPI_BYTES_PER_LED = sizeof(ColorRgb) * SPI_BYTES_PER_COLOUR;
 
 	if (_ledCount != ledValues.size())
 	{
 		Warning(_log, "Ws2812SPI led's number has changed (old: %d, new: %d). Rebuilding buffer.", _ledCount,  ledValues.size());
-		_ledCount = ledValues.size();
+		setLedCount(static_cast<int>(ledValues.size()));
 		
 		_ledBuffer.resize(0, 0x00);
 		_ledBuffer.resize(_ledRGBCount * SPI_BYTES_PER_COLOUR + SPI_FRAME_END_LATCH_BYTES, 0x00);
 	}
 	
-	for (const ColorRgb& color : ledValues)
-	{
-		uint32_t colorBits = ((unsigned int)color.red << 16)
-							 | ((unsigned int)color.green << 8)
-							 | color.blue;
-
-		for (int j=SPI_BYTES_PER_LED - 1; j>=0; j--)
-		{
-			_ledBuffer[spi_ptr+j] = bitpair_to_byte[ colorBits & 0x3 ];
-			colorBits >>= 2;
-		}
-		spi_ptr += SPI_BYTES_PER_LED;
-	}
+	spi_ptr = _encoder.encode(ledValues, _ledBuffer.data()) - _ledBuffer.data();
 
 	for (int j=0; j < SPI_FRAME_END_LATCH_BYTES; j++)
 	{
@@ -0,0 +1,109 @@
+#include <utils/CaptureFile.h>
+
+#include <cstring>
+
+CaptureFileReader::CaptureFileReader()
+	: _data(nullptr)
+	, _startTime(0)
+{
+}
+
+CaptureFileReader::~CaptureFileReader()
+{
+	close();
+}
+
+bool CaptureFileReader::open(const QString& fileName)
+{
+	close();
+
+	_file.setFileName(fileName);
+
+	if (!_file.open(QIODevice::ReadOnly))
+	{
+		_error = _file.errorString();
+		return false;
+	}
+
+	const qint64 size = _file.size();
+
+	if (size < (qint64)sizeof(CaptureFile::FileHeader) || (_data = _file.map(0, size)) == nullptr)
+	{
+		_error = "Could not map the file";
+		close();
+		return false;
+	}
+
+	const CaptureFile::FileHeader* fileHeader = reinterpret_cast<const CaptureFile::FileHeader*>(_data);
+
+	if (memcmp(fileHeader->magic, CaptureFile::MAGIC, sizeof(CaptureFile::MAGIC)) != 0 || fileHeader->version != CaptureFile::VERSION ||
+		fileHeader->headerSize < sizeof(CaptureFile::FileHeader) || fileHeader->headerSize > size || fileHeader->headerSize % 8 != 0)
+	{
+		_error = "Not a HyperHDR capture file";
+		close();
+		return false;
+	}
+
+	_startTime = fileHeader->startTime;
+
+	// an interrupted recording ends with an incomplete record: it is ignored.
+	// The records stay 8 bytes aligned: the header size is checked above and the payloads are padded
+	qint64 position = fileHeader->headerSize;
+
+	while (position + (qint64)sizeof(CaptureFile::RecordHeader) <= size)
+	{
+		const CaptureFile::RecordHeader* record = reinterpret_cast<const CaptureFile::RecordHeader*>(_data + position);
+		const qint64 next = position + (qint64)sizeof(CaptureFile::RecordHeader) + CaptureFile::paddedSize(record->size);
+
+		if (position + (qint64)sizeof(CaptureFile::RecordHeader) + record->size > size)
+			break;
+
+		_records.push_back(position);
+		position = next;
+	}
+
+	return true;
+}
+
+void CaptureFileReader::close()
+{
+	if (_data != nullptr)
+		_file.unmap(_data);
+
+	_data = nullptr;
+	_records.clear();
+	_startTime = 0;
+
+	if (_file.isOpen())
+		_file.close();
+}
+
+bool CaptureFileReader::isOpen() const
+{
+	return _data != nullptr;
+}
+
+QString CaptureFileReader::error() const
+{
+	return _error;
+}
+
+int64_t CaptureFileReader::startTime() const
+{
+	return _startTime;
+}
+
+int CaptureFileReader::count() const
+{
+	return (int)_records.size();
+}
+
+const CaptureFile::RecordHeader& CaptureFileReader::header(int index) const
+{
+	return *reinterpret_cast<const CaptureFile::RecordHeader*>(_data + _records[index]);
+}
+
+const uint8_t* CaptureFileReader::payload(int index) const
+{
+	return _data + _records[index] + sizeof(CaptureFile::RecordHeader);
+}
@@ -0,0 +1,294 @@
+#include <utils/CaptureRecorder.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+#include <cstring>
+
+namespace
+{
+	// about 16 raw 1080p YUYV frames
+	const size_t	MAX_QUEUED_BYTES = 64 * 1024 * 1024;
+
+	// the replay grabber maps the whole file, it must fit the address space of a 32-bit system
+	const uint64_t	MAX_FILE_BYTES = 1536ull * 1024 * 1024;
+	const uint8_t	PADDING[8] = { 0 };
+}
+
+CaptureRecorder* CaptureRecorder::getInstance()
+{
+	static CaptureRecorder recorder;
+	return &recorder;
+}
+
+CaptureRecorder::CaptureRecorder()
+	: _log(Logger::getInstance("CAPTURE_RECORDER"))
+	, _file(nullptr)
+	, _queuedBytes(0)
+	, _running(false)
+	, _recordVideo(false)
+	, _recordLeds(false)
+	, _records(0)
+	, _bytes(0)
+	, _dropped(0)
+	, _metricRecords(Metrics::counter("hyperhdr_capture_recorder_records_total", "Records written to the capture file"))
+	, _metricBytes(Metrics::counter("hyperhdr_capture_recorder_bytes_total", "Bytes written to the capture file"))
+	, _metricDropped(Metrics::counter("hyperhdr_capture_recorder_dropped_records_total", "Records dropped because the capture queue was full"))
+{
+}
+
+CaptureRecorder::~CaptureRecorder()
+{
+	stop();
+}
+
+void CaptureRecorder::setDirectory(const QString& directory)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_directory = directory;
+}
+
+bool CaptureRecorder::start(const QString& fileName, bool video, bool leds, QString& error)
+{
+	std::lock_guard<std::mutex> control(_controlMutex);
+
+	stopRecording();
+
+	if (!video && !leds)
+	{
+		error = "Nothing to record";
+		return false;
+	}
+
+	QString path;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		// the file name comes from the API: only a name inside the capture folder is accepted
+		QString name = QFileInfo(fileName).fileName();
+		if (name.isEmpty())
+			name = QString("capture-%1.hdrcap").arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+
+		QDir().mkpath(_directory);
+		path = QDir(_directory).absoluteFilePath(name);
+	}
+
+	FILE* file = fopen(QSTRING_CSTR(path), "wb");
+	if (file == nullptr)
+	{
+		error = QString("Could not create: %1").arg(path);
+		return false;
+	}
+
+	CaptureFile::FileHeader fileHeader;
+	memset(&fileHeader, 0, sizeof(fileHeader));
+	memcpy(fileHeader.magic, CaptureFile::MAGIC, sizeof(fileHeader.magic));
+	fileHeader.version = CaptureFile::VERSION;
+	fileHeader.headerSize = sizeof(fileHeader);
+	fileHeader.startTime = QDateTime::currentMSecsSinceEpoch();
+
+	if (fwrite(&fileHeader, sizeof(fileHeader), 1, file) != 1)
+	{
+		fclose(file);
+		error = QString("Could not write: %1").arg(path);
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_file = file;
+		_fileName = path;
+		_queue.clear();
+		_queuedBytes = 0;
+		_records = 0;
+		_bytes = sizeof(fileHeader);
+		_dropped = 0;
+		_startTime = std::chrono::steady_clock::now();
+		_running = true;
+	}
+
+	_thread = std::thread(&CaptureRecorder::run, this);
+
+	_recordVideo = video;
+	_recordLeds = leds;
+
+	Info(_log, "Recording %s%s%s to: %s", (video) ? "video frames" : "", (video && leds) ? " and " : "", (leds) ? "LED colors" : "", QSTRING_CSTR(path));
+
+	return true;
+}
+
+void CaptureRecorder::stop()
+{
+	std::lock_guard<std::mutex> control(_controlMutex);
+
+	stopRecording();
+}
+
+void CaptureRecorder::stopRecording()
+{
+	_recordVideo = false;
+	_recordLeds = false;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (!_running)
+			return;
+
+		_running = false;
+	}
+
+	// the writer empties the queue before it quits
+	_wake.notify_one();
+	_thread.join();
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	fclose(_file);
+	_file = nullptr;
+
+	Info(_log, "Recording finished: %s (records: %llu, size: %.1f MB, dropped: %llu)", QSTRING_CSTR(_fileName),
+		(unsigned long long)_records, _bytes / (1024.0 * 1024.0), (unsigned long long)_dropped);
+}
+
+void CaptureRecorder::addVideoFrame(PixelFormat format, int width, int height, int lineLength, const uint8_t* data, int size)
+{
+	if (isRecordingVideo() && data != nullptr && size > 0)
+		push(CaptureFile::RecordType::VIDEO_FRAME, data, size, (uint32_t)format, width, height, lineLength);
+}
+
+void CaptureRecorder::addLedColors(int instance, const std::vector<ColorRgb>& ledColors)
+{
+	if (isRecordingLeds() && !ledColors.empty())
+		push(CaptureFile::RecordType::LED_COLORS, reinterpret_cast<const uint8_t*>(ledColors.data()), ledColors.size() * sizeof(ColorRgb),
+			instance, (uint32_t)ledColors.size(), 0, 0);
+}
+
+void CaptureRecorder::push(CaptureFile::RecordType type, const uint8_t* data, size_t size, uint32_t param0, uint32_t param1, uint32_t param2, uint32_t param3)
+{
+	bool limitReached = false;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (!_running)
+			return;
+
+		if (_bytes + _queuedBytes + sizeof(CaptureFile::RecordHeader) + CaptureFile::paddedSize((uint32_t)size) > MAX_FILE_BYTES)
+		{
+			// the file stays valid up to the last record, the writer keeps running until stop()
+			limitReached = _recordVideo || _recordLeds;
+			_recordVideo = false;
+			_recordLeds = false;
+
+			if (!limitReached)
+				return;
+		}
+		else if (_queuedBytes + size > MAX_QUEUED_BYTES)
+		{
+			_dropped++;
+			_metricDropped->add();
+			return;
+		}
+		else
+			_queuedBytes += size;
+	}
+
+	if (limitReached)
+	{
+		Warning(_log, "The capture file reached the size limit of %llu MB, the recording is stopped: %s",
+			(unsigned long long)(MAX_FILE_BYTES / (1024 * 1024)), QSTRING_CSTR(_fileName));
+		return;
+	}
+
+	// the copy is made outside of the lock, the writer is not blocked by the producers
+	Record record;
+	record.header.type = static_cast<uint32_t>(type);
+	record.header.size = (uint32_t)size;
+	record.header.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _startTime).count();
+	record.header.params[0] = param0;
+	record.header.params[1] = param1;
+	record.header.params[2] = param2;
+	record.header.params[3] = param3;
+	record.payload.assign(data, data + size);
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (!_running)
+		{
+			_queuedBytes -= size;
+			return;
+		}
+
+		_queue.push_back(std::move(record));
+	}
+
+	_wake.notify_one();
+}
+
+void CaptureRecorder::run()
+{
+	bool failed = false;
+
+	while (true)
+	{
+		Record record;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+
+			_wake.wait(lock, [this] { return !_queue.empty() || !_running; });
+
+			if (_queue.empty())
+				break;
+
+			record = std::move(_queue.front());
+			_queue.pop_front();
+		}
+
+		const size_t size = record.payload.size();
+		const size_t padding = CaptureFile::paddedSize(record.header.size) - record.header.size;
+
+		if (!failed &&
+			(fwrite(&record.header, sizeof(record.header), 1, _file) != 1 ||
+			 fwrite(record.payload.data(), 1, size, _file) != size ||
+			 fwrite(PADDING, 1, padding, _file) != padding))
+		{
+			failed = true;
+			_recordVideo = false;
+			_recordLeds = false;
+			Error(_log, "Could not write to the capture file, the recording is stopped: %s", QSTRING_CSTR(_fileName));
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_queuedBytes -= size;
+
+		if (!failed)
+		{
+			_records++;
+			_bytes += sizeof(record.header) + size + padding;
+			_metricRecords->add();
+			_metricBytes->add(sizeof(record.header) + size + padding);
+		}
+	}
+
+	fflush(_file);
+}
+
+QJsonObject CaptureRecorder::status()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	QJsonObject result;
+	result["recording"] = _running;
+	result["video"] = isRecordingVideo();
+	result["leds"] = isRecordingLeds();
+	result["file"] = _fileName;
+	result["records"] = (qint64)_records;
+	result["bytes"] = (qint64)_bytes;
+	result["dropped"] = (qint64)_dropped;
+	result["queued"] = (qint64)_queuedBytes;
+	return result;
+}
@@ -4,7 +4,6 @@
 #include <utils/Logger.h>
 
 #include <ctype.h>
-#include <cxxabi.h>
 #include <execinfo.h>
 #include <unistd.h>
 #include <signal.h>
@@ -46,60 +45,23 @@ void write_to_stderr(const char* data)
 	write_to_stderr(data, strlen(data));
 }
 
-std::string decipher_trace(const std::string &trace)
-{
-	std::string result;
-
-	if(trace.empty())
-	{
-		result += "??\n";
-		return result;
-	}
-
-	auto* begin = strchr(trace.c_str(), '(') + 1;
-	auto* end = strchr(begin, '+');
-
-	if(!end)
-		end = strchr(begin, ')');
-
-	std::string mangled_name(begin, end);
-
-	int status;
-	char * realname = abi::__cxa_demangle(mangled_name.c_str(), 0, 0, &status);
-	result.insert(result.end(), trace.c_str(), begin);
-
-	if(realname)
-		result += realname;
-	else
-		result.insert(result.end(), begin, end);
-
-	free(realname);
-	result.insert(result.size(), end);
-
-	return result;
-}
-
 void print_trace()
 {
 	const int MAX_SIZE = 50;
 	void * addresses[MAX_SIZE];
 	int size = backtrace(addresses, MAX_SIZE);
 
+	// write what is already queued first, but never wait for a logger lock the crashed thread may hold
+	Logger::tryFlush();
+
 	if (!size)
 		return;
 
-	Logger* log = Logger::getInstance("CORE");
-	char ** symbols = backtrace_symbols(addresses, size);
-
 	/* Skip first 2 frames as they are signal
-	 * handler and print_trace functions. */
-	for (int i = 2; i < size; ++i)
-	{
-		std::string line = "\t" + decipher_trace(symbols[i]);
-		Error(log, line.c_str());
-	}
-
-	free(symbols);
+	 * handler and print_trace functions.
+	 * backtrace_symbols_fd does not allocate, the names are not demangled. */
+	write_to_stderr("Backtrace:\n");
+	backtrace_symbols_fd(addresses + 2, size - 2, STDERR_FILENO);
 }
 
 void install_default_handler(int signum)
@@ -169,6 +131,10 @@ void install()
 #ifndef _WIN32
 	Logger* log = Logger::getInstance("CORE");
 
+	// the first backtrace() call loads libgcc, do it now and not in the signal handler
+	void* address;
+	backtrace(&address, 1);
+
 	struct sigaction action{};
 	sigemptyset(&action.sa_mask);
 	action.sa_sigaction = signal_handler;
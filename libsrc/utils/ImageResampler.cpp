@@ -2,6 +2,10 @@
 #include <utils/ColorSys.h>
 #include <utils/Logger.h>
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 //#define TAKE_SCREEN_SHOT
 
 #ifdef TAKE_SCREEN_SHOT
@@ -433,44 +437,165 @@ void ImageResampler::applyLUT(uint8_t* _source, unsigned int width, unsigned int
 	}
 }
 
+namespace
+{
+	///
+	/// Adds ROWS consecutive source rows to the 16-bit column sums, every byte of a row is read once.
+	/// Plain loops over whole lines: the compiler vectorizes the widening additions.
+	///
+	template<int ROWS>
+	void addRows(uint16_t* sum, const uint8_t* sLine, int lineSize, int size, bool first)
+	{
+		if (first)
+		{
+			for (int n = 0; n < size; n++)
+			{
+				uint16_t value = sLine[n];
+				for (int k = 1; k < ROWS; k++)
+					value += sLine[(size_t)k * lineSize + n];
+				sum[n] = value;
+			}
+		}
+		else
+		{
+			for (int n = 0; n < size; n++)
+			{
+				uint16_t value = sLine[n];
+				for (int k = 1; k < ROWS; k++)
+					value += sLine[(size_t)k * lineSize + n];
+				sum[n] += value;
+			}
+		}
+	}
+}
+
 void ImageResampler::processSystemImageBGRA(Image<ColorRgb>& image, int targetSizeX, int targetSizeY,
-	int startX, int startY,
+	int startX, int startY, int sourceSizeX, int sourceSizeY,
 	uint8_t* source, int _actualWidth, int _actualHeight,
-	int division, uint8_t* _lutBuffer, int lineSize)
+	const uint8_t* _lutBuffer, int lineSize)
 {
-	uint32_t	ind_lutd;
-	uint8_t		buffer[8];
-	int divisionX = division * 4;
+	// a 16-bit lane holds the sum of 257 source pixels
+	const int MAX_LANE_PIXELS = 257;
+
+	// accumulators are reused between frames, the system grabbers run on a single thread
+	static thread_local std::vector<uint16_t> columnSum;
+	static thread_local std::vector<uint32_t> boxSum;
+	static thread_local std::vector<int> columnEnd;
 
 	if (lineSize == 0)
 		lineSize = _actualWidth * 4;
 
+	sourceSizeX = std::min(sourceSizeX, _actualWidth - startX);
+	sourceSizeY = std::min(sourceSizeY, _actualHeight - startY);
+	targetSizeX = std::min(targetSizeX, sourceSizeX);
+	targetSizeY = std::min(targetSizeY, sourceSizeY);
+
+	if (targetSizeX <= 0 || targetSizeY <= 0)
+		return;
+
+	columnSum.resize((size_t)sourceSizeX * 4);
+	boxSum.resize((size_t)targetSizeX * 3);
+	columnEnd.resize(targetSizeX);
+
+	// every source pixel belongs to exactly one box, the boxes of a fractional ratio differ by at most one pixel
+	for (int i = 0; i < targetSizeX; i++)
+		columnEnd[i] = (int)(((int64_t)(i + 1) * sourceSizeX) / targetSizeX);
+
+	// rows summed in 16-bit lanes before they are moved to the 32-bit box sums,
+	// and columns of those lanes that can be added up as a whole BGRA word
+	const int boxColumns = (sourceSizeX + targetSizeX - 1) / targetSizeX;
+	const int passRows = std::max(MAX_LANE_PIXELS / boxColumns, 1);
+	const int laneColumns = MAX_LANE_PIXELS / passRows;
+
+	uint16_t* sum = columnSum.data();
+	uint32_t* box = boxSum.data();
+	const int sumSize = (int)columnSum.size();
+	int rowBegin = 0;
+
 	for (int j = 0; j < targetSizeY; j++)
 	{
-		size_t lineSource = std::min(startY + j * division, _actualHeight - 1);
-		int8_t* dLine = ((int8_t*)image.memptr() + (size_t)j * targetSizeX * 3);
-		int8_t* dLineEnd = dLine + (size_t)targetSizeX * 3;
-		int8_t* sLine = (((int8_t*)source + (lineSource * lineSize) + ((size_t)startX * 4)));
+		const int rowEnd = (int)(((int64_t)(j + 1) * sourceSizeY) / targetSizeY);
+
+		std::fill(boxSum.begin(), boxSum.end(), 0);
 
-		if (_lutBuffer == nullptr)
+		for (int passBegin = rowBegin; passBegin < rowEnd; passBegin += passRows)
 		{
-			sLine += 2;
-			while (dLine < dLineEnd)
+			const int passEnd = std::min(passBegin + passRows, rowEnd);
+
+			// vertical pass, up to four source rows at a time
+			for (int row = passBegin; row < passEnd; row += 4)
+			{
+				const uint8_t* sLine = source + (size_t)(startY + row) * lineSize + (size_t)startX * 4;
+				const bool first = (row == passBegin);
+
+				switch (std::min(passEnd - row, 4))
+				{
+					case 1: addRows<1>(sum, sLine, lineSize, sumSize, first); break;
+					case 2: addRows<2>(sum, sLine, lineSize, sumSize, first); break;
+					case 3: addRows<3>(sum, sLine, lineSize, sumSize, first); break;
+					default: addRows<4>(sum, sLine, lineSize, sumSize, first); break;
+				}
+			}
+
+			// horizontal pass: the four 16-bit lanes of a column (BGRA, little endian) are added as one word
+			const uint16_t* acc = sum;
+			int column = 0;
+
+			for (int i = 0; i < targetSizeX; i++)
 			{
-				*dLine++ = *sLine--;
-				*dLine++ = *sLine--;
-				*dLine++ = *sLine;
-				sLine += divisionX + 2;
+				uint64_t lanes = 0;
+				int count = 0;
+
+				for (; column < columnEnd[i]; column++, acc += 4)
+				{
+					uint64_t pixel;
+					memcpy(&pixel, acc, sizeof(pixel));
+					lanes += pixel;
+
+					if (++count == laneColumns || column + 1 == columnEnd[i])
+					{
+						box[3 * i] += (uint32_t)(lanes & 0xFFFF);
+						box[3 * i + 1] += (uint32_t)((lanes >> 16) & 0xFFFF);
+						box[3 * i + 2] += (uint32_t)((lanes >> 32) & 0xFFFF);
+						lanes = 0;
+						count = 0;
+					}
+				}
 			}
 		}
-		else while (dLine < dLineEnd)
+
+		// 32-bit fixed point reciprocal of the box area, the LUT is applied to the averaged color
+		uint8_t* dLine = (uint8_t*)image.memptr() + (size_t)j * targetSizeX * 3;
+		int columnBegin = 0;
+
+		for (int i = 0; i < targetSizeX; i++, dLine += 3)
 		{
-			*((uint32_t*)&buffer) = *((uint32_t*)sLine);
-			sLine += divisionX;
-			ind_lutd = LUT_INDEX(buffer[2], buffer[1], buffer[0]);
-			*((uint32_t*)dLine) = *((uint32_t*)(&_lutBuffer[ind_lutd]));
-			dLine += 3;
+			const uint64_t area = (uint64_t)(rowEnd - rowBegin) * (uint64_t)(columnEnd[i] - columnBegin);
+			const uint64_t reciprocal = (((uint64_t)1 << 32) + area / 2) / area;
+
+			columnBegin = columnEnd[i];
+
+			const uint8_t r = (uint8_t)std::min((box[3 * i + 2] * reciprocal + ((uint64_t)1 << 31)) >> 32, (uint64_t)255);
+			const uint8_t g = (uint8_t)std::min((box[3 * i + 1] * reciprocal + ((uint64_t)1 << 31)) >> 32, (uint64_t)255);
+			const uint8_t b = (uint8_t)std::min((box[3 * i] * reciprocal + ((uint64_t)1 << 31)) >> 32, (uint64_t)255);
+
+			if (_lutBuffer == nullptr)
+			{
+				dLine[0] = r;
+				dLine[1] = g;
+				dLine[2] = b;
+			}
+			else
+			{
+				const uint8_t* lut = &_lutBuffer[LUT_INDEX(r, g, b)];
+
+				dLine[0] = lut[0];
+				dLine[1] = lut[1];
+				dLine[2] = lut[2];
+			}
 		}
+
+		rowBegin = rowEnd;
 	}
 }
 
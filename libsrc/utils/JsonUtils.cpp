@@ -3,11 +3,30 @@
 
 // util includes
 #include <utils/jsonschema/QJsonSchemaChecker.h>
+#include <utils/jsonschema/QJsonSchemaValidator.h>
 
 //qt includes
 #include <QRegularExpression>
 #include <QJsonObject>
 #include <QJsonParseError>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <memory>
+
+namespace
+{
+	// schemas compiled into the application resources never change, they are loaded only once
+	struct CachedSchema
+	{
+		QJsonObject          schema;
+		QJsonSchemaValidator validator;
+	};
+
+	QMutex schemaCacheMutex;
+	QHash<QString, std::shared_ptr<CachedSchema>> schemaCache;
+}
 
 namespace JsonUtils {
 
@@ -86,15 +105,38 @@ namespace JsonUtils {
 
 	bool validate(const QString& file, const QJsonObject& json, const QString& schemaPath, Logger* log)
 	{
-		// get the schema data
-		QJsonObject schema;
-		if(!readFile(schemaPath, schema, log))
-			return false;
+		if (!schemaPath.startsWith(':'))
+		{
+			QJsonObject schema;
+			if (!readFile(schemaPath, schema, log))
+				return false;
 
-		if(!validate(file, json, schema, log))
-			return false;
-		return true;
+			return validate(file, json, schema, log);
+		}
+
+		std::shared_ptr<CachedSchema> cached;
+		{
+			QMutexLocker locker(&schemaCacheMutex);
+
+			cached = schemaCache.value(schemaPath);
+			if (cached == nullptr)
+			{
+				cached = std::make_shared<CachedSchema>();
+				if (!readFile(schemaPath, cached->schema, log))
+					return false;
+
+				if (!cached->validator.compile(cached->schema))
+					Debug(log, "Schema '%s' uses features of the full checker only, it will not be compiled", QSTRING_CSTR(schemaPath));
+
+				schemaCache.insert(schemaPath, cached);
+			}
+		}
+
+		// fast path, the full checker runs only to report the errors
+		if (cached->validator.isCompiled() && cached->validator.validate(json))
+			return true;
 
+		return validate(file, json, cached->schema, log);
 	}
 
 	bool validate(const QString& file, const QJsonObject& json, const QJsonObject& schema, Logger* log)
@@ -3,6 +3,14 @@
 
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #ifndef _WIN32
 #include <syslog.h>
@@ -14,7 +22,6 @@
 #include <QDateTime>
 #include <QFileInfo>
 #include <QMutexLocker>
-#include <QThreadStorage>
 
 #include <time.h>
 
@@ -37,18 +44,366 @@ namespace
 	#endif
 
 	const size_t MAX_IDENTIFICATION_LENGTH = 22;
+	const size_t MAX_MESSAGE_LENGTH = 1024;
+	const unsigned LOG_RING_SIZE = 64;
 
 	QAtomicInteger<unsigned int> LoggerCount = 0;
 	QAtomicInteger<unsigned int> LoggerId    = 0;
 
 	const int MaxRepeatCountSize = 200;
-	QThreadStorage<int> RepeatCount;
-	QThreadStorage<Logger::T_LOG_MESSAGE> RepeatMessage;
 
 	QString getApplicationName()
 	{
 		return "";
 	}
+
+	struct LogRecord
+	{
+		QString          appName;
+		QString          loggerName;
+		const char*      sourceFile = nullptr;
+		const char*      function = nullptr;
+		unsigned int     line = 0;
+		Logger::LogLevel level = Logger::INFO;
+		bool             syslog = false;
+		uint64_t         utime = 0;
+		char             message[MAX_MESSAGE_LENGTH];
+	};
+
+	///
+	/// Single producer (the thread that owns it) / single consumer (the log thread) queue.
+	/// The repeat suppression state is per thread as it always was and only used by the consumer.
+	///
+	struct LogRing
+	{
+		LogRecord             records[LOG_RING_SIZE];
+		std::atomic<unsigned> head{ 0 };
+		std::atomic<unsigned> tail{ 0 };
+		std::atomic<unsigned> dropped{ 0 };
+
+		Logger::T_LOG_MESSAGE repeatMessage;
+		bool                  repeatSyslog = false;
+		int                   repeatCount = 0;
+	};
+
+	///
+	/// Binary log record, numbers in the byte order of the host:
+	/// uint64 utime, uint8 level, uint32 line, then logger name, file name, function and message,
+	/// each one as uint16 length followed by UTF-8 bytes. The file starts with the 8 bytes "HHDRLOG1".
+	///
+	class LogWorker
+	{
+	public:
+		LogWorker() :
+			_stop(false),
+			_pending(false),
+			_dispatch(true),
+			_binaryFile(nullptr)
+		{
+			_thread = std::thread(&LogWorker::run, this);
+		}
+
+		///
+		/// Joins the log thread, the messages that follow are written by the thread that logs them
+		///
+		void stop()
+		{
+			std::lock_guard<std::mutex> lock(_stopMutex);
+
+			if (!_thread.joinable())
+				return;
+
+			// LoggerManager and the event loop may be already gone
+			_dispatch = false;
+			_stop = true;
+			_wake.notify_one();
+			_thread.join();
+
+			drain();
+		}
+
+		bool isStopped() const
+		{
+			return _stop.load();
+		}
+
+		LogRing* getRing()
+		{
+			static thread_local std::shared_ptr<LogRing> ring;
+
+			if (ring == nullptr)
+			{
+				ring = std::make_shared<LogRing>();
+
+				std::lock_guard<std::mutex> lock(_ringsMutex);
+				_rings.push_back(ring);
+			}
+
+			return ring.get();
+		}
+
+		void notify()
+		{
+			if (!_pending.exchange(true))
+				_wake.notify_one();
+		}
+
+		void drain()
+		{
+			std::vector<std::shared_ptr<LogRing>> rings;
+			{
+				std::lock_guard<std::mutex> lock(_ringsMutex);
+				rings = _rings;
+			}
+
+			std::lock_guard<std::mutex> lock(_drainMutex);
+
+			bool written = false;
+			for (auto& ring : rings)
+			{
+				written |= drainRing(*ring);
+
+				// the owner thread has finished
+				if (ring.use_count() == 2 && ring->tail.load() == ring->head.load())
+				{
+					repeatedSummary(*ring, ring->repeatMessage.utime);
+
+					std::lock_guard<std::mutex> lockRings(_ringsMutex);
+					_rings.erase(std::remove(_rings.begin(), _rings.end(), ring), _rings.end());
+				}
+			}
+
+			if (written)
+			{
+				std::cout.flush();
+				if (_binaryFile != nullptr)
+					fflush(_binaryFile);
+			}
+		}
+
+		bool tryDrain()
+		{
+			std::unique_lock<std::mutex> lock(_drainMutex, std::try_to_lock);
+			if (!lock.owns_lock())
+				return false;
+
+			std::unique_lock<std::mutex> lockRings(_ringsMutex, std::try_to_lock);
+			if (!lockRings.owns_lock())
+				return false;
+
+			for (auto& ring : _rings)
+				drainRing(*ring);
+
+			std::cout.flush();
+			if (_binaryFile != nullptr)
+				fflush(_binaryFile);
+
+			return true;
+		}
+
+		bool setBinaryFile(const QString& path)
+		{
+			std::lock_guard<std::mutex> lock(_drainMutex);
+
+			if (_binaryFile != nullptr)
+			{
+				fclose(_binaryFile);
+				_binaryFile = nullptr;
+			}
+
+			if (path.isEmpty())
+				return true;
+
+			_binaryFile = fopen(QSTRING_CSTR(path), "ab");
+			if (_binaryFile == nullptr)
+				return false;
+
+			if (ftell(_binaryFile) == 0)
+				fwrite("HHDRLOG1", 1, 8, _binaryFile);
+
+			return true;
+		}
+
+	private:
+		void run()
+		{
+			while (!_stop)
+			{
+				{
+					std::unique_lock<std::mutex> lock(_wakeMutex);
+					_wake.wait_for(lock, std::chrono::milliseconds(50), [this] { return _pending.load() || _stop.load(); });
+				}
+				_pending = false;
+				drain();
+			}
+		}
+
+		bool drainRing(LogRing& ring)
+		{
+			bool written = false;
+			unsigned tail = ring.tail.load(std::memory_order_relaxed);
+
+			while (tail != ring.head.load(std::memory_order_acquire))
+			{
+				written |= process(ring, ring.records[tail % LOG_RING_SIZE]);
+				ring.tail.store(++tail, std::memory_order_release);
+			}
+
+			unsigned dropped = ring.dropped.exchange(0);
+			if (dropped > 0)
+			{
+				Logger::T_LOG_MESSAGE dropMsg = ring.repeatMessage;
+				dropMsg.level = Logger::WARNING;
+				dropMsg.levelString = LogLevelStrings[Logger::WARNING];
+				dropMsg.message = QString("%1 log message(s) dropped, the log queue of the thread was full").arg(dropped);
+				dropMsg.utime = QDateTime::currentMSecsSinceEpoch();
+				write(dropMsg);
+				written = true;
+			}
+
+			return written;
+		}
+
+		void repeatedSummary(LogRing& ring, uint64_t utime)
+		{
+			if (ring.repeatCount > 10)
+			{
+				Logger::T_LOG_MESSAGE repMsg = ring.repeatMessage;
+				repMsg.message = "Previous line repeats " + QString::number(ring.repeatCount - 10) + " times";
+				repMsg.utime = utime;
+
+				write(repMsg);
+#ifndef _WIN32
+				if (ring.repeatSyslog && repMsg.level >= Logger::WARNING)
+					syslog(LogLevelSysLog[repMsg.level], "Previous line repeats %d times", ring.repeatCount - 10);
+#endif
+			}
+			ring.repeatCount = 0;
+		}
+
+		bool process(LogRing& ring, const LogRecord& record)
+		{
+			bool writeAnyway = false;
+			bool repeatMessage = false;
+
+			if (ring.repeatMessage.loggerName == record.loggerName &&
+				ring.repeatMessage.function == record.function &&
+				ring.repeatMessage.message == record.message &&
+				ring.repeatMessage.line == record.line)
+			{
+				repeatMessage = true;
+				if (ring.repeatCount >= MaxRepeatCountSize)
+					repeatedSummary(ring, record.utime);
+				else
+					ring.repeatCount++;
+
+				if (ring.repeatCount < 10)
+					writeAnyway = true;
+			}
+
+			if (repeatMessage && !writeAnyway)
+				return false;
+
+			if (!repeatMessage && ring.repeatCount)
+				repeatedSummary(ring, record.utime);
+
+			Logger::T_LOG_MESSAGE logMsg;
+
+			logMsg.appName     = record.appName;
+			logMsg.loggerName  = record.loggerName;
+			logMsg.function    = QString(record.function);
+			logMsg.line        = record.line;
+			logMsg.fileName    = FileUtils::getBaseName(record.sourceFile);
+			logMsg.utime       = record.utime;
+			logMsg.message     = QString(record.message);
+			logMsg.level       = record.level;
+			logMsg.levelString = LogLevelStrings[record.level];
+
+			write(logMsg);
+#ifndef _WIN32
+			if (record.syslog && record.level >= Logger::WARNING)
+				syslog(LogLevelSysLog[record.level], "%s", record.message);
+#endif
+			ring.repeatMessage = logMsg;
+			ring.repeatSyslog = record.syslog;
+
+			return true;
+		}
+
+		void write(const Logger::T_LOG_MESSAGE& message)
+		{
+			QString location;
+			if (message.level == Logger::DEBUG)
+			{
+				location = QString("%1:%2:%3() | ")
+					.arg(message.fileName)
+					.arg(message.line)
+					.arg(message.function);
+			}
+
+			QString name = (message.appName + " " + message.loggerName).trimmed();
+			name.resize(MAX_IDENTIFICATION_LENGTH, ' ');
+
+			const QDateTime timestamp = QDateTime::fromMSecsSinceEpoch(message.utime);
+
+			std::cout << QString("%1 %2 : <%3> %4%5")
+					.arg(timestamp.toString("yyyy-MM-ddThh:mm:ss.zzz"))
+					.arg(name)
+					.arg(LogLevelStrings[message.level])
+					.arg(location)
+					.arg(message.message)
+				.toStdString()
+			<< '\n';
+
+			if (_binaryFile != nullptr)
+				writeBinary(message);
+
+			if (_dispatch)
+				QMetaObject::invokeMethod(LoggerManager::getInstance(), "handleNewLogMessage", Qt::QueuedConnection, Q_ARG(Logger::T_LOG_MESSAGE, message));
+		}
+
+		void writeBinaryString(const QString& text)
+		{
+			QByteArray data = text.toUtf8().left(0xFFFF);
+			uint16_t length = static_cast<uint16_t>(data.size());
+			fwrite(&length, sizeof(length), 1, _binaryFile);
+			fwrite(data.constData(), 1, length, _binaryFile);
+		}
+
+		void writeBinary(const Logger::T_LOG_MESSAGE& message)
+		{
+			uint64_t utime = message.utime;
+			uint8_t  level = static_cast<uint8_t>(message.level);
+			uint32_t line = message.line;
+
+			fwrite(&utime, sizeof(utime), 1, _binaryFile);
+			fwrite(&level, sizeof(level), 1, _binaryFile);
+			fwrite(&line, sizeof(line), 1, _binaryFile);
+			writeBinaryString(message.loggerName);
+			writeBinaryString(message.fileName);
+			writeBinaryString(message.function);
+			writeBinaryString(message.message);
+		}
+
+		std::thread                           _thread;
+		std::mutex                            _stopMutex;
+		std::atomic<bool>                     _stop;
+		std::atomic<bool>                     _pending;
+		std::atomic<bool>                     _dispatch;
+		std::mutex                            _wakeMutex;
+		std::condition_variable               _wake;
+		std::mutex                            _drainMutex;
+		std::mutex                            _ringsMutex;
+		std::vector<std::shared_ptr<LogRing>> _rings;
+		FILE*                                 _binaryFile;
+	};
+
+	LogWorker& getLogWorker()
+	{
+		// never destroyed: a thread that is still running at exit can log at any time
+		static LogWorker* worker = new LogWorker();
+		return *worker;
+	}
 } // namespace
 
 Logger* Logger::getInstance(const QString & name, Logger::LogLevel minLevel)
@@ -61,7 +416,10 @@ Logger* Logger::getInstance(const QString & name, Logger::LogLevel minLevel)
 		log = new Logger(name, minLevel);
 		LoggerMap.insert(name, log); // compat version, replace it with following line if we have 100% c++11
 		//LoggerMap.emplace(name, log);  // not compat with older linux distro's e.g. wheezy
-		connect(log, &Logger::newLogMessage, LoggerManager::getInstance(), &LoggerManager::handleNewLogMessage);
+
+		// create the buffer in the main thread and start the log thread
+		LoggerManager::getInstance();
+		getLogWorker();
 	}
 
 	return log;
@@ -69,6 +427,8 @@ Logger* Logger::getInstance(const QString & name, Logger::LogLevel minLevel)
 
 void Logger::deleteInstance(const QString & name)
 {
+	flush();
+
 	QMutexLocker lock(&MapLock);
 
 	if (name.isEmpty())
@@ -146,107 +506,67 @@ Logger::~Logger()
 	}
 }
 
-void Logger::write(const Logger::T_LOG_MESSAGE & message)
+void Logger::flush()
 {
-	QString location;
-	if (message.level == Logger::DEBUG)
-	{
-		location = QString("%1:%2:%3() | ")
-			.arg(message.fileName)
-			.arg(message.line)
-			.arg(message.function);
-	}
-	
-	QString name = (message.appName + " " + message.loggerName).trimmed();
-	name.resize(MAX_IDENTIFICATION_LENGTH, ' ');
+	getLogWorker().drain();
+}
 
-	const QDateTime timestamp = QDateTime::fromMSecsSinceEpoch(message.utime);
+void Logger::shutdown()
+{
+	getLogWorker().stop();
+}
 
-	std::cout << QString("%1 %2 : <%3> %4%5")
-			.arg(timestamp.toString("yyyy-MM-ddThh:mm:ss.zzz"))
-			.arg(name)
-			.arg(LogLevelStrings[message.level])
-			.arg(location)
-			.arg(message.message)
-		.toStdString()
-	<< std::endl;
+bool Logger::tryFlush()
+{
+	return getLogWorker().tryDrain();
+}
 
-	newLogMessage(message);
+bool Logger::setBinaryLogFile(const QString & path)
+{
+	return getLogWorker().setBinaryFile(path);
 }
 
 void Logger::Message(LogLevel level, const char* sourceFile, const char* func, unsigned int line, const char* fmt, ...)
 {
 	Logger::LogLevel globalLevel = static_cast<Logger::LogLevel>(int(GLOBAL_MIN_LOG_LEVEL));
-	bool writeAnyway = false;
-	bool repeatMessage = false;
 
 	if ( (globalLevel == Logger::UNSET && level < _minLevel) // no global level, use level from logger
 	  || (globalLevel > Logger::UNSET && level < globalLevel) ) // global level set, use global level
 		return;
 
-	const size_t max_msg_length = 1024;
-	char msg[max_msg_length];
+	LogWorker& worker = getLogWorker();
+	LogRing*   ring = worker.getRing();
+
+	unsigned head = ring->head.load(std::memory_order_relaxed);
+	if (head - ring->tail.load(std::memory_order_acquire) >= LOG_RING_SIZE)
+	{
+		ring->dropped++;
+		worker.notify();
+		return;
+	}
+
+	LogRecord& record = ring->records[head % LOG_RING_SIZE];
+
 	va_list args;
 	va_start (args, fmt);
-	vsnprintf (msg, max_msg_length, fmt, args);
+	vsnprintf (record.message, MAX_MESSAGE_LENGTH, fmt, args);
 	va_end (args);
 
-	const auto repeatedSummary = [&]
-	{
-		if (RepeatCount.localData() > 10)
-		{
-			Logger::T_LOG_MESSAGE repMsg = RepeatMessage.localData();
-			repMsg.message = "Previous line repeats " + QString::number(RepeatCount.localData()-10) + " times";
-			repMsg.utime = QDateTime::currentMSecsSinceEpoch();
+	record.appName    = _appname;
+	record.loggerName = _name;
+	record.sourceFile = sourceFile;
+	record.function   = func;
+	record.line       = line;
+	record.level      = level;
+	record.syslog     = _syslogEnabled;
+	record.utime      = QDateTime::currentMSecsSinceEpoch();
 
-			write(repMsg);
-#ifndef _WIN32
-			if (_syslogEnabled && repMsg.level >= Logger::WARNING)
-				syslog(LogLevelSysLog[repMsg.level], "Previous line repeats %d times", RepeatCount.localData()-10);
-#endif
-		}
-		RepeatCount.setLocalData(0);
-	};
+	ring->head.store(head + 1, std::memory_order_release);
 
-	if (RepeatMessage.localData().loggerName == _name  &&
-		RepeatMessage.localData().function == func &&
-		RepeatMessage.localData().message == msg   &&
-		RepeatMessage.localData().line == line)
-	{
-		repeatMessage = true;
-		if (RepeatCount.localData() >= MaxRepeatCountSize)
-			repeatedSummary();
-		else
-			RepeatCount.setLocalData(RepeatCount.localData() + 1);
-
-		if (RepeatCount.localData() < 10)
-			writeAnyway = true;		
-	}
-
-	if (!repeatMessage || writeAnyway)
-	{
-		if (!repeatMessage && RepeatCount.localData())
-			repeatedSummary();
-
-		Logger::T_LOG_MESSAGE logMsg;
-
-		logMsg.appName     = _appname;
-		logMsg.loggerName  = _name;
-		logMsg.function    = QString(func);
-		logMsg.line        = line;
-		logMsg.fileName    = FileUtils::getBaseName(sourceFile);
-		logMsg.utime       = QDateTime::currentMSecsSinceEpoch();
-		logMsg.message     = QString(msg);
-		logMsg.level       = level;
-		logMsg.levelString = LogLevelStrings[level];
-
-		write(logMsg);
-#ifndef _WIN32
-		if ( _syslogEnabled && level >= Logger::WARNING )
-			syslog (LogLevelSysLog[level], "%s", msg);
-#endif
-		RepeatMessage.setLocalData(logMsg);
-	}
+	if (worker.isStopped())
+		worker.drain();
+	else
+		worker.notify();
 }
 
 LoggerManager::LoggerManager()
@@ -0,0 +1,290 @@
+// STL includes
+#include <map>
+#include <memory>
+#include <vector>
+
+// Qt includes
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <utils/Metrics.h>
+#include <utils/Logger.h>
+
+namespace
+{
+	struct Family
+	{
+		Metrics::Type type;
+		QString help;
+		std::map<QString, std::unique_ptr<Metrics::Metric>> series;
+	};
+
+	QMutex& registryMutex()
+	{
+		static QMutex mutex;
+		return mutex;
+	}
+
+	std::map<QString, Family>& registry()
+	{
+		static std::map<QString, Family> families;
+		return families;
+	}
+
+	/// Metrics handed out for a name registered with another type, they are not exported
+	std::vector<std::unique_ptr<Metrics::Metric>>& unregistered()
+	{
+		static std::vector<std::unique_ptr<Metrics::Metric>> metrics;
+		return metrics;
+	}
+
+	const char* typeName(Metrics::Type type)
+	{
+		return (type == Metrics::Type::COUNTER) ? "counter" : (type == Metrics::Type::GAUGE) ? "gauge" : "histogram";
+	}
+
+	QString seriesKey(const QString& name, const QString& labels)
+	{
+		return (labels.isEmpty()) ? name : QString("%1{%2}").arg(name).arg(labels);
+	}
+
+	QByteArray seriesName(const QByteArray& name, const QByteArray& labels, const QByteArray& extraLabel = QByteArray())
+	{
+		QByteArray all = labels;
+		if (!extraLabel.isEmpty())
+			all += (all.isEmpty() ? "" : ",") + extraLabel;
+
+		return (all.isEmpty()) ? name : name + '{' + all + '}';
+	}
+
+	// upper bound of the bucket in milliseconds
+	double bucketLimit(int bucket)
+	{
+		return (uint64_t(1) << bucket) / 1000.0;
+	}
+}
+
+int Metrics::Metric::shardIndex()
+{
+	static std::atomic<int> nextShard(0);
+	static thread_local int shard = nextShard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+
+	return shard;
+}
+
+Metrics::Counter::Counter()
+{
+	for (Shard& shard : _shards)
+		shard.value.store(0, std::memory_order_relaxed);
+}
+
+uint64_t Metrics::Counter::value() const
+{
+	uint64_t total = 0;
+
+	for (const Shard& shard : _shards)
+		total += shard.value.load(std::memory_order_relaxed);
+
+	return total;
+}
+
+void Metrics::Counter::toJson(QJsonObject& json, const QString& key) const
+{
+	json[key] = (double)value();
+}
+
+void Metrics::Counter::toPrometheus(QByteArray& out, const QByteArray& name, const QByteArray& labels) const
+{
+	out += seriesName(name, labels) + ' ' + QByteArray::number((qulonglong)value()) + '\n';
+}
+
+Metrics::Gauge::Gauge()
+	: _value(0)
+{
+}
+
+void Metrics::Gauge::toJson(QJsonObject& json, const QString& key) const
+{
+	json[key] = value();
+}
+
+void Metrics::Gauge::toPrometheus(QByteArray& out, const QByteArray& name, const QByteArray& labels) const
+{
+	out += seriesName(name, labels) + ' ' + QByteArray::number(value()) + '\n';
+}
+
+Metrics::Histogram::Histogram()
+{
+	for (Shard& shard : _shards)
+	{
+		for (std::atomic<uint64_t>& bucket : shard.buckets)
+			bucket.store(0, std::memory_order_relaxed);
+		shard.sum.store(0, std::memory_order_relaxed);
+	}
+}
+
+void Metrics::Histogram::collect(uint64_t* buckets, uint64_t& count, uint64_t& sum) const
+{
+	count = 0;
+	sum = 0;
+
+	for (int i = 0; i < BUCKETS; i++)
+		buckets[i] = 0;
+
+	for (const Shard& shard : _shards)
+	{
+		for (int i = 0; i < BUCKETS; i++)
+			buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+		sum += shard.sum.load(std::memory_order_relaxed);
+	}
+
+	for (int i = 0; i < BUCKETS; i++)
+		count += buckets[i];
+}
+
+void Metrics::Histogram::toJson(QJsonObject& json, const QString& key) const
+{
+	uint64_t buckets[BUCKETS], count, sum;
+	collect(buckets, count, sum);
+
+	QJsonObject stats;
+	stats["count"] = (double)count;
+	stats["avg_ms"] = (count > 0) ? sum / (count * 1000.0) : 0.0;
+
+	// percentiles are reported as the upper bound of their bucket
+	const double percentiles[] = { 0.5, 0.95, 0.99 };
+	const char* names[] = { "p50_ms", "p95_ms", "p99_ms" };
+
+	for (int p = 0; p < 3; p++)
+	{
+		uint64_t rank = (uint64_t)(count * percentiles[p]), seen = 0;
+		int bucket = 0;
+
+		while (bucket < BUCKETS - 1 && seen + buckets[bucket] <= rank)
+			seen += buckets[bucket++];
+
+		stats[names[p]] = (count > 0) ? bucketLimit(bucket) : 0.0;
+	}
+
+	json[key] = stats;
+}
+
+void Metrics::Histogram::toPrometheus(QByteArray& out, const QByteArray& name, const QByteArray& labels) const
+{
+	uint64_t buckets[BUCKETS], count, sum, cumulative = 0;
+	collect(buckets, count, sum);
+
+	for (int i = 0; i < BUCKETS - 1; i++)
+	{
+		cumulative += buckets[i];
+		out += seriesName(name + "_bucket", labels, "le=\"" + QByteArray::number(bucketLimit(i) / 1000.0) + '"') + ' ' + QByteArray::number((qulonglong)cumulative) + '\n';
+	}
+
+	out += seriesName(name + "_bucket", labels, "le=\"+Inf\"") + ' ' + QByteArray::number((qulonglong)count) + '\n';
+	out += seriesName(name + "_sum", labels) + ' ' + QByteArray::number(sum / 1000000.0) + '\n';
+	out += seriesName(name + "_count", labels) + ' ' + QByteArray::number((qulonglong)count) + '\n';
+}
+
+Metrics::Metric* Metrics::create(Type type)
+{
+	switch (type)
+	{
+		case Type::COUNTER: return new Counter();
+		case Type::GAUGE: return new Gauge();
+		default: return new Histogram();
+	}
+}
+
+Metrics::Metric* Metrics::getOrCreate(Type type, const QString& name, const QString& help, const QString& labels)
+{
+	Type registeredType;
+	Metric* result;
+	{
+		QMutexLocker locker(&registryMutex());
+
+		std::map<QString, Family>::iterator family = registry().find(name);
+		if (family == registry().end())
+		{
+			Family newFamily;
+			newFamily.type = type;
+			newFamily.help = help;
+			family = registry().emplace(name, std::move(newFamily)).first;
+		}
+
+		registeredType = family->second.type;
+
+		if (registeredType != type)
+		{
+			// the caller casts the result to the requested type: it must never get the registered series
+			unregistered().emplace_back(create(type));
+			result = unregistered().back().get();
+		}
+		else
+		{
+			std::unique_ptr<Metric>& metric = family->second.series[labels];
+			if (metric == nullptr)
+				metric.reset(create(type));
+			result = metric.get();
+		}
+	}
+
+	if (registeredType != type)
+	{
+		Error(Logger::getInstance("METRICS"), "The metric '%s' is already registered as a %s, the %s is not exported",
+			QSTRING_CSTR(name), typeName(registeredType), typeName(type));
+	}
+
+	return result;
+}
+
+Metrics::Counter* Metrics::counter(const QString& name, const QString& help, const QString& labels)
+{
+	return static_cast<Counter*>(getOrCreate(Type::COUNTER, name, help, labels));
+}
+
+Metrics::Gauge* Metrics::gauge(const QString& name, const QString& help, const QString& labels)
+{
+	return static_cast<Gauge*>(getOrCreate(Type::GAUGE, name, help, labels));
+}
+
+Metrics::Histogram* Metrics::histogram(const QString& name, const QString& help, const QString& labels)
+{
+	return static_cast<Histogram*>(getOrCreate(Type::HISTOGRAM, name, help, labels));
+}
+
+QString Metrics::instanceLabel(int instance)
+{
+	return QString("instance=\"%1\"").arg(instance);
+}
+
+QJsonObject Metrics::toJson()
+{
+	QJsonObject json;
+	QMutexLocker locker(&registryMutex());
+
+	for (const auto& family : registry())
+		for (const auto& series : family.second.series)
+			series.second->toJson(json, seriesKey(family.first, series.first));
+
+	return json;
+}
+
+QByteArray Metrics::toPrometheus()
+{
+	QByteArray out;
+	QMutexLocker locker(&registryMutex());
+
+	for (const auto& family : registry())
+	{
+		const QByteArray name = family.first.toUtf8();
+		const char* type = typeName(family.second.type);
+
+		out += "# HELP " + name + ' ' + family.second.help.toUtf8() + '\n';
+		out += "# TYPE " + name + ' ' + type + '\n';
+
+		for (const auto& series : family.second.series)
+			series.second->toPrometheus(out, name, series.first.toUtf8());
+	}
+
+	return out;
+}
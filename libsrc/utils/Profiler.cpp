@@ -4,51 +4,91 @@
 
 #include <QFileInfo>
 #include <QString>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFile>
+
+#include <limits>
 
 struct StopWatchItem {
 	const char* sourceFile;
 	const char* func;
 	unsigned int line;
-	clock_t startTime;
+	std::chrono::steady_clock::time_point startTime;
+};
+
+struct StatisticsItem {
+	quint64 count;
+	double total;
+	double minimum;
+	double maximum;
 };
 
 static unsigned int blockCounter = 0;
 static std::map<QString,StopWatchItem> GlobalProfilerMap;
+static std::map<QString,StatisticsItem> GlobalStatisticsMap;
+static QMutex GlobalProfilerMutex;
 Logger* Profiler::_logger = nullptr;
 
-double getClockDelta(clock_t start)
+double getClockDelta(std::chrono::steady_clock::time_point start)
 {
-	return ((double)(clock() - start) / CLOCKS_PER_SEC);
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 }
 
 Profiler::Profiler(const char* sourceFile, const char* func, unsigned int line)
 	: _file(sourceFile)
 	, _func(func)
 	, _line(line)
-	, _blockId(blockCounter++)
-	, _startTime(clock())
+	, _blockId(0)
+	, _startTime(std::chrono::steady_clock::now())
 {
 	Profiler::initLogger();
+	{
+		QMutexLocker locker(&GlobalProfilerMutex);
+		_blockId = blockCounter++;
+	}
 	_logger->Message(Logger::DEBUG,_file,_func,_line,">>> enter block %d", _blockId);
 }
 
 Profiler::~Profiler()
 {
-  	_logger->Message( Logger::DEBUG, _file,_func, _line, "<<< exit block %d, executed for %f s", _blockId, getClockDelta(_startTime));
+	double delta = getClockDelta(_startTime);
+
+	addSample(QString("block %1:%2:%3()").arg(FileUtils::getBaseName(_file)).arg(_line).arg(_func), delta);
+  	_logger->Message( Logger::DEBUG, _file,_func, _line, "<<< exit block %d, executed for %f s", _blockId, delta);
 }
 
 void Profiler::initLogger()
 {
+	QMutexLocker locker(&GlobalProfilerMutex);
+
 	if (_logger == nullptr)
 		_logger = Logger::getInstance("PROFILER", Logger::DEBUG);
 }
 
+void Profiler::addSample(const QString& name, double seconds)
+{
+	QMutexLocker locker(&GlobalProfilerMutex);
+
+	StatisticsItem empty = { 0, 0, std::numeric_limits<double>::max(), 0 };
+	StatisticsItem& item = GlobalStatisticsMap.emplace(name, empty).first->second;
+
+	item.count++;
+	item.total += seconds;
+	item.minimum = std::min(item.minimum, seconds);
+	item.maximum = std::max(item.maximum, seconds);
+}
+
 void Profiler::TimerStart(const QString& timerName, const char* sourceFile, const char* func, unsigned int line)
 {
 	std::pair<std::map<QString,StopWatchItem>::iterator,bool> ret;
 	Profiler::initLogger();
 
-	StopWatchItem item = {sourceFile, func, line};
+	QMutexLocker locker(&GlobalProfilerMutex);
+
+	StopWatchItem item = {sourceFile, func, line, std::chrono::steady_clock::now()};
 
 	ret = GlobalProfilerMap.emplace(timerName, item);
 	if (!ret.second)
@@ -56,7 +96,7 @@ void Profiler::TimerStart(const QString& timerName, const char* sourceFile, cons
 		if (ret.first->second.sourceFile == sourceFile && ret.first->second.func == func && ret.first->second.line == line)
 		{
 			_logger->Message(Logger::DEBUG, sourceFile, func, line, "restart timer '%s'", QSTRING_CSTR(timerName));
-			ret.first->second.startTime = clock();
+			ret.first->second.startTime = std::chrono::steady_clock::now();
 		}
 		else
 		{
@@ -73,15 +113,103 @@ void Profiler::TimerStart(const QString& timerName, const char* sourceFile, cons
 
 void Profiler::TimerGetTime(const QString& timerName, const char* sourceFile, const char* func, unsigned int line)
 {
-	std::map<QString,StopWatchItem>::iterator ret = GlobalProfilerMap.find(timerName);
 	Profiler::initLogger();
+
+	QMutexLocker locker(&GlobalProfilerMutex);
+
+	std::map<QString,StopWatchItem>::iterator ret = GlobalProfilerMap.find(timerName);
 	if (ret != GlobalProfilerMap.end())
 	{
+		double delta = getClockDelta(ret->second.startTime);
+
 		_logger->Message(Logger::DEBUG, sourceFile, func, line, "timer '%s' started at %s:%d:%s() took %f s execution time until here", QSTRING_CSTR(timerName),
-		                 FileUtils::getBaseName(ret->second.sourceFile).toLocal8Bit().constData(), ret->second.line, ret->second.func, getClockDelta(ret->second.startTime));
+		                 FileUtils::getBaseName(ret->second.sourceFile).toLocal8Bit().constData(), ret->second.line, ret->second.func, delta);
+
+		locker.unlock();
+		addSample(timerName, delta);
 	}
 	else
 	{
 		_logger->Message(Logger::DEBUG, sourceFile, func, line, "ERROR timer '%s' not started", QSTRING_CSTR(timerName));
 	}
 }
+
+bool Profiler::SaveStatistics(const QString& fileName)
+{
+	QJsonObject timers;
+
+	Profiler::initLogger();
+
+	{
+		QMutexLocker locker(&GlobalProfilerMutex);
+
+		for (const auto& entry : GlobalStatisticsMap)
+		{
+			const StatisticsItem& item = entry.second;
+			QJsonObject timer;
+
+			timer["count"] = (double)item.count;
+			timer["average_ms"] = item.total * 1000.0 / item.count;
+			timer["min_ms"] = item.minimum * 1000.0;
+			timer["max_ms"] = item.maximum * 1000.0;
+			timer["total_ms"] = item.total * 1000.0;
+			timers[entry.first] = timer;
+		}
+	}
+
+	QJsonObject root;
+	root["version"] = HYPERHDR_VERSION;
+	root["timers"] = timers;
+
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		Error(_logger, "Cannot write the profiler statistics to '%s'", QSTRING_CSTR(fileName));
+		return false;
+	}
+
+	file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+	file.close();
+
+	Info(_logger, "Statistics of %d timer(s) saved to '%s'", timers.size(), QSTRING_CSTR(fileName));
+	return true;
+}
+
+int Profiler::CompareStatistics(const QString& baselineFileName, double tolerancePercent)
+{
+	int regressions = 0;
+
+	Profiler::initLogger();
+
+	QFile file(baselineFileName);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		Warning(_logger, "Cannot read the profiler baseline '%s'", QSTRING_CSTR(baselineFileName));
+		return -1;
+	}
+
+	const QJsonObject baseline = QJsonDocument::fromJson(file.readAll()).object()["timers"].toObject();
+	file.close();
+
+	QMutexLocker locker(&GlobalProfilerMutex);
+
+	for (const auto& entry : GlobalStatisticsMap)
+	{
+		if (!baseline.contains(entry.first))
+			continue;
+
+		const StatisticsItem& item = entry.second;
+		double current = item.total * 1000.0 / item.count;
+		double previous = baseline[entry.first].toObject()["average_ms"].toDouble();
+
+		if (previous > 0 && current > previous * (1.0 + tolerancePercent / 100.0))
+		{
+			Warning(_logger, "Regression '%s': %.3f ms, baseline %.3f ms (+%.1f%%)",
+			        QSTRING_CSTR(entry.first), current, previous, (current / previous - 1.0) * 100.0);
+			regressions++;
+		}
+	}
+
+	Info(_logger, "Compared with the baseline '%s': %d regression(s) over %.1f%%", QSTRING_CSTR(baselineFileName), regressions, tolerancePercent);
+	return regressions;
+}
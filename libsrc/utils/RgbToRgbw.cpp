@@ -82,4 +82,38 @@ void Rgb_to_Rgbw(ColorRgb input, ColorRgbw * output, WhiteAlgorithm algorithm)
 	}
 }
 
+RgbwTable::RgbwTable(WhiteAlgorithm algorithm)
+{
+	setAlgorithm(algorithm);
+}
+
+void RgbwTable::setAlgorithm(WhiteAlgorithm algorithm)
+{
+	// same factors as Rgb_to_Rgbw
+	double factors[3] = { 1.0, 1.0, 1.0 };
+
+	if (algorithm == WhiteAlgorithm::SUB_MIN_WARM_ADJUST)
+	{
+		factors[0] = 0.274;
+		factors[1] = 0.454;
+		factors[2] = 2.333;
+	}
+	else if (algorithm == WhiteAlgorithm::SUB_MIN_COOL_ADJUST)
+	{
+		factors[0] = 0.299;
+		factors[1] = 0.587;
+		factors[2] = 0.114;
+	}
+
+	_algorithm = algorithm;
+
+	for (int c = 0; c < 3; c++)
+		for (int v = 0; v < 256; v++)
+		{
+			// the white value never exceeds the smallest channel contribution, saturation is harmless
+			_toWhite[c][v] = static_cast<uint8_t>(qMin(255.0, v * factors[c]));
+			_fromWhite[c][v] = static_cast<uint8_t>(qMin(255.0, v / factors[c]));
+		}
+}
+
 };
@@ -0,0 +1,425 @@
+#include <utils/ThreadTopology.h>
+#include <utils/Logger.h>
+#include <utils/QStringUtils.h>
+
+#include <QThread>
+#include <QStringList>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+	#include <time.h>
+	#include <unistd.h>
+	#include <sys/resource.h>
+	#include <sys/syscall.h>
+#endif
+
+namespace
+{
+	const int MAX_CPUS = 64;
+	const int ROLES = static_cast<int>(ThreadTopology::Role::COUNT);
+
+	struct Placement
+	{
+		uint64_t					cpus;		// bit mask, 0 = all CPUs
+		ThreadTopology::Priority	priority;
+	};
+
+	struct ThreadEntry
+	{
+		uint64_t				id;
+		ThreadTopology::Role	role;
+		QString					name;
+		QThread*				thread;
+#if defined(__linux__)
+		pthread_t				handle;
+		pid_t					tid;
+#endif
+	};
+
+	struct FinishedThreads
+	{
+		ThreadTopology::Role	role;
+		uint64_t				count;
+		uint64_t				cpuTime;	// ns
+	};
+
+	struct Registry
+	{
+		std::mutex							mutex;
+		std::vector<ThreadEntry>			threads;
+		std::map<QString, FinishedThreads>	finished;
+		Placement							placement[ROLES];
+		bool								warned[ROLES];
+		uint64_t							nextId;
+
+		Registry()
+			: nextId(1)
+		{
+			for (int i = 0; i < ROLES; i++)
+			{
+				placement[i].cpus = 0;
+				placement[i].priority = ThreadTopology::Priority::NORMAL;
+				warned[i] = false;
+			}
+		}
+	};
+
+	Registry& registry()
+	{
+		static Registry instance;
+		return instance;
+	}
+
+	Logger* threadsLog()
+	{
+		return Logger::getInstance("THREADS");
+	}
+
+	uint64_t parseCpus(const QString& cpus)
+	{
+		uint64_t mask = 0;
+
+		for (const QString& part : QStringUtils::SPLITTER(cpus, ','))
+		{
+			const QStringList range = part.trimmed().split('-');
+			bool ok1 = false, ok2 = false;
+			const int first = range[0].toInt(&ok1);
+			const int last = (range.size() > 1) ? range[1].toInt(&ok2) : first;
+
+			if (!ok1 || (range.size() > 1 && !ok2) || range.size() > 2)
+				continue;
+
+			for (int cpu = std::max(first, 0); cpu <= std::min(last, MAX_CPUS - 1); cpu++)
+				mask |= (1ull << cpu);
+		}
+
+		return mask;
+	}
+
+	bool isDefault(const Placement& placement)
+	{
+		return placement.cpus == 0 && placement.priority == ThreadTopology::Priority::NORMAL;
+	}
+
+	///
+	/// Applies the placement to a running thread, returns an error description or an empty string
+	///
+	QString applyPlacement(const ThreadEntry& entry, const Placement& placement)
+	{
+		QString error;
+
+#if defined(__linux__)
+		cpu_set_t cpuset;
+		CPU_ZERO(&cpuset);
+		for (int cpu = 0; cpu < MAX_CPUS; cpu++)
+			if (placement.cpus == 0 || (placement.cpus & (1ull << cpu)))
+				CPU_SET(cpu, &cpuset);
+
+		int rc = pthread_setaffinity_np(entry.handle, sizeof(cpu_set_t), &cpuset);
+		if (rc != 0)
+			error = QString("affinity: %1").arg(strerror(rc));
+
+		sched_param param;
+		memset(&param, 0, sizeof(param));
+		int policy = SCHED_OTHER;
+
+		if (placement.priority == ThreadTopology::Priority::REALTIME)
+		{
+			policy = SCHED_FIFO;
+			param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+		}
+
+		rc = pthread_setschedparam(entry.handle, policy, &param);
+		if (rc != 0)
+			error += QString("%1priority: %2").arg(error.isEmpty() ? "" : ", ").arg(strerror(rc));
+
+		if (policy == SCHED_OTHER)
+		{
+			// the nice value of a Linux thread is set by its thread id
+			int nice = (placement.priority == ThreadTopology::Priority::LOW) ? 10 : (placement.priority == ThreadTopology::Priority::HIGH) ? -5 : 0;
+			if (setpriority(PRIO_PROCESS, entry.tid, nice) != 0)
+				error += QString("%1nice: %2").arg(error.isEmpty() ? "" : ", ").arg(strerror(errno));
+		}
+#else
+		if (entry.thread != nullptr)
+		{
+			switch (placement.priority)
+			{
+				case ThreadTopology::Priority::LOW:      entry.thread->setPriority(QThread::LowPriority); break;
+				case ThreadTopology::Priority::HIGH:     entry.thread->setPriority(QThread::HighPriority); break;
+				case ThreadTopology::Priority::REALTIME: entry.thread->setPriority(QThread::TimeCriticalPriority); break;
+				default:                                 entry.thread->setPriority(QThread::NormalPriority); break;
+			}
+		}
+#endif
+
+		return error;
+	}
+
+	uint64_t cpuTime(const ThreadEntry& entry)
+	{
+#if defined(__linux__)
+		clockid_t clock;
+		timespec ts;
+		if (pthread_getcpuclockid(entry.handle, &clock) == 0 && clock_gettime(clock, &ts) == 0)
+			return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#else
+		Q_UNUSED(entry);
+#endif
+		return 0;
+	}
+
+	void unregisterThread(uint64_t id)
+	{
+		Registry& reg = registry();
+		std::lock_guard<std::mutex> lock(reg.mutex);
+
+		for (auto it = reg.threads.begin(); it != reg.threads.end(); ++it)
+			if (it->id == id)
+			{
+				// the thread is still alive here: the time of the exiting thread is kept under its name
+				FinishedThreads& finished = reg.finished[it->name];
+				finished.role = it->role;
+				finished.count++;
+				finished.cpuTime += cpuTime(*it);
+
+				reg.threads.erase(it);
+				break;
+			}
+	}
+
+	// removes the thread from the registry when it ends
+	struct ThreadGuard
+	{
+		uint64_t id = 0;
+
+		~ThreadGuard()
+		{
+			if (id != 0)
+				unregisterThread(id);
+		}
+	};
+
+	thread_local ThreadGuard threadGuard;
+}
+
+void ThreadTopology::registerCurrentThread(Role role, const QString& name)
+{
+	QThread* thread = QThread::currentThread();
+
+	if (thread != nullptr && thread->objectName() != name)
+		thread->setObjectName(name);
+
+#if defined(__linux__)
+	// the kernel keeps 15 characters
+	pthread_setname_np(pthread_self(), name.left(15).toLocal8Bit().constData());
+#endif
+
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+
+	ThreadEntry* entry = nullptr;
+
+	for (ThreadEntry& current : reg.threads)
+		if (current.id == threadGuard.id)
+			entry = &current;
+
+	if (entry == nullptr)
+	{
+		ThreadEntry newEntry;
+		newEntry.id = reg.nextId++;
+		newEntry.thread = thread;
+#if defined(__linux__)
+		newEntry.handle = pthread_self();
+		newEntry.tid = static_cast<pid_t>(syscall(SYS_gettid));
+#endif
+		reg.threads.push_back(newEntry);
+		entry = &reg.threads.back();
+		threadGuard.id = entry->id;
+	}
+
+	entry->role = role;
+	entry->name = name;
+
+	const Placement& placement = reg.placement[static_cast<int>(role)];
+
+	// short-living workers start with the default placement: no system calls
+	if (!isDefault(placement))
+	{
+		QString error = applyPlacement(*entry, placement);
+
+		if (!error.isEmpty() && !reg.warned[static_cast<int>(role)])
+		{
+			reg.warned[static_cast<int>(role)] = true;
+			Warning(threadsLog(), "Could not place the %s thread '%s' (%s). CAP_SYS_NICE is required for the high and realtime priority.",
+				QSTRING_CSTR(roleToString(role)), QSTRING_CSTR(name), QSTRING_CSTR(error));
+		}
+	}
+}
+
+void ThreadTopology::placeCurrentThread(int cpu, Priority priority)
+{
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+
+	for (ThreadEntry& entry : reg.threads)
+		if (entry.id == threadGuard.id)
+		{
+			Placement placement;
+			placement.cpus = (cpu >= 0 && cpu < MAX_CPUS) ? (1ull << cpu) : 0;
+			placement.priority = priority;
+
+			QString error = applyPlacement(entry, placement);
+
+			if (error.isEmpty())
+				Info(threadsLog(), "The %s thread '%s' runs on %s with %s priority", QSTRING_CSTR(roleToString(entry.role)), QSTRING_CSTR(entry.name),
+					(cpu >= 0) ? QSTRING_CSTR(QString("CPU %1").arg(cpu)) : "all CPUs", QSTRING_CSTR(priorityToString(priority)));
+			else
+				Warning(threadsLog(), "Could not place the %s thread '%s' (%s). CAP_SYS_NICE is required for the high and realtime priority.",
+					QSTRING_CSTR(roleToString(entry.role)), QSTRING_CSTR(entry.name), QSTRING_CSTR(error));
+			return;
+		}
+}
+
+void ThreadTopology::configure(const QJsonObject& generalConfig)
+{
+	const struct
+	{
+		Role		role;
+		const char*	prefix;
+	} roles[] = { { Role::CAPTURE_WORKER, "captureThreads" }, { Role::INSTANCE, "instanceThreads" }, { Role::EFFECT, "effectThreads" } };
+
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+
+	for (const auto& item : roles)
+	{
+		Placement placement;
+		placement.cpus = parseCpus(generalConfig[QString("%1Cpus").arg(item.prefix)].toString());
+		placement.priority = stringToPriority(generalConfig[QString("%1Priority").arg(item.prefix)].toString("normal"));
+
+		Placement& current = reg.placement[static_cast<int>(item.role)];
+
+		if (current.cpus == placement.cpus && current.priority == placement.priority)
+			continue;
+
+		current = placement;
+		reg.warned[static_cast<int>(item.role)] = false;
+
+		Info(threadsLog(), "%s threads: %s, %s priority", QSTRING_CSTR(roleToString(item.role)),
+			(placement.cpus == 0) ? "all CPUs" : QSTRING_CSTR(QString("CPU mask 0x%1").arg(placement.cpus, 0, 16)),
+			QSTRING_CSTR(priorityToString(placement.priority)));
+
+		for (const ThreadEntry& entry : reg.threads)
+			if (entry.role == item.role)
+			{
+				QString error = applyPlacement(entry, placement);
+
+				if (!error.isEmpty() && !reg.warned[static_cast<int>(item.role)])
+				{
+					reg.warned[static_cast<int>(item.role)] = true;
+					Warning(threadsLog(), "Could not place the %s thread '%s' (%s)", QSTRING_CSTR(roleToString(item.role)), QSTRING_CSTR(entry.name), QSTRING_CSTR(error));
+				}
+			}
+	}
+}
+
+QJsonArray ThreadTopology::report()
+{
+	struct Summary
+	{
+		Role		role;
+		int			running;
+		uint64_t	finished;
+		uint64_t	cpuTime;
+	};
+
+	std::map<QString, Summary> summary;
+
+	Registry& reg = registry();
+	{
+		std::lock_guard<std::mutex> lock(reg.mutex);
+
+		for (const auto& finished : reg.finished)
+		{
+			Summary& item = summary[finished.first];
+			item.role = finished.second.role;
+			item.running = 0;
+			item.finished = finished.second.count;
+			item.cpuTime = finished.second.cpuTime;
+		}
+
+		for (const ThreadEntry& entry : reg.threads)
+		{
+			auto found = summary.find(entry.name);
+			if (found == summary.end())
+			{
+				Summary item = { entry.role, 0, 0, 0 };
+				found = summary.insert(std::make_pair(entry.name, item)).first;
+			}
+
+			found->second.running++;
+			found->second.cpuTime += cpuTime(entry);
+		}
+	}
+
+	QJsonArray result;
+
+	for (const auto& item : summary)
+	{
+		QJsonObject thread;
+		thread["name"] = item.first;
+		thread["role"] = roleToString(item.second.role);
+		thread["running"] = item.second.running;
+		thread["finished"] = (qint64)item.second.finished;
+#if defined(__linux__)
+		thread["cpuTime"] = item.second.cpuTime / 1000000000.0;
+#endif
+		result.append(thread);
+	}
+
+	return result;
+}
+
+QString ThreadTopology::roleToString(Role role)
+{
+	switch (role)
+	{
+		case Role::INSTANCE:       return "instance";
+		case Role::LED_OUTPUT:     return "ledOutput";
+		case Role::CAPTURE_WORKER: return "capture";
+		case Role::EFFECT:         return "effect";
+		default:                   return "other";
+	}
+}
+
+QString ThreadTopology::priorityToString(Priority priority)
+{
+	switch (priority)
+	{
+		case Priority::LOW:      return "low";
+		case Priority::HIGH:     return "high";
+		case Priority::REALTIME: return "realtime";
+		default:                 return "normal";
+	}
+}
+
+ThreadTopology::Priority ThreadTopology::stringToPriority(const QString& priority)
+{
+	if (priority == "low")
+		return Priority::LOW;
+	else if (priority == "high")
+		return Priority::HIGH;
+	else if (priority == "realtime")
+		return Priority::REALTIME;
+
+	return Priority::NORMAL;
+}
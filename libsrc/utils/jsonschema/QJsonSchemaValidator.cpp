@@ -0,0 +1,267 @@
+// stdlib includes
+#include <math.h>
+
+// Utils-Jsonschema includes
+#include <utils/jsonschema/QJsonSchemaValidator.h>
+
+QJsonSchemaValidator::QJsonSchemaValidator()
+{
+}
+
+QJsonSchemaValidator::~QJsonSchemaValidator()
+{
+}
+
+bool QJsonSchemaValidator::compile(const QJsonObject& schema)
+{
+	std::unique_ptr<Node> root(new Node());
+
+	if (!compileNode(*root, schema))
+	{
+		_root.reset();
+		return false;
+	}
+
+	_root = std::move(root);
+	return true;
+}
+
+bool QJsonSchemaValidator::isCompiled() const
+{
+	return _root != nullptr;
+}
+
+bool QJsonSchemaValidator::validate(const QJsonObject& value) const
+{
+	if (_root == nullptr)
+		return false;
+
+	return validateNode(*_root, value);
+}
+
+bool QJsonSchemaValidator::compileNode(Node& node, const QJsonObject& schema)
+{
+	for (QJsonObject::const_iterator i = schema.begin(); i != schema.end(); ++i)
+	{
+		const QString attribute = i.key();
+		const QJsonValue& attributeValue = *i;
+
+		if (attribute == "type")
+		{
+			QString type = attributeValue.toString();
+
+			if (type == "string" || type == "enum")
+				node.type = Type::STRING;
+			else if (type == "number" || type == "double")
+				node.type = Type::NUMBER;
+			else if (type == "integer")
+				node.type = Type::INTEGER;
+			else if (type == "boolean")
+				node.type = Type::BOOLEAN;
+			else if (type == "object")
+				node.type = Type::OBJECT;
+			else if (type == "array")
+				node.type = Type::ARRAY;
+			else if (type == "null")
+				node.type = Type::NULLTYPE;
+			else
+				node.type = Type::ANY;
+		}
+		else if (attribute == "properties")
+		{
+			const QJsonObject properties = attributeValue.toObject();
+
+			node.checkProperties = true;
+			for (QJsonObject::const_iterator p = properties.begin(); p != properties.end(); ++p)
+			{
+				const QJsonObject propertySchema = (*p).toObject();
+
+				// verifyDeps: the property can be skipped depending on the value of another one
+				if (propertySchema["options"].toObject().contains("dependencies"))
+					return false;
+
+				Property property;
+				property.key = p.key();
+				property.required = propertySchema["required"].toBool();
+				property.node.reset(new Node());
+
+				if (!compileNode(*property.node, propertySchema))
+					return false;
+
+				node.properties.push_back(std::move(property));
+			}
+		}
+		else if (attribute == "additionalProperties")
+		{
+			if (!attributeValue.isBool())
+				return false;
+
+			node.denyAdditional = !attributeValue.toBool();
+		}
+		else if (attribute == "dependencies")
+			return false;
+		else if (attribute == "minimum")
+		{
+			node.checkMinimum = true;
+			node.minimum = attributeValue.toDouble();
+		}
+		else if (attribute == "maximum")
+		{
+			node.checkMaximum = true;
+			node.maximum = attributeValue.toDouble();
+		}
+		else if (attribute == "minLength")
+		{
+			node.checkMinLength = true;
+			node.minLength = attributeValue.toInt();
+		}
+		else if (attribute == "maxLength")
+		{
+			node.checkMaxLength = true;
+			node.maxLength = attributeValue.toInt();
+		}
+		else if (attribute == "items")
+		{
+			node.checkArray = true;
+			node.items.reset(new Node());
+			if (!compileNode(*node.items, attributeValue.toObject()))
+				return false;
+		}
+		else if (attribute == "minItems")
+		{
+			node.checkArray = true;
+			node.checkMinItems = true;
+			node.minItems = attributeValue.toInt();
+		}
+		else if (attribute == "maxItems")
+		{
+			node.checkArray = true;
+			node.checkMaxItems = true;
+			node.maxItems = attributeValue.toInt();
+		}
+		else if (attribute == "uniqueItems")
+		{
+			node.checkArray = true;
+			node.uniqueItems = attributeValue.toBool();
+		}
+		else if (attribute == "enum")
+		{
+			// not an array: QJsonSchemaChecker rejects every value
+			node.checkEnum = true;
+			if (attributeValue.isArray())
+			{
+				const QJsonArray values = attributeValue.toArray();
+				for (const QJsonValue& enumValue : values)
+					node.enumValues.push_back(enumValue);
+			}
+		}
+
+		// other attributes are annotations or only schema errors, they do not affect the result
+	}
+
+	return true;
+}
+
+bool QJsonSchemaValidator::validateObject(const Node& node, const QJsonObject& value)
+{
+	int found = 0;
+
+	if (node.checkProperties)
+	{
+		for (const Property& property : node.properties)
+		{
+			QJsonObject::const_iterator member = value.constFind(property.key);
+
+			if (member != value.constEnd())
+			{
+				found++;
+				if (!validateNode(*property.node, *member))
+					return false;
+			}
+			else if (property.required)
+				return false;
+		}
+	}
+
+	if (node.denyAdditional && value.size() > found)
+		return false;
+
+	return true;
+}
+
+bool QJsonSchemaValidator::validateNode(const Node& node, const QJsonValue& value)
+{
+	switch (node.type)
+	{
+		case Type::STRING: if (!value.isString()) return false; break;
+		case Type::NUMBER: if (!value.isDouble()) return false; break;
+		case Type::INTEGER: if (!value.isDouble() || rint(value.toDouble()) != value.toDouble()) return false; break;
+		case Type::BOOLEAN: if (!value.isBool()) return false; break;
+		case Type::OBJECT: if (!value.isObject()) return false; break;
+		case Type::ARRAY: if (!value.isArray()) return false; break;
+		case Type::NULLTYPE: if (!value.isNull()) return false; break;
+		default: break;
+	}
+
+	if ((node.checkMinimum || node.checkMaximum) && !value.isDouble())
+		return false;
+	if (node.checkMinimum && value.toDouble() < node.minimum)
+		return false;
+	if (node.checkMaximum && value.toDouble() > node.maximum)
+		return false;
+
+	if (node.checkMinLength || node.checkMaxLength)
+	{
+		if (!value.isString())
+			return false;
+
+		int length = value.toString().size();
+		if (node.checkMinLength && length < node.minLength)
+			return false;
+		if (node.checkMaxLength && length > node.maxLength)
+			return false;
+	}
+
+	if (node.checkEnum)
+	{
+		bool match = false;
+		for (const QJsonValue& enumValue : node.enumValues)
+			if (enumValue == value)
+			{
+				match = true;
+				break;
+			}
+
+		if (!match)
+			return false;
+	}
+
+	if (node.checkArray)
+	{
+		if (!value.isArray())
+			return false;
+
+		const QJsonArray array = value.toArray();
+
+		if (node.checkMinItems && array.size() < node.minItems)
+			return false;
+		if (node.checkMaxItems && array.size() > node.maxItems)
+			return false;
+
+		if (node.items != nullptr)
+			for (const QJsonValue& item : array)
+				if (!validateNode(*node.items, item))
+					return false;
+
+		if (node.uniqueItems)
+			for (int i = 0; i < array.size(); ++i)
+				for (int j = i + 1; j < array.size(); ++j)
+					if (array[i] == array[j])
+						return false;
+	}
+
+	if (value.isObject() && (node.checkProperties || node.denyAdditional))
+		return validateObject(node, value.toObject());
+
+	return true;
+}
@@ -14,6 +14,8 @@
 #include <QDateTime>
 #include <QHostAddress>
 
+#include <cstring>
+
 #define REQ "request="
 #define RPC "json-rpc"
 
@@ -29,7 +31,11 @@ QtHttpClientWrapper::QtHttpClientWrapper (QTcpSocket * sock, const bool& localCo
 	, m_localConnection(localConnection)
 	, m_websocketClient(nullptr)
 	, m_webJsonRpc     (nullptr)
+	, m_bufferPos      (0)
+	, m_contentLength  (0)
 {
+	// the socket must not buffer without limit either while the requests wait for a reply
+	m_sockClient->setReadBufferSize (MAX_PENDING_SIZE);
 	connect (m_sockClient, &QTcpSocket::readyRead, this, &QtHttpClientWrapper::onClientDataReceived);
 }
 
@@ -50,206 +56,292 @@ QString QtHttpClientWrapper::getGuid (void)
 
 void QtHttpClientWrapper::onClientDataReceived (void)
 {
-	if (m_sockClient != Q_NULLPTR)
+	if (m_sockClient == Q_NULLPTR || m_websocketClient != Q_NULLPTR)
 	{
-		while (m_sockClient->bytesAvailable ())
+		return;
+	}
+
+	// a (json-rpc) reply is pending: stop reading, sendToClientWithReply() resumes
+	if (m_parsingStatus == RequestParsed && m_currentRequest != Q_NULLPTR && m_buffer.size () - m_bufferPos >= MAX_PENDING_SIZE)
+	{
+		return;
+	}
+
+	m_buffer.append (m_sockClient->readAll ());
+
+	// requests are parsed in place from the receive buffer and answered in order (pipelining)
+	while (m_websocketClient == Q_NULLPTR && m_sockClient->isOpen ())
+	{
+		if (m_parsingStatus == AwaitingRequest || m_parsingStatus == AwaitingHeaders)
 		{
-			QByteArray line = m_sockClient->readLine ();
+			const int end = m_buffer.indexOf ('\n', m_bufferPos);
 
-			switch (m_parsingStatus) // handle parsing steps
+			if (end < 0) // incomplete line, wait for more data
 			{
-				case AwaitingRequest: // "command url version" × 1
+				if (m_buffer.size () - m_bufferPos > MAX_LINE_LENGTH)
 				{
-					QString str = QString::fromUtf8 (line).trimmed ();
-					QStringList parts = QStringUtils::SPLITTER(str, SPACE);
-					if (parts.size () == 3)
-					{
-						QString command = parts.at (0);
-						QString url     = parts.at (1);
-						QString version = parts.at (2);
-
-						if (version == QtHttpServer::HTTP_VERSION)
-						{
-							m_currentRequest = new QtHttpRequest (this, m_serverHandle);
-							m_currentRequest->setClientInfo(m_sockClient->localAddress(), m_sockClient->peerAddress());
-							m_currentRequest->setUrl (QUrl (url));
-							m_currentRequest->setCommand (command);
-							m_parsingStatus = AwaitingHeaders;
-						}
-						else
-						{
-						m_parsingStatus = ParsingError;
-						//qWarning () << "Error : unhandled HTTP version :" << version;
-						}
-					}
-					else
-					{
-						m_parsingStatus = ParsingError;
-						//qWarning () << "Error : incorrect HTTP command line :" << line;
-					}
-
-					break;
+					m_parsingStatus = ParsingError;
 				}
-				case AwaitingHeaders: // "header: value" × N (until empty line)
+				else
 				{
-					QByteArray raw = line.trimmed ();
-
-					if (!raw.isEmpty ()) // parse headers
-					{
-						int pos = raw.indexOf (COLON);
-
-						if (pos > 0)
-						{
-							QByteArray header = raw.left (pos).trimmed ();
-							QByteArray value  = raw.mid  (pos +1).trimmed ();
-							m_currentRequest->addHeader (header, value);
-							if (header == QtHttpHeader::ContentLength)
-							{
-								bool ok  = false;
-								const int len = value.toInt (&ok, 10);
-								if (ok)
-								{
-									m_currentRequest->addHeader (QtHttpHeader::ContentLength, QByteArray::number (len));
-								}
-							}
-						}
-						else
-						{
-							m_parsingStatus = ParsingError;
-							qWarning () << "Error : incorrect HTTP headers line :" << line;
-						}
-					}
-					else // end of headers
-					{
-						if (m_currentRequest->getHeader (QtHttpHeader::ContentLength).toInt () > 0)
-						{
-							m_parsingStatus = AwaitingContent;
-						}
-						else
-						{
-							m_parsingStatus = RequestParsed;
-						}
-					}
-
 					break;
 				}
-				case AwaitingContent: // raw data × N (until EOF ??)
+			}
+			else
+			{
+				const char * line = m_buffer.constData () + m_bufferPos;
+				int length = end - m_bufferPos;
+				m_bufferPos = end + 1;
+
+				// trim
+				while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == SPACE || line[length - 1] == '\t'))
+				{
+					length--;
+				}
+				while (length > 0 && (*line == SPACE || *line == '\t'))
 				{
-					m_currentRequest->appendRawData (line);
+					line++;
+					length--;
+				}
 
-					if (m_currentRequest->getRawDataSize () == m_currentRequest->getHeader (QtHttpHeader::ContentLength).toInt ())
+				if (m_parsingStatus == AwaitingRequest)
+				{
+					// empty lines before a request are ignored
+					if (length > 0)
 					{
-						m_parsingStatus = RequestParsed;
+						parseRequestLine (line, length);
 					}
-
-					break;
 				}
-				default:
+				else
 				{
-					break;
+					parseHeaderLine (line, length);
 				}
 			}
+		}
+		else if (m_parsingStatus == AwaitingContent) // raw data × Content-Length
+		{
+			const int available = m_buffer.size () - m_bufferPos;
 
-			switch (m_parsingStatus) // handle parsing status end/error
+			if (available <= 0)
 			{
-				case RequestParsed: // a valid request has ben fully parsed
-				{
-					// Catch websocket header "Upgrade"
-					if(m_currentRequest->getHeader(QtHttpHeader::Upgrade).toLower() == "websocket")
-					{
-						if(m_websocketClient == Q_NULLPTR)
-						{
-							// disconnect this slot from socket for further requests
-							disconnect(m_sockClient, &QTcpSocket::readyRead, this, &QtHttpClientWrapper::onClientDataReceived);
-							// disabling packet bunching
-							m_sockClient->setSocketOption(QAbstractSocket::LowDelayOption, 1);
-							m_sockClient->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
-							m_websocketClient = new WebSocketClient(m_currentRequest, m_sockClient, m_localConnection, this);
-						}
-
-						break;
-					}
+				break;
+			}
 
-					// add  post data to request and catch /jsonrpc subroute url
-					QString path = m_currentRequest->getUrl().path();
-					QString query = (m_currentRequest->getUrl().hasQuery()) ? m_currentRequest->getUrl().query(QUrl::FullyDecoded) : "";
-					QStringList uri_parts = QStringUtils::SPLITTER(path, '/');
-					bool getCallback = (m_currentRequest->getCommand() == "GET") && !uri_parts.empty() &&
-									    uri_parts.at(0) == RPC && 
-										(query.indexOf(REQ, Qt::CaseInsensitive) == 0);
-					
-					if (m_currentRequest->getCommand() == "POST" || getCallback)
-					{
-						QtHttpPostData  postData;
-
-						if (getCallback)
-						{
-							query = query.remove(0,QString(REQ).length());
-							if (query.trimmed().length() == 0)
-							{
-								query = "{\"command\":\"help\"}";
-							}
-						}
-						else
-						{
-							QByteArray data = m_currentRequest->getRawData();
-							QList<QByteArray> parts = data.split('&');
-
-							query = "";
-							for (int i = 0; i < parts.size(); ++i)
-							{
-								QList<QByteArray> keyValue = parts.at(i).split('=');
-								QByteArray value;
-
-								if (keyValue.size() > 1)
-								{
-									value = QByteArray::fromPercentEncoding(keyValue.at(1));
-								}								
-								postData.insert(QString::fromUtf8(keyValue.at(0)), value);
-							}
-						}
-
-						m_currentRequest->setPostData(postData);
-
-						// catch /jsonrpc in url, we need async callback, StaticFileServing is sync						
-						if (getCallback || ( ! uri_parts.empty() && uri_parts.at(0) == RPC ))
-						{
-							if(m_webJsonRpc == Q_NULLPTR)
-							{
-								m_webJsonRpc = new WebJsonRpc(m_currentRequest, m_serverHandle, m_localConnection, this);
-							}
-
-							m_webJsonRpc->handleMessage(m_currentRequest, query);
-							break;
-						}
-					}
+			const int length = qMin (m_contentLength - m_currentRequest->getRawDataSize (), available);
+			m_currentRequest->appendRawData (m_buffer.mid (m_bufferPos, length));
+			m_bufferPos += length;
 
-					QtHttpReply reply (m_serverHandle);
-					connect (&reply, &QtHttpReply::requestSendHeaders, this, &QtHttpClientWrapper::onReplySendHeadersRequested);
-					connect (&reply, &QtHttpReply::requestSendData, this, &QtHttpClientWrapper::onReplySendDataRequested);
-					emit m_serverHandle->requestNeedsReply (m_currentRequest, &reply); // allow app to handle request
-					m_parsingStatus = sendReplyToClient (&reply);
+			if (m_currentRequest->getRawDataSize () >= m_contentLength)
+			{
+				m_parsingStatus = RequestParsed;
+			}
+		}
+		else if (m_parsingStatus == RequestParsed && m_currentRequest != Q_NULLPTR)
+		{
+			// the previous request still waits for its (json-rpc) reply
+			break;
+		}
 
-					break;
-				}
-				case ParsingError: // there was an error durin one of parsing steps
-				{
-					m_sockClient->readAll (); // clear remaining buffer to ignore content
-					QtHttpReply reply (m_serverHandle);
-					reply.setStatusCode (QtHttpReply::BadRequest);
-					reply.appendRawData (QByteArrayLiteral ("<h1>Bad Request (HTTP parsing error) !</h1>"));
-					reply.appendRawData (CRLF);
-					m_parsingStatus = sendReplyToClient (&reply);
+		if (m_parsingStatus == RequestParsed)
+		{
+			handleParsedRequest ();
+		}
+		else if (m_parsingStatus == ParsingError) // there was an error durin one of parsing steps
+		{
+			// ignore the remaining buffer
+			m_buffer.clear ();
+			m_bufferPos = 0;
+
+			QtHttpReply reply (m_serverHandle);
+			reply.setStatusCode (QtHttpReply::BadRequest);
+			reply.appendRawData (QByteArrayLiteral ("<h1>Bad Request (HTTP parsing error) !</h1>"));
+			reply.appendRawData (CRLF);
+			connect (&reply, &QtHttpReply::requestSendHeaders, this, &QtHttpClientWrapper::onReplySendHeadersRequested);
+			connect (&reply, &QtHttpReply::requestSendData, this, &QtHttpClientWrapper::onReplySendDataRequested);
+			m_parsingStatus = sendReplyToClient (&reply);
+
+			break;
+		}
+	}
 
-					break;
-				}
-				default:
+	// drop the parsed part of the buffer
+	if (m_bufferPos > 0)
+	{
+		m_buffer.remove (0, m_bufferPos);
+		m_bufferPos = 0;
+	}
+}
+
+void QtHttpClientWrapper::parseRequestLine (const char * line, int length)
+{
+	// "command url version" × 1
+	const char * end     = line + length;
+	const char * command = line;
+	const char * url     = static_cast<const char *> (memchr (command, SPACE, end - command));
+	const char * version = (url != Q_NULLPTR) ? static_cast<const char *> (memchr (url + 1, SPACE, end - url - 1)) : Q_NULLPTR;
+
+	if (version == Q_NULLPTR || memchr (version + 1, SPACE, end - version - 1) != Q_NULLPTR)
+	{
+		m_parsingStatus = ParsingError;
+		//qWarning () << "Error : incorrect HTTP command line :" << line;
+		return;
+	}
+
+	if (QLatin1String (version + 1, int (end - version - 1)) != QtHttpServer::HTTP_VERSION)
+	{
+		m_parsingStatus = ParsingError;
+		//qWarning () << "Error : unhandled HTTP version :" << version;
+		return;
+	}
+
+	m_currentRequest = new QtHttpRequest (this, m_serverHandle);
+	m_currentRequest->setClientInfo (m_sockClient->localAddress (), m_sockClient->peerAddress ());
+	m_currentRequest->setUrl (QUrl (QString::fromUtf8 (url + 1, int (version - url - 1))));
+	m_currentRequest->setCommand (QString::fromLatin1 (command, int (url - command)));
+	m_contentLength = 0;
+	m_parsingStatus = AwaitingHeaders;
+}
+
+void QtHttpClientWrapper::parseHeaderLine (const char * line, int length)
+{
+	// "header: value" × N (until empty line)
+	if (length == 0) // end of headers
+	{
+		m_parsingStatus = (m_contentLength > 0) ? AwaitingContent : RequestParsed;
+		return;
+	}
+
+	const char * colon = static_cast<const char *> (memchr (line, COLON, length));
+
+	if (colon == Q_NULLPTR || colon == line)
+	{
+		m_parsingStatus = ParsingError;
+		qWarning () << "Error : incorrect HTTP headers line :" << QByteArray (line, length);
+		return;
+	}
+
+	int headerLength = int (colon - line);
+	while (headerLength > 0 && (line[headerLength - 1] == SPACE || line[headerLength - 1] == '\t'))
+	{
+		headerLength--;
+	}
+
+	const char * value = colon + 1;
+	while (value < line + length && (*value == SPACE || *value == '\t'))
+	{
+		value++;
+	}
+
+	const QByteArray header (line, headerLength);
+
+	if (header == QtHttpHeader::ContentLength)
+	{
+		bool ok = false;
+		const int len = QByteArray::fromRawData (value, int (line + length - value)).toInt (&ok, 10);
+		if (ok && len >= 0)
+		{
+			m_contentLength = len;
+			m_currentRequest->addHeader (QtHttpHeader::ContentLength, QByteArray::number (len));
+		}
+	}
+	else
+	{
+		m_currentRequest->addHeader (header, QByteArray (value, int (line + length - value)));
+	}
+}
+
+void QtHttpClientWrapper::handleParsedRequest (void)
+{
+	// Catch websocket header "Upgrade"
+	if(m_currentRequest->getHeader(QtHttpHeader::Upgrade).toLower() == "websocket")
+	{
+		if(m_websocketClient == Q_NULLPTR)
+		{
+			// disconnect this slot from socket for further requests
+			disconnect(m_sockClient, &QTcpSocket::readyRead, this, &QtHttpClientWrapper::onClientDataReceived);
+			// disabling packet bunching
+			m_sockClient->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+			m_sockClient->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
+			// websocket frames are read from the socket as they come, a frame may be larger than the HTTP limit
+			m_sockClient->setReadBufferSize(0);
+			m_websocketClient = new WebSocketClient(m_currentRequest, m_sockClient, m_localConnection, this);
+
+			// the first frames may have arrived together with the upgrade request: give them back to the socket
+			for (int i = m_buffer.size() - 1; i >= m_bufferPos; i--)
+			{
+				m_sockClient->ungetChar(m_buffer.at(i));
+			}
+			m_buffer.clear();
+			m_bufferPos = 0;
+
+			if (m_sockClient->bytesAvailable() > 0)
+			{
+				QMetaObject::invokeMethod(m_websocketClient, "handleWebSocketFrame", Qt::QueuedConnection);
+			}
+		}
+
+		return;
+	}
+
+	// add  post data to request and catch /jsonrpc subroute url
+	QString path = m_currentRequest->getUrl().path();
+	QString query = (m_currentRequest->getUrl().hasQuery()) ? m_currentRequest->getUrl().query(QUrl::FullyDecoded) : "";
+	QStringList uri_parts = QStringUtils::SPLITTER(path, '/');
+	bool getCallback = (m_currentRequest->getCommand() == "GET") && !uri_parts.empty() &&
+					    uri_parts.at(0) == RPC && 
+						(query.indexOf(REQ, Qt::CaseInsensitive) == 0);
+	
+	if (m_currentRequest->getCommand() == "POST" || getCallback)
+	{
+		QtHttpPostData  postData;
+
+		if (getCallback)
+		{
+			query = query.remove(0,QString(REQ).length());
+			if (query.trimmed().length() == 0)
+			{
+				query = "{\"command\":\"help\"}";
+			}
+		}
+		else
+		{
+			QByteArray data = m_currentRequest->getRawData();
+			QList<QByteArray> parts = data.split('&');
+
+			query = "";
+			for (int i = 0; i < parts.size(); ++i)
+			{
+				QList<QByteArray> keyValue = parts.at(i).split('=');
+				QByteArray value;
+
+				if (keyValue.size() > 1)
 				{
-					break;
-				}
+					value = QByteArray::fromPercentEncoding(keyValue.at(1));
+				}								
+				postData.insert(QString::fromUtf8(keyValue.at(0)), value);
 			}
 		}
+
+		m_currentRequest->setPostData(postData);
+
+		// catch /jsonrpc in url, we need async callback, StaticFileServing is sync						
+		if (getCallback || ( ! uri_parts.empty() && uri_parts.at(0) == RPC ))
+		{
+			if(m_webJsonRpc == Q_NULLPTR)
+			{
+				m_webJsonRpc = new WebJsonRpc(m_currentRequest, m_serverHandle, m_localConnection, this);
+			}
+
+			m_webJsonRpc->handleMessage(m_currentRequest, query);
+			return;
+		}
 	}
+
+	QtHttpReply reply (m_serverHandle);
+	connect (&reply, &QtHttpReply::requestSendHeaders, this, &QtHttpClientWrapper::onReplySendHeadersRequested);
+	connect (&reply, &QtHttpReply::requestSendData, this, &QtHttpClientWrapper::onReplySendDataRequested);
+	emit m_serverHandle->requestNeedsReply (m_currentRequest, &reply); // allow app to handle request
+	m_parsingStatus = sendReplyToClient (&reply);
 }
 
 void QtHttpClientWrapper::onReplySendHeadersRequested (void)
@@ -272,7 +364,7 @@ void QtHttpClientWrapper::onReplySendHeadersRequested (void)
 			static const QByteArray & CHUNKED = QByteArrayLiteral ("chunked");
 			reply->addHeader (QtHttpHeader::TransferEncoding, CHUNKED);
 		}
-		else
+		else if (reply->getStatusCode () != QtHttpReply::NotModified)
 		{
 			reply->addHeader (QtHttpHeader::ContentLength, QByteArray::number (reply->getRawDataSize ()));
 		}
@@ -290,8 +382,9 @@ void QtHttpClientWrapper::onReplySendHeadersRequested (void)
 
 		// empty line
 		data.append (CRLF);
+
+		// not flushed: the headers leave together with the data in one segment
 		m_sockClient->write (data);
-		m_sockClient->flush ();
 	}
 }
 
@@ -321,14 +414,29 @@ void QtHttpClientWrapper::sendToClientWithReply(QtHttpReply * reply)
 	connect (reply, &QtHttpReply::requestSendHeaders, this, &QtHttpClientWrapper::onReplySendHeadersRequested, Qt::UniqueConnection);
 	connect (reply, &QtHttpReply::requestSendData, this, &QtHttpClientWrapper::onReplySendDataRequested, Qt::UniqueConnection);
 	m_parsingStatus = sendReplyToClient (reply);
+
+	// continue with the pipelined requests that waited for this reply
+	if (m_bufferPos < m_buffer.size () || m_sockClient->bytesAvailable () > 0)
+	{
+		QMetaObject::invokeMethod (this, "onClientDataReceived", Qt::QueuedConnection);
+	}
 }
 
 QtHttpClientWrapper::ParsingStatus QtHttpClientWrapper::sendReplyToClient (QtHttpReply * reply)
 {
 	if (reply != Q_NULLPTR)
 	{
+		static const QByteArray & CLOSE = QByteArrayLiteral ("close");
+
+		const bool mustClose = (m_currentRequest != Q_NULLPTR && m_currentRequest->getHeader (QtHttpHeader::Connection).toLower () == CLOSE);
+
 		if (!reply->useChunked ())
 		{
+			if (mustClose)
+			{
+				reply->addHeader (QtHttpHeader::Connection, CLOSE);
+			}
+
 			//reply->appendRawData (CRLF);
 			// send all headers and all data in one shot
 			reply->requestSendHeaders ();
@@ -343,9 +451,7 @@ QtHttpClientWrapper::ParsingStatus QtHttpClientWrapper::sendReplyToClient (QtHtt
 
 		if (m_currentRequest != Q_NULLPTR)
 		{
-			static const QByteArray & CLOSE = QByteArrayLiteral ("close");
-
-			if (m_currentRequest->getHeader (QtHttpHeader::Connection).toLower () == CLOSE)
+			if (mustClose)
 			{
 				// must close connection after this request
 				m_sockClient->close ();
@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QByteArray>
 
 class QTcpSocket;
 
@@ -21,6 +22,9 @@ public:
 	static const char SPACE = ' ';
 	static const char COLON = ':';
 	static const QByteArray & CRLF;
+	static const int MAX_LINE_LENGTH = 16384;
+	/// pipelined data kept while a request waits for its reply, the rest is left to TCP flow control
+	static const int MAX_PENDING_SIZE = 1048576;
 
 	enum ParsingStatus {
 		ParsingError    = -1,
@@ -45,6 +49,10 @@ private slots:
 protected:
 	ParsingStatus sendReplyToClient (QtHttpReply * reply);
 
+	void parseRequestLine    (const char * line, int length);
+	void parseHeaderLine     (const char * line, int length);
+	void handleParsedRequest (void);
+
 protected slots:
 	void onReplySendHeadersRequested (void);
 	void onReplySendDataRequested    (void);
@@ -58,6 +66,11 @@ private:
 	const bool        m_localConnection;
 	WebSocketClient * m_websocketClient;
 	WebJsonRpc *      m_webJsonRpc;
+
+	/// received data, parsed in place from m_bufferPos
+	QByteArray        m_buffer;
+	int               m_bufferPos;
+	int               m_contentLength;
 };
 
 #endif // QTHTTPCLIENTWRAPPER_H
@@ -34,6 +34,9 @@ public:
 	static const QByteArray & TransferEncoding;
 	static const QByteArray & ContentDisposition;
 	static const QByteArray & AccessControlAllow;
+	static const QByteArray & ETag;
+	static const QByteArray & IfNoneMatch;
+	static const QByteArray & Vary;
 	// Websocket specific headers
 	static const QByteArray & Upgrade;
 	static const QByteArray & SecWebSocketKey;
@@ -1,4 +1,5 @@
 #include <utils/QStringUtils.h>
+#include <utils/Metrics.h>
 #include "StaticFileServing.h"
 
 #include <QStringBuilder>
@@ -8,8 +9,64 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QResource>
+#include <QCryptographicHash>
 #include <exception>
 
+namespace
+{
+	const int MIN_COMPRESS_SIZE = 512;
+
+	quint32 crc32(const QByteArray& data)
+	{
+		static quint32 table[256] = { 0 };
+
+		if (table[1] == 0)
+		{
+			for (quint32 i = 0; i < 256; i++)
+			{
+				quint32 c = i;
+				for (int k = 0; k < 8; k++)
+					c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				table[i] = c;
+			}
+		}
+
+		quint32 crc = 0xFFFFFFFFu;
+		for (char ch : data)
+			crc = table[(crc ^ (quint8)ch) & 0xFF] ^ (crc >> 8);
+
+		return crc ^ 0xFFFFFFFFu;
+	}
+
+	void appendLittleEndian(QByteArray& out, quint32 value)
+	{
+		for (int i = 0; i < 4; i++)
+			out.append(char((value >> (8 * i)) & 0xFF));
+	}
+
+	// qCompress produces a 4-byte length + zlib stream, gzip needs the raw deflate part of it
+	QByteArray gzip(const QByteArray& data)
+	{
+		QByteArray zlib = qCompress(data, 9);
+
+		if (zlib.size() < 4 + 2 + 4)
+			return QByteArray();
+
+		// gzip header: deflate, no name, no mtime, max compression, unknown OS
+		QByteArray result("\x1f\x8b\x08\x00\x00\x00\x00\x00\x02\xff", 10);
+		result.append(zlib.constData() + 6, zlib.size() - 6 - 4);
+		appendLittleEndian(result, crc32(data));
+		appendLittleEndian(result, quint32(data.size()));
+		return result;
+	}
+
+	bool isCompressible(const QMimeType& mime)
+	{
+		return mime.inherits("text/plain") || mime.name().contains("javascript") ||
+			mime.name().contains("json") || mime.name().contains("xml") || mime.name().contains("svg");
+	}
+}
+
 StaticFileServing::StaticFileServing (QObject * parent)
 	:  QObject   (parent)
 	, _baseUrl ()
@@ -30,6 +87,7 @@ void StaticFileServing::setBaseUrl(const QString& url)
 {
 	_baseUrl = url;
 	_cgi.setBaseUrl(url);
+	_fileCache.clear();
 }
 
 void StaticFileServing::setSSDPDescription(const QString& desc)
@@ -99,6 +157,12 @@ void StaticFileServing::onRequestNeedsReply (QtHttpRequest * request, QtHttpRepl
 				}
 				return;
 			}
+			else if(uri_parts.at(0) == "metrics" && uri_parts.size() == 1)
+			{
+				reply->addHeader ("Content-Type", "text/plain; version=0.0.4");
+				reply->appendRawData (Metrics::toPrometheus());
+				return;
+			}
 			else if(uri_parts.at(0) == "description.xml" && !_ssdpDescription.isNull())
 			{
 				reply->addHeader ("Content-Type", "text/xml");
@@ -121,30 +185,78 @@ void StaticFileServing::onRequestNeedsReply (QtHttpRequest * request, QtHttpRepl
 			path += "/index.html";
 		}
 
-		// get static files
-		QFile file(_baseUrl % "/" % path);
-		if (file.exists())
+		// get static files, every file is read, hashed and compressed only once
+		const QString fileName = _baseUrl % "/" % path;
+		QHash<QString, CachedFile>::iterator cached = _fileCache.find(fileName);
+
+		// files from the resources never change, the others are checked for modification
+		if (cached == _fileCache.end() || (!_baseUrl.startsWith(':') && cached->lastModified != QFileInfo(fileName).lastModified()))
 		{
-			QMimeType mime = _mimeDb->mimeTypeForFile (file.fileName ());
-			if (file.open (QFile::ReadOnly)) {
-				QByteArray data = file.readAll ();
-				reply->addHeader ("Content-Type", mime.name ().toLocal8Bit ());
-				reply->addHeader(QtHttpHeader::AccessControlAllow, "*" );
-				reply->appendRawData (data);
-				file.close ();
+			QFile file(fileName);
+			if (!file.exists())
+			{
+				printErrorToReply (reply, QtHttpReply::NotFound, "Requested file: " % path);
+				return;
 			}
-			else
+			if (!file.open (QFile::ReadOnly))
 			{
 				printErrorToReply (reply, QtHttpReply::Forbidden ,"Requested file: " % path);
+				return;
 			}
+
+			cached = _fileCache.insert(fileName, CachedFile());
+			loadCachedFile(file, *cached);
+			file.close ();
 		}
-		else
-		{
-			printErrorToReply (reply, QtHttpReply::NotFound, "Requested file: " % path);
-		}
+
+		replyWithCachedFile(request, reply, *cached);
 	}
 	else
 	{
 		printErrorToReply (reply, QtHttpReply::MethodNotAllowed,"Unhandled HTTP/1.1 method " % command);
 	}
 }
+
+void StaticFileServing::loadCachedFile(QFile & file, CachedFile & cached)
+{
+	QMimeType mime = _mimeDb->mimeTypeForFile (file.fileName ());
+
+	cached.mime = mime.name ().toLocal8Bit ();
+	cached.data = file.readAll ();
+	cached.etag = '"' + QCryptographicHash::hash(cached.data, QCryptographicHash::Md5).toHex() + '"';
+	cached.lastModified = QFileInfo(file).lastModified();
+	cached.gzipData.clear();
+
+	if (cached.data.size() >= MIN_COMPRESS_SIZE && isCompressible(mime))
+	{
+		QByteArray compressed = gzip(cached.data);
+		if (!compressed.isEmpty() && compressed.size() < cached.data.size() * 9 / 10)
+			cached.gzipData = compressed;
+	}
+}
+
+void StaticFileServing::replyWithCachedFile(QtHttpRequest * request, QtHttpReply * reply, const CachedFile & cached)
+{
+	reply->addHeader ("Content-Type", cached.mime);
+	reply->addHeader (QtHttpHeader::AccessControlAllow, "*" );
+	reply->addHeader (QtHttpHeader::ETag, cached.etag);
+	// the browser may keep the file but has to revalidate it, an unchanged file costs only a 304 reply
+	reply->addHeader (QtHttpHeader::CacheControl, "no-cache");
+
+	if (!cached.gzipData.isEmpty())
+		reply->addHeader (QtHttpHeader::Vary, QtHttpHeader::AcceptEncoding);
+
+	if (request->getHeader (QtHttpHeader::IfNoneMatch).contains (cached.etag))
+	{
+		reply->setStatusCode (QtHttpReply::NotModified);
+	}
+	else if (!cached.gzipData.isEmpty() && request->getHeader (QtHttpHeader::AcceptEncoding).contains ("gzip"))
+	{
+		reply->addHeader (QtHttpHeader::ContentEncoding, "gzip");
+		reply->appendRawData (cached.gzipData);
+	}
+	else
+	{
+		reply->appendRawData (cached.data);
+	}
+}
@@ -2,6 +2,9 @@
 #define STATICFILESERVING_H
 
 #include <QMimeDatabase>
+#include <QHash>
+#include <QDateTime>
+#include <QFile>
 
 //#include "QtHttpServer.h"
 #include "QtHttpRequest.h"
@@ -33,13 +36,29 @@ public slots:
 	void onRequestNeedsReply  (QtHttpRequest * request, QtHttpReply * reply);
 
 private:
+	///
+	/// Static file kept in memory with its precomputed reply headers
+	///
+	struct CachedFile
+	{
+		QByteArray mime;
+		QByteArray etag;
+		QByteArray data;
+		/// gzip encoded data, empty if the file does not compress well
+		QByteArray gzipData;
+		QDateTime  lastModified;
+	};
+
 	QString         _baseUrl;
 	QMimeDatabase * _mimeDb;
 	CgiHandler      _cgi;
 	Logger        * _log;
 	QByteArray      _ssdpDescription;
+	QHash<QString, CachedFile> _fileCache;
 
 	void printErrorToReply (QtHttpReply * reply, QtHttpReply::StatusCode code, QString errorMessage);
+	void loadCachedFile (QFile & file, CachedFile & cached);
+	void replyWithCachedFile (QtHttpRequest * request, QtHttpReply * reply, const CachedFile & cached);
 
 };
 
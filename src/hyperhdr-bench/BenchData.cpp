@@ -0,0 +1,328 @@
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+// Qt includes
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+// HyperHDR includes
+#include <db/SettingsTable.h>
+#include <hyperhdrbase/Grabber.h>
+#include <hyperhdrbase/HyperHdrIManager.h>
+#include <hyperhdrbase/HyperHdrInstance.h>
+#include <utils/ImageResampler.h>
+
+#include "BenchData.h"
+
+namespace
+{
+	///
+	/// Linear congruential generator, the content must not depend on the standard library
+	///
+	class Random
+	{
+	public:
+		explicit Random(uint32_t seed) : _state(seed) {}
+
+		uint8_t next()
+		{
+			_state = _state * 1664525u + 1013904223u;
+			return static_cast<uint8_t>(_state >> 24);
+		}
+
+	private:
+		uint32_t _state;
+	};
+
+	uint8_t clampByte(double value)
+	{
+		return static_cast<uint8_t>(std::min(std::max(value, 0.0), 255.0));
+	}
+
+	/// gradient with some noise, the noise keeps the data out of the trivial paths (flat colors, black)
+	void pixelAt(Random& random, int x, int y, int width, int height, uint8_t& r, uint8_t& g, uint8_t& b)
+	{
+		r = static_cast<uint8_t>((x * 255) / std::max(width - 1, 1)) ^ (random.next() & 0x0F);
+		g = static_cast<uint8_t>((y * 255) / std::max(height - 1, 1)) ^ (random.next() & 0x0F);
+		b = static_cast<uint8_t>(((x + y) * 255) / std::max(width + height - 2, 1)) ^ (random.next() & 0x0F);
+	}
+
+	void rgbToYuv(uint8_t r, uint8_t g, uint8_t b, uint8_t& y, uint8_t& u, uint8_t& v)
+	{
+		y = clampByte(0.257 * r + 0.504 * g + 0.098 * b + 16);
+		u = clampByte(-0.148 * r - 0.291 * g + 0.439 * b + 128);
+		v = clampByte(0.439 * r - 0.368 * g - 0.071 * b + 128);
+	}
+
+	std::unique_ptr<QTemporaryDir> _tempDir;
+}
+
+///
+/// Owner of the benchmark instance, HyperHdrIManager can only be constructed by its friends
+///
+class BenchEnvironment
+{
+public:
+	static HyperHdrInstance* instance()
+	{
+		if (_manager == nullptr)
+		{
+			// the foreground effect would occupy the instance for the first seconds
+			const QString rootPath = BenchData::tempPath();
+			_manager = new HyperHdrIManager(rootPath, nullptr, false);
+			SettingsTable(0).createSettingsRecord("fgEffect", QString(QJsonDocument(QJsonObject{ {"enable", false} }).toJson(QJsonDocument::Compact)));
+
+			_manager->startInstance(0, true);
+
+			QElapsedTimer timeout;
+			timeout.start();
+			while (!_manager->IsInstanceRunning(0) && timeout.elapsed() < 30000)
+				QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+		}
+
+		return _manager->IsInstanceRunning(0) ? _manager->getHyperHdrInstance(0) : nullptr;
+	}
+
+	static void shutdown()
+	{
+		if (_manager != nullptr)
+		{
+			_manager->stopAll();
+
+			QElapsedTimer timeout;
+			timeout.start();
+			while (_manager->IsInstanceRunning(0) && timeout.elapsed() < 30000)
+				QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+
+			delete _manager;
+			_manager = nullptr;
+		}
+	}
+
+private:
+	static HyperHdrIManager* _manager;
+};
+
+HyperHdrIManager* BenchEnvironment::_manager = nullptr;
+
+namespace BenchData
+{
+	Frame createFrame(PixelFormat format, int width, int height)
+	{
+		Frame frame;
+		Random random(static_cast<uint32_t>(format) * 7919u + static_cast<uint32_t>(width));
+
+		frame.format = format;
+		frame.width = width;
+		frame.height = height;
+
+		uint8_t r, g, b, y, u, v;
+
+		switch (format)
+		{
+			case PixelFormat::YUYV:
+			{
+				frame.lineLength = width * 2;
+				frame.data.resize((size_t)frame.lineLength * height);
+
+				for (int j = 0; j < height; j++)
+				{
+					uint8_t* line = frame.data.data() + (size_t)j * frame.lineLength;
+					for (int i = 0; i < width; i += 2, line += 4)
+					{
+						pixelAt(random, i, j, width, height, r, g, b);
+						rgbToYuv(r, g, b, y, u, v);
+						line[0] = y;
+						line[1] = u;
+						line[2] = static_cast<uint8_t>(std::min(y + (random.next() & 0x07), 255));
+						line[3] = v;
+					}
+				}
+				break;
+			}
+
+			case PixelFormat::RGB24:
+			case PixelFormat::XRGB:
+			{
+				const int pixelSize = (format == PixelFormat::RGB24) ? 3 : 4;
+
+				frame.lineLength = width * pixelSize;
+				frame.data.resize((size_t)frame.lineLength * height);
+
+				for (int j = 0; j < height; j++)
+				{
+					uint8_t* line = frame.data.data() + (size_t)j * frame.lineLength;
+					for (int i = 0; i < width; i++, line += pixelSize)
+					{
+						pixelAt(random, i, j, width, height, r, g, b);
+						line[0] = b;
+						line[1] = g;
+						line[2] = r;
+						if (pixelSize == 4)
+							line[3] = 0xFF;
+					}
+				}
+				break;
+			}
+
+			case PixelFormat::I420:
+			case PixelFormat::NV12:
+			{
+				// luma plane followed by the quarter size chroma: separate U and V planes (I420) or interleaved (NV12)
+				frame.lineLength = width;
+				frame.data.resize((size_t)width * height * 3 / 2);
+
+				uint8_t* luma = frame.data.data();
+				uint8_t* chroma = luma + (size_t)width * height;
+
+				for (int j = 0; j < height; j++)
+					for (int i = 0; i < width; i++)
+					{
+						pixelAt(random, i, j, width, height, r, g, b);
+						rgbToYuv(r, g, b, y, u, v);
+						luma[(size_t)j * width + i] = y;
+
+						if ((i & 1) == 0 && (j & 1) == 0)
+						{
+							const size_t index = (size_t)(j / 2) * (width / 2) + (i / 2);
+							if (format == PixelFormat::I420)
+							{
+								chroma[index] = u;
+								chroma[(size_t)(width / 2) * (height / 2) + index] = v;
+							}
+							else
+							{
+								chroma[index * 2] = u;
+								chroma[index * 2 + 1] = v;
+							}
+						}
+					}
+				break;
+			}
+
+			default:
+				frame.lineLength = 0;
+				break;
+		}
+
+		return frame;
+	}
+
+	std::vector<uint8_t> createBGRA(int width, int height)
+	{
+		Frame frame = createFrame(PixelFormat::XRGB, width, height);
+		return std::move(frame.data);
+	}
+
+	Image<ColorRgb> createImage(int width, int height, int horizontalBar, int verticalBar)
+	{
+		Image<ColorRgb> image(width, height);
+		Random random(static_cast<uint32_t>(width * 31 + height));
+
+		for (int j = 0; j < height; j++)
+			for (int i = 0; i < width; i++)
+			{
+				ColorRgb& pixel = image(i, j);
+
+				if (j < horizontalBar || j >= height - horizontalBar || i < verticalBar || i >= width - verticalBar)
+					pixel = ColorRgb{ 0, 0, 0 };
+				else
+					pixelAt(random, i, j, width, height, pixel.red, pixel.green, pixel.blue);
+			}
+
+		return image;
+	}
+
+	const uint8_t* yuvLut()
+	{
+		static std::vector<uint8_t> lut;
+
+		if (lut.empty())
+		{
+			// the decoders read a whole 32-bit word at the last entry
+			lut.resize(LUT_FILE_SIZE + 4);
+
+			for (int v = 0; v < 256; v++)
+				for (int u = 0; u < 256; u++)
+					for (int y = 0; y < 256; y++)
+					{
+						const double c = y - 16, d = u - 128, e = v - 128;
+						uint8_t* entry = &lut[LUT_INDEX(y, u, v)];
+
+						entry[0] = clampByte(1.164 * c + 1.596 * e);
+						entry[1] = clampByte(1.164 * c - 0.392 * d - 0.813 * e);
+						entry[2] = clampByte(1.164 * c + 2.017 * d);
+					}
+		}
+
+		return lut.data();
+	}
+
+	std::vector<Led> createLedLayout(int count)
+	{
+		// top and bottom get 16/9 more LEDs than the sides, like a real 16:9 frame
+		const int horizontal = std::max((count * 8) / 25, 1);
+		const int vertical = std::max((count - 2 * horizontal) / 2, 1);
+		const double depth = 0.08;
+
+		std::vector<Led> leds;
+		leds.reserve(count);
+
+		auto add = [&](double minX, double maxX, double minY, double maxY)
+		{
+			if ((int)leds.size() < count)
+				leds.push_back(Led{ minX, maxX, minY, maxY, 0, ColorOrder::ORDER_RGB });
+		};
+
+		for (int i = 0; i < horizontal; i++)
+			add(double(i) / horizontal, double(i + 1) / horizontal, 0, depth);
+		for (int i = 0; i < vertical; i++)
+			add(1 - depth, 1, double(i) / vertical, double(i + 1) / vertical);
+		for (int i = horizontal - 1; i >= 0; i--)
+			add(double(i) / horizontal, double(i + 1) / horizontal, 1 - depth, 1);
+		for (int i = vertical - 1; i >= 0; i--)
+			add(0, depth, double(i) / vertical, double(i + 1) / vertical);
+
+		// rounding leftovers
+		while ((int)leds.size() < count)
+			leds.push_back(Led{ 0.45, 0.55, 0.45, 0.55, 0, ColorOrder::ORDER_RGB });
+
+		return leds;
+	}
+
+	std::vector<ColorRgb> createLedColors(int count, uint32_t seed)
+	{
+		Random random(seed);
+		std::vector<ColorRgb> colors(count);
+
+		for (ColorRgb& color : colors)
+			color = ColorRgb{ random.next(), random.next(), random.next() };
+
+		return colors;
+	}
+
+	HyperHdrInstance* instance()
+	{
+		return BenchEnvironment::instance();
+	}
+
+	void shutdown()
+	{
+		BenchEnvironment::shutdown();
+		_tempDir.reset();
+	}
+
+	QString tempPath()
+	{
+		if (_tempDir == nullptr)
+			_tempDir.reset(new QTemporaryDir());
+
+		return _tempDir->path();
+	}
+}
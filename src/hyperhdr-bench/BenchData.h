@@ -0,0 +1,75 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+#include <vector>
+
+// Qt includes
+#include <QString>
+
+// HyperHDR includes
+#include <utils/ColorRgb.h>
+#include <utils/Image.h>
+#include <utils/PixelFormat.h>
+#include <hyperhdrbase/LedString.h>
+
+class HyperHdrInstance;
+
+///
+/// Fixed synthetic inputs of the benchmarks. All content comes from a seeded generator,
+/// so every run (and every machine) processes exactly the same bytes.
+///
+namespace BenchData
+{
+	///
+	/// @brief Raw grabber buffer in the given format
+	///
+	struct Frame
+	{
+		PixelFormat				format;
+		int						width;
+		int						height;
+		int						lineLength;
+		std::vector<uint8_t>	data;
+	};
+
+	///
+	/// @brief Frame of the given format with a moving gradient and noise
+	///
+	Frame createFrame(PixelFormat format, int width, int height);
+
+	///
+	/// @brief BGRA frame as delivered by the system grabbers
+	///
+	std::vector<uint8_t> createBGRA(int width, int height);
+
+	///
+	/// @brief RGB image with black bars of the given size (letterbox and pillarbox)
+	///
+	Image<ColorRgb> createImage(int width, int height, int horizontalBar = 0, int verticalBar = 0);
+
+	///
+	/// @brief YUV to RGB table in the layout of the grabbers (see LUT_INDEX), 48 MB
+	///
+	const uint8_t* yuvLut();
+
+	///
+	/// @brief LEDs around the edge of the screen, the layout of a typical TV setup
+	///
+	std::vector<Led> createLedLayout(int count);
+
+	std::vector<ColorRgb> createLedColors(int count, uint32_t seed = 1);
+
+	///
+	/// @brief A running HyperHDR instance (own database in a temporary folder) for the components
+	/// that cannot live without one: smoothing and the Boblight connection. Started on first use.
+	///
+	HyperHdrInstance* instance();
+
+	///
+	/// @brief Stops the instance and removes the temporary folder
+	///
+	void shutdown();
+
+	QString tempPath();
+}
@@ -0,0 +1,92 @@
+// Google Benchmark
+#include <benchmark/benchmark.h>
+
+// Qt includes
+#include <QJsonDocument>
+#include <QJsonObject>
+
+// HyperHDR includes
+#include <hyperhdrbase/ColorAdjustment.h>
+#include <hyperhdrbase/HyperHdrInstance.h>
+#include <hyperhdrbase/LinearColorSmoothing.h>
+#include <hyperhdrbase/MultiColorAdjustment.h>
+
+#include "BenchData.h"
+
+namespace
+{
+	///
+	/// Adjustment with every stage active: channel corrections, gamma, saturation and backlight
+	///
+	ColorAdjustment* createAdjustment()
+	{
+		ColorAdjustment* adjustment = new ColorAdjustment();
+
+		adjustment->_id = "default";
+		adjustment->_rgbBlackAdjustment = RgbChannelAdjustment(0, 0, 0, 0, "ChannelAdjust_BLACK");
+		adjustment->_rgbWhiteAdjustment = RgbChannelAdjustment(0, 255, 240, 220, "ChannelAdjust_WHITE");
+		adjustment->_rgbRedAdjustment = RgbChannelAdjustment(0, 255, 0, 0, "ChannelAdjust_RED");
+		adjustment->_rgbGreenAdjustment = RgbChannelAdjustment(0, 0, 255, 0, "ChannelAdjust_GREEN");
+		adjustment->_rgbBlueAdjustment = RgbChannelAdjustment(0, 0, 0, 255, "ChannelAdjust_BLUE");
+		adjustment->_rgbCyanAdjustment = RgbChannelAdjustment(0, 0, 255, 255, "ChannelAdjust_CYAN");
+		adjustment->_rgbMagentaAdjustment = RgbChannelAdjustment(0, 255, 0, 255, "ChannelAdjust_MAGENTA");
+		adjustment->_rgbYellowAdjustment = RgbChannelAdjustment(0, 255, 255, 0, "ChannelAdjust_YELLOW");
+		adjustment->_rgbTransform = RgbTransform(0, false, 1.2, 1.0, 1.5, 1.5, 1.5, 0.05, false, 100, 100);
+
+		return adjustment;
+	}
+
+	void BM_MultiColorAdjustment(benchmark::State& state)
+	{
+		const int ledCount = (int)state.range(0);
+		const std::vector<ColorRgb> input = BenchData::createLedColors(ledCount);
+
+		MultiColorAdjustment adjustment(0, ledCount);
+		adjustment.addAdjustment(createAdjustment());
+		adjustment.setAdjustmentForLed("default", 0, ledCount - 1);
+
+		std::vector<ColorRgb> colors;
+
+		for (auto _ : state)
+		{
+			colors = input;
+			adjustment.applyAdjustment(colors);
+			benchmark::DoNotOptimize(colors.data());
+		}
+	}
+
+	///
+	/// One smoothing step towards a new target, the work done by the smoothing timer
+	///
+	void BM_LinearColorSmoothing(benchmark::State& state, const char* type)
+	{
+		HyperHdrInstance* instance = BenchData::instance();
+		if (instance == nullptr)
+		{
+			state.SkipWithError("The HyperHDR instance could not be started");
+			return;
+		}
+
+		const int ledCount = (int)state.range(0);
+		const std::vector<ColorRgb> first = BenchData::createLedColors(ledCount, 1);
+		const std::vector<ColorRgb> second = BenchData::createLedColors(ledCount, 2);
+
+		QJsonObject config{ {"enable", true}, {"type", type}, {"time_ms", 150}, {"updateFrequency", 50}, {"continuousOutput", true} };
+
+		// created on the benchmark thread so the slot below can be called directly, its timer is never served
+		LinearColorSmoothing smoothing(QJsonDocument(config), instance);
+		bool flip = false;
+
+		for (auto _ : state)
+		{
+			smoothing.updateLedValues(flip ? first : second);
+			QMetaObject::invokeMethod(&smoothing, "updateLeds", Qt::DirectConnection);
+			flip = !flip;
+		}
+	}
+}
+
+BENCHMARK(BM_MultiColorAdjustment)->Arg(100)->Arg(1000);
+
+BENCHMARK_CAPTURE(BM_LinearColorSmoothing, linear, "linear")->Arg(1000);
+BENCHMARK_CAPTURE(BM_LinearColorSmoothing, alternative, "alternative")->Arg(1000);
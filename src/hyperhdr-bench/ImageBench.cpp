@@ -0,0 +1,151 @@
+// Google Benchmark
+#include <benchmark/benchmark.h>
+
+// HyperHDR includes
+#include <blackborder/BlackBorderDetector.h>
+#include <hyperhdrbase/ImageToLedsMap.h>
+#include <utils/ImageResampler.h>
+#include <utils/Logger.h>
+
+#include "BenchData.h"
+
+using namespace hyperhdr;
+
+namespace
+{
+	const uint8_t* lutFor(PixelFormat format)
+	{
+		return (format == PixelFormat::RGB24 || format == PixelFormat::XRGB) ? nullptr : BenchData::yuvLut();
+	}
+
+	///
+	/// Decoding of a raw grabber buffer to RGB (USB grabbers, the replay grabber)
+	///
+	void BM_ImageResampler_processImage(benchmark::State& state, PixelFormat format)
+	{
+		const BenchData::Frame frame = BenchData::createFrame(format, (int)state.range(0), (int)state.range(1));
+		const uint8_t* lut = lutFor(format);
+		Image<ColorRgb> image;
+
+		for (auto _ : state)
+		{
+			ImageResampler::processImage(0, 0, 0, 0, frame.data.data(), frame.width, frame.height, frame.lineLength, format, lut, image);
+			benchmark::DoNotOptimize(image.memptr());
+		}
+
+		state.SetBytesProcessed(state.iterations() * (int64_t)frame.data.size());
+	}
+
+	///
+	/// Half size decoding used by the quarter frame mode
+	///
+	void BM_ImageResampler_processQImage(benchmark::State& state, PixelFormat format)
+	{
+		const BenchData::Frame frame = BenchData::createFrame(format, (int)state.range(0), (int)state.range(1));
+		const uint8_t* lut = lutFor(format);
+		Image<ColorRgb> image;
+
+		for (auto _ : state)
+		{
+			ImageResampler::processQImage(frame.data.data(), frame.width, frame.height, frame.lineLength, format, lut, image);
+			benchmark::DoNotOptimize(image.memptr());
+		}
+
+		state.SetBytesProcessed(state.iterations() * (int64_t)frame.data.size());
+	}
+
+	///
+	/// Downscale of a system grabber frame (X11, DirectX, macOS) to the default 512 pixels wide capture,
+	/// this is the CPU time per frame of the system grabbers at 1080p and 4K
+	///
+	void BM_ImageResampler_processSystemImageBGRA(benchmark::State& state)
+	{
+		const int width = (int)state.range(0);
+		const int height = (int)state.range(1);
+		const int targetWidth = 512;
+		const int targetHeight = (targetWidth * height) / width;
+
+		std::vector<uint8_t> source = BenchData::createBGRA(width, height);
+		Image<ColorRgb> image(targetWidth, targetHeight);
+
+		for (auto _ : state)
+		{
+			ImageResampler::processSystemImageBGRA(image, targetWidth, targetHeight, 0, 0, width, height, source.data(), width, height, nullptr);
+			benchmark::DoNotOptimize(image.memptr());
+		}
+
+		state.SetBytesProcessed(state.iterations() * (int64_t)source.size());
+	}
+
+	///
+	/// Colors of 120 LEDs from a captured frame, for every mapping type (arg 0)
+	/// 0: multicolor_mean, 1: unicolor_mean, 2: advanced, 3: weighted
+	///
+	void BM_ImageToLedsMap_Process(benchmark::State& state)
+	{
+		const int mappingType = (int)state.range(0);
+		const int width = (int)state.range(1);
+		const int height = (int)state.range(2);
+
+		const Image<ColorRgb> image = BenchData::createImage(width, height);
+		const std::vector<Led> leds = BenchData::createLedLayout(120);
+
+		// same table as ImageProcessor
+		uint16_t advanced[256];
+		for (int i = 0; i < 256; i++)
+			advanced[i] = i * i;
+
+		ImageToLedsMap map(Logger::getInstance("BENCH"), mappingType, false, width, height, 0, 0, 0, leds);
+
+		for (auto _ : state)
+		{
+			std::vector<ColorRgb> colors = map.Process(image, advanced);
+			benchmark::DoNotOptimize(colors.data());
+		}
+	}
+
+	///
+	/// Black border detection on a letterboxed frame, for every detection mode (arg 0)
+	/// 0: default, 1: classic, 2: osd, 3: letterbox
+	///
+	void BM_BlackBorderDetector(benchmark::State& state)
+	{
+		const int mode = (int)state.range(0);
+		const Image<ColorRgb> image = BenchData::createImage(1280, 720, 88, 0);
+		const BlackBorderDetector detector(0.05);
+
+		for (auto _ : state)
+		{
+			BlackBorder border;
+
+			switch (mode)
+			{
+				case 1: border = detector.process_classic(image); break;
+				case 2: border = detector.process_osd(image); break;
+				case 3: border = detector.process_letterbox(image); break;
+				default: border = detector.process(image); break;
+			}
+
+			benchmark::DoNotOptimize(border);
+		}
+	}
+}
+
+BENCHMARK_CAPTURE(BM_ImageResampler_processImage, YUYV, PixelFormat::YUYV)->Args({ 1920, 1080 });
+BENCHMARK_CAPTURE(BM_ImageResampler_processImage, RGB24, PixelFormat::RGB24)->Args({ 1920, 1080 });
+BENCHMARK_CAPTURE(BM_ImageResampler_processImage, XRGB, PixelFormat::XRGB)->Args({ 1920, 1080 });
+BENCHMARK_CAPTURE(BM_ImageResampler_processImage, I420, PixelFormat::I420)->Args({ 1920, 1080 });
+BENCHMARK_CAPTURE(BM_ImageResampler_processImage, NV12, PixelFormat::NV12)->Args({ 1920, 1080 });
+
+BENCHMARK_CAPTURE(BM_ImageResampler_processQImage, YUYV, PixelFormat::YUYV)->Args({ 1920, 1080 });
+BENCHMARK_CAPTURE(BM_ImageResampler_processQImage, RGB24, PixelFormat::RGB24)->Args({ 1920, 1080 });
+BENCHMARK_CAPTURE(BM_ImageResampler_processQImage, XRGB, PixelFormat::XRGB)->Args({ 1920, 1080 });
+BENCHMARK_CAPTURE(BM_ImageResampler_processQImage, I420, PixelFormat::I420)->Args({ 1920, 1080 });
+BENCHMARK_CAPTURE(BM_ImageResampler_processQImage, NV12, PixelFormat::NV12)->Args({ 1920, 1080 });
+
+BENCHMARK(BM_ImageResampler_processSystemImageBGRA)->Args({ 1920, 1080 })->Args({ 3840, 2160 });
+
+BENCHMARK(BM_ImageToLedsMap_Process)->ArgsProduct({ { 0, 1, 2, 3 }, { 480 }, { 270 } });
+BENCHMARK(BM_ImageToLedsMap_Process)->ArgsProduct({ { 0, 1, 2, 3 }, { 1280 }, { 720 } });
+
+BENCHMARK(BM_BlackBorderDetector)->DenseRange(0, 3);
@@ -0,0 +1,72 @@
+// Google Benchmark
+#include <benchmark/benchmark.h>
+
+// Qt includes
+#include <QUuid>
+
+// LED device encoders
+#include "AwaEncoder.h"
+#include "ClocklessSpiEncoder.h"
+#include "E131Encoder.h"
+
+#include "BenchData.h"
+
+namespace
+{
+	/// WS2812 timing, same table as LedDeviceWs2812SPI
+	const uint8_t WS2812_BITPAIR_TO_BYTE[4] = {
+		0b10001000,
+		0b10001100,
+		0b11001000,
+		0b11001100,
+	};
+
+	void BM_Ws2812SpiEncoder(benchmark::State& state)
+	{
+		const std::vector<ColorRgb> colors = BenchData::createLedColors((int)state.range(0));
+		const ClocklessSpiEncoder encoder(WS2812_BITPAIR_TO_BYTE);
+
+		std::vector<uint8_t> buffer(colors.size() * 3 * ClocklessSpiEncoder::SPI_BYTES_PER_COLOUR);
+
+		for (auto _ : state)
+		{
+			encoder.encode(colors, buffer.data());
+			benchmark::DoNotOptimize(buffer.data());
+		}
+
+		state.SetBytesProcessed(state.iterations() * (int64_t)buffer.size());
+	}
+
+	void BM_AwaEncoder(benchmark::State& state)
+	{
+		const std::vector<ColorRgb> colors = BenchData::createLedColors((int)state.range(0));
+
+		std::vector<uint8_t> buffer(colors.size() * 3 + AwaEncoder::CHECKSUM_SIZE);
+
+		for (auto _ : state)
+		{
+			AwaEncoder::encode(colors, buffer.data());
+			benchmark::DoNotOptimize(buffer.data());
+		}
+
+		state.SetBytesProcessed(state.iterations() * (int64_t)buffer.size());
+	}
+
+	void BM_E131Encoder(benchmark::State& state)
+	{
+		const std::vector<ColorRgb> colors = BenchData::createLedColors((int)state.range(0));
+
+		E131Encoder encoder;
+		encoder.setup(QUuid("{5d5e5f7c-7d44-4a1e-9d3a-1f0c4a6b2e91}"), "hyperhdr-bench", 1);
+
+		for (auto _ : state)
+		{
+			const int packets = encoder.encode(colors);
+			benchmark::DoNotOptimize(encoder.packet(packets - 1));
+		}
+	}
+}
+
+BENCHMARK(BM_Ws2812SpiEncoder)->Arg(300)->Arg(1000);
+BENCHMARK(BM_AwaEncoder)->Arg(300)->Arg(1000);
+BENCHMARK(BM_E131Encoder)->Arg(170)->Arg(1000);
@@ -0,0 +1,360 @@
+// Google Benchmark
+#include <benchmark/benchmark.h>
+
+// STL includes
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+// HyperHDR includes
+#include <HyperhdrConfig.h>
+#include <hyperhdrbase/HyperHdrInstance.h>
+#include <utils/CaptureFile.h>
+#include <utils/CaptureRecorder.h>
+#include <utils/ImageResampler.h>
+#include <utils/JsonUtils.h>
+#include <utils/Logger.h>
+#include <utils/Metrics.h>
+
+#ifdef ENABLE_BOBLIGHT
+#include "BoblightClientConnection.h"
+#endif
+
+#include "BenchData.h"
+
+#ifdef ENABLE_BOBLIGHT
+///
+/// The message handler of a connection, without the socket reads around it
+///
+class BoblightBench
+{
+public:
+	static void handleMessage(BoblightClientConnection& connection, const char* data, int size)
+	{
+		connection.handleMessage(data, size);
+	}
+};
+#endif
+
+static void initJsonRpcSchemas()
+{
+	// the resources of a static library are not registered on their own
+	Q_INIT_RESOURCE(JSONRPC_schemas);
+}
+
+namespace
+{
+	QString imageMessage()
+	{
+		const BenchData::Frame frame = BenchData::createFrame(PixelFormat::RGB24, 64, 36);
+		const QByteArray data(reinterpret_cast<const char*>(frame.data.data()), (int)frame.data.size());
+
+		return QString("{\"command\":\"image\",\"priority\":50,\"origin\":\"hyperhdr-bench\",\"imagewidth\":64,\"imageheight\":36,\"imagedata\":\"%1\"}")
+			.arg(QString::fromLatin1(data.toBase64()));
+	}
+
+	///
+	/// Parsing and schema validation of a JSON-RPC message, the part of JsonAPI::handleMessage
+	/// that runs for every message before the command is dispatched
+	///
+	void BM_JsonRpc_handleMessage(benchmark::State& state, const char* command)
+	{
+		initJsonRpcSchemas();
+
+		Logger* log = Logger::getInstance("BENCH");
+		const QString ident = "JsonRpc@bench";
+		QString message;
+
+		if (QString(command) == "color")
+			message = "{\"command\":\"color\",\"priority\":50,\"origin\":\"hyperhdr-bench\",\"color\":[255,128,0],\"duration\":0}";
+		else if (QString(command) == "image")
+			message = imageMessage();
+		else if (QString(command) == "componentstate")
+			message = "{\"command\":\"componentstate\",\"componentstate\":{\"component\":\"SMOOTHING\",\"state\":true}}";
+		else
+			message = "{\"command\":\"serverinfo\",\"subscribe\":[\"all\"],\"tan\":1}";
+
+		for (auto _ : state)
+		{
+			QJsonObject json;
+			bool valid = JsonUtils::parse(ident, message, json, log) &&
+						JsonUtils::validate(ident, json, ":schema", log) &&
+						JsonUtils::validate(ident, json, QString(":schema-%1").arg(json["command"].toString()), log);
+
+			if (!valid)
+			{
+				state.SkipWithError("The message was rejected");
+				break;
+			}
+			benchmark::DoNotOptimize(json);
+		}
+	}
+
+	///
+	/// Cost of the always-on metrics on the hot paths. With several threads all of them update
+	/// the same metric, as the LED device and grabber threads do.
+	///
+	void BM_Metrics_CounterAdd(benchmark::State& state)
+	{
+		static Metrics::Counter* counter = Metrics::counter("hyperhdr_bench_counter_total", "Benchmark counter");
+
+		for (auto _ : state)
+			counter->add();
+	}
+
+	///
+	/// Reference for the contended cases: one atomic shared by all threads, without the shards
+	///
+	void BM_Metrics_SharedAtomicAdd(benchmark::State& state)
+	{
+		static std::atomic<uint64_t> counter(0);
+
+		for (auto _ : state)
+			counter.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void BM_Metrics_HistogramObserve(benchmark::State& state)
+	{
+		static Metrics::Histogram* histogram = Metrics::histogram("hyperhdr_bench_duration_seconds", "Benchmark histogram");
+		uint64_t value = 1;
+
+		for (auto _ : state)
+		{
+			histogram->observe(value);
+			value = (value * 3) & 0xFFFFF;
+		}
+	}
+
+	void BM_Metrics_ScopedTimer(benchmark::State& state)
+	{
+		static Metrics::Histogram* histogram = Metrics::histogram("hyperhdr_bench_scope_seconds", "Benchmark scoped timer");
+
+		for (auto _ : state)
+		{
+			Metrics::ScopedTimer timer(histogram);
+		}
+	}
+
+	void BM_Metrics_toPrometheus(benchmark::State& state)
+	{
+		for (auto _ : state)
+		{
+			QByteArray text = Metrics::toPrometheus();
+			benchmark::DoNotOptimize(text.data());
+		}
+	}
+
+	///
+	/// Replay of a recorded YUYV session: frames are read from the mapped capture file and decoded,
+	/// the per-frame work of the replay grabber without its timer
+	///
+	void BM_Replay_YUYV(benchmark::State& state)
+	{
+		const int width = 1280, height = 720, frames = 24;
+		const QString directory = QDir(BenchData::tempPath()).absoluteFilePath("capture");
+		const QString fileName = QDir(directory).absoluteFilePath("replay.hdrcap");
+
+		if (!QFile::exists(fileName))
+		{
+			CaptureRecorder* recorder = CaptureRecorder::getInstance();
+			const BenchData::Frame frame = BenchData::createFrame(PixelFormat::YUYV, width, height);
+			QString error;
+
+			recorder->setDirectory(directory);
+			if (!recorder->start("replay.hdrcap", true, false, error))
+			{
+				state.SkipWithError(error.toUtf8().constData());
+				return;
+			}
+
+			// 24 frames stay below the queue limit of the recorder, nothing is dropped
+			for (int i = 0; i < frames; i++)
+				recorder->addVideoFrame(frame.format, frame.width, frame.height, frame.lineLength, frame.data.data(), (int)frame.data.size());
+
+			recorder->stop();
+		}
+
+		CaptureFileReader reader;
+		if (!reader.open(fileName) || reader.count() == 0)
+		{
+			state.SkipWithError("The capture file could not be read");
+			return;
+		}
+
+		const uint8_t* lut = BenchData::yuvLut();
+		Image<ColorRgb> image;
+		int index = 0;
+
+		for (auto _ : state)
+		{
+			const CaptureFile::RecordHeader& header = reader.header(index);
+
+			if (header.type == static_cast<uint32_t>(CaptureFile::RecordType::VIDEO_FRAME))
+			{
+				ImageResampler::processImage(0, 0, 0, 0, reader.payload(index), (int)header.params[1], (int)header.params[2],
+					(int)header.params[3], static_cast<PixelFormat>(header.params[0]), lut, image);
+				benchmark::DoNotOptimize(image.memptr());
+			}
+
+			index = (index + 1) % reader.count();
+		}
+	}
+
+#ifdef ENABLE_BOBLIGHT
+	const int BOBLIGHT_FRAMES = 10;
+
+	///
+	/// A Boblight session (boblight-X11 style: every light, then sync)
+	///
+	QByteArray boblightSession(int ledCount)
+	{
+		QByteArray session;
+		const std::vector<ColorRgb> colors = BenchData::createLedColors(ledCount);
+
+		for (int frame = 0; frame < BOBLIGHT_FRAMES; frame++)
+		{
+			for (int i = 0; i < ledCount; i++)
+			{
+				const ColorRgb& color = colors[(i + frame) % ledCount];
+				session += QString("set light %1 rgb %2 %3 %4\n").arg(i).arg(color.red / 255.0, 0, 'f', 6)
+					.arg(color.green / 255.0, 0, 'f', 6).arg(color.blue / 255.0, 0, 'f', 6).toLatin1();
+			}
+			session += "sync\n";
+		}
+
+		return session;
+	}
+
+	bool connectLocal(benchmark::State& state, QTcpServer& server, QTcpSocket& client)
+	{
+		if (!server.listen(QHostAddress::LocalHost))
+		{
+			state.SkipWithError("Could not listen on localhost");
+			return false;
+		}
+
+		client.connectToHost(QHostAddress::LocalHost, server.serverPort());
+		if (!client.waitForConnected(5000) || !server.waitForNewConnection(5000))
+		{
+			state.SkipWithError("Could not connect to localhost");
+			return false;
+		}
+
+		return true;
+	}
+
+	///
+	/// The Boblight parser alone: every line of a session is handled in place, as readData does
+	///
+	void BM_Boblight_Parse(benchmark::State& state)
+	{
+		HyperHdrInstance* instance = BenchData::instance();
+		if (instance == nullptr || instance->getLedCount() == 0)
+		{
+			state.SkipWithError("The HyperHDR instance could not be started");
+			return;
+		}
+
+		const QByteArray session = boblightSession(instance->getLedCount());
+		const uint64_t messagesPerIteration = (uint64_t)BOBLIGHT_FRAMES * (instance->getLedCount() + 1);
+
+		QTcpServer server;
+		QTcpSocket client;
+		if (!connectLocal(state, server, client))
+			return;
+
+		// a valid priority: the completed frames are copied as in a real session
+		BoblightClientConnection connection(instance, server.nextPendingConnection(), 0);
+		const char priority[] = "set priority 200";
+		BoblightBench::handleMessage(connection, priority, (int)strlen(priority));
+
+		for (auto _ : state)
+		{
+			const char* line = session.constData();
+			const char* end = line + session.size();
+			const char* newline;
+
+			while ((newline = static_cast<const char*>(memchr(line, '\n', end - line))) != nullptr)
+			{
+				BoblightBench::handleMessage(connection, line, (int)(newline - line));
+				line = newline + 1;
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * messagesPerIteration);
+	}
+
+	///
+	/// Replay of a Boblight session over a local connection
+	///
+	void BM_Boblight_Session(benchmark::State& state)
+	{
+		HyperHdrInstance* instance = BenchData::instance();
+		if (instance == nullptr || instance->getLedCount() == 0)
+		{
+			state.SkipWithError("The HyperHDR instance could not be started");
+			return;
+		}
+
+		const int ledCount = instance->getLedCount();
+		const QByteArray session = boblightSession(ledCount);
+		const uint64_t messagesPerIteration = (uint64_t)BOBLIGHT_FRAMES * (ledCount + 1);
+
+		QTcpServer server;
+		QTcpSocket client;
+		if (!connectLocal(state, server, client))
+			return;
+
+		// priority 0: the messages are parsed, but nothing is sent to the instance
+		BoblightClientConnection connection(instance, server.nextPendingConnection(), 0);
+		Metrics::Counter* messages = Metrics::counter("hyperhdr_boblight_messages_total", "Boblight messages received", Metrics::instanceLabel(instance->getInstanceIndex()));
+
+		for (auto _ : state)
+		{
+			const uint64_t target = messages->value() + messagesPerIteration;
+
+			client.write(session);
+			client.flush();
+
+			QElapsedTimer timeout;
+			timeout.start();
+			while (messages->value() < target && timeout.elapsed() < 5000)
+				QCoreApplication::processEvents(QEventLoop::AllEvents);
+
+			if (messages->value() < target)
+			{
+				state.SkipWithError("The session was not received");
+				break;
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * BOBLIGHT_FRAMES);
+	}
+#endif
+}
+
+BENCHMARK_CAPTURE(BM_JsonRpc_handleMessage, color, "color");
+BENCHMARK_CAPTURE(BM_JsonRpc_handleMessage, image, "image");
+BENCHMARK_CAPTURE(BM_JsonRpc_handleMessage, componentstate, "componentstate");
+BENCHMARK_CAPTURE(BM_JsonRpc_handleMessage, serverinfo, "serverinfo");
+
+BENCHMARK(BM_Metrics_CounterAdd)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_Metrics_SharedAtomicAdd)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_Metrics_HistogramObserve)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_Metrics_ScopedTimer);
+BENCHMARK(BM_Metrics_toPrometheus);
+
+BENCHMARK(BM_Replay_YUYV);
+
+#ifdef ENABLE_BOBLIGHT
+BENCHMARK(BM_Boblight_Parse);
+BENCHMARK(BM_Boblight_Session)->UseRealTime();
+#endif
@@ -0,0 +1,76 @@
+// Google Benchmark
+#include <benchmark/benchmark.h>
+
+// STL includes
+#include <algorithm>
+
+// HyperHDR includes
+#include <utils/ImageResampler.h>
+#include <grabber/smartX11.h>
+
+// Xlib last: its macros (None, Status, Bool...) clash with the other headers
+#include <X11/Xlib.h>
+
+namespace
+{
+	///
+	/// One frame of the X11 grabber: the capture of the root window (arg 0: maximum width, 0 = no scaling on the
+	/// X server) and the CPU resampling to the default 512 pixels wide capture. Needs a display, e.g. Xvfb.
+	/// A corner of the root window is redrawn before every capture, so the XDamage short-cut for an unchanged
+	/// screen never applies.
+	///
+	void BM_X11_CaptureFrame(benchmark::State& state)
+	{
+		const int maxWidth = (int)state.range(0);
+		x11Handle* handle = initX11Display(0);
+
+		if (handle == nullptr)
+		{
+			state.SkipWithError("No X11 display");
+			return;
+		}
+
+		Display* display = (Display*)handle->handle;
+		Window root = DefaultRootWindow(display);
+		GC gc = XCreateGC(display, root, 0, nullptr);
+		XSetSubwindowMode(display, gc, IncludeInferiors);
+
+		Image<ColorRgb> image;
+		unsigned long color = 0;
+
+		handle->maxWidth = maxWidth;
+
+		for (auto _ : state)
+		{
+			// same connection: the damage event is queued before XSync returns
+			state.PauseTiming();
+			XSetForeground(display, gc, (color++) & 0xFFFFFF);
+			XFillRectangle(display, root, gc, 0, 0, 64, 64);
+			XSync(display, False);
+			state.ResumeTiming();
+
+			unsigned char* data = getFrame(handle);
+
+			if (data == nullptr)
+			{
+				state.SkipWithError("Capture failed");
+				break;
+			}
+
+			// the sizes of Grabber::processSystemFrameBGRA
+			const int targetWidth = std::min(handle->width, 512);
+			const int targetHeight = std::max((handle->height * targetWidth) / handle->width, 1);
+
+			image.resize(targetWidth, targetHeight);
+			ImageResampler::processSystemImageBGRA(image, targetWidth, targetHeight, 0, 0, handle->width, handle->height, data, handle->width, handle->height, nullptr);
+			benchmark::DoNotOptimize(image.memptr());
+		}
+
+		state.counters["scaled"] = handle->scaled;
+
+		XFreeGC(display, gc);
+		uninitX11Display(handle);
+	}
+}
+
+BENCHMARK(BM_X11_CaptureFrame)->Arg(0)->Arg(512)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,169 @@
+// Google Benchmark
+#include <benchmark/benchmark.h>
+
+// STL includes
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// Qt includes
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+// HyperHDR includes
+#include <utils/Logger.h>
+
+#include "BenchData.h"
+
+namespace
+{
+	double toNanoseconds(double value, benchmark::TimeUnit unit)
+	{
+		return value * 1e9 / benchmark::GetTimeUnitMultiplier(unit);
+	}
+
+	///
+	/// Console output as usual, the fastest repetition of every benchmark is kept for the baseline comparison
+	///
+	class CollectingReporter : public benchmark::ConsoleReporter
+	{
+	public:
+		void ReportRuns(const std::vector<Run>& reports) override
+		{
+			for (const Run& run : reports)
+			{
+				if (run.run_type != Run::RT_Iteration || run.iterations == 0)
+					continue;
+
+				const double time = toNanoseconds(run.GetAdjustedRealTime(), run.time_unit);
+				auto found = results.find(run.benchmark_name());
+
+				if (found == results.end() || time < found->second)
+					results[run.benchmark_name()] = time;
+			}
+
+			ConsoleReporter::ReportRuns(reports);
+		}
+
+		std::map<std::string, double> results;
+	};
+
+	///
+	/// @brief Read the fastest real time of every benchmark from a --benchmark_out json file
+	///
+	bool loadBaseline(const QString& fileName, std::map<std::string, double>& baseline)
+	{
+		QFile file(fileName);
+		if (!file.open(QIODevice::ReadOnly))
+			return false;
+
+		const QJsonArray benchmarks = QJsonDocument::fromJson(file.readAll()).object()["benchmarks"].toArray();
+
+		for (const QJsonValue& value : benchmarks)
+		{
+			const QJsonObject entry = value.toObject();
+
+			if (entry["run_type"].toString("iteration") != "iteration")
+				continue;
+
+			const QString unit = entry["time_unit"].toString("ns");
+			const benchmark::TimeUnit timeUnit = (unit == "s") ? benchmark::kSecond : (unit == "ms") ? benchmark::kMillisecond :
+				(unit == "us") ? benchmark::kMicrosecond : benchmark::kNanosecond;
+			const double time = toNanoseconds(entry["real_time"].toDouble(), timeUnit);
+			const std::string name = entry["name"].toString().toStdString();
+
+			auto found = baseline.find(name);
+			if (found == baseline.end() || time < found->second)
+				baseline[name] = time;
+		}
+
+		return !baseline.empty();
+	}
+
+	///
+	/// @return The number of benchmarks slower than the baseline by more than the threshold
+	///
+	int compare(const std::map<std::string, double>& baseline, const std::map<std::string, double>& results, double threshold)
+	{
+		int regressions = 0;
+
+		printf("\n%-70s %14s %14s %9s\n", "Benchmark", "Baseline [ns]", "Current [ns]", "Change");
+
+		for (const auto& result : results)
+		{
+			auto found = baseline.find(result.first);
+			if (found == baseline.end() || found->second <= 0)
+			{
+				printf("%-70s %14s %14.0f %9s\n", result.first.c_str(), "-", result.second, "new");
+				continue;
+			}
+
+			const double change = (result.second / found->second - 1.0) * 100.0;
+			const bool regression = change > threshold;
+
+			printf("%-70s %14.0f %14.0f %+8.1f%%%s\n", result.first.c_str(), found->second, result.second, change, regression ? "  REGRESSION" : "");
+
+			if (regression)
+				regressions++;
+		}
+
+		return regressions;
+	}
+}
+
+///
+/// hyperhdr-bench: performance benchmarks of the processing pipeline on fixed synthetic inputs.
+///
+/// All the Google Benchmark flags apply, e.g. --benchmark_filter=<regex>, --benchmark_repetitions=<n>
+/// and --benchmark_out=<file> --benchmark_out_format=json to save the results. In addition:
+///   --baseline=<file>   compare with the results saved by an earlier run, the exit code is 1 on a regression
+///   --threshold=<pct>   allowed slowdown against the baseline (default 10%)
+///
+int main(int argc, char** argv)
+{
+	QString baselineFile;
+	double threshold = 10.0;
+
+	// remove our own options, Google Benchmark rejects unknown flags
+	std::vector<char*> arguments;
+	for (int i = 0; i < argc; i++)
+	{
+		if (strncmp(argv[i], "--baseline=", 11) == 0)
+			baselineFile = QString::fromLocal8Bit(argv[i] + 11);
+		else if (strncmp(argv[i], "--threshold=", 12) == 0)
+			threshold = atof(argv[i] + 12);
+		else
+			arguments.push_back(argv[i]);
+	}
+	int count = (int)arguments.size();
+
+	benchmark::Initialize(&count, arguments.data());
+	if (benchmark::ReportUnrecognizedArguments(count, arguments.data()))
+		return 1;
+
+	std::map<std::string, double> baseline;
+	if (!baselineFile.isEmpty() && !loadBaseline(baselineFile, baseline))
+	{
+		fprintf(stderr, "Could not read the baseline: %s\n", baselineFile.toLocal8Bit().constData());
+		return 1;
+	}
+
+	QCoreApplication app(argc, argv);
+	Logger::setLogLevel(Logger::WARNING);
+
+	CollectingReporter reporter;
+	benchmark::RunSpecifiedBenchmarks(&reporter);
+
+	BenchData::shutdown();
+	Logger::shutdown();
+
+	if (!baseline.empty() && compare(baseline, reporter.results, threshold) > 0)
+		return 1;
+
+	return 0;
+}
@@ -0,0 +1,237 @@
+// Qt includes
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QtTest>
+
+// HyperHDR includes
+#include <utils/Logger.h>
+
+#include "ProviderRestApi.h"
+
+Q_DECLARE_METATYPE(httpResponse)
+
+///
+/// HTTP server on the loopback interface that answers every request with a canned response.
+/// The client runs its own event loop while it waits, so the server can live in the same thread.
+///
+class MockHttpServer : public QTcpServer
+{
+	Q_OBJECT
+
+public:
+	MockHttpServer()
+		: _ignore(0)
+	{
+		connect(this, &QTcpServer::newConnection, this, &MockHttpServer::acceptConnection);
+	}
+
+	void respond(int status, const QString& reason, const QByteArray& body)
+	{
+		_ignore = 0;
+		_response = QString("HTTP/1.1 %1 %2\r\nContent-Type: application/json\r\nContent-Length: %3\r\nConnection: close\r\n\r\n")
+			.arg(status).arg(reason).arg(body.size()).toUtf8() + body;
+	}
+
+	// accept the next requests but never answer them
+	void ignoreRequests(int count)
+	{
+		_ignore = count;
+	}
+
+	QByteArray lastRequestLine() const { return _requestLine; }
+	QByteArray lastBody() const { return _body; }
+
+private slots:
+	void acceptConnection()
+	{
+		while (hasPendingConnections())
+		{
+			QTcpSocket* socket = nextPendingConnection();
+			socket->setProperty("received", QByteArray());
+			connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+			connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { readRequest(socket); });
+		}
+	}
+
+private:
+	void readRequest(QTcpSocket* socket)
+	{
+		QByteArray received = socket->property("received").toByteArray() + socket->readAll();
+		socket->setProperty("received", received);
+
+		int headerEnd = received.indexOf("\r\n\r\n");
+		if (headerEnd < 0)
+			return;
+
+		int contentLength = 0;
+		for (const QByteArray& line : received.left(headerEnd).split('\n'))
+			if (line.toLower().startsWith("content-length:"))
+				contentLength = line.mid(15).trimmed().toInt();
+
+		if (received.size() < headerEnd + 4 + contentLength)
+			return;
+
+		_requestLine = received.left(received.indexOf("\r\n"));
+		_body = received.mid(headerEnd + 4, contentLength);
+		socket->setProperty("received", QByteArray());
+
+		if (_ignore > 0)
+		{
+			_ignore--;
+			return;
+		}
+
+		socket->write(_response);
+		socket->disconnectFromHost();
+	}
+
+	int        _ignore;
+	QByteArray _response;
+	QByteArray _requestLine;
+	QByteArray _body;
+};
+
+///
+/// ProviderRestApi against the mock server: success, HTTP errors, invalid replies and timeouts
+///
+class ProviderRestApiTest : public QObject
+{
+	Q_OBJECT
+
+private:
+	MockHttpServer _server;
+
+	ProviderRestApi* createApi()
+	{
+		ProviderRestApi* api = new ProviderRestApi("127.0.0.1", _server.serverPort(), "/api/token");
+		api->setTimeout(300);
+		return api;
+	}
+
+private slots:
+	void initTestCase()
+	{
+		qRegisterMetaType<httpResponse>("httpResponse");
+		QVERIFY(_server.listen(QHostAddress::LocalHost));
+	}
+
+	void cleanupTestCase()
+	{
+		Logger::shutdown();
+	}
+
+	void getSuccess()
+	{
+		QScopedPointer<ProviderRestApi> api(createApi());
+		_server.respond(200, "OK", "{\"name\":\"bridge\",\"lights\":3}");
+
+		api->setPath("config");
+		httpResponse response = api->get();
+
+		QVERIFY(!response.error());
+		QCOMPARE(response.getHttpStatusCode(), 200);
+		QCOMPARE(response.getBody().object()["name"].toString(), QString("bridge"));
+		QCOMPARE(response.getBody().object()["lights"].toInt(), 3);
+		QCOMPARE(_server.lastRequestLine(), QByteArray("GET /api/token/config HTTP/1.1"));
+	}
+
+	void putSendsTheBody()
+	{
+		QScopedPointer<ProviderRestApi> api(createApi());
+		_server.respond(200, "OK", "[{\"success\":true}]");
+
+		api->setPath("lights/1/state");
+		httpResponse response = api->put("{\"on\":true}");
+
+		QVERIFY(!response.error());
+		QVERIFY(response.getBody().isArray());
+		QCOMPARE(_server.lastRequestLine(), QByteArray("PUT /api/token/lights/1/state HTTP/1.1"));
+		QCOMPARE(_server.lastBody(), QByteArray("{\"on\":true}"));
+	}
+
+	void httpError()
+	{
+		QScopedPointer<ProviderRestApi> api(createApi());
+		_server.respond(404, "Not Found", "{}");
+
+		api->setPath("lights/99");
+		httpResponse response = api->get();
+
+		QVERIFY(response.error());
+		QCOMPARE(response.getHttpStatusCode(), 404);
+		QVERIFY(response.getErrorReason().contains("404"));
+		QVERIFY(response.getErrorReason().contains("Check Resource given"));
+		QVERIFY(response.getBody().isEmpty());
+	}
+
+	void invalidJson()
+	{
+		QScopedPointer<ProviderRestApi> api(createApi());
+		_server.respond(200, "OK", "not json");
+
+		httpResponse response = api->get();
+
+		QVERIFY(response.error());
+		QCOMPARE(response.getHttpStatusCode(), 200);
+		QVERIFY(!response.getErrorReason().isEmpty());
+	}
+
+	void timeout()
+	{
+		QScopedPointer<ProviderRestApi> api(createApi());
+		_server.respond(200, "OK", "{}");
+		_server.ignoreRequests(1);
+
+		QElapsedTimer elapsed;
+		elapsed.start();
+		httpResponse response = api->get();
+
+		QVERIFY(response.error());
+		QCOMPARE(response.getHttpStatusCode(), 0);
+		QCOMPARE(response.getNetworkReplyError(), QNetworkReply::OperationCanceledError);
+		QVERIFY(response.getErrorReason().contains("300 ms"));
+		QVERIFY(elapsed.elapsed() < 3000);
+	}
+
+	void asyncSuccess()
+	{
+		QScopedPointer<ProviderRestApi> api(createApi());
+		QSignalSpy finished(api.data(), &ProviderRestApi::asyncFinished);
+		_server.respond(200, "OK", "[{\"success\":true}]");
+
+		api->putAsync("lights/2/state", "{\"bri\":128}");
+
+		QTRY_COMPARE(finished.count(), 1);
+		QCOMPARE(finished.at(0).at(0).toString(), QString("lights/2/state"));
+		QVERIFY(!finished.at(0).at(1).value<httpResponse>().error());
+		QCOMPARE(_server.lastBody(), QByteArray("{\"bri\":128}"));
+		QCOMPARE(api->getAsyncPendingCount(), 0);
+	}
+
+	void asyncTimeoutReleasesTheSlot()
+	{
+		QScopedPointer<ProviderRestApi> api(createApi());
+		QSignalSpy finished(api.data(), &ProviderRestApi::asyncFinished);
+		_server.respond(200, "OK", "[{\"success\":true}]");
+		_server.ignoreRequests(1);
+
+		// one request in flight: the second one can only be sent after the first has timed out
+		api->setAsyncLimits(1, 0);
+		api->putAsync("lights/1/state", "{\"on\":true}");
+		api->putAsync("lights/2/state", "{\"on\":true}");
+
+		QTRY_COMPARE(finished.count(), 2);
+		QCOMPARE(finished.at(0).at(0).toString(), QString("lights/1/state"));
+		QVERIFY(finished.at(0).at(1).value<httpResponse>().error());
+		QCOMPARE(finished.at(1).at(0).toString(), QString("lights/2/state"));
+		QVERIFY(!finished.at(1).at(1).value<httpResponse>().error());
+		QCOMPARE(api->getAsyncPendingCount(), 0);
+	}
+};
+
+QTEST_GUILESS_MAIN(ProviderRestApiTest)
+
+#include "ProviderRestApiTest.moc"
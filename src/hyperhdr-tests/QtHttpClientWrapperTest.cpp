@@ -0,0 +1,194 @@
+// Qt includes
+#include <QElapsedTimer>
+#include <QTcpSocket>
+#include <QtTest>
+
+// HyperHDR includes
+#include <utils/Logger.h>
+#include <utils/NetOrigin.h>
+
+#include "QtHttpClientWrapper.h"
+#include "QtHttpReply.h"
+#include "QtHttpRequest.h"
+#include "QtHttpServer.h"
+
+///
+/// Request parsing of the web server: the requests arrive over a real loopback connection
+/// in the pieces the test chooses, every reply echoes what the parser extracted.
+///
+class QtHttpClientWrapperTest : public QObject
+{
+	Q_OBJECT
+
+	struct Response
+	{
+		int        status;
+		QByteArray body;
+	};
+
+private:
+	NetOrigin*   _netOrigin;
+	QtHttpServer* _server;
+
+	///
+	/// @brief Send the parts with a pause in between, so each one is received separately
+	///
+	void send(QTcpSocket& socket, const QList<QByteArray>& parts)
+	{
+		for (const QByteArray& part : parts)
+		{
+			socket.write(part);
+			socket.flush();
+			QTest::qWait(20);
+		}
+	}
+
+	///
+	/// @brief Read until the expected number of responses is complete (or the connection is closed)
+	///
+	QList<Response> receive(QTcpSocket& socket, int expected)
+	{
+		QList<Response> responses;
+		QByteArray data;
+		QElapsedTimer timer;
+		timer.start();
+
+		while (responses.size() < expected && timer.elapsed() < 3000)
+		{
+			if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(50))
+			{
+				if (socket.state() != QAbstractSocket::ConnectedState)
+					break;
+				continue;
+			}
+
+			data.append(socket.readAll());
+
+			int headerEnd;
+			while ((headerEnd = data.indexOf("\r\n\r\n")) >= 0)
+			{
+				const QList<QByteArray> lines = data.left(headerEnd).split('\n');
+				int contentLength = 0;
+
+				for (const QByteArray& line : lines)
+					if (line.toLower().startsWith("content-length:"))
+						contentLength = line.mid(15).trimmed().toInt();
+
+				if (data.size() < headerEnd + 4 + contentLength)
+					break;
+
+				Response response;
+				response.status = lines.first().split(' ').value(1).toInt();
+				response.body = data.mid(headerEnd + 4, contentLength);
+				responses.append(response);
+
+				data.remove(0, headerEnd + 4 + contentLength);
+			}
+		}
+
+		return responses;
+	}
+
+	void connectTo(QTcpSocket& socket)
+	{
+		socket.connectToHost(QHostAddress::LocalHost, _server->getServerPort());
+		QVERIFY(socket.waitForConnected(1000));
+	}
+
+private slots:
+	void initTestCase()
+	{
+		_netOrigin = new NetOrigin(this);
+		_server = new QtHttpServer(this);
+
+		connect(_server, &QtHttpServer::requestNeedsReply, this, [](QtHttpRequest* request, QtHttpReply* reply) {
+			reply->appendRawData(request->getCommand().toUtf8() + " " + request->getUrl().path().toUtf8() + " " +
+				request->getHeader("X-Test") + " " + request->getRawData());
+		});
+
+		_server->start(0);
+		QVERIFY(_server->isListening());
+	}
+
+	void cleanupTestCase()
+	{
+		_server->stop();
+		Logger::shutdown();
+	}
+
+	void pipelinedRequests()
+	{
+		QTcpSocket socket;
+		connectTo(socket);
+
+		send(socket, { "GET /first HTTP/1.1\r\nX-Test: 1\r\n\r\nGET /second HTTP/1.1\r\nX-Test: 2\r\n\r\n"
+			"POST /third HTTP/1.1\r\nContent-Length: 5\r\n\r\nabcde" });
+
+		const QList<Response> responses = receive(socket, 3);
+
+		QCOMPARE(responses.size(), 3);
+		QCOMPARE(responses[0].status, 200);
+		QCOMPARE(responses[0].body, QByteArray("GET /first 1 "));
+		QCOMPARE(responses[1].body, QByteArray("GET /second 2 "));
+		QCOMPARE(responses[2].body, QByteArray("POST /third  abcde"));
+	}
+
+	void splitHeaderLines()
+	{
+		QTcpSocket socket;
+		connectTo(socket);
+
+		send(socket, { "GET /spl", "it HTTP/1.1\r", "\nX-Te", "st:  split ", "value\r\n", "\r", "\n" });
+
+		const QList<Response> responses = receive(socket, 1);
+
+		QCOMPARE(responses.size(), 1);
+		QCOMPARE(responses[0].status, 200);
+		QCOMPARE(responses[0].body, QByteArray("GET /split split value "));
+	}
+
+	void splitContent()
+	{
+		QTcpSocket socket;
+		connectTo(socket);
+
+		// the body arrives in pieces and the next request follows the last one
+		send(socket, { "POST /form HTTP/1.1\r\nContent-Length: 6\r\n\r\nab", "cd", "efGET /next HTTP/1.1\r\n\r\n" });
+
+		const QList<Response> responses = receive(socket, 2);
+
+		QCOMPARE(responses.size(), 2);
+		QCOMPARE(responses[0].body, QByteArray("POST /form  abcdef"));
+		QCOMPARE(responses[1].body, QByteArray("GET /next  "));
+	}
+
+	void overLongLine()
+	{
+		QTcpSocket socket;
+		connectTo(socket);
+
+		send(socket, { "GET /long HTTP/1.1\r\nX-Test: " + QByteArray(QtHttpClientWrapper::MAX_LINE_LENGTH + 1, 'a') });
+
+		const QList<Response> responses = receive(socket, 1);
+
+		QCOMPARE(responses.size(), 1);
+		QCOMPARE(responses[0].status, 400);
+	}
+
+	void malformedRequestLine()
+	{
+		QTcpSocket socket;
+		connectTo(socket);
+
+		send(socket, { "GET /a b HTTP/1.1\r\n\r\n" });
+
+		const QList<Response> responses = receive(socket, 1);
+
+		QCOMPARE(responses.size(), 1);
+		QCOMPARE(responses[0].status, 400);
+	}
+};
+
+QTEST_GUILESS_MAIN(QtHttpClientWrapperTest)
+
+#include "QtHttpClientWrapperTest.moc"
@@ -0,0 +1,100 @@
+// STL includes
+#include <cmath>
+#include <vector>
+
+// Qt includes
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtTest>
+
+// HyperHDR includes
+#include <grabber/SoundCapLinux.h>
+#include <utils/Logger.h>
+#include <utils/Metrics.h>
+
+namespace
+{
+	const int    TONE_RATE = 22050;
+	const int    TONE_SECONDS = 4;
+	const double TONE_FREQUENCY = 440.0;
+	const char*  TONE_DEVICE = "hyperhdr_test_tone";
+}
+
+///
+/// Captures a recorded tone through the ALSA 'file' plugin, so no sound card is needed.
+/// The plugin is declared in a private ~/.asoundrc: HOME points to a temporary directory
+/// before the first ALSA call of the process.
+///
+class SoundCapLinuxTest : public QObject
+{
+	Q_OBJECT
+
+private:
+	QTemporaryDir _home;
+
+	Metrics::Counter* publishedFrames()
+	{
+		return Metrics::counter("hyperhdr_sound_frames_total", "Spectrum frames published to the music effects");
+	}
+
+private slots:
+	void initTestCase()
+	{
+		QVERIFY(_home.isValid());
+
+		// S16_LE mono tone at the capture rate
+		std::vector<int16_t> tone(TONE_RATE * TONE_SECONDS);
+		for (size_t i = 0; i < tone.size(); i++)
+			tone[i] = static_cast<int16_t>(8000.0 * sin(2.0 * M_PI * TONE_FREQUENCY * i / TONE_RATE));
+
+		QFile toneFile(_home.filePath("tone.raw"));
+		QVERIFY(toneFile.open(QIODevice::WriteOnly));
+		toneFile.write(reinterpret_cast<const char*>(tone.data()), tone.size() * sizeof(int16_t));
+		toneFile.close();
+
+		QFile asoundrc(_home.filePath(".asoundrc"));
+		QVERIFY(asoundrc.open(QIODevice::WriteOnly | QIODevice::Text));
+		asoundrc.write(QString(
+			"pcm.%1 {\n"
+			"	type file\n"
+			"	slave.pcm \"null\"\n"
+			"	file \"/dev/null\"\n"
+			"	infile \"%2\"\n"
+			"	format \"raw\"\n"
+			"}\n").arg(TONE_DEVICE).arg(toneFile.fileName()).toUtf8());
+		asoundrc.close();
+
+		qputenv("HOME", _home.path().toUtf8());
+	}
+
+	void cleanupTestCase()
+	{
+		Logger::shutdown();
+	}
+
+	void capturesTheTone()
+	{
+		QJsonObject config;
+		config["enable"] = true;
+		config["device"] = TONE_DEVICE;
+
+		SoundCapLinux capture{ QJsonDocument(config) };
+
+		const uint64_t before = publishedFrames()->value();
+
+		capture.Start();
+		QVERIFY2(capture._isRunning, "the file plugin device could not be opened");
+
+		// the device has no clock: the capture is paced to the sample rate, a frame every 512 samples (~43 per second)
+		QTRY_VERIFY_WITH_TIMEOUT(publishedFrames()->value() >= before + 10, 3000);
+
+		capture.Stop();
+		QVERIFY(!capture._isRunning);
+	}
+};
+
+QTEST_GUILESS_MAIN(SoundCapLinuxTest)
+
+#include "SoundCapLinuxTest.moc"
@@ -0,0 +1,76 @@
+// STL includes
+#include <cmath>
+#include <vector>
+
+// Qt includes
+#include <QtTest>
+
+// HyperHDR includes
+#include <hyperhdrbase/SoundCapture.h>
+#include <utils/Logger.h>
+
+namespace
+{
+	const int    SAMPLE_RATE = 22050;
+	const double AMPLITUDE = 8000.0;
+}
+
+///
+/// Feeds synthetic sine waves through the spectrum analysis and checks the band they land in
+///
+class SoundCaptureTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void cleanupTestCase()
+	{
+		Logger::shutdown();
+	}
+
+	void sinePeaksInItsBand_data()
+	{
+		QTest::addColumn<int>("bin");
+		QTest::addColumn<int>("band");
+
+		// FFT bins of 21.5Hz, the tones are centered on a bin
+		QTest::newRow("43Hz") << 2 << 0;
+		QTest::newRow("172Hz") << 8 << 1;
+		QTest::newRow("345Hz") << 16 << 2;
+		QTest::newRow("689Hz") << 32 << 3;
+		QTest::newRow("1378Hz") << 64 << 4;
+		QTest::newRow("2756Hz") << 128 << 5;
+		QTest::newRow("5168Hz") << 240 << 6;
+		QTest::newRow("8613Hz") << 400 << 7;
+	}
+
+	void sinePeaksInItsBand()
+	{
+		QFETCH(int, bin);
+		QFETCH(int, band);
+
+		const double frequency = bin * double(SAMPLE_RATE) / SOUNDCAP_N_WAVE;
+
+		// two full windows, the result is the spectrum of the last one
+		std::vector<int16_t> samples(2 * SOUNDCAP_N_WAVE);
+		for (size_t i = 0; i < samples.size(); i++)
+			samples[i] = static_cast<int16_t>(lrint(AMPLITUDE * sin(2.0 * M_PI * frequency * i / SAMPLE_RATE + 0.3)));
+
+		SoundCapture::InitSpectrum();
+		QVERIFY(SoundCapture::AnaliseSpectrum(samples.data(), SOUNDCAP_LOG2_N_WAVE));
+		QVERIFY(SoundCapture::AnaliseSpectrum(samples.data() + SOUNDCAP_N_WAVE, SOUNDCAP_LOG2_N_WAVE));
+
+		const int32_t* result = SoundCapture::_resultFFT.pureResult;
+
+		// the window gain is compensated: the band holds the amplitude of the tone and the others only leakage
+		QVERIFY2(result[band] > AMPLITUDE * 0.9, qPrintable(QString("band %1: %2").arg(band).arg(result[band])));
+
+		for (int i = 0; i < SOUNDCAP_RESULT_RES; i++)
+			if (i != band)
+				QVERIFY2(result[i] < result[band] / 20, qPrintable(QString("band %1: %2 against %3").arg(i).arg(result[i]).arg(result[band])));
+	}
+};
+
+QTEST_GUILESS_MAIN(SoundCaptureTest)
+
+#include "SoundCaptureTest.moc"
@@ -13,10 +13,15 @@
 #include <cstdint>
 #include <limits>
 #include <QThread>
+#include <QElapsedTimer>
 
 #include <utils/Components.h>
 #include <utils/JsonUtils.h>
 #include <utils/Image.h>
+#include <utils/Metrics.h>
+#include <utils/CaptureRecorder.h>
+#include <utils/ThreadTopology.h>
+#include <effectengine/EffectScheduler.h>
 
 #include <HyperhdrConfig.h> // Required to determine the cmake options
 
@@ -68,7 +73,7 @@
 
 HyperHdrDaemon *HyperHdrDaemon::daemon = nullptr;
 
-HyperHdrDaemon::HyperHdrDaemon(const QString& rootPath, QObject* parent, bool logLvlOverwrite, bool readonlyMode)
+HyperHdrDaemon::HyperHdrDaemon(const QString& rootPath, QObject* parent, bool logLvlOverwrite, bool readonlyMode, const QJsonObject& replayConfig)
 	: QObject(parent), _log(Logger::getInstance("DAEMON"))
 	  , _instanceManager(new HyperHdrIManager(rootPath, this, readonlyMode))
 	  , _authManager(new AuthManager(this, readonlyMode))
@@ -80,6 +85,7 @@ HyperHdrDaemon::HyperHdrDaemon(const QString& rootPath, QObject* parent, bool lo
 	  , _sslWebserver(nullptr)
 	  , _jsonServer(nullptr)
 	  , _v4l2Grabber(nullptr)
+	  , _replayGrabber(nullptr)
 	  , _mfGrabber(nullptr)
 	  , _avfGrabber(nullptr)
 	  , _macGrabber(nullptr)
@@ -91,6 +97,7 @@ HyperHdrDaemon::HyperHdrDaemon(const QString& rootPath, QObject* parent, bool lo
 	  , _snd(nullptr)        
 	#endif
 	  , _rootPath(rootPath)
+	  , _replayConfig(replayConfig)
 {
 	HyperHdrDaemon::daemon = this;
 
@@ -101,6 +108,16 @@ HyperHdrDaemon::HyperHdrDaemon(const QString& rootPath, QObject* parent, bool lo
 	qRegisterMetaType<QMap<quint8, QJsonObject>>("QMap<quint8,QJsonObject>");
 	qRegisterMetaType<std::vector<ColorRgb>>("std::vector<ColorRgb>");
 
+	// startup phases are reported by the metrics API
+	QElapsedTimer phaseTimer;
+	phaseTimer.start();
+	auto endPhase = [&phaseTimer](const char* phase) {
+		Metrics::gauge("hyperhdr_startup_seconds", "Duration of the startup phases", QString("phase=\"%1\"").arg(phase))->set(phaseTimer.restart() / 1000.0);
+	};
+
+	// recordings requested over JSON-RPC are stored in the configuration folder
+	CaptureRecorder::getInstance()->setDirectory(rootPath + "/captures");
+
 	// init settings
 	_settingsManager = new SettingsManager(0, this, readonlyMode);
 
@@ -110,6 +127,9 @@ HyperHdrDaemon::HyperHdrDaemon(const QString& rootPath, QObject* parent, bool lo
 		handleSettingsUpdate(settings::type::LOGGER, getSetting(settings::type::LOGGER));
 	}
 
+	// placement of the threads that are started later
+	handleSettingsUpdate(settings::type::GENERAL, getSetting(settings::type::GENERAL));
+
 #if defined(ENABLE_SOUNDCAPWINDOWS)
 	// init SoundHandler
 	_snd = new SoundCapWindows(getSetting(settings::type::SNDEFFECT), this);
@@ -133,11 +153,16 @@ HyperHdrDaemon::HyperHdrDaemon(const QString& rootPath, QObject* parent, bool lo
 	// connect and apply settings for NetOrigin
 	connect(this, &HyperHdrDaemon::settingsChanged, _netOrigin, &NetOrigin::handleSettingsUpdate);
 	_netOrigin->handleSettingsUpdate(settings::type::NETWORK, _settingsManager->getSetting(settings::type::NETWORK));
+	endPhase("settings");
 
 	// spawn all Hyperhdr instances (non blocking)
 	handleSettingsUpdate(settings::type::VIDEOGRABBER, getSetting(settings::type::VIDEOGRABBER));
 	handleSettingsUpdate(settings::type::SYSTEMGRABBER, getSetting(settings::type::SYSTEMGRABBER));
+	endPhase("grabbers");
+
+	// the "instances" phase is reported by the instance manager once they are all running
 	_instanceManager->startAll();
+	phaseTimer.restart();
 
 	//Cleaning up Hyperhdr before quit
 	connect(parent, SIGNAL(aboutToQuit()), this, SLOT(freeObjects()));
@@ -153,6 +178,7 @@ HyperHdrDaemon::HyperHdrDaemon(const QString& rootPath, QObject* parent, bool lo
 
 	// ---- network services -----
 	startNetworkServices();	
+	endPhase("network");
 }
 
 void HyperHdrDaemon::instanceStateChanged(InstanceState state, quint8 instance, const QString& name)
@@ -163,6 +189,8 @@ void HyperHdrDaemon::instanceStateChanged(InstanceState state, quint8 instance,
 
 HyperHdrDaemon::~HyperHdrDaemon()
 {
+	EffectScheduler::getInstance()->stop();
+
 #if defined(ENABLE_SOUNDCAPWINDOWS) || defined(ENABLE_SOUNDCAPLINUX) || defined(ENABLE_SOUNDCAPMACOS)
 	delete _snd;	
 #endif
@@ -178,6 +206,8 @@ void HyperHdrDaemon::freeObjects()
 {
 	Debug(_log, "Cleaning up HyperHdr before quit.");
 
+	CaptureRecorder::getInstance()->stop();
+
 	// unload cec
 	unloadCEC();
 
@@ -247,6 +277,7 @@ void HyperHdrDaemon::freeObjects()
 #endif	
 
 	delete _v4l2Grabber;
+	delete _replayGrabber;
 	delete _mfGrabber;
 	delete _dxGrabber;
 	delete _avfGrabber;
@@ -254,6 +285,7 @@ void HyperHdrDaemon::freeObjects()
 	delete _x11Grabber;
 
 	_v4l2Grabber = nullptr;
+	_replayGrabber = nullptr;
 	_mfGrabber = nullptr;
 	_dxGrabber = nullptr;
 	_avfGrabber = nullptr;
@@ -360,6 +392,11 @@ void HyperHdrDaemon::handleSettingsUpdate(settings::type settingsType, const QJs
 		}
 	}
 
+	if (settingsType == settings::type::GENERAL)
+	{
+		ThreadTopology::configure(config.object());
+	}
+
 	if (settingsType == settings::type::SNDEFFECT)
 	{
 	}
@@ -397,7 +434,23 @@ void HyperHdrDaemon::handleSettingsUpdate(settings::type settingsType, const QJs
 
 
 #if defined(ENABLE_V4L2)
-		if (_v4l2Grabber == nullptr)
+		if (!_replayConfig.isEmpty())
+		{
+			if (_replayGrabber == nullptr)
+			{
+				QStringList size = _replayConfig["size"].toString().toLower().split('x');
+
+				_replayGrabber = new ReplayWrapper(_replayConfig["source"].toString(),
+					parsePixelFormat(_replayConfig["format"].toString()),
+					(size.length() == 2) ? size[0].toInt() : 1920,
+					(size.length() == 2) ? size[1].toInt() : 1080,
+					_replayConfig["fps"].toInt(-1), _rootPath);
+
+				_replayGrabber->handleSettingsUpdate(settings::type::VIDEOGRABBER, config);
+				connect(this, &HyperHdrDaemon::settingsChanged, _replayGrabber, &ReplayWrapper::handleSettingsUpdate);
+			}
+		}
+		else if (_v4l2Grabber == nullptr)
 		{
 			_v4l2Grabber = new V4L2Wrapper(grabberConfig["device"].toString("auto"), _rootPath);
 
@@ -408,6 +461,11 @@ void HyperHdrDaemon::handleSettingsUpdate(settings::type settingsType, const QJs
 		Warning(_log, "!The v4l2 grabber can not be instantiated, because it has been left out from the build");		
 #endif
 
+#if !defined(ENABLE_V4L2)
+		if (!_replayConfig.isEmpty())
+			Warning(_log, "The replay grabber requires the V4L2 workers, which have been left out from the build");
+#endif
+
 		emit settingsChanged(settings::type::VIDEODETECTION, getSetting(settings::type::VIDEODETECTION));
 	}
 
@@ -6,8 +6,10 @@
 
 #ifdef ENABLE_V4L2
 	#include <grabber/V4L2Wrapper.h>
+	#include <grabber/ReplayWrapper.h>
 #else
 	typedef QObject V4L2Wrapper;
+	typedef QObject ReplayWrapper;
 #endif
 
 #ifdef ENABLE_MF
@@ -83,7 +85,7 @@ class HyperHdrDaemon : public QObject
 	friend SysTray;
 
 public:
-	HyperHdrDaemon(const QString& rootPath, QObject *parent, bool logLvlOverwrite, bool readonlyMode = false);
+	HyperHdrDaemon(const QString& rootPath, QObject *parent, bool logLvlOverwrite, bool readonlyMode = false, const QJsonObject& replayConfig = QJsonObject());
 	~HyperHdrDaemon();
 
 	///
@@ -148,6 +150,7 @@ private:
 	WebServer*                 _sslWebserver;
 	JsonServer*                _jsonServer;
 	V4L2Wrapper*               _v4l2Grabber;
+	ReplayWrapper*             _replayGrabber;
 	MFWrapper*                 _mfGrabber;
 	AVFWrapper*                _avfGrabber;
 	macOsWrapper*              _macGrabber;
@@ -183,4 +186,7 @@ private:
 	
 	// application root path
 	QString _rootPath;
+
+	// replay source that replaces the video grabber (command line)
+	QJsonObject _replayConfig;
 };
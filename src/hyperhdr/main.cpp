@@ -34,6 +34,9 @@
 #include <commandline/Parser.h>
 #include <commandline/IntOption.h>
 #include <utils/DefaultSignalHandler.h>
+#ifdef ENABLE_PROFILER
+	#include <utils/Profiler.h>
+#endif
 #include <../../include/db/AuthTable.h>
 
 #include "detectProcess.h"
@@ -171,6 +174,11 @@ int main(int argc, char** argv)
 	BooleanOption & silentOption        = parser.add<BooleanOption> ('s', "silent", "Do not print any outputs");
 	BooleanOption & verboseOption       = parser.add<BooleanOption> ('v', "verbose", "Increase verbosity");
 	BooleanOption & debugOption         = parser.add<BooleanOption> ('d', "debug", "Show debug messages");
+	Option        & binaryLogOption     = parser.add<Option>        (0x0, "binaryLog", "Write a compact binary copy of the log to the given file");
+	Option        & replayOption        = parser.add<Option>        (0x0, "replay", "Replace the video grabber with a test pattern (bars, noise, letterbox, hdr) or a capture file");
+	Option        & replayFormatOption  = parser.add<Option>        (0x0, "replayFormat", "Pixel format of the test pattern: yuyv, nv12, i420, mjpeg, xrgb or rgb24 (default: %1)", "yuyv");
+	Option        & replaySizeOption    = parser.add<Option>        (0x0, "replaySize", "Resolution of the test pattern (default: %1)", "1920x1080");
+	IntOption     & replayFpsOption     = parser.add<IntOption>     (0x0, "replayFps", "Replay rate: 0 = as fast as possible, -1 = rate of the source (default: %1)", "-1", -1, 1000);
 #ifdef WIN32
 	BooleanOption & consoleOption       = parser.add<BooleanOption> ('c', "console", "Open a console window to view log output");
 #endif
@@ -240,6 +248,11 @@ int main(int argc, char** argv)
 		return 0;
 	}
 
+	if (parser.isSet(binaryLogOption) && !Logger::setBinaryLogFile(binaryLogOption.value(parser)))
+	{
+		Error(log, "Could not open the binary log file: %s", QSTRING_CSTR(binaryLogOption.value(parser)));
+	}
+
 	int rc = 1;
 	bool readonlyMode = false;
 
@@ -345,7 +358,17 @@ int main(int argc, char** argv)
 		HyperHdrDaemon* hyperhdrd = nullptr;
 		try
 		{
-			hyperhdrd = new HyperHdrDaemon(userDataDirectory.absolutePath(), qApp, bool(logLevelCheck), readonlyMode);
+			QJsonObject replayConfig;
+
+			if (parser.isSet(replayOption))
+			{
+				replayConfig["source"] = replayOption.value(parser);
+				replayConfig["format"] = replayFormatOption.value(parser);
+				replayConfig["size"] = replaySizeOption.value(parser);
+				replayConfig["fps"] = replayFpsOption.getInt(parser);
+			}
+
+			hyperhdrd = new HyperHdrDaemon(userDataDirectory.absolutePath(), qApp, bool(logLevelCheck), readonlyMode, replayConfig);
 		}
 		catch (std::exception& e)
 		{
@@ -368,6 +391,12 @@ int main(int argc, char** argv)
 		}
 		Info(log, "Application closed with code %d", rc);
 		delete hyperhdrd;
+
+#ifdef ENABLE_PROFILER
+		PROFILER_SAVE_STATISTICS(userDataDirectory.absolutePath() + "/profiler.json");
+		if (QFile::exists(userDataDirectory.absolutePath() + "/profiler-baseline.json"))
+			PROFILER_COMPARE_STATISTICS(userDataDirectory.absolutePath() + "/profiler-baseline.json", 10);
+#endif
 	}
 	catch (std::exception& e)
 	{
@@ -376,6 +405,7 @@ int main(int argc, char** argv)
 
 	// delete components
 	Logger::deleteInstance();
+	Logger::shutdown();
 
 #ifdef _WIN32
 	if (parser.isSet(consoleOption))